@@ -97,6 +97,7 @@ extern int64_t autoinclude;     /* Automatically includes files in the DCB */
 extern int64_t imports[];       /* Chain codes with import names */
 extern int64_t nimports;        /* Number of imports */
 extern int64_t libmode;
+extern int64_t optimize;
 
 extern char langinfo[64] ;  /* language setting */
 
@@ -121,17 +122,19 @@ typedef struct _sysproc {
     BASETYPE type;
     int64_t  params;
     int64_t  id;
+    int64_t  flags;
 
     /* For sysproc_list */
     struct _sysproc * next;
 } SYSPROC;
 
 extern void sysproc_init();
-extern int64_t sysproc_add(char * name, char * paramtypes, int type, void * func);
+extern int64_t sysproc_add(char * name, char * paramtypes, int type, void * func, int64_t flags);
 extern SYSPROC *  sysproc_get(int64_t id);
 extern SYSPROC ** sysproc_getall(int64_t id);
 extern char * sysproc_name(int64_t code);
 extern SYSPROC * sysproc_by_name( int64_t code );
+extern SYSPROC * sysproc_by_code( int64_t code );
 
 extern void compile_warning( int, const char *fmt, ... );
 extern void compile_error( const char *fmt, ... );
@@ -561,7 +561,7 @@ static void import_module( const char * filename ) {
     functions_exports = ( DLSYSFUNCS * ) _dlibaddr( library, "functions_exports" );
     if ( functions_exports ) {
         while ( functions_exports->name ) {
-            sysproc_add( functions_exports->name, functions_exports->paramtypes, functions_exports->type, functions_exports->func );
+            sysproc_add( functions_exports->name, functions_exports->paramtypes, functions_exports->type, functions_exports->func, functions_exports->flags );
             functions_exports++;
         }
     }
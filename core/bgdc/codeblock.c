@@ -32,6 +32,8 @@
 
 #include "bgdc.h"
 
+#include <bgddl.h>
+
 /*
  *  FUNCTION : codeblock_postprocess
  *
@@ -125,6 +127,1347 @@ void codeblock_postprocess(CODEBLOCK * code) {
 	}
 }
 
+/*
+ *  FUNCTION : codeblock_optimize
+ *
+ *  Bytecode optimizer, run after codeblock_postprocess once every
+ *  jump holds its final offset. It works in passes:
+ *
+ *  - Folding: operations over constants are computed at compile time
+ *    (PUSH + PUSH + <op>, PUSH + <unary op>, PUSH/INDEX + INDEX), conditional
+ *    jumps over a constant become a JUMP or disappear, jumps to a JUMP
+ *    go straight to its destination and jumps to the next instruction
+ *    are removed.
+ *
+ *  - Dead code: instructions that can't be reached from the entry
+ *    point or the exit/error handlers are removed.
+ *
+ *    Both passes are repeated while they find something to do.
+ *
+ *  - Fusion: values pushed only to be popped are removed, and some
+ *    common sequences are replaced with superinstructions:
+ *
+ *      <cmp> + JFALSE                          -> JFALSE_<cmp>
+ *      <var> + PUSH + VARADD/VARSUB + POP      -> VARADD_<var>
+ *      <var> + INC/DEC/POSTINC/POSTDEC + POP   -> VARADD_<var>
+ *      <var> + GET_<var> + INDEX + LETNP       -> VARADD_<var>
+ *
+ *  A sequence is never rewritten if a jump lands inside it. After each
+ *  pass the code is compacted, and every jump, the exit/error handlers,
+ *  labels and loops are moved to the new offsets.
+ *
+ *  PARAMS :
+ *      code			Pointer to the codeblock to modify
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+#define OPTIMIZE_MAX_PASSES	16
+
+/* A rewrite rule: emits the replacement for the sequence starting at
+ * data[i] and returns the number of words used, or 0 if it doesn't apply */
+
+typedef int (* peephole_rule)(int64_t * data, int n, int i, const char * target, int64_t * out, int * o);
+
+static int codeblock_is_jump(int64_t code) {
+	switch (code & MN_MASK) {
+		case MN_JFALSE_EQ:
+		case MN_JFALSE_NE:
+		case MN_JFALSE_GT:
+		case MN_JFALSE_LT:
+		case MN_JFALSE_GTE:
+		case MN_JFALSE_LTE:
+			return 1;
+	}
+	return code == MN_JUMP      || code == MN_NCALL   ||
+	       code == MN_JFALSE    || code == MN_JTFALSE ||
+	       code == MN_JTRUE     || code == MN_JTTRUE  ||
+	       code == MN_JNOCASE   || code == MN_CLONE   ||
+	       code == MN_EXITHNDLR || code == MN_ERRHNDLR;
+}
+
+static int codeblock_next(int64_t * data, int n, int i) {
+	return i < n ? i + MN_PARAMS(data[i]) + 1 : n;
+}
+
+/* Mark every offset that can be reached other than by falling through */
+
+static void codeblock_targets(CODEBLOCK * code, PROCDEF * my, char * target) {
+	int64_t * data = code->data;
+	int n = code->current, i;
+
+	memset(target, 0, n + 1);
+
+	for (i = 0; i < n; i += MN_PARAMS(data[i]) + 1) {
+		if (codeblock_is_jump(data[i]) && data[i+1] >= 0 && data[i+1] <= n) target[data[i+1]] = 1;
+		if (data[i] == MN_NCALL && i + 2 <= n) target[i+2] = 1; /* return address */
+	}
+	for (i = 0; i < code->label_count; i++) if (code->labels[i] >= 0 && code->labels[i] <= n) target[code->labels[i]] = 1;
+	for (i = 0; i < code->loop_count * 2; i++) if (code->loops[i] >= 0 && code->loops[i] <= n) target[code->loops[i]] = 1;
+	if (my->exitcode > 0 && my->exitcode <= n) target[my->exitcode] = 1;
+	if (my->errorcode > 0 && my->errorcode <= n) target[my->errorcode] = 1;
+}
+
+/* Mark every instruction that can't be executed. Returns how many were found */
+
+static int codeblock_unreachable(CODEBLOCK * code, PROCDEF * my, char * dead) {
+	int64_t * data = code->data;
+	int n = code->current, i, count = 0, sp = 0;
+	int * stack = (int *) calloc(n + 3, sizeof(int));
+
+	if (!stack) {
+		fprintf(stdout, "CODEBLOCK: out of memory\n");
+		exit(1);
+	}
+
+	memset(dead, 1, n + 1);
+
+	stack[sp++] = 0;
+	if (my->exitcode > 0 && my->exitcode < n) stack[sp++] = my->exitcode;
+	if (my->errorcode > 0 && my->errorcode < n) stack[sp++] = my->errorcode;
+
+	while (sp > 0) {
+		i = stack[--sp];
+		while (i < n && dead[i]) {
+			dead[i] = 0;
+			if (codeblock_is_jump(data[i]) && data[i+1] >= 0 && data[i+1] < n && dead[data[i+1]]) stack[sp++] = data[i+1];
+			if (data[i] == MN_JUMP || data[i] == MN_END || data[i] == MN_RETURN) break;
+			i = codeblock_next(data, n, i);
+		}
+	}
+
+	for (i = 0; i < n; i += MN_PARAMS(data[i]) + 1) if (dead[i]) count++;
+
+	free(stack);
+	return count;
+}
+
+/* Apply a rule over the whole codeblock, dropping the dead instructions.
+ * Returns the number of changes */
+
+static int codeblock_rewrite(CODEBLOCK * code, PROCDEF * my, peephole_rule rule, const char * dead) {
+	int64_t * data = code->data, * out;
+	int n = code->current, i, k, o, len, changes = 0;
+	int * newpos;
+	char * target;
+
+	target = (char *) calloc(n + 1, sizeof(char));
+	newpos = (int *) calloc(n + 1, sizeof(int));
+	out = (int64_t *) calloc(n + 1, sizeof(int64_t));
+	if (!target || !newpos || !out) {
+		fprintf(stdout, "CODEBLOCK: out of memory\n");
+		exit(1);
+	}
+
+	codeblock_targets(code, my, target);
+
+	for (i = 0, o = 0; i < n; i += len) {
+		int start = o;
+
+		len = MN_PARAMS(data[i]) + 1;
+
+		if (dead && dead[i]) {
+			changes++;
+		} else if (rule && (k = rule(data, n, i, target, out, &o)) > 0) {
+			len = k;
+			changes++;
+		} else {
+			memcpy(out + o, data + i, len * sizeof(int64_t));
+			o += len;
+		}
+
+		for (k = i; k < i + len && k < n; k++) newpos[k] = start;
+	}
+	newpos[n] = o;
+
+	/* Relocate */
+
+	for (i = 0; i < o; i += MN_PARAMS(out[i]) + 1) {
+		if (codeblock_is_jump(out[i]) && out[i+1] >= 0 && out[i+1] <= n) out[i+1] = newpos[out[i+1]];
+	}
+	for (i = 0; i < code->label_count; i++) if (code->labels[i] >= 0 && code->labels[i] <= n) code->labels[i] = newpos[code->labels[i]];
+	for (i = 0; i < code->loop_count * 2; i++) if (code->loops[i] >= 0 && code->loops[i] <= n) code->loops[i] = newpos[code->loops[i]];
+	if (my->exitcode > 0 && my->exitcode <= n) my->exitcode = newpos[my->exitcode];
+	if (my->errorcode > 0 && my->errorcode <= n) my->errorcode = newpos[my->errorcode];
+
+	memcpy(code->data, out, o * sizeof(int64_t));
+	code->current = o;
+	code->previous = code->previous2 = 0;
+
+	free(out);
+	free(newpos);
+	free(target);
+
+	return changes;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Folding                                                                */
+/* ---------------------------------------------------------------------- */
+
+/* Same conversions that the interpreter does with the stack values */
+
+static double codeblock_fold_getf(int64_t type, int64_t v) {
+	if (MN_TYPEOF(type) == MN_FLOAT) {
+		float f;
+		memcpy(&f, &v, sizeof(f));
+		return f;
+	}
+	return *(double *) &v;
+}
+
+static int64_t codeblock_fold_setf(int64_t type, int64_t v, double d) {
+	if (MN_TYPEOF(type) == MN_FLOAT) {
+		float f = (float) d;
+		memcpy(&v, &f, sizeof(f));
+		return v;
+	}
+	return *(int64_t *) &d;
+}
+
+static int64_t codeblock_fold_cast(int64_t type, int64_t v) {
+	switch (MN_TYPEOF(type)) {
+		case MN_DWORD:					return (int32_t) v;
+		case MN_DWORD | MN_UNSIGNED:	return (uint32_t) v;
+		case MN_WORD:					return (int16_t) v;
+		case MN_WORD | MN_UNSIGNED:		return (uint16_t) v;
+		case MN_BYTE:					return (int8_t) v;
+		case MN_BYTE | MN_UNSIGNED:		return (uint8_t) v;
+	}
+	return v;
+}
+
+static int codeblock_fold_unsigned(int64_t type) {
+	return (MN_TYPEOF(type) & MN_UNSIGNED) != 0;
+}
+
+static int codeblock_fold_isfloat(int64_t type) {
+	return MN_TYPEOF(type) == MN_FLOAT || MN_TYPEOF(type) == MN_DOUBLE;
+}
+
+/* Fold a binary operation. Returns 0 if it can't be done at compile time */
+
+static int codeblock_fold_binary(int64_t op, int64_t a, int64_t b, int64_t * r) {
+	int64_t t = MN_TYPEOF(op);
+
+	if (t == MN_STRING) return 0;
+
+	if (codeblock_fold_isfloat(op)) {
+		double fa = codeblock_fold_getf(op, a), fb = codeblock_fold_getf(op, b);
+		switch (op & MN_MASK) {
+			case MN_ADD:	*r = codeblock_fold_setf(op, a, fa + fb); return 1;
+			case MN_SUB:	*r = codeblock_fold_setf(op, a, fa - fb); return 1;
+			case MN_MUL:	*r = codeblock_fold_setf(op, a, fa * fb); return 1;
+			case MN_DIV:	*r = codeblock_fold_setf(op, a, fa / fb); return 1;
+			case MN_EQ:		*r = fa == fb; return 1;
+			case MN_NE:		*r = fa != fb; return 1;
+			case MN_GT:		*r = fa >  fb; return 1;
+			case MN_LT:		*r = fa <  fb; return 1;
+			case MN_GTE:	*r = fa >= fb; return 1;
+			case MN_LTE:	*r = fa <= fb; return 1;
+		}
+		return 0;
+	}
+
+	switch (op & MN_MASK) {
+		case MN_AND:	*r = a && b; return 1;
+		case MN_OR:		*r = a || b; return 1;
+		case MN_XOR:	*r = (a != 0) ^ (b != 0); return 1;
+
+		/* MUL and DIV use the 64 bits handlers for every integer type */
+
+		case MN_ADD:	*r = (int64_t)((uint64_t) a + (uint64_t) b); return 1;
+		case MN_SUB:	*r = (int64_t)((uint64_t) a - (uint64_t) b); return 1;
+		case MN_MUL:	*r = (int64_t)((uint64_t) a * (uint64_t) b); return 1;
+
+		case MN_DIV:
+			if (!b) return 0; /* Runtime error */
+			if (codeblock_fold_unsigned(op)) *r = (int64_t)((uint64_t) a / (uint64_t) b);
+			else if (b == -1 && a == INT64_MIN) return 0;
+			else *r = a / b;
+			return 1;
+	}
+
+	/* The stack value is int64_t, the operand is casted to the data type */
+
+	b = codeblock_fold_cast(op, b);
+
+	switch (op & MN_MASK) {
+		case MN_BAND:	*r = a & b; return 1;
+		case MN_BOR:	*r = a | b; return 1;
+		case MN_BXOR:	*r = a ^ b; return 1;
+
+		case MN_MOD:
+			if (!b) return 0; /* Runtime error */
+			if (MN_TYPEOF(op) == (MN_QWORD | MN_UNSIGNED)) *r = (int64_t)((uint64_t) a % (uint64_t) b);
+			else if (b == -1 && a == INT64_MIN) return 0;
+			else *r = a % b;
+			return 1;
+
+		case MN_ROL:
+		case MN_ROR:
+			if (b < 0 || b > 63) return 0;
+			if ((op & MN_MASK) == MN_ROL) *r = (int64_t)((uint64_t) a << b);
+			else *r = a >> b;
+			return 1;
+	}
+
+	/* Comparisons cast both values */
+
+	a = codeblock_fold_cast(op, a);
+
+	if (codeblock_fold_unsigned(op)) {
+		switch (op & MN_MASK) {
+			case MN_GT:		*r = (uint64_t) a >  (uint64_t) b; return 1;
+			case MN_LT:		*r = (uint64_t) a <  (uint64_t) b; return 1;
+			case MN_GTE:	*r = (uint64_t) a >= (uint64_t) b; return 1;
+			case MN_LTE:	*r = (uint64_t) a <= (uint64_t) b; return 1;
+		}
+		return 0;
+	}
+
+	switch (op & MN_MASK) {
+		case MN_EQ:		*r = a == b; return 1;
+		case MN_NE:		*r = a != b; return 1;
+		case MN_GT:		*r = a >  b; return 1;
+		case MN_LT:		*r = a <  b; return 1;
+		case MN_GTE:	*r = a >= b; return 1;
+		case MN_LTE:	*r = a <= b; return 1;
+	}
+	return 0;
+}
+
+/* Fold an unary operation. Returns 0 if it can't be done at compile time */
+
+static int codeblock_fold_unary(int64_t op, int64_t a, int64_t * r) {
+	if (MN_TYPEOF(op) == MN_STRING) return 0;
+
+	if (codeblock_fold_isfloat(op)) {
+		double fa = codeblock_fold_getf(op, a);
+		switch (op & MN_MASK) {
+			case MN_NEG:	*r = codeblock_fold_setf(op, a, -fa); return 1;
+			case MN_NOT:	*r = codeblock_fold_setf(op, a, !fa); return 1;
+		}
+		return 0;
+	}
+
+	switch (op & MN_MASK) {
+		case MN_NEG:	*r = (int64_t)(0 - (uint64_t) a); return 1;
+		case MN_NOT:	*r = !a; return 1;
+		case MN_BNOT:	*r = codeblock_fold_cast(op, ~a); return 1;
+	}
+	return 0;
+}
+
+/* Follow a chain of JUMPs */
+
+static int64_t codeblock_jump_dest(int64_t * data, int n, int64_t dest) {
+	int hops = 0;
+	while (dest >= 0 && dest < n && data[dest] == MN_JUMP && data[dest+1] != dest && hops++ < n) dest = data[dest+1];
+	return dest;
+}
+
+static int codeblock_rule_fold(int64_t * data, int n, int i, const char * target, int64_t * out, int * o) {
+	int i1 = codeblock_next(data, n, i), i2 = codeblock_next(data, n, i1), i3 = codeblock_next(data, n, i2);
+	int64_t r;
+
+	/* Jumps to a JUMP, or to the next instruction */
+
+	if (data[i] == MN_JUMP  || data[i] == MN_JFALSE  || data[i] == MN_JTRUE ||
+	    data[i] == MN_JTFALSE || data[i] == MN_JTTRUE)
+	{
+		if (data[i] == MN_JUMP && data[i+1] == i1) return i1 - i;
+
+		r = codeblock_jump_dest(data, n, data[i+1]);
+		if (r != data[i+1]) {
+			out[(*o)++] = data[i];
+			out[(*o)++] = r;
+			return i1 - i;
+		}
+		return 0;
+	}
+
+	if (i1 >= n || target[i1]) return 0;
+
+	/* INDEX + INDEX */
+
+	if (data[i] == MN_INDEX && data[i1] == MN_INDEX) {
+		out[(*o)++] = MN_INDEX;
+		out[(*o)++] = (int64_t)((uint64_t) data[i+1] + (uint64_t) data[i1+1]);
+		return i2 - i;
+	}
+
+	if (data[i] != MN_PUSH) return 0;
+
+	/* Conditional jump over a constant */
+
+	if (data[i1] == MN_JFALSE || data[i1] == MN_JTRUE) {
+		if (!data[i+1] == (data[i1] == MN_JFALSE)) {
+			out[(*o)++] = MN_JUMP;
+			out[(*o)++] = data[i1+1];
+		}
+		return i2 - i;
+	}
+
+	/* PUSH + ADD/SUB -> INDEX */
+
+	if (data[i1] == MN_ADD || data[i1] == MN_SUB) {
+		out[(*o)++] = MN_INDEX;
+		out[(*o)++] = data[i1] == MN_ADD ? data[i+1] : (int64_t)(0 - (uint64_t) data[i+1]);
+		return i2 - i;
+	}
+
+	/* PUSH + INDEX */
+
+	if (data[i1] == MN_INDEX) {
+		out[(*o)++] = MN_PUSH;
+		out[(*o)++] = (int64_t)((uint64_t) data[i+1] + (uint64_t) data[i1+1]);
+		return i2 - i;
+	}
+
+	/* PUSH + <unary op> */
+
+	if (!MN_PARAMS(data[i1]) && codeblock_fold_unary(data[i1], data[i+1], &r)) {
+		out[(*o)++] = MN_PUSH;
+		out[(*o)++] = r;
+		return i2 - i;
+	}
+
+	/* PUSH + PUSH + <binary op> */
+
+	if (data[i1] == MN_PUSH && i2 < n && !target[i2] && !MN_PARAMS(data[i2]) &&
+	    codeblock_fold_binary(data[i2], data[i+1], data[i1+1], &r))
+	{
+		out[(*o)++] = MN_PUSH;
+		out[(*o)++] = r;
+		return i3 - i;
+	}
+
+	return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Fusion                                                                 */
+/* ---------------------------------------------------------------------- */
+
+/* Fused opcode for a variable access (PRIVATE/LOCAL/GLOBAL), or 0 */
+
+static int64_t codeblock_varadd_op(int64_t code) {
+	switch (code & MN_MASK) {
+		case MN_PRIVATE:
+		case MN_GET_PRIV:
+			return MN_VARADD_PRIV;
+		case MN_LOCAL:
+		case MN_GET_LOCAL:
+			return MN_VARADD_LOCAL;
+		case MN_GLOBAL:
+		case MN_GET_GLOBAL:
+			return MN_VARADD_GLOBAL;
+	}
+	return 0;
+}
+
+/* Data types handled by the VARADD_* superinstructions */
+
+static int codeblock_varadd_type(int64_t code) {
+	switch (MN_TYPEOF(code)) {
+		case MN_QWORD:
+		case MN_DWORD:
+		case MN_WORD:
+		case MN_BYTE:
+		case MN_QWORD | MN_UNSIGNED:
+		case MN_DWORD | MN_UNSIGNED:
+		case MN_WORD | MN_UNSIGNED:
+		case MN_BYTE | MN_UNSIGNED:
+		case MN_FLOAT:
+			return 1;
+	}
+	return 0;
+}
+
+/* Immediate for VARADD_*, in the variable data type. Returns 0 if it doesn't fit */
+
+static int codeblock_varadd_imm(int64_t type, int64_t value, int is_float, int negate, int32_t * imm) {
+	if (MN_TYPEOF(type) == MN_FLOAT) {
+		float f;
+		int32_t bits = (int32_t) value;
+		if (is_float) memcpy(&f, &bits, sizeof(f));
+		else          f = (float) value;
+		if (negate) f = -f;
+		memcpy(imm, &f, sizeof(f));
+		return 1;
+	}
+	if (is_float) return 0;
+	if (negate) value = -value;
+	if (value < INT32_MIN || value > INT32_MAX) return 0;
+	*imm = (int32_t) value;
+	return 1;
+}
+
+static int codeblock_rule_fuse(int64_t * data, int n, int i, const char * target, int64_t * out, int * o) {
+	int i1 = codeblock_next(data, n, i), i2 = codeblock_next(data, n, i1), i3 = codeblock_next(data, n, i2);
+	int i4 = codeblock_next(data, n, i3);
+	int32_t imm;
+	int64_t op, c;
+
+	if (i1 >= n || target[i1]) return 0;
+
+	/* Values pushed and discarded right away */
+
+	if (data[i1] == MN_POP &&
+	   (data[i] == MN_DUP || data[i] == MN_PUSH ||
+	   (MN_TYPEOF(data[i]) != MN_STRING && codeblock_varadd_op(data[i]))))
+	{
+		return i2 - i;
+	}
+
+	/* <cmp> + JFALSE */
+
+	if (data[i1] == MN_JFALSE && MN_TYPEOF(data[i]) != MN_STRING) {
+		switch (data[i] & MN_MASK) {
+			case MN_EQ:  op = MN_JFALSE_EQ;  break;
+			case MN_NE:  op = MN_JFALSE_NE;  break;
+			case MN_GT:  op = MN_JFALSE_GT;  break;
+			case MN_LT:  op = MN_JFALSE_LT;  break;
+			case MN_GTE: op = MN_JFALSE_GTE; break;
+			case MN_LTE: op = MN_JFALSE_LTE; break;
+			default:     op = 0;             break;
+		}
+		if (op) {
+			out[(*o)++] = op | MN_TYPEOF(data[i]);
+			out[(*o)++] = data[i1+1];
+			return i2 - i;
+		}
+	}
+
+	/* <var> + ... -> VARADD_<var> */
+
+	op = MN_PARAMS(data[i]) ? codeblock_varadd_op(data[i]) : 0;
+	if (!op || ((data[i] & MN_MASK) != MN_PRIVATE && (data[i] & MN_MASK) != MN_LOCAL && (data[i] & MN_MASK) != MN_GLOBAL) ||
+	    data[i+1] < 0 || data[i+1] > UINT32_MAX || i2 >= n || target[i2])
+	{
+		return 0;
+	}
+
+	c = data[i1] & MN_MASK;
+
+	/* <var> + INC/DEC/POSTINC/POSTDEC + POP */
+
+	if ((c == MN_INC || c == MN_DEC || c == MN_POSTINC || c == MN_POSTDEC) &&
+	    codeblock_varadd_type(data[i1]) && data[i2] == MN_POP &&
+	    codeblock_varadd_imm(data[i1], data[i1+1], 0, c == MN_DEC || c == MN_POSTDEC, &imm))
+	{
+		out[(*o)++] = op | MN_TYPEOF(data[i1]);
+		out[(*o)++] = MN_VARIMM(data[i+1], imm);
+		return i3 - i;
+	}
+
+	if (i3 >= n || target[i3]) return 0;
+
+	/* <var> + PUSH + VARADD/VARSUB + POP */
+
+	if (data[i1] == MN_PUSH &&
+	   ((data[i2] & MN_MASK) == MN_VARADD || (data[i2] & MN_MASK) == MN_VARSUB) &&
+	    codeblock_varadd_type(data[i2]) && data[i3] == MN_POP &&
+	    codeblock_varadd_imm(data[i2], data[i1+1], MN_TYPEOF(data[i2]) == MN_FLOAT, (data[i2] & MN_MASK) == MN_VARSUB, &imm))
+	{
+		out[(*o)++] = op | MN_TYPEOF(data[i2]);
+		out[(*o)++] = MN_VARIMM(data[i+1], imm);
+		return i4 - i;
+	}
+
+	/* <var> + GET_<var> + INDEX + LETNP (var = var + imm) */
+
+	if (codeblock_varadd_op(data[i1]) == op && (data[i1] & MN_MASK) != (data[i] & MN_MASK) &&
+	    data[i1+1] == data[i+1] && data[i2] == MN_INDEX &&
+	    (data[i3] & MN_MASK) == MN_LETNP && MN_TYPEOF(data[i3]) == MN_TYPEOF(data[i1]) &&
+	    MN_TYPEOF(data[i3]) != MN_FLOAT && codeblock_varadd_type(data[i3]) &&
+	    codeblock_varadd_imm(data[i3], data[i2+1], 0, 0, &imm))
+	{
+		out[(*o)++] = op | MN_TYPEOF(data[i3]);
+		out[(*o)++] = MN_VARIMM(data[i+1], imm);
+		return i4 - i;
+	}
+
+	return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* String appends                                                         */
+/* ---------------------------------------------------------------------- */
+
+/* s = s + a + b ... is compiled as <addr> <addr> PTR <a> ADD <b> ADD LETNP,
+ * so every step copies the whole string. When <a>, <b> ... have no side
+ * effects it's rewritten as <addr> <a> VARADD <b> VARADD POP, and the
+ * runtime appends in place (the variable is the only user of its string) */
+
+#define STRCAT_ADDR_LIMIT	16	/* Longest address expression, in words */
+
+static int codeblock_stack_effect(int64_t code, int64_t param, int * pop, int * push);
+
+/* Instructions without side effects, that only work with the stack values */
+
+static int codeblock_strcat_pure(int64_t code) {
+	switch (code & MN_MASK) {
+		case MN_PUSH:
+		case MN_PRIVATE:
+		case MN_PUBLIC:
+		case MN_LOCAL:
+		case MN_GLOBAL:
+		case MN_GET_PRIV:
+		case MN_GET_PUBLIC:
+		case MN_GET_LOCAL:
+		case MN_GET_GLOBAL:
+		case MN_INDEX:
+		case MN_ARRAY:
+		case MN_PTR:
+		case MN_NEG:
+		case MN_NOT:
+		case MN_BNOT:
+		case MN_MUL:
+		case MN_DIV:
+		case MN_ADD:
+		case MN_SUB:
+		case MN_MOD:
+		case MN_ROR:
+		case MN_ROL:
+		case MN_AND:
+		case MN_OR:
+		case MN_XOR:
+		case MN_EQ:
+		case MN_NE:
+		case MN_GT:
+		case MN_LT:
+		case MN_GTE:
+		case MN_LTE:
+		case MN_BAND:
+		case MN_BOR:
+		case MN_BXOR:
+			return 1;
+	}
+	return 0;
+}
+
+/* Conversions of the value at stack_ptr[-param-1] */
+
+static int codeblock_strcat_convert(int64_t code) {
+	switch (code & MN_MASK) {
+		case MN_INT2STR:
+		case MN_DOUBLE2STR:
+		case MN_FLOAT2STR:
+		case MN_CHR2STR:
+		case MN_POINTER2STR:
+		case MN_INT2FLOAT:
+		case MN_FLOAT2INT:
+		case MN_FLOAT2DOUBLE:
+		case MN_DOUBLE2FLOAT:
+		case MN_INT2DOUBLE:
+		case MN_DOUBLE2INT:
+		case MN_INT2DWORD:
+		case MN_INT2WORD:
+		case MN_INT2BYTE:
+			return 1;
+	}
+	return 0;
+}
+
+/* Variable access opcodes that read the value at the address pushed by the other one */
+
+static int codeblock_strcat_get(int64_t addr) {
+	switch (addr & MN_MASK) {
+		case MN_PRIVATE:	return MN_GET_PRIV;
+		case MN_PUBLIC:		return MN_GET_PUBLIC;
+		case MN_LOCAL:		return MN_GET_LOCAL;
+		case MN_GLOBAL:		return MN_GET_GLOBAL;
+	}
+	return 0;
+}
+
+/* Stack depth after a pure instruction, or -1 if it uses values below 0 */
+
+static int codeblock_strcat_depth(int64_t * data, int k, int d) {
+	int pop, push;
+
+	if (codeblock_strcat_convert(data[k])) return data[k+1] < d ? d : -1;
+
+	if (!codeblock_strcat_pure(data[k]) || !codeblock_stack_effect(data[k], MN_PARAMS(data[k]) ? data[k+1] : 0, &pop, &push)) return -1;
+
+	/* Operators read one value more than they pop */
+	if (d < pop + !push) return -1;
+
+	return d - pop + push;
+}
+
+static int codeblock_rule_strcat(int64_t * data, int n, int i, const char * target, int64_t * out, int * o) {
+	int64_t get = codeblock_strcat_get(data[i]);
+	int a, x, k, d, segment = 0;
+
+	if (!codeblock_strcat_pure(data[i])) return 0;
+
+	/* Find the address and where the value is read again */
+
+	if (get && MN_TYPEOF(data[i]) == MN_STRING && (a = codeblock_next(data, n, i)) < n &&
+	    data[a] == (get | MN_STRING) && data[a+1] == data[i+1])
+	{
+		/* <var> GET_<var> */
+		x = codeblock_next(data, n, a);
+	} else {
+		/* <addr> <addr> PTR */
+		get = 0;
+		for (a = i, d = 0; ; ) {
+			if (a >= n || a - i > STRCAT_ADDR_LIMIT || (a > i && target[a])) return 0;
+			if (data[a] == (MN_PTR | MN_STRING) || (d = codeblock_strcat_depth(data, a, d)) < 0) return 0;
+			a = codeblock_next(data, n, a);
+			if (d == 1 && a + (a - i) < n && !memcmp(data + i, data + a, (a - i) * sizeof(int64_t)) &&
+			    data[a + (a - i)] == (MN_PTR | MN_STRING)) break;
+		}
+		x = a + (a - i) + 1;
+	}
+
+	/* The rest must be a chain of ADD|STRING with operands without side effects */
+
+	for (k = a, d = 0; k < n; k = codeblock_next(data, n, k)) {
+		if (target[k]) return 0;
+		if (k < x) continue;
+
+		if (d == 1 && data[k] == (MN_ADD | MN_STRING)) {
+			segment++;
+			d = 0;
+			if (codeblock_next(data, n, k) < n && data[codeblock_next(data, n, k)] == (MN_LETNP | MN_STRING)) break;
+			continue;
+		}
+
+		if ((d = codeblock_strcat_depth(data, k, d)) < 0) return 0;
+
+		/* After the first append the variable has changed, it can't be read again */
+		if (segment && MN_TYPEOF(data[k]) == MN_STRING && (data[k] & MN_MASK) != MN_PUSH &&
+		   ((data[k] & MN_MASK) == MN_PTR || !get || (data[k] == (get | MN_STRING) && data[k+1] == data[i+1])))
+		{
+			return 0;
+		}
+	}
+
+	k = codeblock_next(data, n, k);
+	if (k >= n || target[k]) return 0;
+
+	/* <addr> <a> VARADD <b> VARADD ... POP */
+
+	memcpy(out + *o, data + i, (a - i) * sizeof(int64_t));
+	*o += a - i;
+
+	for (k = x, d = 0; data[k] != (MN_LETNP | MN_STRING); k = codeblock_next(data, n, k)) {
+		if (d == 1 && data[k] == (MN_ADD | MN_STRING)) {
+			out[(*o)++] = MN_VARADD | MN_STRING;
+			d = 0;
+			continue;
+		}
+		d = codeblock_strcat_depth(data, k, d);
+		memcpy(out + *o, data + k, (MN_PARAMS(data[k]) + 1) * sizeof(int64_t));
+		*o += MN_PARAMS(data[k]) + 1;
+	}
+	out[(*o)++] = MN_POP;
+
+	return codeblock_next(data, n, k) - i;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void codeblock_optimize(CODEBLOCK * code) {
+	PROCDEF * my = procdef_search_by_codeblock( code );
+	int pass, changes;
+	char * dead;
+
+	if (!my || my->imported || !code->current) return;
+
+	dead = (char *) calloc(code->current + 1, sizeof(char));
+	if (!dead) {
+		fprintf(stdout, "CODEBLOCK: out of memory\n");
+		exit(1);
+	}
+
+	for (pass = 0; pass < OPTIMIZE_MAX_PASSES; pass++) {
+		changes = codeblock_rewrite(code, my, codeblock_rule_fold, NULL);
+		if (codeblock_unreachable(code, my, dead)) changes += codeblock_rewrite(code, my, NULL, dead);
+		if (!changes) break;
+	}
+
+	codeblock_rewrite(code, my, codeblock_rule_strcat, NULL);
+	codeblock_rewrite(code, my, codeblock_rule_fuse, NULL);
+
+	free(dead);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Stack usage                                                            */
+/* ---------------------------------------------------------------------- */
+
+/* The runtime keeps the stack size (in bytes) in 15 bits */
+
+#define STACK_DEPTH_LIMIT	4094
+
+/* Get how many values an instruction pops and pushes. Returns 0 if the
+ * effect is unknown */
+
+static int codeblock_stack_effect(int64_t code, int64_t param, int * pop, int * push) {
+	PROCDEF * proc;
+	SYSPROC * sys;
+
+	*pop = *push = 0;
+
+	switch (code & MN_MASK) {
+		case MN_DUP:
+		case MN_PUSH:
+		case MN_PRIVATE:
+		case MN_PUBLIC:
+		case MN_LOCAL:
+		case MN_GLOBAL:
+		case MN_GET_PRIV:
+		case MN_GET_PUBLIC:
+		case MN_GET_LOCAL:
+		case MN_GET_GLOBAL:
+		case MN_TYPE:
+		case MN_NCALL:
+			*push = 1;
+			return 1;
+
+		case MN_POP:
+		case MN_ARRAY:
+		case MN_SWITCH:
+		case MN_CASE:
+		case MN_JFALSE:
+		case MN_JTRUE:
+		case MN_FRAME:
+		case MN_LET:
+		case MN_VARADD:
+		case MN_VARSUB:
+		case MN_VARMUL:
+		case MN_VARDIV:
+		case MN_VARMOD:
+		case MN_VARXOR:
+		case MN_VARAND:
+		case MN_VAROR:
+		case MN_VARROR:
+		case MN_VARROL:
+		case MN_STRI2CHR:
+		case MN_STR2A:
+		case MN_STRACAT:
+		case MN_STR2CHARNUL:
+		case MN_MUL:
+		case MN_DIV:
+		case MN_ADD:
+		case MN_SUB:
+		case MN_MOD:
+		case MN_ROR:
+		case MN_ROL:
+		case MN_AND:
+		case MN_OR:
+		case MN_XOR:
+		case MN_EQ:
+		case MN_NE:
+		case MN_GT:
+		case MN_LT:
+		case MN_GTE:
+		case MN_LTE:
+		case MN_BAND:
+		case MN_BOR:
+		case MN_BXOR:
+			*pop = 1;
+			return 1;
+
+		case MN_CASE_R:
+		case MN_LETNP:
+		case MN_COPY_ARRAY:
+		case MN_COPY_ARRAY_REPEAT:
+		case MN_JFALSE_EQ:
+		case MN_JFALSE_NE:
+		case MN_JFALSE_GT:
+		case MN_JFALSE_LT:
+		case MN_JFALSE_GTE:
+		case MN_JFALSE_LTE:
+			*pop = 2;
+			return 1;
+
+		case MN_COPY_STRUCT:
+			*pop = 4;
+			return 1;
+
+		case MN_NOP:
+		case MN_END:
+		case MN_RETURN:
+		case MN_DEBUG:
+		case MN_SENTENCE:
+		case MN_INDEX:
+		case MN_REMOTE:
+		case MN_REMOTE_PUBLIC:
+		case MN_PTR:
+		case MN_GET_REMOTE:
+		case MN_GET_REMOTE_PUBLIC:
+		case MN_NEG:
+		case MN_NOT:
+		case MN_BNOT:
+		case MN_POSTINC:
+		case MN_POSTDEC:
+		case MN_INC:
+		case MN_DEC:
+		case MN_VARADD_PRIV:
+		case MN_VARADD_LOCAL:
+		case MN_VARADD_GLOBAL:
+		case MN_INT2STR:
+		case MN_DOUBLE2STR:
+		case MN_FLOAT2STR:
+		case MN_CHR2STR:
+		case MN_INT2FLOAT:
+		case MN_FLOAT2INT:
+		case MN_FLOAT2DOUBLE:
+		case MN_DOUBLE2FLOAT:
+		case MN_INT2DOUBLE:
+		case MN_DOUBLE2INT:
+		case MN_INT2DWORD:
+		case MN_INT2WORD:
+		case MN_INT2BYTE:
+		case MN_A2STR:
+		case MN_STR2POINTER:
+		case MN_POINTER2STR:
+		case MN_STR2INT:
+		case MN_STR2DOUBLE:
+		case MN_STR2FLOAT:
+		case MN_STR2CHR:
+		case MN_JUMP:
+		case MN_JTFALSE:
+		case MN_JTTRUE:
+		case MN_JNOCASE:
+		case MN_CLONE:
+		case MN_EXITHNDLR:
+		case MN_ERRHNDLR:
+			return 1;
+
+		case MN_CALL:
+		case MN_PROC:
+			proc = libmode ? procdef_search(param) : procdef_get(param);
+			if (!proc || proc->params < 0) return 0;
+			*pop = proc->params;
+			/* CALL stores the result one slot over the value it pushes */
+			*push = (code & MN_MASK) == MN_CALL ? 2 : 0;
+			return 1;
+
+		case MN_SYSCALL:
+		case MN_SYSPROC:
+			if (!(sys = sysproc_by_code(param))) return 0;
+			*pop = sys->params;
+			*push = (code & MN_MASK) == MN_SYSCALL ? 1 : 0;
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Record a new (deeper) stack depth for the instruction at offset i */
+
+static void codeblock_stack_visit(int * depth, char * queued, int * pending, int * sp, int i, int d) {
+	if (d > depth[i]) {
+		depth[i] = d;
+		if (!queued[i]) {
+			queued[i] = 1;
+			pending[(*sp)++] = i;
+		}
+	}
+}
+
+/*
+ *  FUNCTION : codeblock_stack_size
+ *
+ *  Compute the maximum stack depth that the code of a process can reach,
+ *  following every path from its entry point and from its ONEXIT/ONERROR
+ *  handlers. Handlers may start with the stack as deep as the process
+ *  body leaves it at any point.
+ *
+ *  PARAMS :
+ *      code			Pointer to the codeblock
+ *
+ *  RETURN VALUE :
+ *      Stack size in bytes (including the size header) or 0 if the
+ *      depth can't be known (the runtime uses its default size then)
+ */
+
+int64_t codeblock_stack_size(CODEBLOCK * code) {
+	PROCDEF * my = procdef_search_by_codeblock( code );
+	int64_t * data = code->data;
+	int n = code->current, i, d, nd, pop, push, sp = 0, peak = 0, phase;
+	int * depth, * pending;
+	char * queued;
+
+	if (!my || !n) return 0;
+
+	depth = (int *) malloc((n + 1) * sizeof(int));
+	pending = (int *) malloc((n + 1) * sizeof(int));
+	queued = (char *) calloc(n + 1, sizeof(char));
+	if (!depth || !pending || !queued) {
+		fprintf(stdout, "CODEBLOCK: out of memory\n");
+		exit(1);
+	}
+
+	for (i = 0; i <= n; i++) depth[i] = -1;
+
+	codeblock_stack_visit(depth, queued, pending, &sp, 0, 0);
+
+	/* Phase 0 runs the body, phase 1 the handlers */
+
+	for (phase = 0; phase < 2; phase++) {
+		if (phase) {
+			int entry = peak;
+			if (my->exitcode > 0 && my->exitcode < n) codeblock_stack_visit(depth, queued, pending, &sp, my->exitcode, entry);
+			if (my->errorcode > 0 && my->errorcode < n) codeblock_stack_visit(depth, queued, pending, &sp, my->errorcode, entry);
+			for (i = 0; i < n; i = codeblock_next(data, n, i)) {
+				if ((data[i] == MN_EXITHNDLR || data[i] == MN_ERRHNDLR) && data[i+1] > 0 && data[i+1] < n)
+					codeblock_stack_visit(depth, queued, pending, &sp, data[i+1], entry);
+			}
+		}
+
+		while (sp > 0) {
+			i = pending[--sp];
+			queued[i] = 0;
+			d = depth[i];
+
+			if (i >= n) continue;
+
+			if (!codeblock_stack_effect(data[i], MN_PARAMS(data[i]) ? data[i+1] : 0, &pop, &push) || pop > d) {
+				peak = -1;
+				break;
+			}
+
+			nd = d - pop + push;
+			if (nd > peak) peak = nd;
+			if (peak > STACK_DEPTH_LIMIT) {
+				peak = -1;
+				break;
+			}
+
+			/* The CALL result slot is not kept */
+			if (data[i] == MN_CALL) nd--;
+
+			switch (data[i]) {
+				case MN_END:
+				case MN_RETURN:
+					continue;
+
+				case MN_NCALL:
+					if (data[i+1] >= 0 && data[i+1] < n) codeblock_stack_visit(depth, queued, pending, &sp, data[i+1], nd);
+					codeblock_stack_visit(depth, queued, pending, &sp, codeblock_next(data, n, i), d);
+					continue;
+
+				case MN_EXITHNDLR:
+				case MN_ERRHNDLR:
+					break;
+
+				default:
+					if (codeblock_is_jump(data[i]) && data[i+1] >= 0 && data[i+1] < n) codeblock_stack_visit(depth, queued, pending, &sp, data[i+1], nd);
+					if (data[i] == MN_JUMP) continue;
+					break;
+			}
+
+			codeblock_stack_visit(depth, queued, pending, &sp, codeblock_next(data, n, i), nd);
+		}
+
+		if (peak < 0) break;
+	}
+
+	free(queued);
+	free(pending);
+	free(depth);
+
+	return peak < 0 ? 0 : (int64_t)(peak + 1) * sizeof(int64_t);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Parallel safety                                                        */
+/* ---------------------------------------------------------------------- */
+
+/* The analysis keeps one bit per stack slot */
+
+#define PARALLEL_DEPTH_LIMIT	64
+
+#define SLOT(n)			(1ULL << (n))
+#define SLOTS_BELOW(n)	(SLOT(n) - 1)
+
+/* Merge the state of a path into the instruction at offset i. A slot is
+ * only taken as an own address if it is one on every path */
+
+static int codeblock_parallel_visit(int * depth, uint64_t * own, char * queued, int * pending, int * sp, int i, int d, uint64_t mask) {
+	if (depth[i] < 0) {
+		depth[i] = d;
+		own[i] = mask;
+	} else if (depth[i] != d) {
+		return 0;
+	} else if ((own[i] & mask) != own[i]) {
+		own[i] &= mask;
+	} else {
+		return 1;
+	}
+
+	if (!queued[i]) {
+		queued[i] = 1;
+		pending[(*sp)++] = i;
+	}
+	return 1;
+}
+
+/*
+ *  FUNCTION : codeblock_parallel_safe
+ *
+ *  Check if the code of a process only works with its own data, so the
+ *  runtime may run it on a worker thread at the same time as others.
+ *  The code must not access globals or other processes, create processes,
+ *  use strings or call functions not declared as reentrant. Every address
+ *  used to read or write memory is tracked on the stack, and must come
+ *  from one of the process's own variables.
+ *
+ *  PARAMS :
+ *      code			Pointer to the codeblock
+ *
+ *  RETURN VALUE :
+ *      1 if the process is parallel safe, 0 otherwise
+ */
+
+int codeblock_parallel_safe(CODEBLOCK * code) {
+	PROCDEF * my = procdef_search_by_codeblock( code );
+	int64_t * data = code->data;
+	int n = code->current, i, d, nd, pop, push, sp = 0, safe = 1;
+	int * depth, * pending;
+	uint64_t * own, mask;
+	char * queued;
+	SYSPROC * sys;
+
+	if (!my || my->imported || !n) return 0;
+
+	depth = (int *) malloc((n + 1) * sizeof(int));
+	own = (uint64_t *) malloc((n + 1) * sizeof(uint64_t));
+	pending = (int *) malloc((n + 1) * sizeof(int));
+	queued = (char *) calloc(n + 1, sizeof(char));
+	if (!depth || !own || !pending || !queued) {
+		fprintf(stdout, "CODEBLOCK: out of memory\n");
+		exit(1);
+	}
+
+	for (i = 0; i <= n; i++) depth[i] = -1;
+
+	/* Handlers start over whatever the body left, but never touch it */
+
+	codeblock_parallel_visit(depth, own, queued, pending, &sp, 0, 0, 0);
+	if (my->exitcode > 0 && my->exitcode < n) safe = codeblock_parallel_visit(depth, own, queued, pending, &sp, my->exitcode, 0, 0);
+	if (my->errorcode > 0 && my->errorcode < n && safe) safe = codeblock_parallel_visit(depth, own, queued, pending, &sp, my->errorcode, 0, 0);
+	for (i = 0; i < n && safe; i = codeblock_next(data, n, i)) {
+		if ((data[i] == MN_EXITHNDLR || data[i] == MN_ERRHNDLR) && data[i+1] > 0 && data[i+1] < n)
+			safe = codeblock_parallel_visit(depth, own, queued, pending, &sp, data[i+1], 0, 0);
+	}
+
+	while (safe && sp > 0) {
+		i = pending[--sp];
+		queued[i] = 0;
+		d = depth[i];
+		mask = own[i];
+
+		if (i >= n) continue;
+
+		if (!codeblock_stack_effect(data[i], MN_PARAMS(data[i]) ? data[i+1] : 0, &pop, &push) || pop > d) {
+			safe = 0;
+			break;
+		}
+
+		nd = d - pop + push;
+		if (nd >= PARALLEL_DEPTH_LIMIT) {
+			safe = 0;
+			break;
+		}
+
+		/* The string table is shared */
+
+		if (MN_TYPEOF(data[i]) == MN_STRING) {
+			switch (data[i] & MN_MASK) {
+				case MN_PRIVATE:
+				case MN_PUBLIC:
+				case MN_LOCAL:
+				case MN_INDEX:
+				case MN_ARRAY:
+					break;
+
+				default:
+					safe = 0;
+					break;
+			}
+			if (!safe) break;
+		}
+
+		switch (data[i] & MN_MASK) {
+			/* Addresses of its own variables, and offsets from them */
+
+			case MN_PRIVATE:
+			case MN_PUBLIC:
+			case MN_LOCAL:
+				mask |= SLOT(d);
+				break;
+
+			case MN_INDEX:
+				break;
+
+			case MN_ARRAY:
+				mask &= SLOTS_BELOW(nd);
+				break;
+
+			case MN_DUP:
+				mask = (mask & SLOTS_BELOW(d)) | ((mask & SLOT(d - 1)) << 1);
+				break;
+
+			/* Memory accesses */
+
+			case MN_PTR:
+			case MN_INC:
+			case MN_DEC:
+			case MN_POSTINC:
+			case MN_POSTDEC:
+				if (!(mask & SLOT(d - 1))) safe = 0;
+				mask &= SLOTS_BELOW(d - 1);
+				break;
+
+			case MN_LET:
+			case MN_LETNP:
+			case MN_VARADD:
+			case MN_VARSUB:
+			case MN_VARMUL:
+			case MN_VARDIV:
+			case MN_VARMOD:
+			case MN_VARXOR:
+			case MN_VARAND:
+			case MN_VAROR:
+			case MN_VARROR:
+			case MN_VARROL:
+				if (!(mask & SLOT(d - 2))) safe = 0;
+				mask &= SLOTS_BELOW(d - 2);
+				break;
+
+			case MN_COPY_ARRAY:
+			case MN_COPY_ARRAY_REPEAT:
+				if (!(mask & SLOT(d - 3)) || !(mask & SLOT(d - 2))) safe = 0;
+				mask &= SLOTS_BELOW(d - 3);
+				break;
+
+			case MN_SYSCALL:
+			case MN_SYSPROC:
+				if (!(sys = sysproc_by_code(data[i+1])) || !(sys->flags & SYSFUNC_REENTRANT)) safe = 0;
+				mask &= SLOTS_BELOW(d - pop);
+				break;
+
+			/* Flow control, no new values */
+
+			case MN_NOP:
+			case MN_POP:
+			case MN_JUMP:
+			case MN_JFALSE:
+			case MN_JTRUE:
+			case MN_JTFALSE:
+			case MN_JTTRUE:
+			case MN_JNOCASE:
+			case MN_JFALSE_EQ:
+			case MN_JFALSE_NE:
+			case MN_JFALSE_GT:
+			case MN_JFALSE_LT:
+			case MN_JFALSE_GTE:
+			case MN_JFALSE_LTE:
+			case MN_SWITCH:
+			case MN_CASE:
+			case MN_CASE_R:
+			case MN_FRAME:
+			case MN_END:
+			case MN_RETURN:
+			case MN_EXITHNDLR:
+			case MN_ERRHNDLR:
+			case MN_VARADD_PRIV:
+			case MN_VARADD_LOCAL:
+				mask &= SLOTS_BELOW(nd);
+				break;
+
+			/* Values that aren't addresses */
+
+			case MN_PUSH:
+			case MN_GET_PRIV:
+			case MN_GET_PUBLIC:
+			case MN_GET_LOCAL:
+			case MN_TYPE:
+			case MN_NCALL:
+			case MN_NEG:
+			case MN_NOT:
+			case MN_BNOT:
+			case MN_MUL:
+			case MN_DIV:
+			case MN_ADD:
+			case MN_SUB:
+			case MN_MOD:
+			case MN_ROR:
+			case MN_ROL:
+			case MN_AND:
+			case MN_OR:
+			case MN_XOR:
+			case MN_BAND:
+			case MN_BOR:
+			case MN_BXOR:
+			case MN_EQ:
+			case MN_NE:
+			case MN_GT:
+			case MN_LT:
+			case MN_GTE:
+			case MN_LTE:
+			case MN_INT2FLOAT:
+			case MN_FLOAT2INT:
+			case MN_FLOAT2DOUBLE:
+			case MN_DOUBLE2FLOAT:
+			case MN_INT2DOUBLE:
+			case MN_DOUBLE2INT:
+			case MN_INT2DWORD:
+			case MN_INT2WORD:
+			case MN_INT2BYTE:
+				mask &= SLOTS_BELOW(nd - 1);
+				break;
+
+			/* Globals, other processes, process creation, strings, debugging... */
+
+			default:
+				safe = 0;
+				break;
+		}
+
+		if (!safe) break;
+
+		switch (data[i]) {
+			case MN_END:
+			case MN_RETURN:
+				continue;
+
+			case MN_NCALL:
+				if (data[i+1] >= 0 && data[i+1] < n) safe = codeblock_parallel_visit(depth, own, queued, pending, &sp, data[i+1], nd, mask);
+				if (safe) safe = codeblock_parallel_visit(depth, own, queued, pending, &sp, codeblock_next(data, n, i), d, mask);
+				continue;
+
+			case MN_EXITHNDLR:
+			case MN_ERRHNDLR:
+				break;
+
+			default:
+				if (codeblock_is_jump(data[i]) && data[i+1] >= 0 && data[i+1] < n) safe = codeblock_parallel_visit(depth, own, queued, pending, &sp, data[i+1], nd, mask);
+				if (data[i] == MN_JUMP) continue;
+				break;
+		}
+
+		if (safe) safe = codeblock_parallel_visit(depth, own, queued, pending, &sp, codeblock_next(data, n, i), nd, mask);
+	}
+
+	free(queued);
+	free(pending);
+	free(own);
+	free(depth);
+
+	return safe;
+}
+
 /*
  *  FUNCTION : codeblock_init
  *
@@ -76,6 +76,9 @@ extern void codeblock_label_set(CODEBLOCK * c, int64_t label, int offset);
 extern int64_t codeblock_label_get(CODEBLOCK * c, int64_t label);
 extern int64_t codeblock_label_get_id_by_name(CODEBLOCK * c, int64_t name);
 extern void codeblock_postprocess(CODEBLOCK * c);
+extern void codeblock_optimize(CODEBLOCK * c);
+extern int64_t codeblock_stack_size(CODEBLOCK * c);
+extern int codeblock_parallel_safe(CODEBLOCK * c);
 extern void codeblock_dump(CODEBLOCK * c);
 extern void mnemonic_dump(int64_t i, int64_t param);
 extern void program_postprocess();
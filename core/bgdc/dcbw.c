@@ -39,6 +39,7 @@
 
 #include "bgdc.h"
 #include "dcb.h"
+#include "zpack.h"
 
 #define SYSPROCS_ONLY_DECLARE
 #include "sysprocs.h"
@@ -115,11 +116,45 @@ void dcb_add_file( const char * filename ) {
         if ( strcmp( filename, (const char *)dcb_files[i].Name ) == 0 ) return;
 
     dcb_files[dcb_filecount].Name = (uint8_t *) strdup( filename );
+    dcb_files[dcb_filecount].Flags = 0;
     dcb_files[dcb_filecount].SFile = size;
 
     dcb_filecount++;
 }
 
+/* Compress an included file, if it's worth it (at least 1/8 smaller).
+ * Returns the data to store (uncompressed size + zpack block) or NULL */
+
+static uint8_t * dcb_pack_file( const char * filename, uint64_t size, uint64_t * packed ) {
+    uint8_t * data, * out;
+    uint64_t len = size;
+    int outsize = 0;
+    file * fp;
+
+    if ( size < 64 || size > INT32_MAX / 2 ) return NULL;
+
+    data = ( uint8_t * ) malloc( size );
+    out = ( uint8_t * ) malloc( sizeof( len ) + size );
+    if ( !data || !out ) compile_error( MSG_OUT_OF_MEMORY );
+
+    fp = file_open( filename, "rb" );
+    if ( !fp || file_read( fp, data, size ) != size ||
+         !( outsize = zpack_compress( data, size, out + sizeof( len ), size - size / 8 ) ) ) {
+        if ( fp ) file_close( fp );
+        free( data );
+        free( out );
+        return NULL;
+    }
+    file_close( fp );
+    free( data );
+
+    ARRANGE_QWORD( &len );
+    memcpy( out, &len, sizeof( len ) );
+
+    *packed = sizeof( len ) + outsize;
+    return out;
+}
+
 /* Hack for set ID's to varspaces */
 
 VARSPACE ** dcb_orig_varspace = 0;
@@ -186,6 +221,7 @@ int dcb_save( const char * filename, int options, const char * stubname ) {
     uint64_t n, i, size;
     identifier * id;
     file * fp;
+    uint8_t ** packed = NULL;
 
     int64_t NPriVars = 0,
             NPubVars = 0,
@@ -198,7 +234,7 @@ int dcb_save( const char * filename, int options, const char * stubname ) {
     SYSPROC * s;
     int64_t NSysProcs = 0;
 
-    fp = file_open( filename, stubname ? "wb0" : "wb" );
+    fp = file_open( filename, stubname ? "wb0" : "wbp" );
     if ( !fp ) {
         fprintf( stdout, "ERROR: can't open %s\n", filename );
         return 0;
@@ -301,6 +337,7 @@ int dcb_save( const char * filename, int options, const char * stubname ) {
         dcb.proc[n].data.SPublic     = procs[n]->pubdata->current;              ARRANGE_QWORD( &dcb.proc[n].data.SPublic );
 
         dcb.proc[n].data.SCode       = procs[n]->code.current * sizeof( uint64_t ); ARRANGE_QWORD( &dcb.proc[n].data.SCode );
+        dcb.proc[n].data.SStack      = procs[n]->stack_size;                    ARRANGE_QWORD( &dcb.proc[n].data.SStack );
 
         dcb.proc[n].data.OExitCode   = procs[n]->exitcode ;                     ARRANGE_QWORD( &dcb.proc[n].data.OExitCode );
         dcb.proc[n].data.OErrorCode  = procs[n]->errorcode ;                    ARRANGE_QWORD( &dcb.proc[n].data.OErrorCode );
@@ -435,8 +472,19 @@ int dcb_save( const char * filename, int options, const char * stubname ) {
         offset += sizeof( DCB_FILE ) + dcb.file[n].SName;
     }
 
-    /* Data from the included files */
+    /* Data from the included files. A stub is not compressed as a whole, so each
+     * file is compressed on its own (if it's worth it); the others are used in place */
+    if ( stubname && dcb_filecount ) {
+        packed = ( uint8_t ** ) calloc( dcb_filecount, sizeof( uint8_t * ) );
+        if ( !packed ) compile_error( MSG_OUT_OF_MEMORY );
+    }
+
     for ( n = 0; n < dcb_filecount; n++ ) {
+        uint64_t psize;
+        if ( packed && ( packed[n] = dcb_pack_file( dcb_fullname[n], dcb.file[n].SFile, &psize ) ) ) {
+            dcb.file[n].SFile = psize;
+            dcb.file[n].Flags |= DCB_FILE_COMPRESSED;
+        }
         dcb.file[n].OFile = offset;                                                         ARRANGE_QWORD( &dcb.file[n].OFile );
         offset += dcb.file[n].SFile;                                                        ARRANGE_QWORD( &dcb.file[n].SFile );
     }
@@ -522,9 +570,17 @@ int dcb_save( const char * filename, int options, const char * stubname ) {
 
     for ( n = 0; n < dcb_filecount; n++ ) {
         char buffer[8192];
-        file * fp_r = file_open( dcb_fullname[n], "rb" );
+        file * fp_r;
         int64_t siz = 0;
 
+        if ( packed && packed[n] ) {
+            file_write( fp, packed[n], dcb.file[n].SFile );
+            free( packed[n] );
+            continue;
+        }
+
+        fp_r = file_open( dcb_fullname[n], "rb" );
+
         assert( fp_r );
         while ( !file_eof( fp_r ) ) {
             int64_t chunk_size = file_read( fp_r, buffer, 8192 );
@@ -534,6 +590,7 @@ int dcb_save( const char * filename, int options, const char * stubname ) {
         }
         file_close( fp_r );
     }
+    free( packed );
 
     /* Write the stub signature */
 
@@ -550,7 +607,11 @@ int dcb_save( const char * filename, int options, const char * stubname ) {
         file_write( fp, &dcb_signature, sizeof( dcb_signature ) );
     }
 
-    file_close( fp );
+    if ( !file_close( fp ) ) {
+        fprintf( stdout, "ERROR: error writing %s\n", filename );
+        file_remove( filename );
+        return 0;
+    }
 
     /* 6. Show statistics */
 
@@ -747,9 +808,16 @@ void codeblock_adjust(CODEBLOCK * code) {
             ptr[1] = get_new_off( ptr[1], locvaroffs, dcb.data.NLocVars );
         }
 
+        if ( (*ptr & MN_MASK) == MN_VARADD_GLOBAL ) {
+            ptr[1] = MN_VARIMM( get_new_off( MN_VARIMM_OFFSET( ptr[1] ), glovaroffs, dcb.data.NGloVars ), MN_VARIMM_VALUE( ptr[1] ) );
+        }
+
+        if ( (*ptr & MN_MASK) == MN_VARADD_LOCAL ) {
+            ptr[1] = MN_VARIMM( get_new_off( MN_VARIMM_OFFSET( ptr[1] ), locvaroffs, dcb.data.NLocVars ), MN_VARIMM_VALUE( ptr[1] ) );
+        }
+
         if ( (*ptr & MN_MASK) == MN_SENTENCE ) {
-            if ( dcb.data.Version == 0x0700 ) ptr[1] = (ptr[1] & 0xfffff) | ( fileid[ptr[1]>>24] << 20 );
-            else                              ptr[1] = (ptr[1] & 0xfffff) | ( fileid[ptr[1]>>20] << 20 );
+            ptr[1] = (ptr[1] & 0xfffff) | ( fileid[ptr[1]>>20] << 20 );
         }
 
         if ( (*ptr & MN_MASK) == MN_SYSCALL || (*ptr & MN_MASK)  == MN_SYSPROC ) {
@@ -829,7 +897,7 @@ int dcb_load_lib( const char * filename ) {
     ARRANGE_QWORD( &dcb.data.OSysProcsCodes );
 
     if ( memcmp( dcb.data.Header, DCL_MAGIC, sizeof( DCL_MAGIC ) - 1 ) != 0 ) return 0 ;
-    if ( dcb.data.Version < 0x0710 ) return -1 ;
+    if ( dcb.data.Version < 0x0900 ) return -1 ;
 
     /* Load identifiers */
 
@@ -1007,6 +1075,7 @@ int dcb_load_lib( const char * filename ) {
         ARRANGE_QWORD( &dcb.proc[n].data.SPublic );
 
         ARRANGE_QWORD( &dcb.proc[n].data.SCode );
+        ARRANGE_QWORD( &dcb.proc[n].data.SStack );
 
         ARRANGE_QWORD( &dcb.proc[n].data.OExitCode );
         ARRANGE_QWORD( &dcb.proc[n].data.OErrorCode );
@@ -1137,7 +1206,7 @@ int dcb_load_lib( const char * filename ) {
             ARRANGE_QWORD( &dcbfile.OFile );
 
             file_read( fp, &fname, dcbfile.SName ) ;
-            file_add_xfile( fp, NULL, dcbfile.OFile, fname, dcbfile.SFile ) ;
+            file_add_xfile( fp, NULL, dcbfile.OFile, fname, dcbfile.SFile, 0 ) ;
         }
     }
 #endif
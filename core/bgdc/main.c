@@ -66,6 +66,7 @@ char langinfo[64];
 extern int64_t debug;
 int64_t autodeclare = 1;
 int64_t libmode = 0;
+int64_t optimize = 1;
 
 static char _main_path[__MAX_PATH] = { 0 };
 char * main_path = NULL;
@@ -93,7 +94,7 @@ int main( int argc, char *argv[] ) {
     char stubname[__MAX_PATH] = "";
     char importname[__MAX_PATH] = "";
     char compilerimport[__MAX_PATH] = "";
-    int i, j;
+    int i, j, ok;
     char *ptr;
 
     /* get my executable name */
@@ -203,6 +204,11 @@ int main( int argc, char *argv[] ) {
                 continue;
             }
 
+            if ( !strcmp( argv[i], "--no-optimize" ) ) {
+                optimize = 0 ;
+                continue;
+            }
+
             j = 1;
             while ( argv[i][j] ) {
                 if ( argv[i][j] == 'd' ) {
@@ -438,9 +444,9 @@ int main( int argc, char *argv[] ) {
 #ifdef WIN32
         strcat( dcbname, ".exe" );
 #endif
-        dcb_save( dcbname, dcb_options, stubname );
+        ok = dcb_save( dcbname, dcb_options, stubname );
     } else {
-        dcb_save( dcbname, dcb_options, NULL );
+        ok = dcb_save( dcbname, dcb_options, NULL );
     }
 
     /* unload Modules */
@@ -449,7 +455,7 @@ int main( int argc, char *argv[] ) {
     /* destroy error messages list */
     err_destroyErrorTable();
 
-    return 0;
+    return ok ? 0 : 1;
 }
 
 /* --------------------------------------------------------------------------- */
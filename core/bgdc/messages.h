@@ -38,7 +38,7 @@
 #define MSG_READ_ERROR                          "%s: file reading error"
 #define MSG_DIRECTORY_MISSING                   "You must specify a directory"
 #define MSG_TOO_MANY_FILES                      "Too many files specified"
-#define MSG_DCBL_DCB_VERSION_ERROR              "%s isn't 7.10 DCB version, you need a 7.10 version or greater for use this feature\n"
+#define MSG_DCBL_DCB_VERSION_ERROR              "%s isn't 9.00 DCB version, you need a 9.00 version or greater for use this feature\n"
 
 #define MSG_USAGE                               "Usage: %s [options] filename\n\n"
 
@@ -53,6 +53,7 @@
                                                 "   -D macro=text   Set a macro\n" \
                                                 "   -p|--pedantic   Don't use automatic declare\n" \
                                                 "   --libmode       Build a library\n" \
+                                                "   --no-optimize   Don't run the bytecode optimizer\n" \
                                                 "   -L library      Include a library\n" \
                                                 "   -C options      Specify compiler options\n" \
                                                 "                   Where options are:\n" \
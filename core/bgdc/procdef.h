@@ -42,6 +42,7 @@
 #define PROC_USES_LOCALS    0x02
 #define PROC_FUNCTION       0x04
 #define PROC_USES_PUBLICS   0x08
+#define PROC_PARALLEL       0x10    /* Only touches its own data, see codeblock_parallel_safe() */
 
 typedef struct _sentence {
     int64_t file;
@@ -81,6 +82,8 @@ typedef struct _procdef {
     int64_t     exitcode;
     int64_t     errorcode;
 
+    int64_t     stack_size; /* Bytes, 0 = runtime default */
+
     SENTENCE    * sentences;
     int64_t     sentence_count;
 } PROCDEF;
@@ -144,6 +144,11 @@ void procdef_destroy (PROCDEF * proc) {
 void program_postprocess() {
     int n;
     for ( n = 0; n <= procdef_maxid; n++ ) codeblock_postprocess( &procs[n]->code );
+    if ( optimize ) for ( n = 0; n <= procdef_maxid; n++ ) codeblock_optimize( &procs[n]->code );
+    for ( n = 0; n <= procdef_maxid; n++ ) {
+        procs[n]->stack_size = codeblock_stack_size( &procs[n]->code );
+        if ( !( procs[n]->flags & PROC_FUNCTION ) && codeblock_parallel_safe( &procs[n]->code ) ) procs[n]->flags |= PROC_PARALLEL;
+    }
 }
 
 void program_dumpprocesses() {
@@ -166,6 +171,9 @@ void procdef_dump( PROCDEF * proc ) {
         printf( "\n" );
     }
 
+    if ( proc->stack_size ) printf( "---- Stack size: %" PRId64 " bytes\n\n", proc->stack_size );
+    if ( proc->flags & PROC_PARALLEL ) printf( "---- Parallel safe\n\n" );
+
     /* segment_dump  (proc->pridata); */
     codeblock_dump( &proc->code );
 }
@@ -69,12 +69,13 @@ void sysproc_init( void ) {
  *  paramtypes  String representation of the parameter
  *  type   Type of the returning value
  *  func   Pointer to the function itself or a stub
+ *  flags  SYSFUNC_* flags
  *
  *  RETURN VALUE:
  *      Identifier code allocated for the function
  */
 
-int64_t sysproc_add( char * name, char * paramtypes, int type, void * func ) {
+int64_t sysproc_add( char * name, char * paramtypes, int type, void * func, int64_t flags ) {
     static SYSPROC * sysproc_new = 0 ;
     static int sysproc_maxcode = 0 ;
     static int sysproc_count = 0 ;
@@ -98,6 +99,7 @@ int64_t sysproc_add( char * name, char * paramtypes, int type, void * func ) {
     sysproc_new->params = strlen( paramtypes ) ;
     sysproc_new->type = type ;
     sysproc_new->id   = identifier_search_or_add( name ) ;
+    sysproc_new->flags = flags ;
     sysproc_new->next = NULL ;
 
     sysproc_new++ ;
@@ -235,3 +237,15 @@ SYSPROC * sysproc_by_name( int64_t code ) {
     }
     return NULL ;
 }
+
+/* ---------------------------------------------------------------------- */
+
+SYSPROC * sysproc_by_code( int64_t code ) {
+    SYSPROC * s = sysprocs ;
+
+    while ( s->name ) {
+        if ( s->code == code ) return s ;
+        s++ ;
+    }
+    return NULL ;
+}
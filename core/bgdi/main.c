@@ -281,6 +281,19 @@ int main( int argc, char *argv[] ) {
                         file_addp( &argv[i][j + 1] ) ;
                         break ;
                     }
+                    if ( argv[i][j] == 'j' ) {
+                        if ( argv[i][j+1] == 0 ) {
+                            if ( i == argc - 1 ) {
+                                fprintf( stderr, MSG_THREADS_MISSING "\n" ) ;
+                                exit( 0 );
+                            }
+                            parallel_threads = atoll( argv[i+1] );
+                            i++ ;
+                            break ;
+                        }
+                        parallel_threads = atoll( &argv[i][j + 1] ) ;
+                        break ;
+                    }
                     j++ ;
                 }
             } else {
@@ -33,6 +33,8 @@
 
 #define MSG_USAGE                               "Usage: %s [options] <data code block file>[.dcb]\n\n"
 #define MSG_OPTIONS                             "   -d       Activate DEBUG mode (several -d for increment debug level)\n" \
-                                                "   -i dir   Adds the directory to the PATH\n\n"
+                                                "   -i dir   Adds the directory to the PATH\n" \
+                                                "   -j n     Run parallel-safe processes on n threads\n\n"
+#define MSG_THREADS_MISSING                     "You must specify the number of threads"
 
 #endif
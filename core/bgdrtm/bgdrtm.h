@@ -62,6 +62,7 @@ extern char *appexefullpath;
 
 extern int64_t debug;          /* 1 if running in debug mode                    */
 extern int64_t system_paused;
+extern int64_t parallel_threads;
 
 /* Trace */
 extern int64_t exit_value;
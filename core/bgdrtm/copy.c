@@ -43,9 +43,54 @@
 
 #include "xstrings.h"
 #include "bgdrtm.h"
+#include "typeplan.h"
 
 static int64_t copytype( void * dst, void * src, DCB_TYPEDEF * var );
 
+/*
+ *  FUNCTION : copyplan
+ *
+ *  Copy data following a type layout plan
+ *
+ *  PARAMS :
+ *  dst    Pointer to the destination memory
+ *  src    Pointer to the source
+ *  op     Pointer to the plan ops
+ *  nops   Number of ops
+ *
+ */
+
+static void copyplan( uint8_t * dst, uint8_t * src, TYPEPLAN_OP * op, int64_t nops ) {
+    TYPEPLAN_OP * end = op + nops;
+    int64_t n, size;
+
+    for ( ; op < end; op++ ) {
+        switch ( op->op ) {
+            case TYPEPLAN_DATA:
+                memcpy( dst, src, op->size );
+                break;
+
+            case TYPEPLAN_STRING:
+                for ( n = 0; n < op->count; n++ ) {
+                    string_discard( (( int64_t * )dst )[n] );
+                    string_use( (( int64_t * )src )[n] );
+                    (( int64_t * )dst )[n] = (( int64_t * )src )[n];
+                }
+                break;
+
+            case TYPEPLAN_REPEAT:
+                size = op->size / op->count;
+                for ( n = 0; n < op->count; n++ ) copyplan( dst + n * size, src + n * size, op + 1, op->length );
+                dst += op->size;
+                src += op->size;
+                op += op->length;
+                continue;
+        }
+        dst += op->size;
+        src += op->size;
+    }
+}
+
 /*
  *  FUNCTION : copyvars
  *
@@ -95,6 +140,25 @@ int64_t copyvars( void * dst, void * src, DCB_VAR * var, int nvars ) {
 int64_t copytypes( void * dst, void * src, DCB_TYPEDEF * var, int64_t nvars, int64_t reps ) {
     int64_t result = 0, partial, _nvars = nvars;
     DCB_TYPEDEF * _var = var;
+    TYPEPLAN * plan = typeplan_get( var, nvars );
+
+    if ( plan ) {
+        if ( reps <= 0 ) return 0;
+
+        /* Plain data is copied at once */
+        if ( plan->nops == 1 && plan->ops[0].op == TYPEPLAN_DATA ) {
+            memcpy( dst, src, plan->size * reps );
+            return plan->size * reps;
+        }
+
+        for ( ; reps > 0; reps-- ) {
+            copyplan( dst, src, plan->ops, plan->nops );
+            src = (( uint8_t* )src ) + plan->size;
+            dst = (( uint8_t* )dst ) + plan->size;
+            result += plan->size;
+        }
+        return result;
+    }
 
     for ( ; reps > 0; reps-- ) {
         var = _var;
@@ -38,6 +38,7 @@
 #include "dcb.h"
 #include "dirs.h"
 #include "files.h"
+#include "pslang.h"
 #include "xstrings.h"
 
 #define SYSPROCS_ONLY_DECLARE
@@ -67,13 +68,15 @@ void sysprocs_fixup( void ) {
     int64_t n;
 
     while ( proc->func ) {
+        int64_t id = getid( proc->name );
+
         proc->code = -1;
 
         s = sysproc_code_ref;
         for ( n = 0; n < dcb.data.NSysProcsCodes; n++, s++ ) {
             if (
                 proc->type == s->Type && proc->params == s->Params &&
-                s->Id == getid( proc->name ) && !strcmp( (const char *)s->ParamTypes, proc->paramtypes ) )
+                s->Id == id && !strcmp( (const char *)s->ParamTypes, proc->paramtypes ) )
             {
                 proc->code = s->Code;
                 break;
@@ -85,6 +88,38 @@ void sysprocs_fixup( void ) {
 
 /* ---------------------------------------------------------------------- */
 
+/* Replaces the operand of every CALL/PROC/SYSCALL/SYSPROC with a pointer to
+ * its PROCDEF/SYSPROC, so the interpreter doesn't look it up on each call.
+ * Unknown targets become NULL, and fail when (and if) they are executed. */
+
+void calls_fixup( void ) {
+    int64_t n, * ptr, * end;
+
+    for ( n = 0; n < procdef_count; n++ ) {
+        if ( !procs[n].code ) continue;
+
+        ptr = procs[n].code;
+        end = procs[n].code + procs[n].code_size / sizeof( int64_t );
+
+        while ( ptr < end ) {
+            switch ( *ptr ) {
+                case MN_CALL:
+                case MN_PROC:
+                    ptr[1] = ( int64_t )( intptr_t ) procdef_get( ptr[1] );
+                    break;
+
+                case MN_SYSCALL:
+                case MN_SYSPROC:
+                    ptr[1] = ( int64_t )( intptr_t ) sysproc_get( ptr[1] );
+                    break;
+            }
+            ptr += MN_PARAMS( *ptr ) + 1;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
 PROCDEF * procdef_get( int64_t n ) {
     if ( n >= 0 && n < procdef_count ) return &procs[n];
     return NULL;
@@ -282,16 +317,100 @@ void arrange_varspace_data( DCB_VAR * basevar, int nvars, char * basedata ) {
 
 /* ---------------------------------------------------------------------- */
 
-DCB_VAR * read_and_arrange_varspace( file * fp, int count ) {
-    int n, n1;
-    DCB_VAR * vars = ( DCB_VAR * ) calloc( count, sizeof( DCB_VAR ) );
-    if ( !vars ) {
+/* Identifiers are looked up by code and by name through two open addressing
+ * tables of indexes into dcb.id (0 is an empty slot, so they are stored + 1) */
+
+static uint32_t * id_by_code = NULL;
+static uint32_t * id_by_name = NULL;
+static uint32_t id_index_mask = 0;
+
+static uint32_t id_hash_name( const char * name ) {
+    uint32_t h = 2166136261u;
+    while ( *name ) h = ( h ^ ( uint8_t ) *name++ ) * 16777619u;
+    return h;
+}
+
+static void id_index_build( void ) {
+    uint32_t size = 16, n, h;
+
+    while ( size < dcb.data.NID * 2 ) size <<= 1;
+
+    id_by_code = ( uint32_t * ) calloc( size, sizeof( uint32_t ) );
+    id_by_name = ( uint32_t * ) calloc( size, sizeof( uint32_t ) );
+    if ( !id_by_code || !id_by_name ) {
         fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
         exit(2);
     }
+    id_index_mask = size - 1;
+
+    /* The first entry wins, as in a linear search */
+    for ( n = 0; n < dcb.data.NID; n++ ) {
+        dcb.id[n].Name[sizeof( dcb.id[n].Name ) - 1] = '\0';
+
+        for ( h = ( uint32_t ) dcb.id[n].Code & id_index_mask; id_by_code[h]; h = ( h + 1 ) & id_index_mask )
+            if ( dcb.id[id_by_code[h] - 1].Code == dcb.id[n].Code ) break;
+        if ( !id_by_code[h] ) id_by_code[h] = n + 1;
+
+        for ( h = id_hash_name( ( const char * ) dcb.id[n].Name ) & id_index_mask; id_by_name[h]; h = ( h + 1 ) & id_index_mask )
+            if ( !strcmp( ( const char * ) dcb.id[id_by_name[h] - 1].Name, ( const char * ) dcb.id[n].Name ) ) break;
+        if ( !id_by_name[h] ) id_by_name[h] = n + 1;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* The sections of the DCB (everything before the included files) are loaded
+ * at once, and most of them are used in place */
+
+static uint8_t * dcb_image = NULL;
+static int64_t dcb_image_size = 0;
+
+static void * dcb_section( int64_t offset, int64_t size ) {
+    if ( offset < 0 || size < 0 || offset > dcb_image_size || size > dcb_image_size - offset ) {
+        fprintf( stderr, "ERROR: Runtime error - %s: corrupted DCB\n", __FUNCTION__ );
+        exit(2);
+    }
+    return dcb_image + offset;
+}
+
+/* Counts come from the file: they are checked against the image before
+ * being multiplied by the size of their elements */
+
+static void dcb_count( uint64_t count, int64_t size ) {
+    if ( count > ( uint64_t ) dcb_image_size / size ) {
+        fprintf( stderr, "ERROR: Runtime error - %s: corrupted DCB\n", __FUNCTION__ );
+        exit(2);
+    }
+}
+
+static void * dcb_table( int64_t offset, uint64_t count, int64_t size ) {
+    dcb_count( count, size );
+    return dcb_section( offset, count * size );
+}
+
+/* ---------------------------------------------------------------------- */
+
+static uint64_t dcb_hash( const uint8_t * data, int64_t size ) {
+    uint64_t h = 14695981039346656037ULL, w;
+
+    for ( ; size >= 8; data += 8, size -= 8 ) {
+        memcpy( &w, data, 8 );
+        h = ( h ^ w ) * 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    while ( size-- ) h = ( h ^ *data++ ) * 1099511628211ULL;
+
+    return h;
+}
+
+/* ---------------------------------------------------------------------- */
+
+DCB_VAR * read_and_arrange_varspace( int64_t offset, uint64_t count ) {
+    DCB_VAR * vars = ( DCB_VAR * ) dcb_table( offset, count, sizeof( DCB_VAR ) );
+    uint64_t n;
+    int n1;
 
     for ( n = 0; n < count; n++ ) {
-        file_read( fp, &vars[n], sizeof( DCB_VAR ) );
         ARRANGE_QWORD( &vars[n].ID );
         ARRANGE_QWORD( &vars[n].Offset );
         for ( n1 = 0; n1 < MAX_TYPECHUNKS; n1++ ) ARRANGE_QWORD( &vars[n].Type.Count[n1] );
@@ -322,6 +441,7 @@ void remove_parent_refs(char *path) {
 int dcb_load_from( file * fp, const char * filename, int offset ) {
     unsigned int n;
     uint64_t size;
+    int64_t pos;
 
     /* Read dcb contents */
 
@@ -365,7 +485,29 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
     ARRANGE_QWORD( &dcb.data.OSourceFiles );
     ARRANGE_QWORD( &dcb.data.OSysProcsCodes );
 
-    if ( memcmp( dcb.data.Header, DCB_MAGIC, sizeof( DCB_MAGIC ) - 1 ) != 0 || dcb.data.Version < 0x0800 ) return 0;
+    if ( memcmp( dcb.data.Header, DCB_MAGIC, sizeof( DCB_MAGIC ) - 1 ) != 0 || dcb.data.Version < 0x0900 ) return 0;
+
+    dcb_image_size = dcb.data.OFilesTab;
+    dcb_image = ( uint8_t * ) file_load( fp, offset, dcb_image_size );
+    if ( !dcb_image ) {
+        fprintf( stderr, "ERROR: Runtime error - Could not read file (%s)\n", filename );
+        exit(2);
+    }
+
+    dcb.hash = dcb_hash( dcb_image, dcb_image_size );
+
+    dcb_count( dcb.data.NProcs, sizeof( DCB_PROC_DATA ) );
+    dcb_count( dcb.data.NID, sizeof( DCB_ID ) );
+    dcb_count( dcb.data.NStrings, sizeof( uint64_t ) );
+    dcb_count( dcb.data.NLocVars, sizeof( DCB_VAR ) );
+    dcb_count( dcb.data.NLocStrings, sizeof( int64_t ) );
+    dcb_count( dcb.data.NGloVars, sizeof( DCB_VAR ) );
+    dcb_count( dcb.data.NVarSpaces, sizeof( DCB_VARSPACE ) );
+    dcb_count( dcb.data.SGlobal, 1 );
+    dcb_count( dcb.data.SLocal, 1 );
+    dcb_count( dcb.data.NImports, sizeof( uint64_t ) );
+    dcb_count( dcb.data.NSourceFiles, sizeof( uint64_t ) );
+    dcb_count( dcb.data.NSysProcsCodes, sizeof( DCB_SYSPROC_CODE ) );
 
     globaldata = calloc( dcb.data.SGlobal + 8, 1 );
     localdata  = calloc( dcb.data.SLocal + 8, 1 );
@@ -384,20 +526,16 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
 
     /* Retrieves global data areas */
 
-    file_seek( fp, offset + dcb.data.OGlobal, SEEK_SET );
-    file_read( fp, globaldata, dcb.data.SGlobal );         /* **** */
-
-    file_seek( fp, offset + dcb.data.OLocal, SEEK_SET );
-    file_read( fp, localdata, dcb.data.SLocal );           /* **** */
+    memcpy( globaldata, dcb_section( dcb.data.OGlobal, dcb.data.SGlobal ), dcb.data.SGlobal );
+    memcpy( localdata, dcb_section( dcb.data.OLocal, dcb.data.SLocal ), dcb.data.SLocal );
 
     if ( dcb.data.NLocStrings ) {
-        file_seek( fp, offset + dcb.data.OLocStrings, SEEK_SET );
-        file_readUint64A( fp, (uint64_t *)localstr, dcb.data.NLocStrings );
+        memcpy( localstr, dcb_table( dcb.data.OLocStrings, dcb.data.NLocStrings, sizeof( int64_t ) ), dcb.data.NLocStrings * sizeof( int64_t ) );
+        ARRANGE_QWORDS( localstr, dcb.data.NLocStrings );
     }
 
-    file_seek( fp, offset + dcb.data.OProcsTab, SEEK_SET );
     for ( n = 0; n < dcb.data.NProcs; n++ ) {
-        file_read( fp, &dcb.proc[n], sizeof( DCB_PROC_DATA ) );
+        memcpy( &dcb.proc[n], dcb_section( dcb.data.OProcsTab + n * sizeof( DCB_PROC_DATA ), sizeof( DCB_PROC_DATA ) ), sizeof( DCB_PROC_DATA ) );
 
         ARRANGE_QWORD( &dcb.proc[n].data.ID );
         ARRANGE_QWORD( &dcb.proc[n].data.Flags );
@@ -415,6 +553,7 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
         ARRANGE_QWORD( &dcb.proc[n].data.SPublic );
 
         ARRANGE_QWORD( &dcb.proc[n].data.SCode );
+        ARRANGE_QWORD( &dcb.proc[n].data.SStack );
 
         ARRANGE_QWORD( &dcb.proc[n].data.OExitCode );
         ARRANGE_QWORD( &dcb.proc[n].data.OErrorCode );
@@ -434,10 +573,8 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
 
     /* Retrieves strings */
 
-    dcb.data.OStrings += offset;
-    dcb.data.OText += offset;
-
-    string_load( fp, dcb.data.OStrings, dcb.data.OText, dcb.data.NStrings, dcb.data.SText );
+    string_load( dcb_table( dcb.data.OStrings, dcb.data.NStrings, sizeof( uint64_t ) ),
+                 dcb_section( dcb.data.OText, dcb.data.SText ), dcb.data.NStrings, dcb.data.SText );
 
     /* Retrieves included files */
 
@@ -456,7 +593,9 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
 
             file_read( fp, &fname, dcbfile.SName );
 			remove_parent_refs(fname);
-            file_add_xfile( fp, filename, offset + dcbfile.OFile, fname, dcbfile.SFile );
+            /* Flags were not initialized by older compilers */
+            file_add_xfile( fp, filename, offset + dcbfile.OFile, fname, dcbfile.SFile,
+                            ( dcb.data.Version >= 0x0901 && ( dcbfile.Flags & DCB_FILE_COMPRESSED ) ) ? XFILE_COMPRESSED : 0 );
         }
     }
 
@@ -468,49 +607,31 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
             fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
             exit(2);
         }
-        file_seek( fp, offset + dcb.data.OImports, SEEK_SET );
-        file_readUint64A( fp, dcb.imports, dcb.data.NImports );
+        memcpy( dcb.imports, dcb_table( dcb.data.OImports, dcb.data.NImports, sizeof( uint64_t ) ), dcb.data.NImports * sizeof( uint64_t ) );
+        ARRANGE_QWORDS( dcb.imports, dcb.data.NImports );
     }
 
     /* Retrieves debugging data */
 
     if ( dcb.data.NID ) {
-        dcb.id = ( DCB_ID * ) calloc( dcb.data.NID, sizeof( DCB_ID ) );
-        if ( !dcb.id ) {
-            fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-            exit(2);
-        }
-        file_seek( fp, offset + dcb.data.OID, SEEK_SET );
-
-        for ( n = 0; n < dcb.data.NID; n++ ) {
-            file_read( fp, &dcb.id[n], sizeof( DCB_ID ) );
-            ARRANGE_QWORD( &dcb.id[n].Code );
-        }
+        dcb.id = ( DCB_ID * ) dcb_table( dcb.data.OID, dcb.data.NID, sizeof( DCB_ID ) );
+        for ( n = 0; n < dcb.data.NID; n++ ) ARRANGE_QWORD( &dcb.id[n].Code );
+        id_index_build();
     }
 
-    if ( dcb.data.NGloVars ) {
-        file_seek( fp, offset + dcb.data.OGloVars, SEEK_SET );
-        dcb.glovar = read_and_arrange_varspace( fp, dcb.data.NGloVars );
-    }
-
-    if ( dcb.data.NLocVars ) {
-        file_seek( fp, offset + dcb.data.OLocVars, SEEK_SET );
-        dcb.locvar = read_and_arrange_varspace( fp, dcb.data.NLocVars );
-    }
+    if ( dcb.data.NGloVars ) dcb.glovar = read_and_arrange_varspace( dcb.data.OGloVars, dcb.data.NGloVars );
+    if ( dcb.data.NLocVars ) dcb.locvar = read_and_arrange_varspace( dcb.data.OLocVars, dcb.data.NLocVars );
 
     if ( dcb.data.NVarSpaces ) {
-        dcb.varspace = ( DCB_VARSPACE * ) calloc( dcb.data.NVarSpaces, sizeof( DCB_VARSPACE ) );
+        dcb.varspace = ( DCB_VARSPACE * ) dcb_table( dcb.data.OVarSpaces, dcb.data.NVarSpaces, sizeof( DCB_VARSPACE ) );
         dcb.varspace_vars = ( DCB_VAR ** ) calloc( dcb.data.NVarSpaces, sizeof( DCB_VAR * ) );
 
-        if ( !dcb.varspace || !dcb.varspace_vars ) {
+        if ( !dcb.varspace_vars ) {
             fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
             exit(2);
         }
 
-        file_seek( fp, offset + dcb.data.OVarSpaces, SEEK_SET );
-
         for ( n = 0; n < dcb.data.NVarSpaces; n++ ) {
-            file_read( fp, &dcb.varspace[n], sizeof( DCB_VARSPACE ) );
             ARRANGE_QWORD( &dcb.varspace[n].NVars );
             ARRANGE_QWORD( &dcb.varspace[n].OVars );
         }
@@ -518,8 +639,7 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
         for ( n = 0; n < dcb.data.NVarSpaces; n++ ) {
             dcb.varspace_vars[n] = 0;
             if ( !dcb.varspace[n].NVars ) continue;
-            file_seek( fp, offset + dcb.varspace[n].OVars, SEEK_SET );
-            dcb.varspace_vars[n] = read_and_arrange_varspace( fp, dcb.varspace[n].NVars );
+            dcb.varspace_vars[n] = read_and_arrange_varspace( dcb.varspace[n].OVars, dcb.varspace[n].NVars );
         }
     }
 
@@ -538,10 +658,13 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
             exit(2);
         }
 
-        file_seek( fp, offset + dcb.data.OSourceFiles, SEEK_SET );
+        pos = dcb.data.OSourceFiles;
         for ( n = 0; n < dcb.data.NSourceFiles; n++ ) {
-            file_readUint64( fp, &size );
-            file_read( fp, fname, size );
+            memcpy( &size, dcb_section( pos, sizeof( size ) ), sizeof( size ) );
+            ARRANGE_QWORD( &size );
+            memcpy( fname, dcb_section( pos + sizeof( size ), size ), size < sizeof( fname ) ? size : sizeof( fname ) );
+            fname[sizeof( fname ) - 1] = '\0';
+            pos += sizeof( size ) + size;
             switch ( load_file( fname, n ) ) {
                 case 0:
                     fprintf( stdout, "WARNING: Runtime warning - file not found (%s)\n", fname );
@@ -564,40 +687,35 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
         procs[n].private_size       = dcb.proc[n].data.SPrivate;
         procs[n].public_size        = dcb.proc[n].data.SPublic;
         procs[n].code_size          = dcb.proc[n].data.SCode;
+        procs[n].stack_size         = dcb.proc[n].data.SStack;
         procs[n].id                 = dcb.proc[n].data.ID;
         procs[n].flags              = dcb.proc[n].data.Flags;
         procs[n].type               = n;
         procs[n].name               = getid_name( procs[n].id );
         procs[n].breakpoint         = 0;
 
-        if ( dcb.proc[n].data.SPrivate ) {
-            procs[n].pridata = ( uint8_t * )calloc( dcb.proc[n].data.SPrivate, sizeof( uint8_t ) ); /* Size in bytes */
-            if ( !procs[n].pridata ) {
-                fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-                exit(2);
-            }
-            file_seek( fp, offset + dcb.proc[n].data.OPrivate, SEEK_SET );
-            file_read( fp, procs[n].pridata, dcb.proc[n].data.SPrivate );      /* *** */
-        }
+        /* Unknown or too big for the stack header: use the default size */
+        if ( !procs[n].stack_size || procs[n].stack_size > STACK_SIZE_MASK ) procs[n].stack_size = STACK_SIZE;
 
-        if ( dcb.proc[n].data.SPublic ) {
-            procs[n].pubdata = ( uint8_t * )calloc( dcb.proc[n].data.SPublic, sizeof( uint8_t ) ); /* Size in bytes */
-            if ( !procs[n].pubdata ) {
-                fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-                exit(2);
-            }
-            file_seek( fp, offset + dcb.proc[n].data.OPublic, SEEK_SET );
-            file_read( fp, procs[n].pubdata, dcb.proc[n].data.SPublic );       /* *** */
-        }
+        /* The initial data of privates and publics is only copied to new instances */
+        if ( dcb.proc[n].data.SPrivate ) procs[n].pridata = ( uint8_t * ) dcb_section( dcb.proc[n].data.OPrivate, dcb.proc[n].data.SPrivate );
+        if ( dcb.proc[n].data.SPublic ) procs[n].pubdata = ( uint8_t * ) dcb_section( dcb.proc[n].data.OPublic, dcb.proc[n].data.SPublic );
 
         if ( dcb.proc[n].data.SCode ) {
-            procs[n].code = ( int64_t * ) calloc( dcb.proc[n].data.SCode / sizeof( int64_t ), sizeof( int64_t ) ); /* Size in bytes */
-            if ( !procs[n].code ) {
-                fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-                exit(2);
+            int64_t * code = ( int64_t * ) dcb_section( dcb.proc[n].data.OCode, dcb.proc[n].data.SCode );
+
+            /* The code is used in place, unless it isn't aligned */
+            if ( ( intptr_t ) code & ( sizeof( int64_t ) - 1 ) ) {
+                procs[n].code = ( int64_t * ) malloc( dcb.proc[n].data.SCode );
+                if ( !procs[n].code ) {
+                    fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+                    exit(2);
+                }
+                memcpy( procs[n].code, code, dcb.proc[n].data.SCode );
+            } else {
+                procs[n].code = code;
             }
-            file_seek( fp, offset + dcb.proc[n].data.OCode, SEEK_SET );
-            file_readUint64A( fp, (uint64_t *)procs[n].code, dcb.proc[n].data.SCode / sizeof(uint64_t) );
+            ARRANGE_QWORDS( procs[n].code, dcb.proc[n].data.SCode / sizeof( int64_t ) );
 
             if ( dcb.proc[n].data.OExitCode )   procs[n].exitcode = dcb.proc[n].data.OExitCode;
             else                                procs[n].exitcode = 0;
@@ -612,8 +730,8 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
                 fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
                 exit(2);
             }
-            file_seek( fp, offset + dcb.proc[n].data.OPriStrings, SEEK_SET );
-            file_readUint64A( fp, (uint64_t *)procs[n].strings, dcb.proc[n].data.NPriStrings );
+            memcpy( procs[n].strings, dcb_table( dcb.proc[n].data.OPriStrings, dcb.proc[n].data.NPriStrings, sizeof( int64_t ) ), dcb.proc[n].data.NPriStrings * sizeof( int64_t ) );
+            ARRANGE_QWORDS( procs[n].strings, dcb.proc[n].data.NPriStrings );
         }
 
         if ( dcb.proc[n].data.NPubStrings ) {
@@ -622,19 +740,17 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
                 fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
                 exit(2);
             }
-            file_seek( fp, offset + dcb.proc[n].data.OPubStrings, SEEK_SET );
-            file_readUint64A( fp, (uint64_t *)procs[n].pubstrings, dcb.proc[n].data.NPubStrings );
+            memcpy( procs[n].pubstrings, dcb_table( dcb.proc[n].data.OPubStrings, dcb.proc[n].data.NPubStrings, sizeof( int64_t ) ), dcb.proc[n].data.NPubStrings * sizeof( int64_t ) );
+            ARRANGE_QWORDS( procs[n].pubstrings, dcb.proc[n].data.NPubStrings );
         }
 
         if ( dcb.proc[n].data.NPriVars ) {
-            file_seek( fp, offset + dcb.proc[n].data.OPriVars, SEEK_SET );
-            dcb.proc[n].privar = read_and_arrange_varspace( fp, dcb.proc[n].data.NPriVars );
+            dcb.proc[n].privar = read_and_arrange_varspace( dcb.proc[n].data.OPriVars, dcb.proc[n].data.NPriVars );
             arrange_varspace_data( dcb.proc[n].privar, dcb.proc[n].data.NPriVars, procs[n].pridata );
         }
 
         if ( dcb.proc[n].data.NPubVars ) {
-            file_seek( fp, offset + dcb.proc[n].data.OPubVars, SEEK_SET );
-            dcb.proc[n].pubvar = read_and_arrange_varspace( fp, dcb.proc[n].data.NPubVars );
+            dcb.proc[n].pubvar = read_and_arrange_varspace( dcb.proc[n].data.OPubVars, dcb.proc[n].data.NPubVars );
             arrange_varspace_data( dcb.proc[n].pubvar, dcb.proc[n].data.NPubVars, procs[n].pubdata );
         }
     }
@@ -646,10 +762,11 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
         fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
         exit(2);
     }
-    file_seek( fp, offset + dcb.data.OSysProcsCodes, SEEK_SET );
+    pos = dcb.data.OSysProcsCodes;
     for ( n = 0; n < dcb.data.NSysProcsCodes; n++ ) {
         DCB_SYSPROC_CODE sdcb;
-        file_read( fp, &sdcb, sizeof( DCB_SYSPROC_CODE ) );
+        memcpy( &sdcb, dcb_section( pos, sizeof( DCB_SYSPROC_CODE ) ), sizeof( DCB_SYSPROC_CODE ) );
+        pos += sizeof( DCB_SYSPROC_CODE );
 
         ARRANGE_QWORD( &sdcb.Id );
         ARRANGE_DWORD( &sdcb.Type );
@@ -660,13 +777,16 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
         sysproc_code_ref[n].Type = sdcb.Type;
         sysproc_code_ref[n].Params = sdcb.Params;
         sysproc_code_ref[n].Code = sdcb.Code;
+
+        dcb_count( sdcb.Params, 1 );
         sysproc_code_ref[n].ParamTypes = ( uint8_t * ) calloc( sdcb.Params + 1, sizeof( uint8_t ) );
 
         if ( !sysproc_code_ref[n].ParamTypes ) {
             fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
             exit(2);
         }
-        if ( sdcb.Params ) file_read( fp, sysproc_code_ref[n].ParamTypes, sdcb.Params );
+        if ( sdcb.Params ) memcpy( sysproc_code_ref[n].ParamTypes, dcb_section( pos, sdcb.Params ), sdcb.Params );
+        pos += sdcb.Params;
     }
 
     sysprocs_fixup();
@@ -679,16 +799,20 @@ int dcb_load_from( file * fp, const char * filename, int offset ) {
 /* ---------------------------------------------------------------------- */
 
 char * getid_name( int64_t code ) {
-    int n;
-    for ( n = 0; n < dcb.data.NID; n++ ) if ( dcb.id[n].Code == code ) return (char *)dcb.id[n].Name;
+    uint32_t h;
+    if ( !id_by_code ) return "(?)";
+    for ( h = ( uint32_t ) code & id_index_mask; id_by_code[h]; h = ( h + 1 ) & id_index_mask )
+        if ( dcb.id[id_by_code[h] - 1].Code == code ) return (char *)dcb.id[id_by_code[h] - 1].Name;
     return "(?)";
 }
 
 /* ---------------------------------------------------------------------- */
 
 int64_t getid( char * name ) {
-    int n;
-    for ( n = 0; n < dcb.data.NID; n++ ) if ( strcmp( (const char *)dcb.id[n].Name, name ) == 0 ) return dcb.id[n].Code;
+    uint32_t h;
+    if ( !id_by_name ) return -1;
+    for ( h = id_hash_name( name ) & id_index_mask; id_by_name[h]; h = ( h + 1 ) & id_index_mask )
+        if ( !strcmp( (const char *)dcb.id[id_by_name[h] - 1].Name, name ) ) return dcb.id[id_by_name[h] - 1].Code;
     return -1;
 }
 
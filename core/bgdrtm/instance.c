@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 
 #ifdef TARGET_BEOS
 #include <posix/assert.h>
@@ -53,11 +54,47 @@
 
 #define HASH(id)            (uint64_t)((id)&0x0000ffff)
 #define HASH_PRIORITY(id)   (uint64_t)(((id) + INSTANCE_NORMALIZE_PRIORITY) & 0x0000ffff)
-#define HASH_INSTANCE(id)   (uint64_t)(((( uint64_t )( intptr_t )(id)) >> 2 ) & 0x0000ffff)
 #define HASH_SIZE           65536
 
-INSTANCE ** hashed_by_id = NULL;
-INSTANCE ** hashed_by_instance = NULL;
+/* Process IDs are a slot index plus a generation counter:
+ *
+ *      bits 63-32: generation of the slot, bumped each time the slot is freed
+ *      bits 31-0:  FIRST_INSTANCE_ID + slot index
+ *
+ * A stale ID (its process is dead and the slot reused) never matches the
+ * slot generation, so lookups are O(1) and never return the wrong process.
+ */
+
+#define ID_INDEX(id)        ( ( uint64_t )( uint32_t )( id ) - FIRST_INSTANCE_ID )
+#define ID_GENERATION(id)   ( ( uint64_t )( id ) >> 32 )
+#define ID_MAKE(index,gen)  ( ( int64_t )( ( ( uint64_t )( gen ) << 32 ) | ( FIRST_INSTANCE_ID + ( index ) ) ) )
+
+#define ID_MAX_INDEX        ( 0xffffffffULL - FIRST_INSTANCE_ID )
+#define ID_MAX_GENERATION   0x7fffffffULL
+
+/* New slots are used before recycling freed ones while there are less than
+ * this, so short runs get the same IDs than old versions */
+
+#define ID_FRESH_SLOTS      65536
+
+#define ID_NO_SLOT          ( ( uint32_t ) -1 )
+
+typedef struct {
+    INSTANCE * instance;
+    uint32_t generation;
+    uint32_t next_free;
+    int in_use;
+} INSTANCE_SLOT;
+
+static INSTANCE_SLOT * id_slots = NULL;
+static uint64_t id_slots_count = 0;         /* Slots ever used */
+static uint64_t id_slots_allocated = 0;
+
+/* FIFO of freed slots, so a freed ID takes as long as possible to come back */
+
+static uint32_t id_free_first = ID_NO_SLOT;
+static uint32_t id_free_last = ID_NO_SLOT;
+
 INSTANCE ** hashed_by_type = NULL;
 INSTANCE ** hashed_by_priority = NULL;
 
@@ -66,54 +103,54 @@ INSTANCE * first_instance = NULL;
 /* Priority lists */
 
 static INSTANCE * iterator_by_priority  = NULL;
-static int64_t    iterator_pos          = INSTANCE_MAX_PRIORITY;
+static int64_t    iterator_pos          = INSTANCE_MAX_PRIORITY + 1;
+
+/* Two level bitmap of the non empty priority lists: one bit per priority,
+   and one summary bit per 64 priorities */
 
-static int64_t instance_maxid =  FIRST_INSTANCE_ID;
+#define PRIORITY_WORDS      ( HASH_SIZE / 64 )
+#define BITS_UPTO(b)        ( ( b ) == 63 ? ~0ULL : ( ( 1ULL << ( ( b ) + 1 ) ) - 1 ) )
 
-static int64_t instance_min_actual_prio = INSTANCE_MAX_PRIORITY;
-static int64_t instance_max_actual_prio = INSTANCE_MIN_PRIORITY;
+static uint64_t priority_bits[ PRIORITY_WORDS ];
+static uint64_t priority_summary[ PRIORITY_WORDS / 64 ];
+
+/* Instances that can't run (sleeping, frozen, waiting or paused) are taken
+   out of the priority lists, so the scheduler doesn't visit them until
+   they're woken up */
+
+static INSTANCE * parked_instances = NULL;
 
 /* ---------------------------------------------------------------------- */
 /* By id                                                                  */
 /* ---------------------------------------------------------------------- */
 
 void instance_add_to_list_by_id( INSTANCE * r, uint64_t id ) {
-    if ( !hashed_by_id ) hashed_by_id = calloc( HASH_SIZE, sizeof( INSTANCE * ) );
-    hashed_by_id[HASH( id )] = r;
+    id_slots[ID_INDEX( id )].instance = r;
 }
 
 /* ---------------------------------------------------------------------- */
 
 void instance_remove_from_list_by_id( INSTANCE * r, uint64_t id ) {
-    hashed_by_id[HASH( id )] = NULL;
-}
+    uint64_t index = ID_INDEX( id );
+    INSTANCE_SLOT * slot;
 
-/* ---------------------------------------------------------------------- */
-/* By instance                                                            */
-/* ---------------------------------------------------------------------- */
+    if ( index >= id_slots_count ) return;
 
-void instance_add_to_list_by_instance( INSTANCE * r ) {
-    unsigned int hash = HASH_INSTANCE( r );
+    slot = &id_slots[index];
+    if ( !slot->in_use || slot->generation != ID_GENERATION( id ) ) return;
 
-    if ( !hashed_by_instance ) hashed_by_instance = calloc( HASH_SIZE, sizeof( INSTANCE * ) );
+    slot->instance = NULL;
+    slot->in_use = 0;
+    if ( ++slot->generation > ID_MAX_GENERATION ) slot->generation = 0;
 
-    r->prev_by_instance = NULL;
-    r->next_by_instance = hashed_by_instance[hash];
-    if ( r->next_by_instance ) r->next_by_instance->prev_by_instance = r;
-    hashed_by_instance[hash] = r;
+    slot->next_free = ID_NO_SLOT;
+    if ( id_free_last != ID_NO_SLOT ) id_slots[id_free_last].next_free = ( uint32_t ) index;
+    else                              id_free_first = ( uint32_t ) index;
+    id_free_last = ( uint32_t ) index;
 }
 
 /* ---------------------------------------------------------------------- */
 
-void instance_remove_from_list_by_instance( INSTANCE * r ) {
-    unsigned int hash = HASH_INSTANCE( r );
-
-    if ( r->prev_by_instance ) r->prev_by_instance->next_by_instance = r->next_by_instance;
-    if ( r->next_by_instance ) r->next_by_instance->prev_by_instance = r->prev_by_instance;
-
-    if ( hashed_by_instance[hash] == r ) hashed_by_instance[hash] = r->next_by_instance;
-}
-
 /* ---------------------------------------------------------------------- */
 /* By type                                                                */
 /* ---------------------------------------------------------------------- */
@@ -144,6 +181,46 @@ void instance_remove_from_list_by_type( INSTANCE * r, uint64_t itype ) {
 /* By priority                                                            */
 /* ---------------------------------------------------------------------- */
 
+static int priority_highest_bit( uint64_t v ) {
+#if defined( __GNUC__ ) || defined( __clang__ )
+    return 63 - __builtin_clzll( v );
+#else
+    int n = 0;
+    while ( v >>= 1 ) n++;
+    return n;
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* Get the highest non empty priority list under pos (both are hash
+   indexes), or -1 if there is none */
+
+static int64_t priority_find_below( int64_t pos ) {
+    int64_t word, group;
+    uint64_t bits;
+
+    if ( --pos < 0 ) return -1;
+
+    word = pos >> 6;
+    bits = priority_bits[ word ] & BITS_UPTO( pos & 63 );
+    if ( bits ) return ( word << 6 ) + priority_highest_bit( bits );
+
+    if ( --word < 0 ) return -1;
+
+    group = word >> 6;
+    bits = priority_summary[ group ] & BITS_UPTO( word & 63 );
+    while ( !bits ) {
+        if ( --group < 0 ) return -1;
+        bits = priority_summary[ group ];
+    }
+
+    word = ( group << 6 ) + priority_highest_bit( bits );
+    return ( word << 6 ) + priority_highest_bit( priority_bits[ word ] );
+}
+
+/* ---------------------------------------------------------------------- */
+
 void instance_add_to_list_by_priority( INSTANCE * r, int64_t priority ) {
     unsigned int hash;
 
@@ -160,8 +237,8 @@ void instance_add_to_list_by_priority( INSTANCE * r, int64_t priority ) {
     hashed_by_priority[hash] = r;
     r->last_priority = priority;
 
-    if ( priority < instance_min_actual_prio ) instance_min_actual_prio = priority;
-    if ( priority > instance_max_actual_prio ) instance_max_actual_prio = priority;
+    priority_bits[ hash >> 6 ] |= 1ULL << ( hash & 63 );
+    priority_summary[ hash >> 12 ] |= 1ULL << ( ( hash >> 6 ) & 63 );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -169,26 +246,72 @@ void instance_add_to_list_by_priority( INSTANCE * r, int64_t priority ) {
 void instance_remove_from_list_by_priority( INSTANCE * r ) {
     unsigned int hash = HASH_PRIORITY( r->last_priority );
 
-    /* Update iterator_by_priority if necessary */
-
-    if ( iterator_by_priority == r ) instance_next_by_priority();
-
     if ( r->prev_by_priority ) r->prev_by_priority->next_by_priority = r->next_by_priority;
     if ( r->next_by_priority ) r->next_by_priority->prev_by_priority = r->prev_by_priority;
 
+    if ( r->parked ) {
+        if ( parked_instances == r ) parked_instances = r->next_by_priority;
+        r->parked = 0;
+        return;
+    }
+
+    /* Update iterator_by_priority if necessary */
+
+    if ( iterator_by_priority == r ) iterator_by_priority = r->next_by_priority;
+
     if ( hashed_by_priority[hash] == r ) hashed_by_priority[hash] = r->next_by_priority;
 
-    if ( !hashed_by_priority[hash] ) {
-        if ( r->last_priority == instance_min_actual_prio ) {
-            while ( instance_min_actual_prio < instance_max_actual_prio && !hashed_by_priority[ instance_min_actual_prio + INSTANCE_NORMALIZE_PRIORITY ] )
-                    instance_min_actual_prio++;
-        }
+    if ( !hashed_by_priority[hash] && !( priority_bits[ hash >> 6 ] &= ~( 1ULL << ( hash & 63 ) ) ) )
+        priority_summary[ hash >> 12 ] &= ~( 1ULL << ( ( hash >> 6 ) & 63 ) );
+}
 
-        if ( r->last_priority == instance_max_actual_prio ) {
-            while ( instance_max_actual_prio > instance_min_actual_prio && !hashed_by_priority[ instance_max_actual_prio + INSTANCE_NORMALIZE_PRIORITY ] )
-                    instance_max_actual_prio--;
-        }
-    }
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_park
+ *
+ *  Take an instance that can't run out of the scheduler lists. It will be
+ *  skipped by instance_next_by_priority() until instance_wake() is called.
+ *
+ *  PARAMS :
+ *      r               Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void instance_park( INSTANCE * r ) {
+    if ( r->parked ) return;
+
+    instance_remove_from_list_by_priority( r );
+
+    r->prev_by_priority = NULL;
+    r->next_by_priority = parked_instances;
+    if ( parked_instances ) parked_instances->prev_by_priority = r;
+    parked_instances = r;
+    r->parked = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_wake
+ *
+ *  Give a parked instance back to the scheduler. Must be called after
+ *  changing the status of an instance, if it may be able to run now.
+ *
+ *  PARAMS :
+ *      r               Pointer to the instance (may be NULL)
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void instance_wake( INSTANCE * r ) {
+    if ( !r || !r->parked ) return;
+
+    instance_remove_from_list_by_priority( r );
+    instance_add_to_list_by_priority( r, r->last_priority );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -207,8 +330,11 @@ void instance_remove_from_list_by_priority( INSTANCE * r ) {
  */
 
 void instance_dirty( INSTANCE * i ) {
+    int parked = i->parked;
+
     instance_remove_from_list_by_priority( i );
     instance_add_to_list_by_priority( i, LOCINT64( i, PRIORITY ) );
+    if ( parked ) instance_park( i );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -226,8 +352,10 @@ void instance_dirty( INSTANCE * i ) {
  */
 
 INSTANCE * instance_get( int64_t id ) {
-    if ( !hashed_by_id || !id ) return NULL;
-    return ( hashed_by_id[HASH( id )] );
+    uint64_t index = ID_INDEX( id );
+
+    if ( index >= id_slots_count || id_slots[index].generation != ID_GENERATION( id ) ) return NULL;
+    return id_slots[index].instance;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -246,21 +374,185 @@ INSTANCE * instance_get( int64_t id ) {
  */
 
 int64_t instance_getid() {
-    int64_t id = instance_maxid++;
+    uint64_t index;
 
-    if ( !hashed_by_id ) hashed_by_id = calloc( HASH_SIZE, sizeof( INSTANCE * ) );
+    if ( id_free_first != ID_NO_SLOT && ( id_slots_count >= ID_FRESH_SLOTS || id_slots_count > ID_MAX_INDEX ) ) {
+        index = id_free_first;
+        id_free_first = id_slots[index].next_free;
+        if ( id_free_first == ID_NO_SLOT ) id_free_last = ID_NO_SLOT;
+    } else {
+        if ( id_slots_count > ID_MAX_INDEX ) return -1;
+
+        if ( id_slots_count >= id_slots_allocated ) {
+            uint64_t allocated = id_slots_allocated ? id_slots_allocated * 2 : 1024;
+            INSTANCE_SLOT * slots = ( INSTANCE_SLOT * ) realloc( id_slots, allocated * sizeof( INSTANCE_SLOT ) );
+            if ( !slots ) return -1;
+            id_slots = slots;
+            id_slots_allocated = allocated;
+        }
 
-    if ( id <= LAST_INSTANCE_ID && !hashed_by_id[ HASH( id ) ] ) return id;
+        index = id_slots_count++;
+        id_slots[index].generation = 0;
+    }
+
+    id_slots[index].instance = NULL;
+    id_slots[index].in_use = 1;
+    id_slots[index].next_free = ID_NO_SLOT;
+
+    return ID_MAKE( index, id_slots[index].generation );
+}
+
+/* ---------------------------------------------------------------------- */
+/* Instance memory pools                                                  */
+/* ---------------------------------------------------------------------- */
+
+/* Every instance is allocated as one block: the INSTANCE struct, followed
+   by its private, public and local data and its stack. Destroyed instances
+   return their block to a free list in their PROCDEF, so the next instance
+   of the same process type reuses it without calling the system allocator */
+
+#define POOL_ALIGN(n)       ( ( ( int64_t )( n ) + 15 ) & ~( int64_t ) 15 )
+
+#define POOL_PRIDATA(proc)  POOL_ALIGN( sizeof( INSTANCE ) )
+#define POOL_PUBDATA(proc)  ( POOL_PRIDATA( proc ) + POOL_ALIGN( ( proc )->private_size + sizeof( int64_t ) ) )
+#define POOL_LOCDATA(proc)  ( POOL_PUBDATA( proc ) + POOL_ALIGN( ( proc )->public_size + sizeof( int64_t ) ) )
+#define POOL_STACK(proc)    ( POOL_LOCDATA( proc ) + POOL_ALIGN( local_size + sizeof( int64_t ) ) )
+
+static INSTANCE_POOL_STATS pool_stats = { 0 };
 
-    for (; instance_maxid <= LAST_INSTANCE_ID; instance_maxid++ ) {
-        if ( !hashed_by_id[HASH( instance_maxid )] ) return instance_maxid++;
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_alloc
+ *
+ *  Get a zeroed INSTANCE with its data and stack pointers set, from the
+ *  process pool if possible. Data contents are left uninitialized.
+ *
+ *  PARAMS :
+ *      proc            Pointer to the procedure definition
+ *
+ *  RETURN VALUE :
+ *      Pointer to the new instance
+ */
+
+static INSTANCE * instance_alloc( PROCDEF * proc ) {
+    INSTANCE * r;
+    uint8_t * block;
+
+    if ( !proc->pool_block_size ) proc->pool_block_size = POOL_STACK( proc ) + proc->stack_size;
+
+    if ( proc->pool ) {
+        r = proc->pool;
+        proc->pool = r->next;
+        proc->pool_count--;
+
+        pool_stats.reused++;
+        pool_stats.pooled--;
+        pool_stats.bytes_pooled -= proc->pool_block_size;
+    } else {
+        r = ( INSTANCE * ) malloc( proc->pool_block_size );
+        if ( !r ) {
+            fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+            exit( 2 );
+        }
+
+        pool_stats.allocated++;
     }
 
-    for ( instance_maxid = FIRST_INSTANCE_ID; instance_maxid < id; instance_maxid++ ) {
-        if ( !hashed_by_id[HASH( instance_maxid )] ) return instance_maxid++;
+    pool_stats.in_use++;
+    pool_stats.bytes_in_use += proc->pool_block_size;
+
+    memset( r, 0, sizeof( INSTANCE ) );
+
+    block = ( uint8_t * ) r;
+
+    r->pridata  = block + POOL_PRIDATA( proc );
+    r->pubdata  = block + POOL_PUBDATA( proc );
+    r->locdata  = block + POOL_LOCDATA( proc );
+    r->stack    = ( int64_t * ) ( block + POOL_STACK( proc ) );
+    r->stack[0] = proc->stack_size;
+
+    return r;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_free
+ *
+ *  Return an instance block to its process pool.
+ *
+ *  PARAMS :
+ *      r               Pointer to the instance
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+static void instance_free( INSTANCE * r ) {
+    PROCDEF * proc = r->proc;
+
+    pool_stats.in_use--;
+    pool_stats.bytes_in_use -= proc->pool_block_size;
+    pool_stats.pooled++;
+    pool_stats.bytes_pooled += proc->pool_block_size;
+
+    r->next = proc->pool;
+    proc->pool = r;
+    proc->pool_count++;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : instance_pool_release
+ *
+ *  Give all pooled (unused) instance blocks back to the system.
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void instance_pool_release() {
+    INSTANCE * r;
+    int64_t n;
+
+    for ( n = 0; n < procdef_count; n++ ) {
+        while (( r = procs[n].pool )) {
+            procs[n].pool = r->next;
+            free( r );
+        }
+        procs[n].pool_count = 0;
     }
 
-    return -1;
+    pool_stats.pooled = 0;
+    pool_stats.bytes_pooled = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void instance_pool_get_stats( INSTANCE_POOL_STATS * stats ) {
+    *stats = pool_stats;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void instance_pool_dump() {
+    int64_t n;
+
+    printf( "Instance pools: %" PRId64 " allocated, %" PRId64 " reused, "
+            "%" PRId64 " in use (%" PRId64 " bytes), %" PRId64 " pooled (%" PRId64 " bytes)\n",
+            pool_stats.allocated, pool_stats.reused,
+            pool_stats.in_use, pool_stats.bytes_in_use,
+            pool_stats.pooled, pool_stats.bytes_pooled );
+
+    for ( n = 0; n < procdef_count; n++ )
+        if ( procs[n].pool_block_size )
+            printf( "  %-32s block %6" PRId64 " bytes, %" PRId64 " pooled\n",
+                    procs[n].name ? procs[n].name : "?", procs[n].pool_block_size, procs[n].pool_count );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -291,12 +583,8 @@ INSTANCE * instance_duplicate( INSTANCE * father ) {
 
     if ( ( pid = instance_getid() ) == -1 ) return NULL;
 
-    r = ( INSTANCE * ) calloc( 1, sizeof( INSTANCE ) );
-    assert( r );
+    r = instance_alloc( father->proc );
 
-    r->pridata          = ( int64_t * ) malloc( father->private_size + sizeof( int64_t ) );
-    r->pubdata          = ( int64_t * ) malloc( father->public_size + sizeof( int64_t ) );
-    r->locdata          = ( int64_t * ) malloc( local_size + sizeof( int64_t ) );
     r->code             = father->code;
     r->codeptr          = father->codeptr;
     r->exitcode         = father->exitcode;
@@ -350,7 +638,6 @@ INSTANCE * instance_duplicate( INSTANCE * father ) {
     first_instance = r;
 
     instance_add_to_list_by_id( r, pid );
-    instance_add_to_list_by_instance( r );
     instance_add_to_list_by_type( r, itype );
     instance_add_to_list_by_priority( r, LOCINT64( father, PRIORITY ) ); // Use father for avoid scan-build warning, can use 'r'
 
@@ -359,7 +646,6 @@ INSTANCE * instance_duplicate( INSTANCE * father ) {
 
     r->called_by = NULL;
 
-    r->stack = malloc( father->stack[0] );
     memmove(r->stack, father->stack, ( void * ) father->stack_ptr - ( void * ) father->stack );
     r->stack_ptr = &r->stack[1];
 
@@ -399,12 +685,8 @@ INSTANCE * instance_new( PROCDEF * proc, INSTANCE * father ) {
 
     if ( ( pid = instance_getid() ) == -1 ) return NULL;
 
-    r = ( INSTANCE * ) calloc( 1, sizeof( INSTANCE ) );
-    assert( r );
+    r = instance_alloc( proc );
 
-    r->pridata          = ( int64_t * ) malloc( proc->private_size + sizeof( int64_t ) );
-    r->pubdata          = ( int64_t * ) malloc( proc->public_size + sizeof( int64_t ) );
-    r->locdata          = ( int64_t * ) malloc( local_size + sizeof( int64_t ) );
     r->code             = proc->code;
     r->codeptr          = proc->code;
     r->exitcode         = proc->exitcode;
@@ -460,7 +742,6 @@ INSTANCE * instance_new( PROCDEF * proc, INSTANCE * father ) {
     first_instance = r;
 
     instance_add_to_list_by_id( r, pid );
-    instance_add_to_list_by_instance( r );
     instance_add_to_list_by_type( r, proc->type );
     instance_add_to_list_by_priority( r, 0 );
 
@@ -469,9 +750,7 @@ INSTANCE * instance_new( PROCDEF * proc, INSTANCE * father ) {
 
     r->called_by = NULL;
 
-    r->stack = malloc( STACK_SIZE );
     r->stack_ptr = &r->stack[1];
-    r->stack[0] = STACK_SIZE;
 
     /* Initialize list pointers */
 
@@ -563,17 +842,10 @@ void instance_destroy( INSTANCE * r ) {
     /* Remove the instance from all hash lists */
 
     instance_remove_from_list_by_id( r, LOCQWORD( r, PROCESS_ID ) );
-    instance_remove_from_list_by_instance( r );
     instance_remove_from_list_by_type( r, LOCQWORD( r, PROCESS_TYPE ) );
     instance_remove_from_list_by_priority( r );
 
-    free( r->stack );
-
-    free( r->locdata );
-    free( r->pubdata );
-    free( r->pridata );
-
-    free( r );
+    instance_free( r );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -617,14 +889,10 @@ void instance_destroy_all( INSTANCE * except ) {
  */
 
 int instance_exists( INSTANCE * r ) {
-    INSTANCE * i;
-    if ( !hashed_by_instance || !r ) return 0;
-    i = hashed_by_instance[HASH_INSTANCE( r )];
-    while ( i ) {
-        if ( r == i ) return 1;
-        i = i->next_by_instance;
-    }
-    return 0;
+    /* Instance blocks stay in their pools after destroy, so the ID of a dead
+       instance is still readable, but its slot doesn't point to it anymore */
+    if ( !r ) return 0;
+    return instance_get( LOCQWORD( r, PROCESS_ID ) ) == r;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -648,17 +916,23 @@ int instance_exists( INSTANCE * r ) {
 INSTANCE * instance_next_by_priority() {
     INSTANCE * r = iterator_by_priority;
 
-    if ( iterator_by_priority ) iterator_by_priority = iterator_by_priority->next_by_priority;
-
-    if ( !iterator_by_priority ) {
-        if ( !hashed_by_priority ) return NULL;
+    if ( !r ) {
+        /* Go to the next non empty list. This is done here and not after
+           returning the last instance of a list, so instances added while
+           that one runs are honored */
+        int64_t pos = priority_find_below( iterator_pos + INSTANCE_NORMALIZE_PRIORITY );
 
-        if ( iterator_pos < instance_min_actual_prio || iterator_pos > instance_max_actual_prio )
-            iterator_pos = instance_max_actual_prio + 1;
+        if ( pos < 0 ) {
+            iterator_pos = INSTANCE_MAX_PRIORITY + 1;
+            return NULL;
+        }
 
-        while ( --iterator_pos >= instance_min_actual_prio && !( iterator_by_priority = hashed_by_priority[ iterator_pos + INSTANCE_NORMALIZE_PRIORITY ] ) );
+        iterator_pos = pos - INSTANCE_NORMALIZE_PRIORITY;
+        r = hashed_by_priority[ pos ];
     }
 
+    iterator_by_priority = r->next_by_priority;
+
     return ( r );
 }
 
@@ -710,7 +984,8 @@ INSTANCE * instance_get_by_type( uint64_t itype, INSTANCE ** context ) {
 /* ---------------------------------------------------------------------- */
 
 void instance_reset_iterator_by_priority() {
-    iterator_by_priority = hashed_by_priority[ ( iterator_pos = instance_max_actual_prio ) + INSTANCE_NORMALIZE_PRIORITY ];
+    iterator_by_priority = NULL;
+    iterator_pos = INSTANCE_MAX_PRIORITY + 1;
 }
 
 /* ---------------------------------------------------------------------- */
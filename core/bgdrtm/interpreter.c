@@ -41,6 +41,9 @@
 #include "instance.h"
 #include "offsets.h"
 #include "xstrings.h"
+#include "jobs.h"
+
+#include "interpreter_p.h"
 
 /* ---------------------------------------------------------------------- */
 /* Interpreter's main module                                              */
@@ -73,10 +76,47 @@ INSTANCE * trace_instance = NULL;
 
 #define FATAL_ERROR_DIV_BY_ZERO_CHECK(cond)     FATAL_ERROR_CHECK( cond, "ERROR: Runtime error in %s(%" PRId64 ") - Division by zero\n", r->proc->name, LOCQWORD( r, PROCESS_ID ) )
 
+/* Debugger wants control on every instruction */
+
+#define DEBUGGER_ACTIVE()   ( debug > 0 || debugger_show_console || debugger_trace || debugger_step )
+
 #define GET_INSTANCE() \
     INSTANCE* i = instance_get( r->stack_ptr[-1] ); \
     FATAL_ERROR_CHECK( !i, "ERROR: Runtime error in %s(%" PRId64 ") - Process %" PRId64 " not active\n", r->proc->name, LOCQWORD( r, PROCESS_ID ), r->stack_ptr[-1] )
 
+/* ---------------------------------------------------------------------- */
+/* Parallel-safe instances are collected here and run on the worker pool  */
+/* before any other instance runs, so the execution order is only relaxed */
+/* between consecutive parallel-safe instances.                           */
+
+static INSTANCE ** job_batch = NULL;
+static int64_t job_batch_count = 0;
+static int64_t job_batch_size = 0;
+
+#define JOB_ELIGIBLE(i) \
+    ( ( (i)->proc->flags & PROC_PARALLEL ) && !(i)->first_run && !(i)->called_by && \
+      !(i)->proc->breakpoint && !(i)->breakpoint && \
+      !instance_pre_execute_hook_count && !instance_pos_execute_hook_count && \
+      !DEBUGGER_ACTIVE() )
+
+static void job_batch_add( INSTANCE * i ) {
+    if ( job_batch_count == job_batch_size ) {
+        job_batch_size += 1024;
+        job_batch = ( INSTANCE ** ) realloc( job_batch, sizeof( INSTANCE * ) * job_batch_size );
+        if ( !job_batch ) {
+            fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+            exit( 2 );
+        }
+    }
+    job_batch[ job_batch_count++ ] = i;
+}
+
+static void job_batch_flush() {
+    if ( !job_batch_count ) return;
+    jobs_run( job_batch, job_batch_count );
+    job_batch_count = 0;
+}
+
 /* ---------------------------------------------------------------------- */
 
 int64_t instance_go_all() {
@@ -101,12 +141,26 @@ int64_t instance_go_all() {
                         for ( int n = 0; n < process_exec_hook_count; n++ )
                             process_exec_hook_list[n]( i );
                     /* Hook */
+
+                    /* Parallel-safe: leave it for the worker pool */
+                    if ( jobs_active() && JOB_ELIGIBLE( i ) ) {
+                        job_batch_add( i );
+                        i_count++;
+                        i = instance_next_by_priority();
+                        continue;
+                    }
                 } else if ( status & ~( STATUS_KILLED | STATUS_DEAD ) ) { /* STATUS_SLEEPING OR STATUS_FROZEN OR STATUS_WAITING_MASK OR STATUS_PAUSED_MASK */
+                    /* Don't visit it again until its status changes */
+                    INSTANCE * idle = i;
                     i = instance_next_by_priority();
+                    instance_park( idle );
                     continue;
                 }
                 /* If instance is KILLED or DEAD, run instance without exec_hook executed. */
 
+                /* Pending parallel-safe instances run before this one */
+                job_batch_flush();
+
                 instance_go( i );
 
                 i_count++;
@@ -118,6 +172,8 @@ int64_t instance_go_all() {
             i = instance_next_by_priority();
         }
 
+        job_batch_flush();
+
         /* If frame is complete, then update internal vars and execute main hooks. */
 
         if ( !i_count ) {
@@ -131,6 +187,9 @@ int64_t instance_go_all() {
                 // if status == STATUS_KILLED or STATUS_DEAD then the process still lives
                 if ( status == STATUS_DEAD || status == STATUS_KILLED || status == STATUS_RUNNING ) LOCINT64( i, FRAME_PERCENT ) -= 100;
 
+                /* Status changed outside of signal() & co. */
+                if ( i->parked && ( status == STATUS_DEAD || status == STATUS_KILLED || status == STATUS_RUNNING ) ) instance_wake( i );
+
                 if ( i->last_priority != LOCINT64( i, PRIORITY ) ) {
                     instance_dirty( i );
                     LOCINT64( i, SAVED_PRIORITY ) = LOCINT64( i, PRIORITY );
@@ -190,6 +249,31 @@ int64_t instance_go( INSTANCE * r ) {
 
     int64_t debugger_step_pending = 0; // local to instance
 
+    /* 1 if the debugger needs per-instruction checks (tracing, stepping, debug output) */
+    int instrumented = 0;
+
+#ifdef USE_THREADED_DISPATCH
+    /* Opcode -> handler label table, filled on first run */
+    static void * dispatch_table[ OPCODE_TABLE_SIZE ];
+    /* Same, but every opcode goes through the instrumented checks first */
+    static void * dispatch_checked[ OPCODE_TABLE_SIZE ];
+    static int dispatch_table_ready = 0;
+
+    /* Table used after each instruction */
+    void ** dispatch = dispatch_table;
+
+    if ( !dispatch_table_ready ) {
+        for ( int n = 0; n < OPCODE_TABLE_SIZE; n++ ) {
+            dispatch_table[ n ] = &&op_invalid;
+            dispatch_checked[ n ] = &&check_instruction;
+        }
+#define OPCODE_LABEL(op, type) dispatch_table[ OPCODE_INDEX( OPCODE(op, type) ) ] = &&op_##op##_##type;
+        OPCODES_LIST(OPCODE_LABEL)
+#undef OPCODE_LABEL
+        dispatch_table_ready = 1;
+    }
+#endif
+
     /* ------------------------------------------------------------------------------- */
     /* Restore if exit by debug                                                        */
 
@@ -216,9 +300,21 @@ int64_t instance_go( INSTANCE * r ) {
     }
 
 main_loop_instance_go:
-    trace_sentence = -1;
+    /* Don't write it if not needed, instances on the worker pool go through here too */
+    if ( trace_sentence != -1 ) trace_sentence = -1;
+
+    for ( ;; ) {
+#ifdef USE_THREADED_DISPATCH
+check_instruction:
+#endif
+        /* Control flow boundary (jumps, calls, returns) or instrumented mode: */
+        /* check exit requests, status changes and debugger activity.          */
+
+        FATAL_ERROR_CHECK(r->stack_ptr < r->stack, "ERROR: Runtime error in %s(%" PRId64 ") - Critical Stack Problem StackBase=%p StackPTR=%p\n", r->proc->name, LOCQWORD( r, PROCESS_ID ), (void *)r->stack, (void *)r->stack_ptr );
+        FATAL_ERROR_CHECK(r->stack_ptr > r->stack + ( r->stack[0] & STACK_SIZE_MASK ) / sizeof( r->stack[0] ), "ERROR: Runtime error in %s(%" PRId64 ") - Stack Overflow StackBase=%p StackPTR=%p\n", r->proc->name, LOCQWORD( r, PROCESS_ID ), (void *)r->stack, (void *)r->stack_ptr );
+
+        if ( must_exit ) break;
 
-    while ( !must_exit ) {
         /* If I was killed or I'm waiting status, then exit */
         uint64_t status = *status_ptr;
         if ( status & ( STATUS_KILLED | STATUS_WAITING_MASK | STATUS_PAUSED_MASK ) ) {
@@ -227,48 +323,62 @@ main_loop_instance_go:
             goto break_all;
         }
 
-        if ( trace_sentence != -1 ) {
-             while( debugger_show_console ) {
-                /* Hook */
-                if ( handler_hook_count )
-                    for ( int n = 0; n < handler_hook_count; n++ )
-                        handler_hook_list[n].hook();
-                /* Hook */
+        instrumented = DEBUGGER_ACTIVE();
+#ifdef USE_THREADED_DISPATCH
+        dispatch = instrumented ? dispatch_checked : dispatch_table;
+#endif
+
+        if ( instrumented ) {
+            if ( trace_sentence != -1 ) {
+                 while( debugger_show_console ) {
+                    /* Hook */
+                    if ( handler_hook_count )
+                        for ( int n = 0; n < handler_hook_count; n++ )
+                            handler_hook_list[n].hook();
+                    /* Hook */
+                }
             }
-        }
 
-        /* debug output */
-        if ( debug > 0 ) {
-            if ( debug > 2 ) {
-                int c = 34 - stack_dump( r ) * 17;
-                if ( debug > 1 ) printf( "%*.*s[%4" PRIu64 "] ", c, c, "", ( uint64_t ) ( pc - r->code ) );
+            /* debug output */
+            if ( debug > 0 ) {
+                if ( debug > 2 ) {
+                    int c = 34 - stack_dump( r ) * 17;
+                    if ( debug > 1 ) printf( "%*.*s[%4" PRIu64 "] ", c, c, "", ( uint64_t ) ( pc - r->code ) );
+                }
+                else if ( debug > 1 ) printf( "[%4" PRIu64 "] ", ( uint64_t ) ( pc - r->code ) );
+                mnemonic_dump( *pc, pc[1] );
+                fflush(stdout);
             }
-            else if ( debug > 1 ) printf( "[%4" PRIu64 "] ", ( uint64_t ) ( pc - r->code ) );
-            mnemonic_dump( *pc, pc[1] );
-            fflush(stdout);
         }
 
+#ifdef USE_THREADED_DISPATCH
+        /* Jump straight to the handler, the switch below is never evaluated */
+        goto *dispatch_table[ OPCODE_INDEX( *pc ) ];
+#else
+next_instruction:
+#endif
+
         switch ( *pc ) {
 
             /* No operation */
-            case MN_NOP:
+            OPCASE(NOP, NONE)
                 ++pc;
                 break;
 
             /* Stack manipulation */
 
-            case MN_DUP:
+            OPCASE(DUP, NONE)
                 *r->stack_ptr = r->stack_ptr[-1];
                 ++r->stack_ptr;
                 ++pc;
                 break;
 
-            case MN_PUSH:
+            OPCASE(PUSH, NONE)
                 *r->stack_ptr++ = pc[1];
                 pc += 2;
                 break;
 
-            case MN_PUSH | MN_STRING:
+            OPCASE(PUSH, STRING)
             {
                 uint64_t n = pc[1];
                 *r->stack_ptr++ = n;
@@ -277,34 +387,34 @@ main_loop_instance_go:
                 break;
             }
 
-            case MN_POP:
+            OPCASE(POP, NONE)
                 --r->stack_ptr;
                 ++pc;
                 break;
 
-            case MN_POP | MN_STRING:
+            OPCASE(POP, STRING)
                 --r->stack_ptr;
                 string_discard( *r->stack_ptr );
                 ++pc;
                 break;
 
             // array[var] (maybe data type is nonsense)
-            case MN_INDEX | MN_QWORD:
-            case MN_INDEX | MN_UNSIGNED | MN_QWORD:
-            case MN_INDEX | MN_DWORD:
-            case MN_INDEX | MN_UNSIGNED | MN_DWORD:
-            case MN_INDEX | MN_WORD:
-            case MN_INDEX | MN_UNSIGNED | MN_WORD:
-            case MN_INDEX | MN_BYTE:
-            case MN_INDEX | MN_UNSIGNED | MN_BYTE:
-            case MN_INDEX | MN_STRING:
-            case MN_INDEX | MN_FLOAT:
-            case MN_INDEX | MN_DOUBLE:
+            OPCASE(INDEX, QWORD)
+            OPCASE(INDEX, UQWORD)
+            OPCASE(INDEX, DWORD)
+            OPCASE(INDEX, UDWORD)
+            OPCASE(INDEX, WORD)
+            OPCASE(INDEX, UWORD)
+            OPCASE(INDEX, BYTE)
+            OPCASE(INDEX, UBYTE)
+            OPCASE(INDEX, STRING)
+            OPCASE(INDEX, FLOAT)
+            OPCASE(INDEX, DOUBLE)
                 r->stack_ptr[-1] += pc[1];
                 pc += 2;
                 break;
 
-            case MN_ARRAY:
+            OPCASE(ARRAY, NONE)
                 --r->stack_ptr;
                 r->stack_ptr[-1] += pc[1] * r->stack_ptr[0];
                 pc += 2;
@@ -312,18 +422,21 @@ main_loop_instance_go:
 
             /* Process calls */
 
-            case MN_CLONE:
+            /* Calls are control flow boundaries, they continue the loop to check  */
+            /* the status (a call or a system function may kill or freeze me).     */
+
+            OPCASE(CLONE, NONE)
             {
                 INSTANCE* i = instance_duplicate( r );
                 i->codeptr = pc + 2;
                 pc = r->code + pc[1];
-                break;
+                continue;
             }
 
-#define OP_PROC_CALL(case_value, stack_error, stack_run, stack_child_alive) \
-case case_value: \
+#define OP_PROC_CALL(op, type, stack_error, stack_run, stack_child_alive) \
+OPCASE(op, type) \
 { \
-    PROCDEF * proc = procdef_get( pc[1] ); \
+    PROCDEF * proc = ( PROCDEF * )( intptr_t ) pc[1]; \
     FATAL_ERROR_CHECK( !proc, "ERROR: Runtime error in %s(%" PRId64 ") - Unknown process\n", r->proc->name, LOCQWORD( r, PROCESS_ID ) ) \
     \
     /* Process uses FRAME or locals, must create an instance */ \
@@ -333,7 +446,7 @@ case case_value: \
         r->stack_ptr -= proc->params; \
         stack_error \
         pc += 2; \
-        break; \
+        continue; \
     } \
     \
     for ( int n = 0; n < proc->params; n++ ) \
@@ -381,12 +494,12 @@ case case_value: \
     *status_ptr &= ~STATUS_WAITING_MASK; \
     if ( child_is_alive ) i->called_by = NULL; \
     \
-    break; \
+    continue; \
 }
 
             // MN_CALL
             OP_PROC_CALL(
-                MN_CALL,
+                CALL, NONE,
                 /* stack_error */
                 r->stack[0] |= STACK_RETURN_VALUE; \
                 *r->stack_ptr = -1; \
@@ -403,7 +516,7 @@ case case_value: \
 
             // MN_PROC
             OP_PROC_CALL(
-                MN_PROC,
+                PROC, NONE,
                 /* stack_error */
                 r->stack[0] &= ~STACK_RETURN_VALUE;,
 
@@ -415,83 +528,83 @@ case case_value: \
                 r->stack[0] &= ~STACK_RETURN_VALUE;
             )
 
-            case MN_SYSCALL:
+            OPCASE(SYSCALL, NONE)
             {
-                SYSPROC * p = sysproc_get( pc[1] );
+                SYSPROC * p = ( SYSPROC * )( intptr_t ) pc[1];
                 FATAL_ERROR_CHECK( !p, "ERROR: Runtime error in %s(%" PRId64 ") - Unknown system function\n", r->proc->name, LOCQWORD( r, PROCESS_ID ) )
                 r->stack_ptr -= p->params;
                 *r->stack_ptr = ( *p->func )( r, r->stack_ptr );
                 ++r->stack_ptr;
                 pc += 2;
-                break;
+                continue;
             }
 
-            case MN_SYSPROC:
+            OPCASE(SYSPROC, NONE)
             {
-                SYSPROC * p = sysproc_get( pc[1] );
+                SYSPROC * p = ( SYSPROC * )( intptr_t ) pc[1];
                 FATAL_ERROR_CHECK( !p, "ERROR: Runtime error in %s(%" PRId64 ") - Unknown system process\n", r->proc->name, LOCQWORD( r, PROCESS_ID ) )
                 r->stack_ptr -= p->params;
                 ( *p->func )( r, r->stack_ptr );
                 pc += 2;
-                break;
+                continue;
             }
 
-#define CASE_ALL_TYPES(case_value) \
-case case_value | MN_QWORD: \
-case case_value | MN_UNSIGNED | MN_QWORD: \
-case case_value | MN_DWORD: \
-case case_value | MN_UNSIGNED | MN_DWORD: \
-case case_value | MN_WORD: \
-case case_value | MN_UNSIGNED | MN_WORD: \
-case case_value | MN_BYTE: \
-case case_value | MN_UNSIGNED | MN_BYTE: \
-case case_value | MN_STRING: \
-case case_value | MN_DOUBLE: \
-case case_value | MN_FLOAT:
+#define CASE_ALL_TYPES(op) \
+OPCASE(op, QWORD) \
+OPCASE(op, UQWORD) \
+OPCASE(op, DWORD) \
+OPCASE(op, UDWORD) \
+OPCASE(op, WORD) \
+OPCASE(op, UWORD) \
+OPCASE(op, BYTE) \
+OPCASE(op, UBYTE) \
+OPCASE(op, STRING) \
+OPCASE(op, DOUBLE) \
+OPCASE(op, FLOAT)
 
             /* Access to variables address */
 
-#define OP_VAR_PTR(case_value, get_macro) \
-CASE_ALL_TYPES(case_value) { \
+#define OP_VAR_PTR(op, get_macro) \
+CASE_ALL_TYPES(op) { \
     *r->stack_ptr++ = ( uint64_t )( intptr_t )&get_macro( r, pc[1] ); \
     pc += 2; \
     break; \
 }
 
-            OP_VAR_PTR(MN_PRIVATE, PRIQWORD)
-            OP_VAR_PTR(MN_PUBLIC, PUBQWORD)
-            OP_VAR_PTR(MN_LOCAL, LOCQWORD)
+            OP_VAR_PTR(PRIVATE, PRIQWORD)
+            OP_VAR_PTR(PUBLIC, PUBQWORD)
+            OP_VAR_PTR(LOCAL, LOCQWORD)
 
-            CASE_ALL_TYPES(MN_GLOBAL)
+            CASE_ALL_TYPES(GLOBAL)
                 *r->stack_ptr++ = ( uint64_t )( intptr_t )&GLOQWORD( pc[1] );
                 pc += 2;
                 break;
 
-#define OP_VAR_REMOTE_PTR(case_value, get_macro) \
-CASE_ALL_TYPES(case_value) { \
+#define OP_VAR_REMOTE_PTR(op, get_macro) \
+CASE_ALL_TYPES(op) { \
     GET_INSTANCE() \
     r->stack_ptr[-1] = ( uint64_t )( intptr_t )&get_macro( i, pc[1] ); \
     pc += 2; \
     break; \
 }
 
-            OP_VAR_REMOTE_PTR(MN_REMOTE, LOCQWORD)
-            OP_VAR_REMOTE_PTR(MN_REMOTE_PUBLIC, PUBQWORD)
+            OP_VAR_REMOTE_PTR(REMOTE, LOCQWORD)
+            OP_VAR_REMOTE_PTR(REMOTE_PUBLIC, PUBQWORD)
 
             /***********************/
             /* Access to variables */
             /***********************/
 
-#define OP_GET(case_value, get_macro) \
-case case_value: \
+#define OP_GET(op, type, get_macro) \
+OPCASE(op, type) \
 { \
     *r->stack_ptr++ = get_macro(r, pc[1]); \
     pc += 2; \
     break; \
 }
 
-#define OP_GETS(case_value, get_macro) \
-case case_value: \
+#define OP_GETS(op, type, get_macro) \
+OPCASE(op, type) \
 { \
     uint64_t string_id = get_macro( r, pc[1] ); \
     *r->stack_ptr++ = string_id; \
@@ -504,74 +617,74 @@ case case_value: \
             /* Access to private variables */
             /*******************************/
 
-            case MN_GET_PRIV | MN_UNSIGNED | MN_QWORD:
-            case MN_GET_PRIV | MN_DOUBLE:
-            OP_GET(MN_GET_PRIV | MN_QWORD, PRIQWORD)
-            OP_GET(MN_GET_PRIV | MN_DWORD, PRIINT32)
-            case MN_GET_PRIV | MN_FLOAT:
-            OP_GET(MN_GET_PRIV | MN_UNSIGNED | MN_DWORD, PRIDWORD)
-            OP_GET(MN_GET_PRIV | MN_WORD, PRIINT16)
-            OP_GET(MN_GET_PRIV | MN_UNSIGNED | MN_WORD, PRIWORD)
-            OP_GET(MN_GET_PRIV | MN_BYTE, PRIINT8)
-            OP_GET(MN_GET_PRIV | MN_UNSIGNED | MN_BYTE, PRIBYTE)
-            OP_GETS(MN_GET_PRIV | MN_STRING, PRIQWORD)
+            OPCASE(GET_PRIV, UQWORD)
+            OPCASE(GET_PRIV, DOUBLE)
+            OP_GET(GET_PRIV, QWORD, PRIQWORD)
+            OP_GET(GET_PRIV, DWORD, PRIINT32)
+            OPCASE(GET_PRIV, FLOAT)
+            OP_GET(GET_PRIV, UDWORD, PRIDWORD)
+            OP_GET(GET_PRIV, WORD, PRIINT16)
+            OP_GET(GET_PRIV, UWORD, PRIWORD)
+            OP_GET(GET_PRIV, BYTE, PRIINT8)
+            OP_GET(GET_PRIV, UBYTE, PRIBYTE)
+            OP_GETS(GET_PRIV, STRING, PRIQWORD)
 
             /******************************/
             /* Access to public variables */
             /******************************/
 
-            case MN_GET_PUBLIC | MN_UNSIGNED | MN_QWORD:
-            case MN_GET_PUBLIC | MN_DOUBLE:
-            OP_GET(MN_GET_PUBLIC | MN_QWORD, PUBQWORD)
-            OP_GET(MN_GET_PUBLIC | MN_DWORD, PUBINT32)
-            case MN_GET_PUBLIC | MN_FLOAT:
-            OP_GET(MN_GET_PUBLIC | MN_UNSIGNED | MN_DWORD, PUBDWORD)
-            OP_GET(MN_GET_PUBLIC | MN_WORD, PUBINT16)
-            OP_GET(MN_GET_PUBLIC | MN_UNSIGNED | MN_WORD, PUBWORD)
-            OP_GET(MN_GET_PUBLIC | MN_BYTE, PUBINT8)
-            OP_GET(MN_GET_PUBLIC | MN_UNSIGNED | MN_BYTE, PUBBYTE)
-            OP_GETS(MN_GET_PUBLIC | MN_STRING, PUBQWORD)
+            OPCASE(GET_PUBLIC, UQWORD)
+            OPCASE(GET_PUBLIC, DOUBLE)
+            OP_GET(GET_PUBLIC, QWORD, PUBQWORD)
+            OP_GET(GET_PUBLIC, DWORD, PUBINT32)
+            OPCASE(GET_PUBLIC, FLOAT)
+            OP_GET(GET_PUBLIC, UDWORD, PUBDWORD)
+            OP_GET(GET_PUBLIC, WORD, PUBINT16)
+            OP_GET(GET_PUBLIC, UWORD, PUBWORD)
+            OP_GET(GET_PUBLIC, BYTE, PUBINT8)
+            OP_GET(GET_PUBLIC, UBYTE, PUBBYTE)
+            OP_GETS(GET_PUBLIC, STRING, PUBQWORD)
 
             /*****************************/
             /* Access to local variables */
             /*****************************/
 
-            case MN_GET_LOCAL | MN_UNSIGNED | MN_QWORD:
-            case MN_GET_LOCAL | MN_DOUBLE:
-            OP_GET(MN_GET_LOCAL | MN_QWORD, LOCQWORD)
-            OP_GET(MN_GET_LOCAL | MN_DWORD, LOCINT32)
-            case MN_GET_LOCAL | MN_FLOAT:
-            OP_GET(MN_GET_LOCAL | MN_UNSIGNED | MN_DWORD, LOCDWORD)
-            OP_GET(MN_GET_LOCAL | MN_WORD, LOCINT16)
-            OP_GET(MN_GET_LOCAL | MN_UNSIGNED | MN_WORD, LOCWORD)
-            OP_GET(MN_GET_LOCAL | MN_BYTE, LOCINT8)
-            OP_GET(MN_GET_LOCAL | MN_UNSIGNED | MN_BYTE, LOCBYTE)
-            OP_GETS(MN_GET_LOCAL | MN_STRING, LOCQWORD)
+            OPCASE(GET_LOCAL, UQWORD)
+            OPCASE(GET_LOCAL, DOUBLE)
+            OP_GET(GET_LOCAL, QWORD, LOCQWORD)
+            OP_GET(GET_LOCAL, DWORD, LOCINT32)
+            OPCASE(GET_LOCAL, FLOAT)
+            OP_GET(GET_LOCAL, UDWORD, LOCDWORD)
+            OP_GET(GET_LOCAL, WORD, LOCINT16)
+            OP_GET(GET_LOCAL, UWORD, LOCWORD)
+            OP_GET(GET_LOCAL, BYTE, LOCINT8)
+            OP_GET(GET_LOCAL, UBYTE, LOCBYTE)
+            OP_GETS(GET_LOCAL, STRING, LOCQWORD)
 
             /******************************/
             /* Access to global variables */
             /******************************/
 
-#define OP_GET_GLOBAL(case_value, get_macro) \
-case case_value: \
+#define OP_GET_GLOBAL(op, type, get_macro) \
+OPCASE(op, type) \
 { \
     *r->stack_ptr++ = get_macro(pc[1]); \
     pc += 2; \
     break; \
 }
 
-            case MN_GET_GLOBAL | MN_UNSIGNED | MN_QWORD:
-            case MN_GET_GLOBAL | MN_DOUBLE:
-            OP_GET_GLOBAL(MN_GET_GLOBAL | MN_QWORD, GLOQWORD)
-            OP_GET_GLOBAL(MN_GET_GLOBAL | MN_DWORD, GLOINT32)
-            case MN_GET_GLOBAL | MN_FLOAT:
-            OP_GET_GLOBAL(MN_GET_GLOBAL | MN_UNSIGNED | MN_DWORD, GLODWORD)
-            OP_GET_GLOBAL(MN_GET_GLOBAL | MN_WORD, GLOINT16)
-            OP_GET_GLOBAL(MN_GET_GLOBAL | MN_UNSIGNED | MN_WORD, GLOWORD)
-            OP_GET_GLOBAL(MN_GET_GLOBAL | MN_BYTE, GLOINT8)
-            OP_GET_GLOBAL(MN_GET_GLOBAL | MN_UNSIGNED | MN_BYTE, GLOBYTE)
-
-            case MN_GET_GLOBAL | MN_STRING:
+            OPCASE(GET_GLOBAL, UQWORD)
+            OPCASE(GET_GLOBAL, DOUBLE)
+            OP_GET_GLOBAL(GET_GLOBAL, QWORD, GLOQWORD)
+            OP_GET_GLOBAL(GET_GLOBAL, DWORD, GLOINT32)
+            OPCASE(GET_GLOBAL, FLOAT)
+            OP_GET_GLOBAL(GET_GLOBAL, UDWORD, GLODWORD)
+            OP_GET_GLOBAL(GET_GLOBAL, WORD, GLOINT16)
+            OP_GET_GLOBAL(GET_GLOBAL, UWORD, GLOWORD)
+            OP_GET_GLOBAL(GET_GLOBAL, BYTE, GLOINT8)
+            OP_GET_GLOBAL(GET_GLOBAL, UBYTE, GLOBYTE)
+
+            OPCASE(GET_GLOBAL, STRING)
             {
                 uint64_t string_id = GLOQWORD( pc[1] );
                 *r->stack_ptr++ = string_id;
@@ -584,8 +697,8 @@ case case_value: \
             /* Access to remote variables */
             /******************************/
 
-#define OP_GET_REMOTE(case_value, get_macro) \
-case case_value: \
+#define OP_GET_REMOTE(op, type, get_macro) \
+OPCASE(op, type) \
 { \
     GET_INSTANCE() \
     r->stack_ptr[-1] = get_macro(i, pc[1]); \
@@ -593,8 +706,8 @@ case case_value: \
     break; \
 }
 
-#define OP_GET_REMOTES(case_value, get_macro) \
-case case_value: \
+#define OP_GET_REMOTES(op, type, get_macro) \
+OPCASE(op, type) \
 { \
     GET_INSTANCE() \
     uint64_t string_id = get_macro( i, pc[1] ); \
@@ -604,58 +717,58 @@ case case_value: \
     break; \
 }
 
-            case MN_GET_REMOTE | MN_UNSIGNED | MN_QWORD:
-            case MN_GET_REMOTE | MN_DOUBLE:
-            OP_GET_REMOTE(MN_GET_REMOTE | MN_QWORD, LOCQWORD)
-            OP_GET_REMOTE(MN_GET_REMOTE | MN_DWORD, LOCINT32)
-            case MN_GET_REMOTE | MN_FLOAT:
-            OP_GET_REMOTE(MN_GET_REMOTE | MN_UNSIGNED | MN_DWORD, LOCDWORD)
-            OP_GET_REMOTE(MN_GET_REMOTE | MN_WORD, LOCINT16)
-            OP_GET_REMOTE(MN_GET_REMOTE | MN_UNSIGNED | MN_WORD, LOCWORD)
-            OP_GET_REMOTE(MN_GET_REMOTE | MN_BYTE, LOCINT8)
-            OP_GET_REMOTE(MN_GET_REMOTE | MN_UNSIGNED | MN_BYTE, LOCBYTE)
-            OP_GET_REMOTES(MN_GET_REMOTE | MN_STRING, LOCQWORD)
+            OPCASE(GET_REMOTE, UQWORD)
+            OPCASE(GET_REMOTE, DOUBLE)
+            OP_GET_REMOTE(GET_REMOTE, QWORD, LOCQWORD)
+            OP_GET_REMOTE(GET_REMOTE, DWORD, LOCINT32)
+            OPCASE(GET_REMOTE, FLOAT)
+            OP_GET_REMOTE(GET_REMOTE, UDWORD, LOCDWORD)
+            OP_GET_REMOTE(GET_REMOTE, WORD, LOCINT16)
+            OP_GET_REMOTE(GET_REMOTE, UWORD, LOCWORD)
+            OP_GET_REMOTE(GET_REMOTE, BYTE, LOCINT8)
+            OP_GET_REMOTE(GET_REMOTE, UBYTE, LOCBYTE)
+            OP_GET_REMOTES(GET_REMOTE, STRING, LOCQWORD)
 
             /*************************************/
             /* Access to remote public variables */
             /*************************************/
 
-            case MN_GET_REMOTE_PUBLIC | MN_UNSIGNED | MN_QWORD:
-            case MN_GET_REMOTE_PUBLIC | MN_DOUBLE:
-            OP_GET_REMOTE(MN_GET_REMOTE_PUBLIC | MN_QWORD, PUBQWORD)
-            OP_GET_REMOTE(MN_GET_REMOTE_PUBLIC | MN_DWORD, PUBINT32)
-            case MN_GET_REMOTE_PUBLIC | MN_FLOAT:
-            OP_GET_REMOTE(MN_GET_REMOTE_PUBLIC | MN_UNSIGNED | MN_DWORD, PUBDWORD)
-            OP_GET_REMOTE(MN_GET_REMOTE_PUBLIC | MN_WORD, PUBINT16)
-            OP_GET_REMOTE(MN_GET_REMOTE_PUBLIC | MN_UNSIGNED | MN_WORD, PUBWORD)
-            OP_GET_REMOTE(MN_GET_REMOTE_PUBLIC | MN_BYTE, PUBINT8)
-            OP_GET_REMOTE(MN_GET_REMOTE_PUBLIC | MN_UNSIGNED | MN_BYTE, PUBBYTE)
-            OP_GET_REMOTES(MN_GET_REMOTE_PUBLIC | MN_STRING, PUBQWORD)
+            OPCASE(GET_REMOTE_PUBLIC, UQWORD)
+            OPCASE(GET_REMOTE_PUBLIC, DOUBLE)
+            OP_GET_REMOTE(GET_REMOTE_PUBLIC, QWORD, PUBQWORD)
+            OP_GET_REMOTE(GET_REMOTE_PUBLIC, DWORD, PUBINT32)
+            OPCASE(GET_REMOTE_PUBLIC, FLOAT)
+            OP_GET_REMOTE(GET_REMOTE_PUBLIC, UDWORD, PUBDWORD)
+            OP_GET_REMOTE(GET_REMOTE_PUBLIC, WORD, PUBINT16)
+            OP_GET_REMOTE(GET_REMOTE_PUBLIC, UWORD, PUBWORD)
+            OP_GET_REMOTE(GET_REMOTE_PUBLIC, BYTE, PUBINT8)
+            OP_GET_REMOTE(GET_REMOTE_PUBLIC, UBYTE, PUBBYTE)
+            OP_GET_REMOTES(GET_REMOTE_PUBLIC, STRING, PUBQWORD)
 
             /*******************************/
             /* Access to pointer variables */
             /*******************************/
 
-#define OP_PTR(case_value, ctype) \
-case case_value: \
+#define OP_PTR(op, type, ctype) \
+OPCASE(op, type) \
 { \
     r->stack_ptr[-1] = *( ctype * )( intptr_t )r->stack_ptr[-1]; \
     ++pc; \
     break; \
 }
 
-            case MN_PTR | MN_UNSIGNED | MN_QWORD:
-            case MN_PTR | MN_DOUBLE:
-            OP_PTR(MN_PTR | MN_QWORD, int64_t)
-            OP_PTR(MN_PTR | MN_DWORD, int32_t)
-            case MN_PTR | MN_FLOAT:
-            OP_PTR(MN_PTR | MN_UNSIGNED | MN_DWORD, uint32_t)
-            OP_PTR(MN_PTR | MN_WORD, int16_t)
-            OP_PTR(MN_PTR | MN_UNSIGNED | MN_WORD, uint16_t)
-            OP_PTR(MN_PTR | MN_BYTE, int8_t)
-            OP_PTR(MN_PTR | MN_UNSIGNED | MN_BYTE, uint8_t)
-
-            case MN_PTR | MN_STRING:
+            OPCASE(PTR, UQWORD)
+            OPCASE(PTR, DOUBLE)
+            OP_PTR(PTR, QWORD, int64_t)
+            OP_PTR(PTR, DWORD, int32_t)
+            OPCASE(PTR, FLOAT)
+            OP_PTR(PTR, UDWORD, uint32_t)
+            OP_PTR(PTR, WORD, int16_t)
+            OP_PTR(PTR, UWORD, uint16_t)
+            OP_PTR(PTR, BYTE, int8_t)
+            OP_PTR(PTR, UBYTE, uint8_t)
+
+            OPCASE(PTR, STRING)
             {
                 uint64_t string_id = *( int64_t * )( intptr_t )r->stack_ptr[-1];
                 r->stack_ptr[-1] = string_id;
@@ -668,16 +781,16 @@ case case_value: \
             /* Maths */
             /*********/
 
-#define OP_EXPRF(case_value, ctype, oper) \
-case case_value: \
+#define OP_EXPRF(op, type, ctype, oper) \
+OPCASE(op, type) \
 { \
     *( ctype * )&r->stack_ptr[-1] = ( ctype ) oper *(( ctype * ) &r->stack_ptr[-1] ); \
     ++pc; \
     break; \
 }
 
-#define OP_EXPRF_WITH_ARG(case_value, ctype, oper) \
-case case_value: \
+#define OP_EXPRF_WITH_ARG(op, type, ctype, oper) \
+OPCASE(op, type) \
 { \
     *( ctype * )&r->stack_ptr[-2] oper##= *(( ctype * ) &r->stack_ptr[-1] ); \
     --r->stack_ptr; \
@@ -685,8 +798,8 @@ case case_value: \
     break; \
 }
 
-#define OP_EXPRF_WITH_ARG_MOD(case_value, ctype) \
-case case_value: \
+#define OP_EXPRF_WITH_ARG_MOD(op, type, ctype) \
+OPCASE(op, type) \
 { \
     *( ctype * )&r->stack_ptr[-2] = fmod( *( ctype * )&r->stack_ptr[-2], *(( ctype * ) &r->stack_ptr[-1] ) ); \
     --r->stack_ptr; \
@@ -694,8 +807,8 @@ case case_value: \
     break; \
 }
 
-#define OP_EXPR(case_value, oper) \
-case case_value: \
+#define OP_EXPR(op, type, oper) \
+OPCASE(op, type) \
 { \
     r->stack_ptr[-1] = oper r->stack_ptr[-1]; \
     ++pc; \
@@ -708,43 +821,46 @@ case case_value: \
     ++pc; \
     break;
 
-#define OP_EXPR_WITH_ARG(case_value, ctype, oper) \
-case case_value: \
+#define OP_EXPR_WITH_ARG(op, type, ctype, oper) \
+OPCASE(op, type) \
 { \
     OP_EXPR_WITH_ARG_BODY(ctype, oper) \
 }
 
-#define OP_EXPR_WITH_ARG_DIVMOD(case_value, ctype, oper) \
-case case_value: \
+#define OP_EXPR_WITH_ARG_DIVMOD(op, type, ctype, oper) \
+OPCASE(op, type) \
 { \
     FATAL_ERROR_DIV_BY_ZERO_CHECK( !r->stack_ptr[-1] ) \
     OP_EXPR_WITH_ARG_BODY(ctype, oper) \
 }
 
-#define OP_EXPR_WITH_ARG_DIV(case_value, ctype) OP_EXPR_WITH_ARG_DIVMOD(case_value, ctype, /)
-#define OP_EXPR_WITH_ARG_MOD(case_value, ctype) OP_EXPR_WITH_ARG_DIVMOD(case_value, ctype, %)
+#define OP_EXPR_WITH_ARG_DIV(op, type, ctype) OP_EXPR_WITH_ARG_DIVMOD(op, type, ctype, /)
+#define OP_EXPR_WITH_ARG_MOD(op, type, ctype) OP_EXPR_WITH_ARG_DIVMOD(op, type, ctype, %)
 
-            case MN_NEG | MN_UNSIGNED | MN_QWORD:
-            OP_EXPR(MN_NEG | MN_QWORD, -)
-            OP_EXPRF(MN_NEG | MN_DOUBLE, double, -)
-            OP_EXPRF(MN_NEG | MN_FLOAT, float, -)
+            OPCASE(NEG, UQWORD)
+            OP_EXPR(NEG, QWORD, -)
+            OP_EXPRF(NEG, DOUBLE, double, -)
+            OP_EXPRF(NEG, FLOAT, float, -)
 
-            case MN_NOT | MN_UNSIGNED | MN_QWORD:
-            OP_EXPR(MN_NOT | MN_QWORD, !)
-            OP_EXPRF(MN_NOT | MN_DOUBLE, double, !)
-            OP_EXPRF(MN_NOT | MN_FLOAT, float, !)
+            OPCASE(NOT, UQWORD)
+            OP_EXPR(NOT, QWORD, !)
+            OP_EXPRF(NOT, DOUBLE, double, !)
+            OP_EXPRF(NOT, FLOAT, float, !)
 
-            OP_EXPR_WITH_ARG(MN_ADD | MN_QWORD, int64_t, +)
-            OP_EXPR_WITH_ARG(MN_ADD | MN_UNSIGNED | MN_QWORD, uint64_t, +)
-            OP_EXPRF_WITH_ARG(MN_ADD | MN_DOUBLE, double, +)
-            OP_EXPRF_WITH_ARG(MN_ADD | MN_FLOAT, float, +)
+            OP_EXPR_WITH_ARG(ADD, QWORD, int64_t, +)
+            OP_EXPR_WITH_ARG(ADD, UQWORD, uint64_t, +)
+            OP_EXPRF_WITH_ARG(ADD, DOUBLE, double, +)
+            OP_EXPRF_WITH_ARG(ADD, FLOAT, float, +)
 
-            case MN_ADD | MN_STRING:
+            OPCASE(ADD, STRING)
             {
                 uint64_t string_id1 = r->stack_ptr[-2], string_id2 = r->stack_ptr[-1];
-                int64_t n = string_add( string_id1, string_id2 );
-                string_use( n );
-                string_discard( string_id1 );
+                /* Temporaries (only used by this stack slot) are appended in place */
+                int64_t n = string_append( string_id1, string_id2 );
+                if ( n != string_id1 ) {
+                    string_use( n );
+                    string_discard( string_id1 );
+                }
                 string_discard( string_id2 );
                 --r->stack_ptr;
                 r->stack_ptr[-1] = n;
@@ -752,104 +868,104 @@ case case_value: \
                 break;
             }
 
-            OP_EXPR_WITH_ARG(MN_SUB | MN_QWORD, int64_t, -)
-            OP_EXPR_WITH_ARG(MN_SUB | MN_UNSIGNED | MN_QWORD, uint64_t, -)
-            OP_EXPRF_WITH_ARG(MN_SUB | MN_DOUBLE, double, -)
-            OP_EXPRF_WITH_ARG(MN_SUB | MN_FLOAT, float, -)
-
-            case MN_MUL | MN_DWORD:
-            case MN_MUL | MN_WORD:
-            case MN_MUL | MN_BYTE:
-            OP_EXPR_WITH_ARG(MN_MUL | MN_QWORD, int64_t, *)
-            case MN_MUL| MN_UNSIGNED | MN_DWORD:
-            case MN_MUL| MN_UNSIGNED | MN_WORD:
-            case MN_MUL| MN_UNSIGNED | MN_BYTE:
-            OP_EXPR_WITH_ARG(MN_MUL | MN_UNSIGNED | MN_QWORD, uint64_t, *)
-            OP_EXPRF_WITH_ARG(MN_MUL | MN_DOUBLE, double, *)
-            OP_EXPRF_WITH_ARG(MN_MUL | MN_FLOAT, float, *)
-
-            case MN_DIV | MN_DWORD:
-            case MN_DIV | MN_WORD:
-            case MN_DIV | MN_BYTE:
-            OP_EXPR_WITH_ARG_DIV(MN_DIV | MN_QWORD, int64_t)
-            case MN_DIV | MN_UNSIGNED | MN_DWORD:
-            case MN_DIV | MN_UNSIGNED | MN_WORD:
-            case MN_DIV | MN_UNSIGNED | MN_BYTE:
-            OP_EXPR_WITH_ARG_DIV(MN_DIV | MN_UNSIGNED | MN_QWORD, uint64_t)
-            OP_EXPRF_WITH_ARG(MN_DIV | MN_DOUBLE, double, /)
-            OP_EXPRF_WITH_ARG(MN_DIV | MN_FLOAT, float, /)
-
-            OP_EXPR_WITH_ARG_MOD(MN_MOD | MN_QWORD, int64_t)
-            OP_EXPR_WITH_ARG_MOD(MN_MOD | MN_UNSIGNED | MN_QWORD, uint64_t)
-            OP_EXPR_WITH_ARG_MOD(MN_MOD | MN_DWORD, int32_t)
-            OP_EXPR_WITH_ARG_MOD(MN_MOD | MN_UNSIGNED | MN_DWORD, uint32_t)
-            OP_EXPR_WITH_ARG_MOD(MN_MOD | MN_WORD, int16_t)
-            OP_EXPR_WITH_ARG_MOD(MN_MOD | MN_UNSIGNED | MN_WORD, uint16_t)
-            OP_EXPR_WITH_ARG_MOD(MN_MOD | MN_BYTE, int8_t)
-            OP_EXPR_WITH_ARG_MOD(MN_MOD | MN_UNSIGNED | MN_BYTE, uint8_t)
-            OP_EXPRF_WITH_ARG_MOD(MN_MOD | MN_DOUBLE, double)
-            OP_EXPRF_WITH_ARG_MOD(MN_MOD | MN_FLOAT, float)
+            OP_EXPR_WITH_ARG(SUB, QWORD, int64_t, -)
+            OP_EXPR_WITH_ARG(SUB, UQWORD, uint64_t, -)
+            OP_EXPRF_WITH_ARG(SUB, DOUBLE, double, -)
+            OP_EXPRF_WITH_ARG(SUB, FLOAT, float, -)
+
+            OPCASE(MUL, DWORD)
+            OPCASE(MUL, WORD)
+            OPCASE(MUL, BYTE)
+            OP_EXPR_WITH_ARG(MUL, QWORD, int64_t, *)
+            OPCASE(MUL, UDWORD)
+            OPCASE(MUL, UWORD)
+            OPCASE(MUL, UBYTE)
+            OP_EXPR_WITH_ARG(MUL, UQWORD, uint64_t, *)
+            OP_EXPRF_WITH_ARG(MUL, DOUBLE, double, *)
+            OP_EXPRF_WITH_ARG(MUL, FLOAT, float, *)
+
+            OPCASE(DIV, DWORD)
+            OPCASE(DIV, WORD)
+            OPCASE(DIV, BYTE)
+            OP_EXPR_WITH_ARG_DIV(DIV, QWORD, int64_t)
+            OPCASE(DIV, UDWORD)
+            OPCASE(DIV, UWORD)
+            OPCASE(DIV, UBYTE)
+            OP_EXPR_WITH_ARG_DIV(DIV, UQWORD, uint64_t)
+            OP_EXPRF_WITH_ARG(DIV, DOUBLE, double, /)
+            OP_EXPRF_WITH_ARG(DIV, FLOAT, float, /)
+
+            OP_EXPR_WITH_ARG_MOD(MOD, QWORD, int64_t)
+            OP_EXPR_WITH_ARG_MOD(MOD, UQWORD, uint64_t)
+            OP_EXPR_WITH_ARG_MOD(MOD, DWORD, int32_t)
+            OP_EXPR_WITH_ARG_MOD(MOD, UDWORD, uint32_t)
+            OP_EXPR_WITH_ARG_MOD(MOD, WORD, int16_t)
+            OP_EXPR_WITH_ARG_MOD(MOD, UWORD, uint16_t)
+            OP_EXPR_WITH_ARG_MOD(MOD, BYTE, int8_t)
+            OP_EXPR_WITH_ARG_MOD(MOD, UBYTE, uint8_t)
+            OP_EXPRF_WITH_ARG_MOD(MOD, DOUBLE, double)
+            OP_EXPRF_WITH_ARG_MOD(MOD, FLOAT, float)
 
             /* Bitwise operations */
 
-            OP_EXPR_WITH_ARG(MN_ROR | MN_QWORD, int64_t, >>)
-            OP_EXPR_WITH_ARG(MN_ROR | MN_UNSIGNED | MN_QWORD, uint64_t, >>)
-            OP_EXPR_WITH_ARG(MN_ROR | MN_DWORD, int32_t, >>)
-            OP_EXPR_WITH_ARG(MN_ROR | MN_UNSIGNED | MN_DWORD, uint32_t, >>)
-            OP_EXPR_WITH_ARG(MN_ROR | MN_WORD, int16_t, >>)
-            OP_EXPR_WITH_ARG(MN_ROR | MN_UNSIGNED | MN_WORD, uint16_t, >>)
-            OP_EXPR_WITH_ARG(MN_ROR | MN_BYTE, int8_t, >>)
-            OP_EXPR_WITH_ARG(MN_ROR | MN_UNSIGNED | MN_BYTE, uint8_t, >>)
-
-            OP_EXPR_WITH_ARG(MN_ROL | MN_QWORD, int64_t, <<)
-            OP_EXPR_WITH_ARG(MN_ROL | MN_UNSIGNED | MN_QWORD, uint64_t, <<)
-            OP_EXPR_WITH_ARG(MN_ROL | MN_DWORD, int32_t, <<)
-            OP_EXPR_WITH_ARG(MN_ROL | MN_UNSIGNED | MN_DWORD, uint32_t, <<)
-            OP_EXPR_WITH_ARG(MN_ROL | MN_WORD, int16_t, <<)
-            OP_EXPR_WITH_ARG(MN_ROL | MN_UNSIGNED | MN_WORD, uint16_t, <<)
-            OP_EXPR_WITH_ARG(MN_ROL | MN_BYTE, int8_t, <<)
-            OP_EXPR_WITH_ARG(MN_ROL | MN_UNSIGNED | MN_BYTE, uint8_t, <<)
-
-            OP_EXPR_WITH_ARG(MN_BAND | MN_QWORD, int64_t, &)
-            OP_EXPR_WITH_ARG(MN_BAND | MN_UNSIGNED | MN_QWORD, uint64_t, &)
-            OP_EXPR_WITH_ARG(MN_BAND | MN_DWORD, int32_t, &)
-            OP_EXPR_WITH_ARG(MN_BAND | MN_UNSIGNED | MN_DWORD, uint32_t, &)
-            OP_EXPR_WITH_ARG(MN_BAND | MN_WORD, int16_t, &)
-            OP_EXPR_WITH_ARG(MN_BAND | MN_UNSIGNED | MN_WORD, uint16_t, &)
-            OP_EXPR_WITH_ARG(MN_BAND | MN_BYTE, int8_t, &)
-            OP_EXPR_WITH_ARG(MN_BAND | MN_UNSIGNED | MN_BYTE, uint8_t, &)
-
-            OP_EXPR_WITH_ARG(MN_BOR | MN_QWORD, int64_t, |)
-            OP_EXPR_WITH_ARG(MN_BOR | MN_UNSIGNED | MN_QWORD, uint64_t, |)
-            OP_EXPR_WITH_ARG(MN_BOR | MN_DWORD, int32_t, |)
-            OP_EXPR_WITH_ARG(MN_BOR | MN_UNSIGNED | MN_DWORD, uint32_t, |)
-            OP_EXPR_WITH_ARG(MN_BOR | MN_WORD, int16_t, |)
-            OP_EXPR_WITH_ARG(MN_BOR | MN_UNSIGNED | MN_WORD, uint16_t, |)
-            OP_EXPR_WITH_ARG(MN_BOR | MN_BYTE, int8_t, |)
-            OP_EXPR_WITH_ARG(MN_BOR | MN_UNSIGNED | MN_BYTE, uint8_t, |)
-
-            OP_EXPR_WITH_ARG(MN_BXOR | MN_QWORD, int64_t, ^)
-            OP_EXPR_WITH_ARG(MN_BXOR | MN_UNSIGNED | MN_QWORD, uint64_t, ^)
-            OP_EXPR_WITH_ARG(MN_BXOR | MN_DWORD, int32_t, ^)
-            OP_EXPR_WITH_ARG(MN_BXOR | MN_UNSIGNED | MN_DWORD, uint32_t, ^)
-            OP_EXPR_WITH_ARG(MN_BXOR | MN_WORD, int16_t, ^)
-            OP_EXPR_WITH_ARG(MN_BXOR | MN_UNSIGNED | MN_WORD, uint16_t, ^)
-            OP_EXPR_WITH_ARG(MN_BXOR | MN_BYTE, int8_t, ^)
-            OP_EXPR_WITH_ARG(MN_BXOR | MN_UNSIGNED | MN_BYTE, uint8_t, ^)
-
-            OP_EXPR(MN_BNOT | MN_QWORD, ( int64_t ) ~)
-            OP_EXPR(MN_BNOT | MN_UNSIGNED | MN_QWORD, ( uint64_t ) ~)
-            OP_EXPR(MN_BNOT | MN_DWORD, ( int32_t ) ~)
-            OP_EXPR(MN_BNOT | MN_UNSIGNED | MN_DWORD, ( uint32_t ) ~)
-            OP_EXPR(MN_BNOT | MN_WORD, ( int16_t ) ~)
-            OP_EXPR(MN_BNOT | MN_UNSIGNED | MN_WORD, ( uint16_t ) ~)
-            OP_EXPR(MN_BNOT | MN_BYTE, ( int8_t ) ~)
-            OP_EXPR(MN_BNOT | MN_UNSIGNED | MN_BYTE, ( uint8_t ) ~)
+            OP_EXPR_WITH_ARG(ROR, QWORD, int64_t, >>)
+            OP_EXPR_WITH_ARG(ROR, UQWORD, uint64_t, >>)
+            OP_EXPR_WITH_ARG(ROR, DWORD, int32_t, >>)
+            OP_EXPR_WITH_ARG(ROR, UDWORD, uint32_t, >>)
+            OP_EXPR_WITH_ARG(ROR, WORD, int16_t, >>)
+            OP_EXPR_WITH_ARG(ROR, UWORD, uint16_t, >>)
+            OP_EXPR_WITH_ARG(ROR, BYTE, int8_t, >>)
+            OP_EXPR_WITH_ARG(ROR, UBYTE, uint8_t, >>)
+
+            OP_EXPR_WITH_ARG(ROL, QWORD, int64_t, <<)
+            OP_EXPR_WITH_ARG(ROL, UQWORD, uint64_t, <<)
+            OP_EXPR_WITH_ARG(ROL, DWORD, int32_t, <<)
+            OP_EXPR_WITH_ARG(ROL, UDWORD, uint32_t, <<)
+            OP_EXPR_WITH_ARG(ROL, WORD, int16_t, <<)
+            OP_EXPR_WITH_ARG(ROL, UWORD, uint16_t, <<)
+            OP_EXPR_WITH_ARG(ROL, BYTE, int8_t, <<)
+            OP_EXPR_WITH_ARG(ROL, UBYTE, uint8_t, <<)
+
+            OP_EXPR_WITH_ARG(BAND, QWORD, int64_t, &)
+            OP_EXPR_WITH_ARG(BAND, UQWORD, uint64_t, &)
+            OP_EXPR_WITH_ARG(BAND, DWORD, int32_t, &)
+            OP_EXPR_WITH_ARG(BAND, UDWORD, uint32_t, &)
+            OP_EXPR_WITH_ARG(BAND, WORD, int16_t, &)
+            OP_EXPR_WITH_ARG(BAND, UWORD, uint16_t, &)
+            OP_EXPR_WITH_ARG(BAND, BYTE, int8_t, &)
+            OP_EXPR_WITH_ARG(BAND, UBYTE, uint8_t, &)
+
+            OP_EXPR_WITH_ARG(BOR, QWORD, int64_t, |)
+            OP_EXPR_WITH_ARG(BOR, UQWORD, uint64_t, |)
+            OP_EXPR_WITH_ARG(BOR, DWORD, int32_t, |)
+            OP_EXPR_WITH_ARG(BOR, UDWORD, uint32_t, |)
+            OP_EXPR_WITH_ARG(BOR, WORD, int16_t, |)
+            OP_EXPR_WITH_ARG(BOR, UWORD, uint16_t, |)
+            OP_EXPR_WITH_ARG(BOR, BYTE, int8_t, |)
+            OP_EXPR_WITH_ARG(BOR, UBYTE, uint8_t, |)
+
+            OP_EXPR_WITH_ARG(BXOR, QWORD, int64_t, ^)
+            OP_EXPR_WITH_ARG(BXOR, UQWORD, uint64_t, ^)
+            OP_EXPR_WITH_ARG(BXOR, DWORD, int32_t, ^)
+            OP_EXPR_WITH_ARG(BXOR, UDWORD, uint32_t, ^)
+            OP_EXPR_WITH_ARG(BXOR, WORD, int16_t, ^)
+            OP_EXPR_WITH_ARG(BXOR, UWORD, uint16_t, ^)
+            OP_EXPR_WITH_ARG(BXOR, BYTE, int8_t, ^)
+            OP_EXPR_WITH_ARG(BXOR, UBYTE, uint8_t, ^)
+
+            OP_EXPR(BNOT, QWORD, ( int64_t ) ~)
+            OP_EXPR(BNOT, UQWORD, ( uint64_t ) ~)
+            OP_EXPR(BNOT, DWORD, ( int32_t ) ~)
+            OP_EXPR(BNOT, UDWORD, ( uint32_t ) ~)
+            OP_EXPR(BNOT, WORD, ( int16_t ) ~)
+            OP_EXPR(BNOT, UWORD, ( uint16_t ) ~)
+            OP_EXPR(BNOT, BYTE, ( int8_t ) ~)
+            OP_EXPR(BNOT, UBYTE, ( uint8_t ) ~)
 
             /* Logical operations */
 
-#define OP_EXPR_WITH_ARG_NON_ASSIGN_OPERATOR(case_value, ctype, oper) \
-case case_value: \
+#define OP_EXPR_WITH_ARG_NON_ASSIGN_OPERATOR(op, type, ctype, oper) \
+OPCASE(op, type) \
 { \
     r->stack_ptr[-2] = ( ctype ) r->stack_ptr[-2] oper ( ctype ) r->stack_ptr[-1]; \
     --r->stack_ptr; \
@@ -857,10 +973,10 @@ case case_value: \
     break; \
 }
 
-            OP_EXPR_WITH_ARG_NON_ASSIGN_OPERATOR(MN_AND, int64_t, &&)
-            OP_EXPR_WITH_ARG_NON_ASSIGN_OPERATOR(MN_OR, int64_t, ||)
+            OP_EXPR_WITH_ARG_NON_ASSIGN_OPERATOR(AND, NONE, int64_t, &&)
+            OP_EXPR_WITH_ARG_NON_ASSIGN_OPERATOR(OR, NONE, int64_t, ||)
 
-            case MN_XOR:
+            OPCASE(XOR, NONE)
             {
                 r->stack_ptr[-2] = ( r->stack_ptr[-2] != 0 ) ^ ( r->stack_ptr[-1] != 0 );
                 --r->stack_ptr;
@@ -870,54 +986,54 @@ case case_value: \
 
             /* Comparisons */
 
-#define OP_CMP(case_value, ctype, oper) OP_EXPR_WITH_ARG_NON_ASSIGN_OPERATOR(case_value, ctype, oper)
-
-            OP_CMP(MN_EQ | MN_QWORD, int64_t, ==)
-            OP_CMP(MN_NE | MN_QWORD, int64_t, !=)
-            OP_CMP(MN_GTE | MN_QWORD, int64_t, >=)
-            OP_CMP(MN_GTE | MN_UNSIGNED | MN_QWORD, uint64_t, >=)
-            OP_CMP(MN_LTE | MN_QWORD, int64_t, <=)
-            OP_CMP(MN_LTE | MN_UNSIGNED | MN_QWORD, uint64_t, <=)
-            OP_CMP(MN_GT | MN_QWORD, int64_t, >)
-            OP_CMP(MN_GT | MN_UNSIGNED | MN_QWORD, uint64_t, >)
-            OP_CMP(MN_LT | MN_QWORD, int64_t, <)
-            OP_CMP(MN_LT | MN_UNSIGNED | MN_QWORD, uint64_t, <)
-
-            OP_CMP(MN_EQ | MN_DWORD, int32_t, ==)
-            OP_CMP(MN_NE | MN_DWORD, int32_t, !=)
-            OP_CMP(MN_GTE | MN_DWORD, int32_t, >=)
-            OP_CMP(MN_GTE | MN_UNSIGNED | MN_DWORD, uint32_t, >=)
-            OP_CMP(MN_LTE | MN_DWORD, int32_t, <=)
-            OP_CMP(MN_LTE | MN_UNSIGNED | MN_DWORD, uint32_t, <=)
-            OP_CMP(MN_GT | MN_DWORD, int32_t, >)
-            OP_CMP(MN_GT | MN_UNSIGNED | MN_DWORD, uint32_t, >)
-            OP_CMP(MN_LT | MN_DWORD, int32_t, <)
-            OP_CMP(MN_LT | MN_UNSIGNED | MN_DWORD, uint32_t, <)
-
-            OP_CMP(MN_EQ | MN_WORD, int16_t, ==)
-            OP_CMP(MN_NE | MN_WORD, int16_t, !=)
-            OP_CMP(MN_GTE | MN_WORD, int16_t, >=)
-            OP_CMP(MN_GTE | MN_UNSIGNED | MN_WORD, uint16_t, >=)
-            OP_CMP(MN_LTE | MN_WORD, int16_t, <=)
-            OP_CMP(MN_LTE | MN_UNSIGNED | MN_WORD, uint16_t, <=)
-            OP_CMP(MN_GT | MN_WORD, int16_t, >)
-            OP_CMP(MN_GT | MN_UNSIGNED | MN_WORD, uint16_t, >)
-            OP_CMP(MN_LT | MN_WORD, int16_t, <)
-            OP_CMP(MN_LT | MN_UNSIGNED | MN_WORD, uint16_t, <)
-
-            OP_CMP(MN_EQ | MN_BYTE, int8_t, ==)
-            OP_CMP(MN_NE | MN_BYTE, int8_t, !=)
-            OP_CMP(MN_GTE | MN_BYTE, int8_t, >=)
-            OP_CMP(MN_GTE | MN_UNSIGNED | MN_BYTE, uint8_t, >=)
-            OP_CMP(MN_LTE | MN_BYTE, int8_t, <=)
-            OP_CMP(MN_LTE | MN_UNSIGNED | MN_BYTE, uint8_t, <=)
-            OP_CMP(MN_GT | MN_BYTE, int8_t, >)
-            OP_CMP(MN_GT | MN_UNSIGNED | MN_BYTE, uint8_t, >)
-            OP_CMP(MN_LT | MN_BYTE, int8_t, <)
-            OP_CMP(MN_LT | MN_UNSIGNED | MN_BYTE, uint8_t, <)
-
-#define OP_CMPF(case_value, ctype, oper) \
-case case_value: \
+#define OP_CMP(op, type, ctype, oper) OP_EXPR_WITH_ARG_NON_ASSIGN_OPERATOR(op, type, ctype, oper)
+
+            OP_CMP(EQ, QWORD, int64_t, ==)
+            OP_CMP(NE, QWORD, int64_t, !=)
+            OP_CMP(GTE, QWORD, int64_t, >=)
+            OP_CMP(GTE, UQWORD, uint64_t, >=)
+            OP_CMP(LTE, QWORD, int64_t, <=)
+            OP_CMP(LTE, UQWORD, uint64_t, <=)
+            OP_CMP(GT, QWORD, int64_t, >)
+            OP_CMP(GT, UQWORD, uint64_t, >)
+            OP_CMP(LT, QWORD, int64_t, <)
+            OP_CMP(LT, UQWORD, uint64_t, <)
+
+            OP_CMP(EQ, DWORD, int32_t, ==)
+            OP_CMP(NE, DWORD, int32_t, !=)
+            OP_CMP(GTE, DWORD, int32_t, >=)
+            OP_CMP(GTE, UDWORD, uint32_t, >=)
+            OP_CMP(LTE, DWORD, int32_t, <=)
+            OP_CMP(LTE, UDWORD, uint32_t, <=)
+            OP_CMP(GT, DWORD, int32_t, >)
+            OP_CMP(GT, UDWORD, uint32_t, >)
+            OP_CMP(LT, DWORD, int32_t, <)
+            OP_CMP(LT, UDWORD, uint32_t, <)
+
+            OP_CMP(EQ, WORD, int16_t, ==)
+            OP_CMP(NE, WORD, int16_t, !=)
+            OP_CMP(GTE, WORD, int16_t, >=)
+            OP_CMP(GTE, UWORD, uint16_t, >=)
+            OP_CMP(LTE, WORD, int16_t, <=)
+            OP_CMP(LTE, UWORD, uint16_t, <=)
+            OP_CMP(GT, WORD, int16_t, >)
+            OP_CMP(GT, UWORD, uint16_t, >)
+            OP_CMP(LT, WORD, int16_t, <)
+            OP_CMP(LT, UWORD, uint16_t, <)
+
+            OP_CMP(EQ, BYTE, int8_t, ==)
+            OP_CMP(NE, BYTE, int8_t, !=)
+            OP_CMP(GTE, BYTE, int8_t, >=)
+            OP_CMP(GTE, UBYTE, uint8_t, >=)
+            OP_CMP(LTE, BYTE, int8_t, <=)
+            OP_CMP(LTE, UBYTE, uint8_t, <=)
+            OP_CMP(GT, BYTE, int8_t, >)
+            OP_CMP(GT, UBYTE, uint8_t, >)
+            OP_CMP(LT, BYTE, int8_t, <)
+            OP_CMP(LT, UBYTE, uint8_t, <)
+
+#define OP_CMPF(op, type, ctype, oper) \
+OPCASE(op, type) \
 { \
     r->stack_ptr[-2] = *(( ctype * ) &r->stack_ptr[-2] ) oper *(( ctype * ) &r->stack_ptr[-1] ); \
     --r->stack_ptr; \
@@ -927,26 +1043,26 @@ case case_value: \
 
             /* Floating point comparisons (double) */
 
-            OP_CMPF(MN_EQ | MN_DOUBLE, double, ==)
-            OP_CMPF(MN_NE | MN_DOUBLE, double, !=)
-            OP_CMPF(MN_GTE | MN_DOUBLE, double, >=)
-            OP_CMPF(MN_LTE | MN_DOUBLE, double, <=)
-            OP_CMPF(MN_GT | MN_DOUBLE, double, >)
-            OP_CMPF(MN_LT | MN_DOUBLE, double, <)
+            OP_CMPF(EQ, DOUBLE, double, ==)
+            OP_CMPF(NE, DOUBLE, double, !=)
+            OP_CMPF(GTE, DOUBLE, double, >=)
+            OP_CMPF(LTE, DOUBLE, double, <=)
+            OP_CMPF(GT, DOUBLE, double, >)
+            OP_CMPF(LT, DOUBLE, double, <)
 
             /* Floating point comparisons (float) */
 
-            OP_CMPF(MN_EQ | MN_FLOAT, float, ==)
-            OP_CMPF(MN_NE | MN_FLOAT, float, !=)
-            OP_CMPF(MN_GTE | MN_FLOAT, float, >=)
-            OP_CMPF(MN_LTE | MN_FLOAT, float, <=)
-            OP_CMPF(MN_GT | MN_FLOAT, float, >)
-            OP_CMPF(MN_LT | MN_FLOAT, float, <)
+            OP_CMPF(EQ, FLOAT, float, ==)
+            OP_CMPF(NE, FLOAT, float, !=)
+            OP_CMPF(GTE, FLOAT, float, >=)
+            OP_CMPF(LTE, FLOAT, float, <=)
+            OP_CMPF(GT, FLOAT, float, >)
+            OP_CMPF(LT, FLOAT, float, <)
 
             /* String comparisons */
 
-#define OP_CMPS(case_value, oper) \
-case case_value: \
+#define OP_CMPS(op, type, oper) \
+OPCASE(op, type) \
 { \
     uint64_t string_id1 = r->stack_ptr[-2], string_id2 = r->stack_ptr[-1]; \
     int64_t n = string_comp( string_id1, string_id2 ) oper 0; \
@@ -958,95 +1074,108 @@ case case_value: \
     break; \
 }
 
-            OP_CMPS(MN_EQ | MN_STRING, ==)
-            OP_CMPS(MN_NE | MN_STRING, !=)
-            OP_CMPS(MN_GTE | MN_STRING, >=)
-            OP_CMPS(MN_LTE | MN_STRING, <=)
-            OP_CMPS(MN_GT | MN_STRING, >)
-            OP_CMPS(MN_LT | MN_STRING, <)
+#define OP_EQS(op, type, oper) \
+OPCASE(op, type) \
+{ \
+    uint64_t string_id1 = r->stack_ptr[-2], string_id2 = r->stack_ptr[-1]; \
+    int64_t n = oper string_equal( string_id1, string_id2 ); \
+    string_discard( string_id1 ); \
+    string_discard( string_id2 ); \
+    r->stack_ptr[-2] = n; \
+    --r->stack_ptr; \
+    ++pc; \
+    break; \
+}
+
+            OP_EQS(EQ, STRING, !!)
+            OP_EQS(NE, STRING, !)
+            OP_CMPS(GTE, STRING, >=)
+            OP_CMPS(LTE, STRING, <=)
+            OP_CMPS(GT, STRING, >)
+            OP_CMPS(LT, STRING, <)
 
             /* Convert */
 
-#define OP_CVTF2I(case_value, ctype_from, ctype_to) \
-case case_value: \
+#define OP_CVTF2I(op, type, ctype_from, ctype_to) \
+OPCASE(op, type) \
 { \
     r->stack_ptr[-pc[1] - 1] = ( ctype_to ) * ( ctype_from * ) &( r->stack_ptr[-pc[1] - 1] ); \
     pc += 2; \
     break; \
 }
 
-            OP_CVTF2I(MN_DOUBLE2INT | MN_QWORD, double, int64_t)
-            OP_CVTF2I(MN_DOUBLE2INT | MN_UNSIGNED | MN_QWORD, double, uint64_t)
-            OP_CVTF2I(MN_DOUBLE2INT | MN_DWORD, double, int32_t)
-            OP_CVTF2I(MN_DOUBLE2INT | MN_UNSIGNED | MN_DWORD, double, uint32_t)
-            OP_CVTF2I(MN_DOUBLE2INT | MN_WORD, double, int16_t)
-            OP_CVTF2I(MN_DOUBLE2INT | MN_UNSIGNED | MN_WORD, double, uint16_t)
-            OP_CVTF2I(MN_DOUBLE2INT | MN_BYTE, double, int8_t)
-            OP_CVTF2I(MN_DOUBLE2INT | MN_UNSIGNED | MN_BYTE, double, uint8_t)
-
-            OP_CVTF2I(MN_FLOAT2INT | MN_QWORD, float, int64_t)
-            OP_CVTF2I(MN_FLOAT2INT | MN_UNSIGNED | MN_QWORD, float, uint64_t)
-            OP_CVTF2I(MN_FLOAT2INT | MN_DWORD, float, int32_t)
-            OP_CVTF2I(MN_FLOAT2INT | MN_UNSIGNED | MN_DWORD, float, uint32_t)
-            OP_CVTF2I(MN_FLOAT2INT | MN_WORD, float, int16_t)
-            OP_CVTF2I(MN_FLOAT2INT | MN_UNSIGNED | MN_WORD, float, uint16_t)
-            OP_CVTF2I(MN_FLOAT2INT | MN_BYTE, float, int8_t)
-            OP_CVTF2I(MN_FLOAT2INT | MN_UNSIGNED | MN_BYTE, float, uint8_t)
-
-#define OP_CVTI2F(case_value, ctype_from, ctype_to) \
-case case_value: \
+            OP_CVTF2I(DOUBLE2INT, QWORD, double, int64_t)
+            OP_CVTF2I(DOUBLE2INT, UQWORD, double, uint64_t)
+            OP_CVTF2I(DOUBLE2INT, DWORD, double, int32_t)
+            OP_CVTF2I(DOUBLE2INT, UDWORD, double, uint32_t)
+            OP_CVTF2I(DOUBLE2INT, WORD, double, int16_t)
+            OP_CVTF2I(DOUBLE2INT, UWORD, double, uint16_t)
+            OP_CVTF2I(DOUBLE2INT, BYTE, double, int8_t)
+            OP_CVTF2I(DOUBLE2INT, UBYTE, double, uint8_t)
+
+            OP_CVTF2I(FLOAT2INT, QWORD, float, int64_t)
+            OP_CVTF2I(FLOAT2INT, UQWORD, float, uint64_t)
+            OP_CVTF2I(FLOAT2INT, DWORD, float, int32_t)
+            OP_CVTF2I(FLOAT2INT, UDWORD, float, uint32_t)
+            OP_CVTF2I(FLOAT2INT, WORD, float, int16_t)
+            OP_CVTF2I(FLOAT2INT, UWORD, float, uint16_t)
+            OP_CVTF2I(FLOAT2INT, BYTE, float, int8_t)
+            OP_CVTF2I(FLOAT2INT, UBYTE, float, uint8_t)
+
+#define OP_CVTI2F(op, type, ctype_from, ctype_to) \
+OPCASE(op, type) \
 { \
     *( ctype_to* ) &(r->stack_ptr[-pc[1] - 1]) = ( ctype_to ) ( ctype_from ) r->stack_ptr[-pc[1] - 1]; \
     pc += 2; \
     break; \
 }
 
-            OP_CVTI2F(MN_INT2DOUBLE | MN_QWORD, int64_t, double)
-            OP_CVTI2F(MN_INT2DOUBLE | MN_UNSIGNED | MN_QWORD, uint64_t, double)
-            OP_CVTI2F(MN_INT2DOUBLE | MN_DWORD, int32_t, double)
-            OP_CVTI2F(MN_INT2DOUBLE | MN_UNSIGNED | MN_DWORD, uint32_t, double)
-            OP_CVTI2F(MN_INT2DOUBLE | MN_WORD, int16_t, double)
-            OP_CVTI2F(MN_INT2DOUBLE | MN_UNSIGNED | MN_WORD, uint16_t, double)
-            OP_CVTI2F(MN_INT2DOUBLE | MN_BYTE, int8_t, double)
-            OP_CVTI2F(MN_INT2DOUBLE | MN_UNSIGNED | MN_BYTE, uint8_t, double)
-
-            OP_CVTI2F(MN_INT2FLOAT | MN_QWORD, int64_t, float)
-            OP_CVTI2F(MN_INT2FLOAT | MN_UNSIGNED | MN_QWORD, uint64_t, float)
-            OP_CVTI2F(MN_INT2FLOAT | MN_DWORD, int32_t, float)
-            OP_CVTI2F(MN_INT2FLOAT | MN_UNSIGNED | MN_DWORD, uint32_t, float)
-            OP_CVTI2F(MN_INT2FLOAT | MN_WORD, int16_t, float)
-            OP_CVTI2F(MN_INT2FLOAT | MN_UNSIGNED | MN_WORD, uint16_t, float)
-            OP_CVTI2F(MN_INT2FLOAT | MN_BYTE, int8_t, float)
-            OP_CVTI2F(MN_INT2FLOAT | MN_UNSIGNED | MN_BYTE, uint8_t, float)
-
-#define OP_CVTI2I(case_value, ctype_from) \
-case case_value: \
+            OP_CVTI2F(INT2DOUBLE, QWORD, int64_t, double)
+            OP_CVTI2F(INT2DOUBLE, UQWORD, uint64_t, double)
+            OP_CVTI2F(INT2DOUBLE, DWORD, int32_t, double)
+            OP_CVTI2F(INT2DOUBLE, UDWORD, uint32_t, double)
+            OP_CVTI2F(INT2DOUBLE, WORD, int16_t, double)
+            OP_CVTI2F(INT2DOUBLE, UWORD, uint16_t, double)
+            OP_CVTI2F(INT2DOUBLE, BYTE, int8_t, double)
+            OP_CVTI2F(INT2DOUBLE, UBYTE, uint8_t, double)
+
+            OP_CVTI2F(INT2FLOAT, QWORD, int64_t, float)
+            OP_CVTI2F(INT2FLOAT, UQWORD, uint64_t, float)
+            OP_CVTI2F(INT2FLOAT, DWORD, int32_t, float)
+            OP_CVTI2F(INT2FLOAT, UDWORD, uint32_t, float)
+            OP_CVTI2F(INT2FLOAT, WORD, int16_t, float)
+            OP_CVTI2F(INT2FLOAT, UWORD, uint16_t, float)
+            OP_CVTI2F(INT2FLOAT, BYTE, int8_t, float)
+            OP_CVTI2F(INT2FLOAT, UBYTE, uint8_t, float)
+
+#define OP_CVTI2I(op, type, ctype_from) \
+OPCASE(op, type) \
 { \
     r->stack_ptr[-pc[1] - 1] = ( ctype_from ) r->stack_ptr[-pc[1] - 1]; \
     pc += 2; \
     break; \
 }
 
-            OP_CVTI2I(MN_INT2DWORD, int32_t)
-            OP_CVTI2I(MN_INT2DWORD | MN_UNSIGNED, uint32_t)
-            OP_CVTI2I(MN_INT2WORD, int16_t)
-            OP_CVTI2I(MN_INT2WORD | MN_UNSIGNED, uint16_t)
-            OP_CVTI2I(MN_INT2BYTE, int8_t)
-            OP_CVTI2I(MN_INT2BYTE | MN_UNSIGNED, uint8_t)
+            OP_CVTI2I(INT2DWORD, NONE, int32_t)
+            OP_CVTI2I(INT2DWORD, UNSIGNED, uint32_t)
+            OP_CVTI2I(INT2WORD, NONE, int16_t)
+            OP_CVTI2I(INT2WORD, UNSIGNED, uint16_t)
+            OP_CVTI2I(INT2BYTE, NONE, int8_t)
+            OP_CVTI2I(INT2BYTE, UNSIGNED, uint8_t)
 
-#define OP_CVTF2F(case_value, ctype_from, ctype_to) \
-case case_value: \
+#define OP_CVTF2F(op, type, ctype_from, ctype_to) \
+OPCASE(op, type) \
 { \
     *( ctype_to * )&( r->stack_ptr[-pc[1] - 1] ) = ( ctype_to ) * ( ctype_from * ) &( r->stack_ptr[-pc[1] - 1] ); \
     pc += 2; \
     break; \
 }
 
-            OP_CVTF2F(MN_DOUBLE2FLOAT, double, float)
-            OP_CVTF2F(MN_FLOAT2DOUBLE, float, double)
+            OP_CVTF2F(DOUBLE2FLOAT, NONE, double, float)
+            OP_CVTF2F(FLOAT2DOUBLE, NONE, float, double)
 
-#define OP_INT2STR(case_value, ntos_func, ctype) \
-case case_value: \
+#define OP_INT2STR(op, type, ntos_func, ctype) \
+OPCASE(op, type) \
 { \
     uint64_t* string_id1_ptr = &r->stack_ptr[-pc[1] - 1]; \
     uint64_t value = ntos_func( ( ctype ) *string_id1_ptr ); \
@@ -1056,17 +1185,17 @@ case case_value: \
     break; \
 }
 
-            OP_INT2STR(MN_INT2STR | MN_QWORD, string_itoa, int64_t)
-            OP_INT2STR(MN_INT2STR | MN_UNSIGNED | MN_QWORD, string_uitoa, uint64_t)
-            OP_INT2STR(MN_INT2STR | MN_DWORD, string_itoa, int32_t)
-            OP_INT2STR(MN_INT2STR | MN_UNSIGNED | MN_DWORD, string_uitoa, uint32_t)
-            OP_INT2STR(MN_INT2STR | MN_WORD, string_itoa, int16_t)
-            OP_INT2STR(MN_INT2STR | MN_UNSIGNED | MN_WORD, string_uitoa, uint16_t)
-            OP_INT2STR(MN_INT2STR | MN_BYTE, string_itoa, int8_t)
-            OP_INT2STR(MN_INT2STR | MN_UNSIGNED | MN_BYTE, string_uitoa, uint8_t)
-
-#define OP_CVTF2S(case_value, ctype_from) \
-case case_value: \
+            OP_INT2STR(INT2STR, QWORD, string_itoa, int64_t)
+            OP_INT2STR(INT2STR, UQWORD, string_uitoa, uint64_t)
+            OP_INT2STR(INT2STR, DWORD, string_itoa, int32_t)
+            OP_INT2STR(INT2STR, UDWORD, string_uitoa, uint32_t)
+            OP_INT2STR(INT2STR, WORD, string_itoa, int16_t)
+            OP_INT2STR(INT2STR, UWORD, string_uitoa, uint16_t)
+            OP_INT2STR(INT2STR, BYTE, string_itoa, int8_t)
+            OP_INT2STR(INT2STR, UBYTE, string_uitoa, uint8_t)
+
+#define OP_CVTF2S(op, type, ctype_from) \
+OPCASE(op, type) \
 { \
     uint64_t* string_id1_ptr = &r->stack_ptr[-pc[1] - 1]; \
     uint64_t value = string_ftoa( *( ctype_from * ) string_id1_ptr ); \
@@ -1076,10 +1205,10 @@ case case_value: \
     break; \
 }
 
-            OP_CVTF2S(MN_FLOAT2STR, float)
-            OP_CVTF2S(MN_DOUBLE2STR, double)
+            OP_CVTF2S(FLOAT2STR, NONE, float)
+            OP_CVTF2S(DOUBLE2STR, NONE, double)
 
-            case MN_CHR2STR:
+            OPCASE(CHR2STR, NONE)
             {
                 char buffer[2];
                 buffer[0] = ( uint8_t )r->stack_ptr[-pc[1] - 1];
@@ -1090,7 +1219,7 @@ case case_value: \
                 break;
             }
 
-            case MN_STRI2CHR:
+            OPCASE(STRI2CHR, NONE)
             {
                 uint64_t* string_id_ptr = &r->stack_ptr[-2];
                 uint64_t string_old = *string_id_ptr;
@@ -1101,7 +1230,7 @@ case case_value: \
                 break;
             }
 
-            case MN_STR2CHR:
+            OPCASE(STR2CHR, NONE)
             {
                 int64_t string_id = r->stack_ptr[-pc[1] - 1];
                 r->stack_ptr[-1] = *string_get( string_id );
@@ -1110,7 +1239,7 @@ case case_value: \
                 break;
             }
 
-            case MN_STR2POINTER:
+            OPCASE(STR2POINTER, NONE)
             {
                 uint64_t* string_id_ptr = &r->stack_ptr[-pc[1] - 1];
                 int64_t string_id = *string_id_ptr;
@@ -1120,7 +1249,7 @@ case case_value: \
                 break;
             }
 
-            case MN_POINTER2STR:
+            OPCASE(POINTER2STR, NONE)
             {
                 uint64_t* string_id_ptr = &r->stack_ptr[-pc[1] - 1];
                 uint64_t string_id = string_ptoa( ( void * )( intptr_t )( *string_id_ptr ) );
@@ -1131,8 +1260,8 @@ case case_value: \
             }
 
 
-#define OP_CVTS2F(case_value, ctype_to) \
-case case_value: \
+#define OP_CVTS2F(op, type, ctype_to) \
+OPCASE(op, type) \
 { \
     uint64_t* string_id_ptr = &r->stack_ptr[-pc[1] - 1]; \
     uint64_t string_id = *string_id_ptr; \
@@ -1143,10 +1272,10 @@ case case_value: \
     break; \
 }
 
-            OP_CVTS2F(MN_STR2DOUBLE, double)
-            OP_CVTS2F(MN_STR2FLOAT, float)
+            OP_CVTS2F(STR2DOUBLE, NONE, double)
+            OP_CVTS2F(STR2FLOAT, NONE, float)
 
-            case MN_STR2INT:
+            OPCASE(STR2INT, NONE)
             {
                 uint64_t* string_id_ptr = &r->stack_ptr[-pc[1] - 1];
                 uint64_t string_id = *string_id_ptr;
@@ -1157,7 +1286,7 @@ case case_value: \
                 break;
             }
 
-            case MN_A2STR:
+            OPCASE(A2STR, NONE)
             {
                 uint64_t* param = &r->stack_ptr[-pc[1] - 1];
                 int64_t string_id = string_new( *( char ** )param );
@@ -1167,7 +1296,7 @@ case case_value: \
                 break;
             }
 
-            case MN_STR2A:
+            OPCASE(STR2A, NONE)
             {
                 uint64_t* param1 = &r->stack_ptr[-2];
                 uint64_t string_id = r->stack_ptr[-1];
@@ -1180,7 +1309,7 @@ case case_value: \
                 break;
             }
 
-            case MN_STR2CHARNUL:
+            OPCASE(STR2CHARNUL, NONE)
             {
                 uint64_t string_id = r->stack_ptr[-1];
                 strcpy( *( char ** )( intptr_t ) r->stack_ptr[-2], string_get( string_id ) );
@@ -1192,8 +1321,8 @@ case case_value: \
 
             /* Direct variables operations */
 
-#define OP_LETNP(case_value, ctype, getvalue) \
-case case_value: \
+#define OP_LETNP(op, type, ctype, getvalue) \
+OPCASE(op, type) \
 { \
     ( *( ctype* )( intptr_t )( r->stack_ptr[-2] ) ) = getvalue r->stack_ptr[-1]; \
     r->stack_ptr -= 2; \
@@ -1201,18 +1330,18 @@ case case_value: \
     break; \
 }
 
-            OP_LETNP(MN_LETNP | MN_QWORD, int64_t,)
-            OP_LETNP(MN_LETNP | MN_UNSIGNED | MN_QWORD, uint64_t,)
-            OP_LETNP(MN_LETNP | MN_DWORD, int32_t,)
-            OP_LETNP(MN_LETNP | MN_UNSIGNED | MN_DWORD, uint32_t,)
-            OP_LETNP(MN_LETNP | MN_WORD, int16_t,)
-            OP_LETNP(MN_LETNP | MN_UNSIGNED | MN_WORD, uint16_t,)
-            OP_LETNP(MN_LETNP | MN_BYTE, int8_t,)
-            OP_LETNP(MN_LETNP | MN_UNSIGNED | MN_BYTE, uint8_t,)
-            OP_LETNP(MN_LETNP | MN_DOUBLE, double, *( double * ) &)
-            OP_LETNP(MN_LETNP | MN_FLOAT, float, *( float * ) &)
-
-            case MN_LETNP | MN_STRING:
+            OP_LETNP(LETNP, QWORD, int64_t,)
+            OP_LETNP(LETNP, UQWORD, uint64_t,)
+            OP_LETNP(LETNP, DWORD, int32_t,)
+            OP_LETNP(LETNP, UDWORD, uint32_t,)
+            OP_LETNP(LETNP, WORD, int16_t,)
+            OP_LETNP(LETNP, UWORD, uint16_t,)
+            OP_LETNP(LETNP, BYTE, int8_t,)
+            OP_LETNP(LETNP, UBYTE, uint8_t,)
+            OP_LETNP(LETNP, DOUBLE, double, *( double * ) &)
+            OP_LETNP(LETNP, FLOAT, float, *( float * ) &)
+
+            OPCASE(LETNP, STRING)
             {
                 uint64_t* string_dest = ( int64_t * )( intptr_t )( r->stack_ptr[-2] );
                 string_discard( *string_dest );
@@ -1222,8 +1351,8 @@ case case_value: \
                 break;
             }
 
-#define OP_LET(case_value, ctype, getvalue) \
-case case_value: \
+#define OP_LET(op, type, ctype, getvalue) \
+OPCASE(op, type) \
 { \
     ( *( ctype* )( intptr_t )( r->stack_ptr[-2] ) ) = getvalue r->stack_ptr[-1]; \
     --r->stack_ptr; \
@@ -1231,18 +1360,18 @@ case case_value: \
     break; \
 }
 
-            OP_LET(MN_LET | MN_QWORD, int64_t,)
-            OP_LET(MN_LET | MN_UNSIGNED | MN_QWORD, uint64_t,)
-            OP_LET(MN_LET | MN_DWORD, int32_t,)
-            OP_LET(MN_LET | MN_UNSIGNED | MN_DWORD, uint32_t,)
-            OP_LET(MN_LET | MN_WORD, int16_t,)
-            OP_LET(MN_LET | MN_UNSIGNED | MN_WORD, uint16_t,)
-            OP_LET(MN_LET | MN_BYTE, int8_t,)
-            OP_LET(MN_LET | MN_UNSIGNED | MN_BYTE, uint8_t,)
-            OP_LET(MN_LET | MN_DOUBLE, double, *( double * ) &)
-            OP_LET(MN_LET | MN_FLOAT, float, *( float * ) &)
-
-            case MN_LET | MN_STRING:
+            OP_LET(LET, QWORD, int64_t,)
+            OP_LET(LET, UQWORD, uint64_t,)
+            OP_LET(LET, DWORD, int32_t,)
+            OP_LET(LET, UDWORD, uint32_t,)
+            OP_LET(LET, WORD, int16_t,)
+            OP_LET(LET, UWORD, uint16_t,)
+            OP_LET(LET, BYTE, int8_t,)
+            OP_LET(LET, UBYTE, uint8_t,)
+            OP_LET(LET, DOUBLE, double, *( double * ) &)
+            OP_LET(LET, FLOAT, float, *( float * ) &)
+
+            OPCASE(LET, STRING)
             {
                 uint64_t* string_dest = ( int64_t * )( intptr_t )( r->stack_ptr[-2] );
                 string_discard( *string_dest );
@@ -1253,8 +1382,8 @@ case case_value: \
             }
 
 
-#define OP_VAR(case_value, ctype, oper, getvalue) \
-case case_value: \
+#define OP_VAR(op, type, ctype, oper, getvalue) \
+OPCASE(op, type) \
 { \
     *( ctype * )( intptr_t )( r->stack_ptr[-2] ) oper##= getvalue r->stack_ptr[-1]; \
     --r->stack_ptr; \
@@ -1262,101 +1391,104 @@ case case_value: \
     break; \
 }
 
-            OP_VAR(MN_VARADD | MN_QWORD, int64_t, +,)
-            OP_VAR(MN_VARADD | MN_UNSIGNED | MN_QWORD, uint64_t, +,)
-            OP_VAR(MN_VARADD | MN_DWORD, int32_t, +,)
-            OP_VAR(MN_VARADD | MN_UNSIGNED | MN_DWORD, uint32_t, +,)
-            OP_VAR(MN_VARADD | MN_WORD, int16_t, +,)
-            OP_VAR(MN_VARADD | MN_UNSIGNED | MN_WORD, uint16_t, +,)
-            OP_VAR(MN_VARADD | MN_BYTE, int8_t, +,)
-            OP_VAR(MN_VARADD | MN_UNSIGNED | MN_BYTE, uint8_t, +,)
-            OP_VAR(MN_VARADD | MN_DOUBLE, double, +, *( double * ) &)
-            OP_VAR(MN_VARADD | MN_FLOAT, float, +, *( float * ) &)
-
-            case MN_VARADD | MN_STRING:
+            OP_VAR(VARADD, QWORD, int64_t, +,)
+            OP_VAR(VARADD, UQWORD, uint64_t, +,)
+            OP_VAR(VARADD, DWORD, int32_t, +,)
+            OP_VAR(VARADD, UDWORD, uint32_t, +,)
+            OP_VAR(VARADD, WORD, int16_t, +,)
+            OP_VAR(VARADD, UWORD, uint16_t, +,)
+            OP_VAR(VARADD, BYTE, int8_t, +,)
+            OP_VAR(VARADD, UBYTE, uint8_t, +,)
+            OP_VAR(VARADD, DOUBLE, double, +, *( double * ) &)
+            OP_VAR(VARADD, FLOAT, float, +, *( float * ) &)
+
+            OPCASE(VARADD, STRING)
             {
                 uint64_t* string_id1_ptr = ( int64_t * )( intptr_t )( r->stack_ptr[-2] );
                 uint64_t string_id1 = *string_id1_ptr, string_id2 = r->stack_ptr[-1];
-                *string_id1_ptr = string_add( string_id1, string_id2 );
-                string_use( *string_id1_ptr );
-                string_discard( string_id1 );
+                /* Appended in place if the variable is its only user */
+                *string_id1_ptr = string_append( string_id1, string_id2 );
+                if ( *string_id1_ptr != string_id1 ) {
+                    string_use( *string_id1_ptr );
+                    string_discard( string_id1 );
+                }
                 string_discard( string_id2 );
                 --r->stack_ptr;
                 ++pc;
                 break;
             }
 
-            OP_VAR(MN_VARSUB | MN_QWORD, int64_t, -,)
-            OP_VAR(MN_VARSUB | MN_UNSIGNED | MN_QWORD, uint64_t, -,)
-            OP_VAR(MN_VARSUB | MN_DWORD, int32_t, -,)
-            OP_VAR(MN_VARSUB | MN_UNSIGNED | MN_DWORD, uint32_t, -,)
-            OP_VAR(MN_VARSUB | MN_WORD, int16_t, -,)
-            OP_VAR(MN_VARSUB | MN_UNSIGNED | MN_WORD, uint16_t, -,)
-            OP_VAR(MN_VARSUB | MN_BYTE, int8_t, -,)
-            OP_VAR(MN_VARSUB | MN_UNSIGNED | MN_BYTE, uint8_t, -,)
-            OP_VAR(MN_VARSUB | MN_DOUBLE, double, -, *( double * ) &)
-            OP_VAR(MN_VARSUB | MN_FLOAT, float, -, *( float * ) &)
-
-            OP_VAR(MN_VARMUL | MN_QWORD, int64_t, *,)
-            OP_VAR(MN_VARMUL | MN_UNSIGNED | MN_QWORD, uint64_t, *,)
-            OP_VAR(MN_VARMUL | MN_DWORD, int32_t, *,)
-            OP_VAR(MN_VARMUL | MN_UNSIGNED | MN_DWORD, uint32_t, *,)
-            OP_VAR(MN_VARMUL | MN_WORD, int16_t, *,)
-            OP_VAR(MN_VARMUL | MN_UNSIGNED | MN_WORD, uint16_t, *,)
-            OP_VAR(MN_VARMUL | MN_BYTE, int8_t, *,)
-            OP_VAR(MN_VARMUL | MN_UNSIGNED | MN_BYTE, uint8_t, *,)
-            OP_VAR(MN_VARMUL | MN_DOUBLE, double, *, *( double * ) &)
-            OP_VAR(MN_VARMUL | MN_FLOAT, float, *, *( float * ) &)
-
-            OP_VAR(MN_VAROR | MN_QWORD, int64_t, |,)
-            OP_VAR(MN_VAROR | MN_UNSIGNED | MN_QWORD, uint64_t, |,)
-            OP_VAR(MN_VAROR | MN_DWORD, int32_t, |,)
-            OP_VAR(MN_VAROR | MN_UNSIGNED | MN_DWORD, uint32_t, |,)
-            OP_VAR(MN_VAROR | MN_WORD, int16_t, |,)
-            OP_VAR(MN_VAROR | MN_UNSIGNED | MN_WORD, uint16_t, |,)
-            OP_VAR(MN_VAROR | MN_BYTE, int8_t, |,)
-            OP_VAR(MN_VAROR | MN_UNSIGNED | MN_BYTE, uint8_t, |,)
-
-            OP_VAR(MN_VARXOR | MN_QWORD, int64_t, ^,)
-            OP_VAR(MN_VARXOR | MN_UNSIGNED | MN_QWORD, uint64_t, ^,)
-            OP_VAR(MN_VARXOR | MN_DWORD, int32_t, ^,)
-            OP_VAR(MN_VARXOR | MN_UNSIGNED | MN_DWORD, uint32_t, ^,)
-            OP_VAR(MN_VARXOR | MN_WORD, int16_t, ^,)
-            OP_VAR(MN_VARXOR | MN_UNSIGNED | MN_WORD, uint16_t, ^,)
-            OP_VAR(MN_VARXOR | MN_BYTE, int8_t, ^,)
-            OP_VAR(MN_VARXOR | MN_UNSIGNED | MN_BYTE, uint8_t, ^,)
-
-            OP_VAR(MN_VARAND | MN_QWORD, int64_t, &,)
-            OP_VAR(MN_VARAND | MN_UNSIGNED | MN_QWORD, uint64_t, &,)
-            OP_VAR(MN_VARAND | MN_DWORD, int32_t, &,)
-            OP_VAR(MN_VARAND | MN_UNSIGNED | MN_DWORD, uint32_t, &,)
-            OP_VAR(MN_VARAND | MN_WORD, int16_t, &,)
-            OP_VAR(MN_VARAND | MN_UNSIGNED | MN_WORD, uint16_t, &,)
-            OP_VAR(MN_VARAND | MN_BYTE, int8_t, &,)
-            OP_VAR(MN_VARAND | MN_UNSIGNED | MN_BYTE, uint8_t, &,)
-
-            OP_VAR(MN_VARROR | MN_QWORD, int64_t, >>,)
-            OP_VAR(MN_VARROR | MN_UNSIGNED | MN_QWORD, uint64_t, >>,)
-            OP_VAR(MN_VARROR | MN_DWORD, int32_t, >>,)
-            OP_VAR(MN_VARROR | MN_UNSIGNED | MN_DWORD, uint32_t, >>,)
-            OP_VAR(MN_VARROR | MN_WORD, int16_t, >>,)
-            OP_VAR(MN_VARROR | MN_UNSIGNED | MN_WORD, uint16_t, >>,)
-            OP_VAR(MN_VARROR | MN_BYTE, int8_t, >>,)
-            OP_VAR(MN_VARROR | MN_UNSIGNED | MN_BYTE, uint8_t, >>,)
-
-            OP_VAR(MN_VARROL | MN_QWORD, int64_t, <<,)
-            OP_VAR(MN_VARROL | MN_UNSIGNED | MN_QWORD, uint64_t, <<,)
-            OP_VAR(MN_VARROL | MN_DWORD, int32_t, <<,)
-            OP_VAR(MN_VARROL | MN_UNSIGNED | MN_DWORD, uint32_t, <<,)
-            OP_VAR(MN_VARROL | MN_WORD, int16_t, <<,)
-            OP_VAR(MN_VARROL | MN_UNSIGNED | MN_WORD, uint16_t, <<,)
-            OP_VAR(MN_VARROL | MN_BYTE, int8_t, <<,)
-            OP_VAR(MN_VARROL | MN_UNSIGNED | MN_BYTE, uint8_t, <<,)
+            OP_VAR(VARSUB, QWORD, int64_t, -,)
+            OP_VAR(VARSUB, UQWORD, uint64_t, -,)
+            OP_VAR(VARSUB, DWORD, int32_t, -,)
+            OP_VAR(VARSUB, UDWORD, uint32_t, -,)
+            OP_VAR(VARSUB, WORD, int16_t, -,)
+            OP_VAR(VARSUB, UWORD, uint16_t, -,)
+            OP_VAR(VARSUB, BYTE, int8_t, -,)
+            OP_VAR(VARSUB, UBYTE, uint8_t, -,)
+            OP_VAR(VARSUB, DOUBLE, double, -, *( double * ) &)
+            OP_VAR(VARSUB, FLOAT, float, -, *( float * ) &)
+
+            OP_VAR(VARMUL, QWORD, int64_t, *,)
+            OP_VAR(VARMUL, UQWORD, uint64_t, *,)
+            OP_VAR(VARMUL, DWORD, int32_t, *,)
+            OP_VAR(VARMUL, UDWORD, uint32_t, *,)
+            OP_VAR(VARMUL, WORD, int16_t, *,)
+            OP_VAR(VARMUL, UWORD, uint16_t, *,)
+            OP_VAR(VARMUL, BYTE, int8_t, *,)
+            OP_VAR(VARMUL, UBYTE, uint8_t, *,)
+            OP_VAR(VARMUL, DOUBLE, double, *, *( double * ) &)
+            OP_VAR(VARMUL, FLOAT, float, *, *( float * ) &)
+
+            OP_VAR(VAROR, QWORD, int64_t, |,)
+            OP_VAR(VAROR, UQWORD, uint64_t, |,)
+            OP_VAR(VAROR, DWORD, int32_t, |,)
+            OP_VAR(VAROR, UDWORD, uint32_t, |,)
+            OP_VAR(VAROR, WORD, int16_t, |,)
+            OP_VAR(VAROR, UWORD, uint16_t, |,)
+            OP_VAR(VAROR, BYTE, int8_t, |,)
+            OP_VAR(VAROR, UBYTE, uint8_t, |,)
+
+            OP_VAR(VARXOR, QWORD, int64_t, ^,)
+            OP_VAR(VARXOR, UQWORD, uint64_t, ^,)
+            OP_VAR(VARXOR, DWORD, int32_t, ^,)
+            OP_VAR(VARXOR, UDWORD, uint32_t, ^,)
+            OP_VAR(VARXOR, WORD, int16_t, ^,)
+            OP_VAR(VARXOR, UWORD, uint16_t, ^,)
+            OP_VAR(VARXOR, BYTE, int8_t, ^,)
+            OP_VAR(VARXOR, UBYTE, uint8_t, ^,)
+
+            OP_VAR(VARAND, QWORD, int64_t, &,)
+            OP_VAR(VARAND, UQWORD, uint64_t, &,)
+            OP_VAR(VARAND, DWORD, int32_t, &,)
+            OP_VAR(VARAND, UDWORD, uint32_t, &,)
+            OP_VAR(VARAND, WORD, int16_t, &,)
+            OP_VAR(VARAND, UWORD, uint16_t, &,)
+            OP_VAR(VARAND, BYTE, int8_t, &,)
+            OP_VAR(VARAND, UBYTE, uint8_t, &,)
+
+            OP_VAR(VARROR, QWORD, int64_t, >>,)
+            OP_VAR(VARROR, UQWORD, uint64_t, >>,)
+            OP_VAR(VARROR, DWORD, int32_t, >>,)
+            OP_VAR(VARROR, UDWORD, uint32_t, >>,)
+            OP_VAR(VARROR, WORD, int16_t, >>,)
+            OP_VAR(VARROR, UWORD, uint16_t, >>,)
+            OP_VAR(VARROR, BYTE, int8_t, >>,)
+            OP_VAR(VARROR, UBYTE, uint8_t, >>,)
+
+            OP_VAR(VARROL, QWORD, int64_t, <<,)
+            OP_VAR(VARROL, UQWORD, uint64_t, <<,)
+            OP_VAR(VARROL, DWORD, int32_t, <<,)
+            OP_VAR(VARROL, UDWORD, uint32_t, <<,)
+            OP_VAR(VARROL, WORD, int16_t, <<,)
+            OP_VAR(VARROL, UWORD, uint16_t, <<,)
+            OP_VAR(VARROL, BYTE, int8_t, <<,)
+            OP_VAR(VARROL, UBYTE, uint8_t, <<,)
 
             /* VAR DIV/MOD */
 
-#define op_VARDIVMOD(case_value, ctype, oper) \
-case case_value: \
+#define op_VARDIVMOD(op, type, ctype, oper) \
+OPCASE(op, type) \
 { \
     ctype divider = r->stack_ptr[-1]; \
     FATAL_ERROR_DIV_BY_ZERO_CHECK( !divider ) \
@@ -1366,11 +1498,11 @@ case case_value: \
     break; \
 }
 
-#define op_VARDIV(case_value, ctype) op_VARDIVMOD(case_value, ctype, /)
-#define op_VARMOD(case_value, ctype) op_VARDIVMOD(case_value, ctype, %)
+#define op_VARDIV(op, type, ctype) op_VARDIVMOD(op, type, ctype, /)
+#define op_VARMOD(op, type, ctype) op_VARDIVMOD(op, type, ctype, %)
 
-#define op_VARDIVF(case_value, ctype) \
-case case_value: \
+#define op_VARDIVF(op, type, ctype) \
+OPCASE(op, type) \
 { \
     *( ctype * )( intptr_t )( r->stack_ptr[-2] ) /= *( ctype * ) &r->stack_ptr[-1]; \
     --r->stack_ptr; \
@@ -1378,8 +1510,8 @@ case case_value: \
     break; \
 }
 
-#define op_VARMODF(case_value, ctype) \
-case case_value: \
+#define op_VARMODF(op, type, ctype) \
+OPCASE(op, type) \
 { \
     *( ctype * )( intptr_t )( r->stack_ptr[-2] ) = fmod( *( ctype * ) r->stack_ptr[-2], *( ctype * ) &r->stack_ptr[-1] ); \
     --r->stack_ptr; \
@@ -1389,33 +1521,33 @@ case case_value: \
 
             /* VAR DIV */
 
-            op_VARDIV(MN_VARDIV | MN_QWORD, int64_t)
-            op_VARDIV(MN_VARDIV | MN_UNSIGNED | MN_QWORD, uint64_t)
-            op_VARDIV(MN_VARDIV | MN_DWORD, int32_t)
-            op_VARDIV(MN_VARDIV | MN_UNSIGNED | MN_DWORD, uint32_t)
-            op_VARDIV(MN_VARDIV | MN_WORD, int16_t)
-            op_VARDIV(MN_VARDIV | MN_UNSIGNED | MN_WORD, uint16_t)
-            op_VARDIV(MN_VARDIV | MN_BYTE, int8_t)
-            op_VARDIV(MN_VARDIV | MN_UNSIGNED | MN_BYTE, uint8_t)
-            op_VARDIVF(MN_VARDIV | MN_DOUBLE, double)
-            op_VARDIVF(MN_VARDIV | MN_FLOAT, float)
+            op_VARDIV(VARDIV, QWORD, int64_t)
+            op_VARDIV(VARDIV, UQWORD, uint64_t)
+            op_VARDIV(VARDIV, DWORD, int32_t)
+            op_VARDIV(VARDIV, UDWORD, uint32_t)
+            op_VARDIV(VARDIV, WORD, int16_t)
+            op_VARDIV(VARDIV, UWORD, uint16_t)
+            op_VARDIV(VARDIV, BYTE, int8_t)
+            op_VARDIV(VARDIV, UBYTE, uint8_t)
+            op_VARDIVF(VARDIV, DOUBLE, double)
+            op_VARDIVF(VARDIV, FLOAT, float)
 
             /* VAR MOD */
 
-            op_VARMOD(MN_VARMOD | MN_QWORD, int64_t)
-            op_VARMOD(MN_VARMOD | MN_UNSIGNED | MN_QWORD, uint64_t)
-            op_VARMOD(MN_VARMOD | MN_DWORD, int32_t)
-            op_VARMOD(MN_VARMOD | MN_UNSIGNED | MN_DWORD, uint32_t)
-            op_VARMOD(MN_VARMOD | MN_WORD, int16_t)
-            op_VARMOD(MN_VARMOD | MN_UNSIGNED | MN_WORD, uint16_t)
-            op_VARMOD(MN_VARMOD | MN_BYTE, int8_t)
-            op_VARMOD(MN_VARMOD | MN_UNSIGNED | MN_BYTE, uint8_t)
-            op_VARMODF(MN_VARMOD | MN_DOUBLE, double)
-            op_VARMODF(MN_VARMOD | MN_FLOAT, float)
+            op_VARMOD(VARMOD, QWORD, int64_t)
+            op_VARMOD(VARMOD, UQWORD, uint64_t)
+            op_VARMOD(VARMOD, DWORD, int32_t)
+            op_VARMOD(VARMOD, UDWORD, uint32_t)
+            op_VARMOD(VARMOD, WORD, int16_t)
+            op_VARMOD(VARMOD, UWORD, uint16_t)
+            op_VARMOD(VARMOD, BYTE, int8_t)
+            op_VARMOD(VARMOD, UBYTE, uint8_t)
+            op_VARMODF(VARMOD, DOUBLE, double)
+            op_VARMODF(VARMOD, FLOAT, float)
 
             /* String operations */
 
-            case MN_STRACAT:
+            OPCASE(STRACAT, NONE)
             {
                 int64_t n = r->stack_ptr[-1];
                 strncat( *( char ** )( &r->stack_ptr[-2] ), string_get( n ), (pc[1]-1) - strlen( *( char ** )( &r->stack_ptr[-2] ) ) );
@@ -1428,38 +1560,38 @@ case case_value: \
 
             /* Direct operations with variables QWORD type */
 
-#define OP_DECINC(case_value, ctype, oper) \
-case case_value: \
+#define OP_DECINC(op, type, ctype, oper) \
+OPCASE(op, type) \
 { \
     ( *( ctype * )( intptr_t )( r->stack_ptr[-1] ) ) oper##= pc[1]; \
     pc += 2; \
     break; \
 }
 
-            OP_DECINC(MN_INC | MN_QWORD, int64_t, +)
-            OP_DECINC(MN_INC | MN_UNSIGNED | MN_QWORD, uint64_t, +)
-            OP_DECINC(MN_INC | MN_DWORD, int32_t, +)
-            OP_DECINC(MN_INC | MN_UNSIGNED | MN_DWORD, uint32_t, +)
-            OP_DECINC(MN_INC | MN_WORD, int16_t, +)
-            OP_DECINC(MN_INC | MN_UNSIGNED | MN_WORD, uint16_t, +)
-            OP_DECINC(MN_INC | MN_BYTE, int8_t, +)
-            OP_DECINC(MN_INC | MN_UNSIGNED | MN_BYTE, uint8_t, +)
-            OP_DECINC(MN_INC | MN_DOUBLE, double, +)
-            OP_DECINC(MN_INC | MN_FLOAT, float, +)
-
-            OP_DECINC(MN_DEC | MN_QWORD, int64_t, -)
-            OP_DECINC(MN_DEC | MN_UNSIGNED | MN_QWORD, uint64_t, -)
-            OP_DECINC(MN_DEC | MN_DWORD, int32_t, -)
-            OP_DECINC(MN_DEC | MN_UNSIGNED | MN_DWORD, uint32_t, -)
-            OP_DECINC(MN_DEC | MN_WORD, int16_t, -)
-            OP_DECINC(MN_DEC | MN_UNSIGNED | MN_WORD, uint16_t, -)
-            OP_DECINC(MN_DEC | MN_BYTE, int8_t, -)
-            OP_DECINC(MN_DEC | MN_UNSIGNED | MN_BYTE, uint8_t, -)
-            OP_DECINC(MN_DEC | MN_DOUBLE, double, -)
-            OP_DECINC(MN_DEC | MN_FLOAT, float, -)
-
-#define OP_POSTDECINC(case_value, ctype, oper, getvalue) \
-case case_value: \
+            OP_DECINC(INC, QWORD, int64_t, +)
+            OP_DECINC(INC, UQWORD, uint64_t, +)
+            OP_DECINC(INC, DWORD, int32_t, +)
+            OP_DECINC(INC, UDWORD, uint32_t, +)
+            OP_DECINC(INC, WORD, int16_t, +)
+            OP_DECINC(INC, UWORD, uint16_t, +)
+            OP_DECINC(INC, BYTE, int8_t, +)
+            OP_DECINC(INC, UBYTE, uint8_t, +)
+            OP_DECINC(INC, DOUBLE, double, +)
+            OP_DECINC(INC, FLOAT, float, +)
+
+            OP_DECINC(DEC, QWORD, int64_t, -)
+            OP_DECINC(DEC, UQWORD, uint64_t, -)
+            OP_DECINC(DEC, DWORD, int32_t, -)
+            OP_DECINC(DEC, UDWORD, uint32_t, -)
+            OP_DECINC(DEC, WORD, int16_t, -)
+            OP_DECINC(DEC, UWORD, uint16_t, -)
+            OP_DECINC(DEC, BYTE, int8_t, -)
+            OP_DECINC(DEC, UBYTE, uint8_t, -)
+            OP_DECINC(DEC, DOUBLE, double, -)
+            OP_DECINC(DEC, FLOAT, float, -)
+
+#define OP_POSTDECINC(op, type, ctype, oper, getvalue) \
+OPCASE(op, type) \
 { \
     ctype* var_ptr = ( ctype * )( intptr_t ) r->stack_ptr[-1]; \
     ctype current_value = *var_ptr; \
@@ -1469,35 +1601,69 @@ case case_value: \
     break; \
 }
 
-            case MN_POSTDEC | MN_UNSIGNED | MN_QWORD:
-            OP_POSTDECINC(MN_POSTDEC | MN_QWORD, int64_t, -,)
-            OP_POSTDECINC(MN_POSTDEC | MN_DWORD, int32_t, -,)
-            OP_POSTDECINC(MN_POSTDEC | MN_UNSIGNED | MN_DWORD, uint32_t, -,)
-            OP_POSTDECINC(MN_POSTDEC | MN_WORD, int16_t, -,)
-            OP_POSTDECINC(MN_POSTDEC | MN_UNSIGNED | MN_WORD, uint16_t, -,)
-            OP_POSTDECINC(MN_POSTDEC | MN_BYTE, int8_t, -,)
-            OP_POSTDECINC(MN_POSTDEC | MN_UNSIGNED | MN_BYTE, uint8_t, -,)
-            OP_POSTDECINC(MN_POSTDEC | MN_DOUBLE, double, -, *( uint64_t * ) &)
-            OP_POSTDECINC(MN_POSTDEC | MN_FLOAT, float, -, *( uint32_t * ) &)
-
-            case MN_POSTINC | MN_UNSIGNED | MN_QWORD:
-            OP_POSTDECINC(MN_POSTINC | MN_QWORD, int64_t, +,)
-            OP_POSTDECINC(MN_POSTINC | MN_DWORD, int32_t, +,)
-            OP_POSTDECINC(MN_POSTINC | MN_UNSIGNED | MN_DWORD, uint32_t, +,)
-            OP_POSTDECINC(MN_POSTINC | MN_WORD, int16_t, +,)
-            OP_POSTDECINC(MN_POSTINC | MN_UNSIGNED | MN_WORD, uint16_t, +,)
-            OP_POSTDECINC(MN_POSTINC | MN_BYTE, int8_t, +,)
-            OP_POSTDECINC(MN_POSTINC | MN_UNSIGNED | MN_BYTE, uint8_t, +,)
-            OP_POSTDECINC(MN_POSTINC | MN_DOUBLE, double, +, *( uint64_t * ) &)
-            OP_POSTDECINC(MN_POSTINC | MN_FLOAT, float, +, *( uint32_t * ) &)
+            OPCASE(POSTDEC, UQWORD)
+            OP_POSTDECINC(POSTDEC, QWORD, int64_t, -,)
+            OP_POSTDECINC(POSTDEC, DWORD, int32_t, -,)
+            OP_POSTDECINC(POSTDEC, UDWORD, uint32_t, -,)
+            OP_POSTDECINC(POSTDEC, WORD, int16_t, -,)
+            OP_POSTDECINC(POSTDEC, UWORD, uint16_t, -,)
+            OP_POSTDECINC(POSTDEC, BYTE, int8_t, -,)
+            OP_POSTDECINC(POSTDEC, UBYTE, uint8_t, -,)
+            OP_POSTDECINC(POSTDEC, DOUBLE, double, -, *( uint64_t * ) &)
+            OP_POSTDECINC(POSTDEC, FLOAT, float, -, *( uint32_t * ) &)
+
+            OPCASE(POSTINC, UQWORD)
+            OP_POSTDECINC(POSTINC, QWORD, int64_t, +,)
+            OP_POSTDECINC(POSTINC, DWORD, int32_t, +,)
+            OP_POSTDECINC(POSTINC, UDWORD, uint32_t, +,)
+            OP_POSTDECINC(POSTINC, WORD, int16_t, +,)
+            OP_POSTDECINC(POSTINC, UWORD, uint16_t, +,)
+            OP_POSTDECINC(POSTINC, BYTE, int8_t, +,)
+            OP_POSTDECINC(POSTINC, UBYTE, uint8_t, +,)
+            OP_POSTDECINC(POSTINC, DOUBLE, double, +, *( uint64_t * ) &)
+            OP_POSTDECINC(POSTINC, FLOAT, float, +, *( uint32_t * ) &)
+
+            /* Variable += immediate (superinstructions) */
+
+#define OP_VARADD_IMM(op, type, ctype, base) \
+OPCASE(op, type) \
+{ \
+    *( ctype * )( ( uint8_t * )( base ) + MN_VARIMM_OFFSET( pc[1] ) ) += ( ctype ) MN_VARIMM_VALUE( pc[1] ); \
+    pc += 2; \
+    break; \
+}
+
+#define OP_VARADD_IMMF(op, base) \
+OPCASE(op, FLOAT) \
+{ \
+    int32_t imm = MN_VARIMM_VALUE( pc[1] ); \
+    *( float * )( ( uint8_t * )( base ) + MN_VARIMM_OFFSET( pc[1] ) ) += *( float * ) &imm; \
+    pc += 2; \
+    break; \
+}
+
+#define OP_VARADD_IMM_ALL(op, base) \
+OP_VARADD_IMM(op, QWORD, int64_t, base) \
+OP_VARADD_IMM(op, UQWORD, uint64_t, base) \
+OP_VARADD_IMM(op, DWORD, int32_t, base) \
+OP_VARADD_IMM(op, UDWORD, uint32_t, base) \
+OP_VARADD_IMM(op, WORD, int16_t, base) \
+OP_VARADD_IMM(op, UWORD, uint16_t, base) \
+OP_VARADD_IMM(op, BYTE, int8_t, base) \
+OP_VARADD_IMM(op, UBYTE, uint8_t, base) \
+OP_VARADD_IMMF(op, base)
+
+            OP_VARADD_IMM_ALL(VARADD_PRIV, r->pridata)
+            OP_VARADD_IMM_ALL(VARADD_LOCAL, r->locdata)
+            OP_VARADD_IMM_ALL(VARADD_GLOBAL, globaldata)
 
             /* Jumps */
 
-            case MN_JUMP:
+            OPCASE(JUMP, NONE)
                 pc = r->code + pc[1];
                 continue;
 
-            case MN_JTRUE:
+            OPCASE(JTRUE, NONE)
                 --r->stack_ptr;
                 if ( *r->stack_ptr ) {
                     pc = r->code + pc[1];
@@ -1506,7 +1672,7 @@ case case_value: \
                 pc += 2;
                 break;
 
-            case MN_JFALSE:
+            OPCASE(JFALSE, NONE)
                 --r->stack_ptr;
                 if ( !*r->stack_ptr ) {
                     pc = r->code + pc[1];
@@ -1515,7 +1681,7 @@ case case_value: \
                 pc += 2;
                 break;
 
-            case MN_JTTRUE:
+            OPCASE(JTTRUE, NONE)
                 if ( r->stack_ptr[-1] ) {
                     pc = r->code + pc[1];
                     continue;
@@ -1523,7 +1689,7 @@ case case_value: \
                 pc += 2;
                 break;
 
-            case MN_JTFALSE:
+            OPCASE(JTFALSE, NONE)
                 if ( !r->stack_ptr[-1] ) {
                     pc = r->code + pc[1];
                     continue;
@@ -1531,44 +1697,96 @@ case case_value: \
                 pc += 2;
                 break;
 
-            case MN_NCALL:
+            /* Compare + JFALSE (superinstructions) */
+
+#define OP_JCMP(op, type, ctype, oper) \
+OPCASE(op, type) \
+{ \
+    r->stack_ptr -= 2; \
+    if ( !( ( ctype ) r->stack_ptr[0] oper ( ctype ) r->stack_ptr[1] ) ) { \
+        pc = r->code + pc[1]; \
+        continue; \
+    } \
+    pc += 2; \
+    break; \
+}
+
+#define OP_JCMPF(op, type, ctype, oper) \
+OPCASE(op, type) \
+{ \
+    r->stack_ptr -= 2; \
+    if ( !( *(( ctype * ) &r->stack_ptr[0] ) oper *(( ctype * ) &r->stack_ptr[1] ) ) ) { \
+        pc = r->code + pc[1]; \
+        continue; \
+    } \
+    pc += 2; \
+    break; \
+}
+
+#define OP_JCMP_ALL(op, oper) \
+OP_JCMP(op, QWORD, int64_t, oper) \
+OP_JCMP(op, DWORD, int32_t, oper) \
+OP_JCMP(op, WORD, int16_t, oper) \
+OP_JCMP(op, BYTE, int8_t, oper) \
+OP_JCMPF(op, DOUBLE, double, oper) \
+OP_JCMPF(op, FLOAT, float, oper)
+
+#define OP_JCMP_UNSIGNED(op, oper) \
+OP_JCMP(op, UQWORD, uint64_t, oper) \
+OP_JCMP(op, UDWORD, uint32_t, oper) \
+OP_JCMP(op, UWORD, uint16_t, oper) \
+OP_JCMP(op, UBYTE, uint8_t, oper)
+
+            OP_JCMP_ALL(JFALSE_EQ, ==)
+            OP_JCMP_ALL(JFALSE_NE, !=)
+            OP_JCMP_ALL(JFALSE_GT, >)
+            OP_JCMP_ALL(JFALSE_LT, <)
+            OP_JCMP_ALL(JFALSE_GTE, >=)
+            OP_JCMP_ALL(JFALSE_LTE, <=)
+            OP_JCMP_UNSIGNED(JFALSE_GT, >)
+            OP_JCMP_UNSIGNED(JFALSE_LT, <)
+            OP_JCMP_UNSIGNED(JFALSE_GTE, >=)
+            OP_JCMP_UNSIGNED(JFALSE_LTE, <=)
+
+            OPCASE(NCALL, NONE)
                 *r->stack_ptr++ = pc - r->code + 2 ; /* Push next address */
                 pc = r->code + pc[1] ; /* Call function */
                 ++r->call_level;
-                break;
+                continue;
 
             /* Switch */
 
-            case MN_SWITCH:
+            OPCASE(SWITCH, NONE)
                 r->switchval = *--r->stack_ptr;
                 r->cased = 0;
                 ++pc;
                 break;
 
-            case MN_SWITCH | MN_STRING:
+            OPCASE(SWITCH, STRING)
                 if ( r->switchval_string != 0 ) string_discard( r->switchval_string );
                 r->switchval_string = *--r->stack_ptr;
                 r->cased = 0;
                 ++pc;
                 break;
 
-            case MN_CASE:
+            OPCASE(CASE, NONE)
                 if ( r->switchval == *--r->stack_ptr ) r->cased = 2;
                 ++pc;
                 break;
 
-            case MN_CASE | MN_STRING:
+            OPCASE(CASE, STRING)
             {
                 --r->stack_ptr;
                 uint64_t string_id = *r->stack_ptr;
-                if ( string_comp( r->switchval_string, string_id ) == 0 ) r->cased = 2;
+                /* The SWITCH value hash is calculated once, and the CASE constants ones are kept */
+                if ( string_equal( r->switchval_string, string_id ) ) r->cased = 2;
                 string_discard( string_id );
                 //string_discard( r->stack_ptr[-1] );
                 ++pc;
                 break;
             }
 
-            case MN_CASE_R:
+            OPCASE(CASE_R, NONE)
             {
                 r->stack_ptr -= 2;
                 if ( r->switchval >= r->stack_ptr[0] && r->switchval <= r->stack_ptr[1] ) r->cased = 1;
@@ -1576,7 +1794,7 @@ case case_value: \
                 break;
             }
 
-            case MN_CASE_R | MN_STRING:
+            OPCASE(CASE_R, STRING)
             {
                 r->stack_ptr -= 2;
                 if ( string_comp( r->switchval_string, r->stack_ptr[0] ) >= 0 &&
@@ -1588,7 +1806,7 @@ case case_value: \
                 break;
             }
 
-            case MN_JNOCASE:
+            OPCASE(JNOCASE, NONE)
                 if ( r->cased < 1 ) {
                     pc = r->code + pc[1];
                     continue;
@@ -1598,7 +1816,7 @@ case case_value: \
 
             /* Process control */
 
-            case MN_TYPE:
+            OPCASE(TYPE, NONE)
             {
                 PROCDEF * def = procdef_get( pc[1] );
                 FATAL_ERROR_CHECK( !def, "ERROR: Runtime error in %s(%" PRId64 ") - Invalid type\n", r->proc->name, LOCQWORD( r, PROCESS_ID ) );
@@ -1607,7 +1825,7 @@ case case_value: \
                 break;
             }
 
-            case MN_FRAME:
+            OPCASE(FRAME, NONE)
                 LOCINT64( r, FRAME_PERCENT ) += r->stack_ptr[-1];
                 --r->stack_ptr;
                 r->codeptr = pc + 1;
@@ -1621,11 +1839,12 @@ case case_value: \
                         r->called_by->stack_ptr[-1] = return_value;
 
                     LOCQWORD( r->called_by, STATUS ) &= ~STATUS_WAITING_MASK;
+                    instance_wake( r->called_by );
                     r->called_by = NULL;
                 }
                 goto break_all;
 
-            case MN_END:
+            OPCASE(END, NONE)
                 if ( r->call_level > 0 ) {
                     pc = r->code + *--r->stack_ptr;
                     r->call_level--;
@@ -1637,7 +1856,7 @@ case case_value: \
                 if ( *status_ptr != STATUS_DEAD ) *status_ptr = STATUS_KILLED;
                 goto break_all;
 
-            case MN_RETURN:
+            OPCASE(RETURN, NONE)
                 if ( r->call_level > 0 ) {
                     pc = r->code + *--r->stack_ptr;
                     r->call_level--;
@@ -1653,28 +1872,28 @@ case case_value: \
 
             /* Handlers */
 
-            case MN_EXITHNDLR:
+            OPCASE(EXITHNDLR, NONE)
                 r->exitcode = pc[1];
                 pc += 2;
                 break;
 
-            case MN_ERRHNDLR:
+            OPCASE(ERRHNDLR, NONE)
                 r->errorcode = pc[1];
                 pc += 2;
                 break;
 
             /* Others */
 
-            case MN_DEBUG:
+            OPCASE(DEBUG, NONE)
                 if ( dcb.data.NSourceFiles ) {
                     if ( debug > 0 ) printf( "\n::: DEBUG from %s(%" PRId64 ")\n", r->proc->name, LOCQWORD( r, PROCESS_ID ) );
                     trace_sentence = -1;
                     debugger_show_console = 1;
                 }
                 ++pc;
-                break;
+                continue;
 
-            case MN_SENTENCE:
+            OPCASE(SENTENCE, NONE)
                 trace_sentence     = pc[1];
                 trace_instance     = r;
                 pc += 2;
@@ -1683,40 +1902,40 @@ case case_value: \
                     debugger_step = 0;
                     debugger_show_console = 1;
                 }
-                break;
+                continue;
 
 
-            case MN_COPY_ARRAY | MN_QWORD:
-            case MN_COPY_ARRAY | MN_UNSIGNED | MN_QWORD:
-            case MN_COPY_ARRAY | MN_DOUBLE:
+            OPCASE(COPY_ARRAY, QWORD)
+            OPCASE(COPY_ARRAY, UQWORD)
+            OPCASE(COPY_ARRAY, DOUBLE)
                 memmove( ( int8_t * )( ( intptr_t )r->stack_ptr[-3] ), ( int8_t * )( ( intptr_t )r->stack_ptr[-2] ), r->stack_ptr[-1] * sizeof( int64_t ));
                 r->stack_ptr -= 2;
                 ++pc;
                 break;
 
-            case MN_COPY_ARRAY | MN_DWORD:
-            case MN_COPY_ARRAY | MN_UNSIGNED | MN_DWORD:
-            case MN_COPY_ARRAY | MN_FLOAT:
+            OPCASE(COPY_ARRAY, DWORD)
+            OPCASE(COPY_ARRAY, UDWORD)
+            OPCASE(COPY_ARRAY, FLOAT)
                 memmove( ( int8_t * )( ( intptr_t )r->stack_ptr[-3] ), ( int8_t * )( ( intptr_t )r->stack_ptr[-2] ), r->stack_ptr[-1] * sizeof( int32_t ) );
                 r->stack_ptr -= 2;
                 ++pc;
                 break;
 
-            case MN_COPY_ARRAY | MN_WORD:
-            case MN_COPY_ARRAY | MN_UNSIGNED | MN_WORD:
+            OPCASE(COPY_ARRAY, WORD)
+            OPCASE(COPY_ARRAY, UWORD)
                 memmove( ( int8_t * )( ( intptr_t )r->stack_ptr[-3] ), ( int8_t * )( ( intptr_t )r->stack_ptr[-2] ), r->stack_ptr[-1] * sizeof( int16_t ) );
                 r->stack_ptr -= 2;
                 ++pc;
                 break;
 
-            case MN_COPY_ARRAY | MN_BYTE:
-            case MN_COPY_ARRAY | MN_UNSIGNED | MN_BYTE:
+            OPCASE(COPY_ARRAY, BYTE)
+            OPCASE(COPY_ARRAY, UBYTE)
                 memmove( ( int8_t * )( ( intptr_t )r->stack_ptr[-3] ), ( int8_t * )( ( intptr_t )r->stack_ptr[-2] ), r->stack_ptr[-1] );
                 r->stack_ptr -= 2;
                 ++pc;
                 break;
 
-            case MN_COPY_ARRAY | MN_STRING:
+            OPCASE(COPY_ARRAY, STRING)
             {
                 // Size in elements
                 int64_t * dst = ( int64_t * )( ( intptr_t )r->stack_ptr[-3] );
@@ -1733,9 +1952,9 @@ case case_value: \
                 break;
             }
 
-            case MN_COPY_ARRAY_REPEAT | MN_QWORD:
-            case MN_COPY_ARRAY_REPEAT | MN_UNSIGNED | MN_QWORD:
-            case MN_COPY_ARRAY_REPEAT | MN_DOUBLE:
+            OPCASE(COPY_ARRAY_REPEAT, QWORD)
+            OPCASE(COPY_ARRAY_REPEAT, UQWORD)
+            OPCASE(COPY_ARRAY_REPEAT, DOUBLE)
             {
                 int8_t * dst = ( int8_t * )( ( intptr_t )r->stack_ptr[-3] );
                 int8_t * src = ( int8_t * )( ( intptr_t )r->stack_ptr[-2] );
@@ -1750,9 +1969,9 @@ case case_value: \
                 break;
             }
 
-            case MN_COPY_ARRAY_REPEAT | MN_DWORD:
-            case MN_COPY_ARRAY_REPEAT | MN_UNSIGNED | MN_DWORD:
-            case MN_COPY_ARRAY_REPEAT | MN_FLOAT:
+            OPCASE(COPY_ARRAY_REPEAT, DWORD)
+            OPCASE(COPY_ARRAY_REPEAT, UDWORD)
+            OPCASE(COPY_ARRAY_REPEAT, FLOAT)
             {
                 int8_t * dst = ( int8_t * )( ( intptr_t )r->stack_ptr[-3] );
                 int8_t * src = ( int8_t * )( ( intptr_t )r->stack_ptr[-2] );
@@ -1767,8 +1986,8 @@ case case_value: \
                 break;
             }
 
-            case MN_COPY_ARRAY_REPEAT | MN_WORD:
-            case MN_COPY_ARRAY_REPEAT | MN_UNSIGNED | MN_WORD:
+            OPCASE(COPY_ARRAY_REPEAT, WORD)
+            OPCASE(COPY_ARRAY_REPEAT, UWORD)
             {
                 int8_t * dst = ( int8_t * )( ( intptr_t )r->stack_ptr[-3] );
                 int8_t * src = ( int8_t * )( ( intptr_t )r->stack_ptr[-2] );
@@ -1783,8 +2002,8 @@ case case_value: \
                 break;
             }
 
-            case MN_COPY_ARRAY_REPEAT | MN_BYTE:
-            case MN_COPY_ARRAY_REPEAT | MN_UNSIGNED | MN_BYTE:
+            OPCASE(COPY_ARRAY_REPEAT, BYTE)
+            OPCASE(COPY_ARRAY_REPEAT, UBYTE)
             {
                 int8_t * dst = ( int8_t * )( ( intptr_t )r->stack_ptr[-3] );
                 int8_t * src = ( int8_t * )( ( intptr_t )r->stack_ptr[-2] );
@@ -1799,7 +2018,7 @@ case case_value: \
                 break;
             }
 
-            case MN_COPY_ARRAY_REPEAT | MN_STRING:
+            OPCASE(COPY_ARRAY_REPEAT, STRING)
             {
                 // Size in elements
                 int64_t * dst = ( int64_t * )( ( intptr_t )r->stack_ptr[-3] );
@@ -1819,19 +2038,20 @@ case case_value: \
                 break;
             }
 
-            case MN_COPY_STRUCT:
+            OPCASE(COPY_STRUCT, NONE)
                 copytypes(( void * )( intptr_t )r->stack_ptr[-5], ( void * )( intptr_t )r->stack_ptr[-4], ( DCB_TYPEDEF * )( intptr_t )r->stack_ptr[-3], r->stack_ptr[-2], r->stack_ptr[-1] );
                 r->stack_ptr -= 4;
                 ++pc;
                 break;
 
             default:
+#ifdef USE_THREADED_DISPATCH
+            op_invalid:
+#endif
                 FATAL_ERROR_CHECK( 1, "ERROR: Runtime error in %s(%" PRId64 ") - Mnemonic 0x%02"PRIX64" not implemented\n", r->proc->name, LOCQWORD( r, PROCESS_ID ), *pc )
                 break;
         }
 
-        FATAL_ERROR_CHECK(r->stack_ptr < r->stack, "ERROR: Runtime error in %s(%" PRId64 ") - Critical Stack Problem StackBase=%p StackPTR=%p\n", r->proc->name, LOCQWORD( r, PROCESS_ID ), (void *)r->stack, (void *)r->stack_ptr );
-
 #ifdef EXIT_ON_EMPTY_STACK
         if ( r->stack_ptr == r->stack ) {
             r->codeptr = pc;
@@ -1839,6 +2059,16 @@ case case_value: \
         }
 #endif
 
+#ifdef USE_THREADED_DISPATCH
+        /* Release mode jumps straight to the next handler, instrumented mode goes to the checks */
+        goto *dispatch[ OPCODE_INDEX( *pc ) ];
+#else
+        /* Debugger attached: check everything before every instruction */
+        if ( instrumented ) continue;
+
+        /* Release mode: straight to the next instruction */
+        goto next_instruction;
+#endif
     }
 
     /* *** GENERAL EXIT *** */
@@ -1852,6 +2082,7 @@ break_all:
                 r->called_by->stack_ptr[-1] = return_value;
 
             LOCQWORD( r->called_by, STATUS ) &= ~STATUS_WAITING_MASK;
+            instance_wake( r->called_by );
         }
         r->called_by = NULL;
 
@@ -1863,7 +2094,9 @@ break_all:
             pc = r->codeptr;
             goto main_loop_instance_go;
         } else {
-            instance_destroy( r );
+            /* Worker threads can't touch the instance lists, the pool destroys it later */
+            if ( r->job ) r->job = JOB_DESTROY;
+            else          instance_destroy( r );
             r = NULL;
         }
     }
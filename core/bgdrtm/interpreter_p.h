@@ -0,0 +1,257 @@
+/*
+ *  Copyright (C) SplinterGU (Fenix/BennuGD) (Since 2006)
+ *  Copyright (C) 2002-2006 Fenix Team (Fenix)
+ *  Copyright (C) 1999-2002 José Luis Cebrián Pagüe (Fenix)
+ *
+ *  This file is part of Bennu Game Development
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+/*
+ * FILE        : interpreter_p.h
+ * DESCRIPTION : Opcode dispatch helpers for the interpreter main loop
+ */
+
+#ifndef __INTERPRETER_P_H
+#define __INTERPRETER_P_H
+
+#include "pslang.h"
+
+/* ---------------------------------------------------------------------- */
+/* Threaded dispatch (computed goto) is used when the compiler supports   */
+/* labels as values. Define NO_THREADED_DISPATCH to force the plain       */
+/* switch based loop.                                                     */
+/* ---------------------------------------------------------------------- */
+
+#if defined( __GNUC__ ) && !defined( NO_THREADED_DISPATCH )
+#define USE_THREADED_DISPATCH   1
+#endif
+
+/* Data type suffixes, used to build case values and label names */
+
+#define MN_T_NONE       0
+#define MN_T_UNSIGNED   MN_UNSIGNED
+#define MN_T_QWORD      MN_QWORD
+#define MN_T_UQWORD     ( MN_UNSIGNED | MN_QWORD )
+#define MN_T_DWORD      MN_DWORD
+#define MN_T_UDWORD     ( MN_UNSIGNED | MN_DWORD )
+#define MN_T_WORD       MN_WORD
+#define MN_T_UWORD      ( MN_UNSIGNED | MN_WORD )
+#define MN_T_BYTE       MN_BYTE
+#define MN_T_UBYTE      ( MN_UNSIGNED | MN_BYTE )
+#define MN_T_STRING     MN_STRING
+#define MN_T_FLOAT      MN_FLOAT
+#define MN_T_DOUBLE     MN_DOUBLE
+
+#define OPCODE(op, type)        ( MN_##op | MN_T_##type )
+
+/* Mnemonic + data type packed in 12 bits (bits 8-11 are never used) */
+
+#define OPCODE_TABLE_SIZE       0x1000
+#define OPCODE_INDEX(code)      ( ( ( code ) & MN_MASK ) | ( ( ( code ) >> 4 ) & 0x0F00 ) )
+
+#ifdef USE_THREADED_DISPATCH
+#define OPCASE(op, type)        case OPCODE(op, type): op_##op##_##type:
+#else
+#define OPCASE(op, type)        case OPCODE(op, type):
+#endif
+
+/* ---------------------------------------------------------------------- */
+/* Every opcode handled by instance_go(), one OPCASE() each.              */
+/* ---------------------------------------------------------------------- */
+
+#define OPCODES_ALL_TYPES(X, op) \
+    X(op, QWORD) X(op, UQWORD) X(op, DWORD) X(op, UDWORD) \
+    X(op, WORD) X(op, UWORD) X(op, BYTE) X(op, UBYTE) \
+    X(op, STRING) X(op, FLOAT) X(op, DOUBLE)
+
+#define OPCODES_INTEGER_TYPES(X, op) \
+    X(op, QWORD) X(op, UQWORD) X(op, DWORD) X(op, UDWORD) \
+    X(op, WORD) X(op, UWORD) X(op, BYTE) X(op, UBYTE)
+
+#define OPCODES_NUMERIC_TYPES(X, op) \
+    OPCODES_INTEGER_TYPES(X, op) X(op, FLOAT) X(op, DOUBLE)
+
+#define OPCODES_LIST(X) \
+    X(NOP, NONE) \
+    X(DUP, NONE) \
+    X(PUSH, NONE) X(PUSH, STRING) \
+    X(POP, NONE) X(POP, STRING) \
+    OPCODES_ALL_TYPES(X, INDEX) \
+    X(ARRAY, NONE) \
+    X(CLONE, NONE) \
+    X(CALL, NONE) \
+    X(PROC, NONE) \
+    X(SYSCALL, NONE) \
+    X(SYSPROC, NONE) \
+    OPCODES_ALL_TYPES(X, PRIVATE) \
+    OPCODES_ALL_TYPES(X, PUBLIC) \
+    OPCODES_ALL_TYPES(X, LOCAL) \
+    OPCODES_ALL_TYPES(X, GLOBAL) \
+    OPCODES_ALL_TYPES(X, REMOTE) \
+    OPCODES_ALL_TYPES(X, REMOTE_PUBLIC) \
+    OPCODES_ALL_TYPES(X, GET_PRIV) \
+    OPCODES_ALL_TYPES(X, GET_PUBLIC) \
+    OPCODES_ALL_TYPES(X, GET_LOCAL) \
+    OPCODES_ALL_TYPES(X, GET_GLOBAL) \
+    OPCODES_ALL_TYPES(X, GET_REMOTE) \
+    OPCODES_ALL_TYPES(X, GET_REMOTE_PUBLIC) \
+    OPCODES_ALL_TYPES(X, PTR) \
+    X(NEG, QWORD) X(NEG, UQWORD) X(NEG, FLOAT) X(NEG, DOUBLE) \
+    X(NOT, QWORD) X(NOT, UQWORD) X(NOT, FLOAT) X(NOT, DOUBLE) \
+    X(ADD, QWORD) X(ADD, UQWORD) X(ADD, STRING) X(ADD, FLOAT) \
+    X(ADD, DOUBLE) \
+    X(SUB, QWORD) X(SUB, UQWORD) X(SUB, FLOAT) X(SUB, DOUBLE) \
+    X(MUL, QWORD) X(MUL, UQWORD) X(MUL, DWORD) X(MUL, UDWORD) \
+    X(MUL, WORD) X(MUL, UWORD) X(MUL, BYTE) X(MUL, UBYTE) \
+    X(MUL, FLOAT) X(MUL, DOUBLE) \
+    X(DIV, QWORD) X(DIV, UQWORD) X(DIV, DWORD) X(DIV, UDWORD) \
+    X(DIV, WORD) X(DIV, UWORD) X(DIV, BYTE) X(DIV, UBYTE) \
+    X(DIV, FLOAT) X(DIV, DOUBLE) \
+    X(MOD, QWORD) X(MOD, UQWORD) X(MOD, DWORD) X(MOD, UDWORD) \
+    X(MOD, WORD) X(MOD, UWORD) X(MOD, BYTE) X(MOD, UBYTE) \
+    X(MOD, FLOAT) X(MOD, DOUBLE) \
+    X(ROR, QWORD) X(ROR, UQWORD) X(ROR, DWORD) X(ROR, UDWORD) \
+    X(ROR, WORD) X(ROR, UWORD) X(ROR, BYTE) X(ROR, UBYTE) \
+    X(ROL, QWORD) X(ROL, UQWORD) X(ROL, DWORD) X(ROL, UDWORD) \
+    X(ROL, WORD) X(ROL, UWORD) X(ROL, BYTE) X(ROL, UBYTE) \
+    X(BAND, QWORD) X(BAND, UQWORD) X(BAND, DWORD) X(BAND, UDWORD) \
+    X(BAND, WORD) X(BAND, UWORD) X(BAND, BYTE) X(BAND, UBYTE) \
+    X(BOR, QWORD) X(BOR, UQWORD) X(BOR, DWORD) X(BOR, UDWORD) \
+    X(BOR, WORD) X(BOR, UWORD) X(BOR, BYTE) X(BOR, UBYTE) \
+    X(BXOR, QWORD) X(BXOR, UQWORD) X(BXOR, DWORD) X(BXOR, UDWORD) \
+    X(BXOR, WORD) X(BXOR, UWORD) X(BXOR, BYTE) X(BXOR, UBYTE) \
+    X(BNOT, QWORD) X(BNOT, UQWORD) X(BNOT, DWORD) X(BNOT, UDWORD) \
+    X(BNOT, WORD) X(BNOT, UWORD) X(BNOT, BYTE) X(BNOT, UBYTE) \
+    X(AND, NONE) \
+    X(OR, NONE) \
+    X(XOR, NONE) \
+    X(EQ, QWORD) X(EQ, DWORD) X(EQ, WORD) X(EQ, BYTE) \
+    X(EQ, STRING) X(EQ, FLOAT) X(EQ, DOUBLE) \
+    X(NE, QWORD) X(NE, DWORD) X(NE, WORD) X(NE, BYTE) \
+    X(NE, STRING) X(NE, FLOAT) X(NE, DOUBLE) \
+    OPCODES_ALL_TYPES(X, GTE) \
+    OPCODES_ALL_TYPES(X, LTE) \
+    OPCODES_ALL_TYPES(X, GT) \
+    OPCODES_ALL_TYPES(X, LT) \
+    X(DOUBLE2INT, QWORD) X(DOUBLE2INT, UQWORD) X(DOUBLE2INT, DWORD) X(DOUBLE2INT, UDWORD) \
+    X(DOUBLE2INT, WORD) X(DOUBLE2INT, UWORD) X(DOUBLE2INT, BYTE) X(DOUBLE2INT, UBYTE) \
+    X(FLOAT2INT, QWORD) X(FLOAT2INT, UQWORD) X(FLOAT2INT, DWORD) X(FLOAT2INT, UDWORD) \
+    X(FLOAT2INT, WORD) X(FLOAT2INT, UWORD) X(FLOAT2INT, BYTE) X(FLOAT2INT, UBYTE) \
+    X(INT2DOUBLE, QWORD) X(INT2DOUBLE, UQWORD) X(INT2DOUBLE, DWORD) X(INT2DOUBLE, UDWORD) \
+    X(INT2DOUBLE, WORD) X(INT2DOUBLE, UWORD) X(INT2DOUBLE, BYTE) X(INT2DOUBLE, UBYTE) \
+    X(INT2FLOAT, QWORD) X(INT2FLOAT, UQWORD) X(INT2FLOAT, DWORD) X(INT2FLOAT, UDWORD) \
+    X(INT2FLOAT, WORD) X(INT2FLOAT, UWORD) X(INT2FLOAT, BYTE) X(INT2FLOAT, UBYTE) \
+    X(INT2DWORD, NONE) X(INT2DWORD, UNSIGNED) \
+    X(INT2WORD, NONE) X(INT2WORD, UNSIGNED) \
+    X(INT2BYTE, NONE) X(INT2BYTE, UNSIGNED) \
+    X(DOUBLE2FLOAT, NONE) \
+    X(FLOAT2DOUBLE, NONE) \
+    X(INT2STR, QWORD) X(INT2STR, UQWORD) X(INT2STR, DWORD) X(INT2STR, UDWORD) \
+    X(INT2STR, WORD) X(INT2STR, UWORD) X(INT2STR, BYTE) X(INT2STR, UBYTE) \
+    X(FLOAT2STR, NONE) \
+    X(DOUBLE2STR, NONE) \
+    X(CHR2STR, NONE) \
+    X(STRI2CHR, NONE) \
+    X(STR2CHR, NONE) \
+    X(STR2POINTER, NONE) \
+    X(POINTER2STR, NONE) \
+    X(STR2DOUBLE, NONE) \
+    X(STR2FLOAT, NONE) \
+    X(STR2INT, NONE) \
+    X(A2STR, NONE) \
+    X(STR2A, NONE) \
+    X(STR2CHARNUL, NONE) \
+    X(JFALSE_EQ, QWORD) X(JFALSE_EQ, DWORD) X(JFALSE_EQ, WORD) X(JFALSE_EQ, BYTE) \
+    X(JFALSE_EQ, FLOAT) X(JFALSE_EQ, DOUBLE) \
+    X(JFALSE_NE, QWORD) X(JFALSE_NE, DWORD) X(JFALSE_NE, WORD) X(JFALSE_NE, BYTE) \
+    X(JFALSE_NE, FLOAT) X(JFALSE_NE, DOUBLE) \
+    OPCODES_NUMERIC_TYPES(X, JFALSE_GT) \
+    OPCODES_NUMERIC_TYPES(X, JFALSE_LT) \
+    OPCODES_NUMERIC_TYPES(X, JFALSE_GTE) \
+    OPCODES_NUMERIC_TYPES(X, JFALSE_LTE) \
+    OPCODES_INTEGER_TYPES(X, VARADD_PRIV) X(VARADD_PRIV, FLOAT) \
+    OPCODES_INTEGER_TYPES(X, VARADD_LOCAL) X(VARADD_LOCAL, FLOAT) \
+    OPCODES_INTEGER_TYPES(X, VARADD_GLOBAL) X(VARADD_GLOBAL, FLOAT) \
+    OPCODES_ALL_TYPES(X, LETNP) \
+    OPCODES_ALL_TYPES(X, LET) \
+    OPCODES_ALL_TYPES(X, VARADD) \
+    X(VARSUB, QWORD) X(VARSUB, UQWORD) X(VARSUB, DWORD) X(VARSUB, UDWORD) \
+    X(VARSUB, WORD) X(VARSUB, UWORD) X(VARSUB, BYTE) X(VARSUB, UBYTE) \
+    X(VARSUB, FLOAT) X(VARSUB, DOUBLE) \
+    X(VARMUL, QWORD) X(VARMUL, UQWORD) X(VARMUL, DWORD) X(VARMUL, UDWORD) \
+    X(VARMUL, WORD) X(VARMUL, UWORD) X(VARMUL, BYTE) X(VARMUL, UBYTE) \
+    X(VARMUL, FLOAT) X(VARMUL, DOUBLE) \
+    X(VAROR, QWORD) X(VAROR, UQWORD) X(VAROR, DWORD) X(VAROR, UDWORD) \
+    X(VAROR, WORD) X(VAROR, UWORD) X(VAROR, BYTE) X(VAROR, UBYTE) \
+    X(VARXOR, QWORD) X(VARXOR, UQWORD) X(VARXOR, DWORD) X(VARXOR, UDWORD) \
+    X(VARXOR, WORD) X(VARXOR, UWORD) X(VARXOR, BYTE) X(VARXOR, UBYTE) \
+    X(VARAND, QWORD) X(VARAND, UQWORD) X(VARAND, DWORD) X(VARAND, UDWORD) \
+    X(VARAND, WORD) X(VARAND, UWORD) X(VARAND, BYTE) X(VARAND, UBYTE) \
+    X(VARROR, QWORD) X(VARROR, UQWORD) X(VARROR, DWORD) X(VARROR, UDWORD) \
+    X(VARROR, WORD) X(VARROR, UWORD) X(VARROR, BYTE) X(VARROR, UBYTE) \
+    X(VARROL, QWORD) X(VARROL, UQWORD) X(VARROL, DWORD) X(VARROL, UDWORD) \
+    X(VARROL, WORD) X(VARROL, UWORD) X(VARROL, BYTE) X(VARROL, UBYTE) \
+    X(VARDIV, QWORD) X(VARDIV, UQWORD) X(VARDIV, DWORD) X(VARDIV, UDWORD) \
+    X(VARDIV, WORD) X(VARDIV, UWORD) X(VARDIV, BYTE) X(VARDIV, UBYTE) \
+    X(VARDIV, FLOAT) X(VARDIV, DOUBLE) \
+    X(VARMOD, QWORD) X(VARMOD, UQWORD) X(VARMOD, DWORD) X(VARMOD, UDWORD) \
+    X(VARMOD, WORD) X(VARMOD, UWORD) X(VARMOD, BYTE) X(VARMOD, UBYTE) \
+    X(VARMOD, FLOAT) X(VARMOD, DOUBLE) \
+    X(STRACAT, NONE) \
+    X(INC, QWORD) X(INC, UQWORD) X(INC, DWORD) X(INC, UDWORD) \
+    X(INC, WORD) X(INC, UWORD) X(INC, BYTE) X(INC, UBYTE) \
+    X(INC, FLOAT) X(INC, DOUBLE) \
+    X(DEC, QWORD) X(DEC, UQWORD) X(DEC, DWORD) X(DEC, UDWORD) \
+    X(DEC, WORD) X(DEC, UWORD) X(DEC, BYTE) X(DEC, UBYTE) \
+    X(DEC, FLOAT) X(DEC, DOUBLE) \
+    X(POSTDEC, QWORD) X(POSTDEC, UQWORD) X(POSTDEC, DWORD) X(POSTDEC, UDWORD) \
+    X(POSTDEC, WORD) X(POSTDEC, UWORD) X(POSTDEC, BYTE) X(POSTDEC, UBYTE) \
+    X(POSTDEC, FLOAT) X(POSTDEC, DOUBLE) \
+    X(POSTINC, QWORD) X(POSTINC, UQWORD) X(POSTINC, DWORD) X(POSTINC, UDWORD) \
+    X(POSTINC, WORD) X(POSTINC, UWORD) X(POSTINC, BYTE) X(POSTINC, UBYTE) \
+    X(POSTINC, FLOAT) X(POSTINC, DOUBLE) \
+    X(JUMP, NONE) \
+    X(JTRUE, NONE) \
+    X(JFALSE, NONE) \
+    X(JTTRUE, NONE) \
+    X(JTFALSE, NONE) \
+    X(NCALL, NONE) \
+    X(SWITCH, NONE) X(SWITCH, STRING) \
+    X(CASE, NONE) X(CASE, STRING) \
+    X(CASE_R, NONE) X(CASE_R, STRING) \
+    X(JNOCASE, NONE) \
+    X(TYPE, NONE) \
+    X(FRAME, NONE) \
+    X(END, NONE) \
+    X(RETURN, NONE) \
+    X(EXITHNDLR, NONE) \
+    X(ERRHNDLR, NONE) \
+    X(DEBUG, NONE) \
+    X(SENTENCE, NONE) \
+    OPCODES_ALL_TYPES(X, COPY_ARRAY) \
+    OPCODES_ALL_TYPES(X, COPY_ARRAY_REPEAT) \
+    X(COPY_STRUCT, NONE)
+
+/* ---------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ *  Copyright (C) SplinterGU (Fenix/BennuGD) (Since 2006)
+ *
+ *  This file is part of Bennu Game Development
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+/*
+ * FILE        : jobs.c
+ * DESCRIPTION : Runs batches of parallel-safe instances on worker threads
+ *
+ * The compiler flags as PROC_PARALLEL the processes that only touch their
+ * own data and only call reentrant functions. Inside a scheduling pass the
+ * interpreter collects the consecutive ones in a batch, and runs it here
+ * before any other instance. The main thread works on the batch too, and
+ * waits until every instance reaches its FRAME (or its end).
+ *
+ * Workers can't touch the instance lists, so instances that end on a
+ * worker are marked JOB_DESTROY and destroyed here by the main thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+
+#include "bgdrtm.h"
+#include "jobs.h"
+
+/* --------------------------------------------------------------------------- */
+
+/* Instances taken by each worker at once */
+
+#define JOBS_CHUNK          8
+
+#ifdef USE_THREADS
+
+static pthread_t * jobs_threads = NULL;
+static int64_t jobs_threads_count = 0;
+
+static pthread_mutex_t jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobs_done = PTHREAD_COND_INITIALIZER;
+
+static INSTANCE ** jobs_list = NULL;
+static int64_t jobs_count = 0;
+static int64_t jobs_next = 0;
+
+static int64_t jobs_generation = 0;     /* Incremented for every batch */
+static int64_t jobs_busy = 0;           /* Workers still on the current batch */
+static int jobs_quit = 0;
+
+/* --------------------------------------------------------------------------- */
+
+/* Run chunks of the current batch until there are no more */
+
+static void jobs_work() {
+    int64_t n, last;
+
+    for ( ;; ) {
+        pthread_mutex_lock( &jobs_mutex );
+        n = jobs_next;
+        jobs_next += JOBS_CHUNK;
+        pthread_mutex_unlock( &jobs_mutex );
+
+        if ( n >= jobs_count ) break;
+
+        last = n + JOBS_CHUNK;
+        if ( last > jobs_count ) last = jobs_count;
+
+        for ( ; n < last; n++ ) instance_go( jobs_list[n] );
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void * jobs_worker( void * arg ) {
+    int64_t generation = 0;
+
+    pthread_mutex_lock( &jobs_mutex );
+    for ( ;; ) {
+        while ( !jobs_quit && generation == jobs_generation ) pthread_cond_wait( &jobs_start, &jobs_mutex );
+        if ( jobs_quit ) break;
+
+        generation = jobs_generation;
+        pthread_mutex_unlock( &jobs_mutex );
+
+        jobs_work();
+
+        pthread_mutex_lock( &jobs_mutex );
+        if ( !--jobs_busy ) pthread_cond_signal( &jobs_done );
+    }
+    pthread_mutex_unlock( &jobs_mutex );
+
+    return NULL;
+}
+
+#endif
+
+/* --------------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : jobs_init
+ *
+ *  Start the worker pool
+ *
+ *  PARAMS :
+ *      threads         Total threads running processes, including the
+ *                      main one (0 or 1 = no pool)
+ *
+ *  RETURN VALUE :
+ *      Number of worker threads started
+ */
+
+int64_t jobs_init( int64_t threads ) {
+#ifdef USE_THREADS
+    int64_t n;
+
+    if ( jobs_threads || threads < 2 ) return jobs_threads_count;
+
+    jobs_threads = ( pthread_t * ) malloc( sizeof( pthread_t ) * ( threads - 1 ) );
+    if ( !jobs_threads ) {
+        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+        exit( 2 );
+    }
+
+    for ( n = 0; n < threads - 1; n++ ) {
+        if ( pthread_create( &jobs_threads[ jobs_threads_count ], NULL, jobs_worker, NULL ) ) {
+            fprintf( stderr, "WARNING: can't create worker thread, using %" PRId64 "\n", jobs_threads_count );
+            break;
+        }
+        jobs_threads_count++;
+    }
+
+    return jobs_threads_count;
+#else
+    if ( threads > 1 ) fprintf( stderr, "WARNING: built without threads support, parallel processes run on the main thread\n" );
+    return 0;
+#endif
+}
+
+/* --------------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : jobs_active
+ *
+ *  RETURN VALUE :
+ *      1 if there are worker threads running
+ */
+
+int64_t jobs_active() {
+#ifdef USE_THREADS
+    return jobs_threads_count > 0;
+#else
+    return 0;
+#endif
+}
+
+/* --------------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : jobs_run
+ *
+ *  Run a batch of parallel-safe instances until all of them reach a FRAME
+ *  or end. Must be called from the main thread.
+ *
+ *  PARAMS :
+ *      list            Instances to run
+ *      count           Number of instances in the list
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void jobs_run( INSTANCE ** list, int64_t count ) {
+    int64_t n;
+
+#ifdef USE_THREADS
+    if ( jobs_threads_count && count >= JOBS_MIN_BATCH ) {
+        for ( n = 0; n < count; n++ ) list[n]->job = JOB_RUNNING;
+
+        pthread_mutex_lock( &jobs_mutex );
+        jobs_list = list;
+        jobs_count = count;
+        jobs_next = 0;
+        jobs_busy = jobs_threads_count;
+        jobs_generation++;
+        pthread_cond_broadcast( &jobs_start );
+        pthread_mutex_unlock( &jobs_mutex );
+
+        jobs_work();
+
+        pthread_mutex_lock( &jobs_mutex );
+        while ( jobs_busy ) pthread_cond_wait( &jobs_done, &jobs_mutex );
+        pthread_mutex_unlock( &jobs_mutex );
+
+        /* Finish what the workers couldn't do */
+        for ( n = 0; n < count; n++ ) {
+            if ( list[n]->job == JOB_DESTROY ) instance_destroy( list[n] );
+            else list[n]->job = JOB_NONE;
+        }
+        return;
+    }
+#endif
+
+    for ( n = 0; n < count; n++ ) instance_go( list[n] );
+}
+
+/* --------------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : jobs_exit
+ *
+ *  Stop the worker pool
+ *
+ *  PARAMS :
+ *      None
+ *
+ *  RETURN VALUE :
+ *      None
+ */
+
+void jobs_exit() {
+#ifdef USE_THREADS
+    int64_t n;
+
+    if ( !jobs_threads ) return;
+
+    pthread_mutex_lock( &jobs_mutex );
+    jobs_quit = 1;
+    pthread_cond_broadcast( &jobs_start );
+    pthread_mutex_unlock( &jobs_mutex );
+
+    for ( n = 0; n < jobs_threads_count; n++ ) pthread_join( jobs_threads[n], NULL );
+
+    free( jobs_threads );
+    jobs_threads = NULL;
+    jobs_threads_count = 0;
+    jobs_quit = 0;
+#endif
+}
+
+/* --------------------------------------------------------------------------- */
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) SplinterGU (Fenix/BennuGD) (Since 2006)
+ *
+ *  This file is part of Bennu Game Development
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+#ifndef __JOBS_H
+#define __JOBS_H
+
+#include "instance_st.h"
+
+/* --------------------------------------------------------------------------- */
+/* Worker pool for parallel-safe processes (PROC_PARALLEL)                     */
+/* --------------------------------------------------------------------------- */
+
+/* INSTANCE.job values */
+
+#define JOB_NONE            0
+#define JOB_RUNNING         1   /* Running on the pool */
+#define JOB_DESTROY         2   /* Finished on the pool, to be destroyed by the main thread */
+
+/* Smaller batches aren't worth waking the workers */
+
+#define JOBS_MIN_BATCH      32
+
+/* --------------------------------------------------------------------------- */
+
+extern int64_t jobs_init( int64_t threads );
+extern int64_t jobs_active();
+extern void jobs_run( INSTANCE ** list, int64_t count );
+extern void jobs_exit();
+
+/* --------------------------------------------------------------------------- */
+
+#endif
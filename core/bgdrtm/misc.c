@@ -40,6 +40,7 @@
 #include "dcb.h"
 #include "sysprocs_p.h"
 #include "xstrings.h"
+#include "jobs.h"
 
 #include "fmath.h"
 
@@ -68,6 +69,8 @@ int64_t debug = 0;  /* 1 if running in debug mode      */
 
 int64_t system_paused = 0;
 
+int64_t parallel_threads = 0;   /* Threads running parallel-safe processes (bgdi -j) */
+
 /* --------------------------------------------------------------------------- */
 
 /* os versions */
@@ -292,6 +295,8 @@ void bgdrtm_entry( int argc, char * argv[] ) {
 #endif
 
     init_cos_tables();
+
+    jobs_init( parallel_threads );
 }
 
 /* --------------------------------------------------------------------------- */
@@ -311,11 +316,17 @@ void bgdrtm_entry( int argc, char * argv[] ) {
 void bgdrtm_exit()
 {
     int n;
+
+    jobs_exit();
+
     /* Finalize all modules */
     if ( module_finalize_count )
         for ( n = 0; n < module_finalize_count; n++ )
             module_finalize_list[n]();
 
+    if ( debug ) instance_pool_dump();
+    instance_pool_release();
+
 #if defined(TARGET_GP2X_WIZ) || defined(TARGET_CAANOO)
     bgdrtm_ptimer_cleanup();
 
@@ -39,6 +39,7 @@
 #include <inttypes.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
 
 //#ifdef TARGET_BEOS
 //#include <posix/assert.h>
@@ -57,6 +58,35 @@
 #define bit_clr(m,b)    (((uint64_t *)(m))[(b)>>6] &= ~(1ULL<<((b)&0x3F)))
 #define bit_tst(m,b)    (((uint64_t *)(m))[(b)>>6] &   (1ULL<<((b)&0x3F)))
 
+/****************************************************************************/
+/* STRING DATA :                                                            */
+/****************************************************************************/
+/* Every string is a header, with its length, followed by the text. Short   */
+/* strings (the usual temporaries: numbers, names, HUD text) are stored in  */
+/* fixed size blocks taken from an arena, and recycled through a free list  */
+/* when discarded, so they never go through malloc(). Longer strings are    */
+/* allocated with malloc(). DCB fixed strings live in string_mem.           */
+/*                                                                          */
+/* The hash of the text is calculated the first time it's needed and kept  */
+/* in the header, so comparing for equality a string against the same ones  */
+/* (SWITCH/CASE, constants) only compares lengths and hashes most times.    */
+/****************************************************************************/
+
+typedef struct _string_data {
+    uint64_t len;                   /* Text length, without the '\0' */
+    uint64_t size;                  /* Room for text, with the '\0'. STRING_FIXED for DCB strings */
+    uint64_t hash;                  /* Hash of the text, 0 if not calculated yet */
+    unsigned char text[];
+} STRING_DATA;
+
+#define STRING_FIXED            0
+
+#define STRING_SMALL_BLOCK      64                                          /* Arena block size */
+#define STRING_SMALL_SIZE       ( STRING_SMALL_BLOCK - sizeof( STRING_DATA ) ) /* Room for text in an arena block */
+#define STRING_ARENA_BLOCKS     1024                                        /* Blocks per arena chunk */
+
+#define STRING_ALIGN(n)         ( ( ( n ) + 7 ) & ~7 )
+
 /****************************************************************************/
 /* STATIC VARIABLES :                                                       */
 /****************************************************************************/
@@ -66,7 +96,7 @@ static unsigned char    * string_mem = NULL;
 
 static int              string_reserved = 0;        /* Last fixed string */
 
-static unsigned char    ** string_ptr = NULL;       /* Pointers to each string's text. Every string is allocated using strdup() or malloc().
+static STRING_DATA      ** string_ptr = NULL;       /* Pointers to each string's data, from the arena or malloc().
                                                        A pointer of a unused slot is 0.
                                                        Exception: "fixed" strings are stored in a separate memory block and should not be freed */
 static uint64_t         * string_uct = NULL;        /* Usage count for each string. An unused slot has a count of 0 */
@@ -80,6 +110,8 @@ static int              string_bmp_start = 0;       /* Offset of assignable stri
 static int              string_last_id = 1;         /* How many strings slots are used. This is only the bigger id in use + 1.
                                                       There may be unused slots in this many positions */
 
+static STRING_DATA      * string_arena_free = NULL; /* Free arena blocks. The first bytes of the text keep the next one */
+
 /* --------------------------------------------------------------------------- */
 
 void _string_ptoa( unsigned char *t, void * ptr )  {
@@ -164,40 +196,188 @@ int64_t string_atop( unsigned char *str )  {
 
 /* --------------------------------------------------------------------------- */
 
-void _string_ntoa( unsigned char *p, uint64_t n ) {
-    unsigned char * i = p;
+/* Two digits at a time, "00" to "99" */
+
+static const char string_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* Writes n backwards, ending just before end. Returns where it starts */
 
-    p += 20; // Max int64 digits - 1
-    if ( ( int64_t ) n < 0 ) {
-        * i++ = '-';
-        n = ( uint64_t ) (- ( int64_t ) n );
+static inline unsigned char * string_utoa_back( unsigned char * end, uint64_t n ) {
+    while ( n >= 100 ) {
+        const char * d = &string_digit_pairs[ ( n % 100 ) * 2 ];
+        n /= 100;
+        *--end = d[1];
+        *--end = d[0];
+    }
+    if ( n >= 10 ) {
+        *--end = string_digit_pairs[ n * 2 + 1 ];
+        *--end = string_digit_pairs[ n * 2 ];
+    } else {
+        *--end = '0' + n;
     }
+    return end;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Returns the length of the text */
 
-    * p = '\0';
-    do {
-        * --p = '0' + ( n % 10LL );
-    } while ( n /= 10LL );
+static int string_ntoa_len( unsigned char *p, int64_t n ) {
+    unsigned char buf[24], * start = string_utoa_back( buf + sizeof( buf ), n < 0 ? 0 - ( uint64_t ) n : ( uint64_t ) n );
+    int len = buf + sizeof( buf ) - start;
 
-    if ( p > i ) while (( *i++ = *p++ ));
+    if ( n < 0 ) *p++ = '-';
+    memcpy( p, start, len );
+    p[len] = '\0';
+
+    return len + ( n < 0 );
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int string_utoa_len( unsigned char *p, uint64_t n ) {
+    unsigned char buf[24], * start = string_utoa_back( buf + sizeof( buf ), n );
+    int len = buf + sizeof( buf ) - start;
+
+    memcpy( p, start, len );
+    p[len] = '\0';
+
+    return len;
+}
+
+/* --------------------------------------------------------------------------- */
+
+void _string_ntoa( unsigned char *p, uint64_t n ) {
+    string_ntoa_len( p, ( int64_t ) n );
 }
 
 /* --------------------------------------------------------------------------- */
 
 void _string_utoa( unsigned char *p, uint64_t n ) {
-    unsigned char * i = p;
+    string_utoa_len( p, n );
+}
 
-    p += 20; // Max int64 digits - 1
+/* --------------------------------------------------------------------------- */
 
-    * p = '\0';
-    do {
-        * --p = '0' + ( n % 10LL );
-    } while ( n /= 10LL );
+/*
+ *  FUNCTION : _string_dtoa
+ *
+ *  Writes a double with a fixed number of decimals, with the same result
+ *  as sprintf( "%.*f" ). Values that can be scaled to an exact integer are
+ *  converted here, and sprintf() is only used for huge values, NaN/Inf and
+ *  the ones too close to a rounding tie.
+ *
+ *  PARAMS:
+ *              p           Buffer (384 bytes are enough for any value)
+ *              n           Value
+ *              dec         Number of decimals (0 to 9)
+ *
+ *  RETURN VALUE:
+ *      Length of the text
+ */
+
+int _string_dtoa( unsigned char *p, double n, int dec ) {
+    static const double scale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    unsigned char buf[40], * start, * end = buf + sizeof( buf );
+    double x, m, frac;
+    uint64_t v;
+    int len;
+
+    if ( dec < 0 || dec > 9 || !isfinite( n ) ) return sprintf( ( char * ) p, "%.*f", dec, n );
+
+    x = fabs( n ) * scale[dec];
+
+    /* The scaled value must be exact as integer, and not near .5 (the
+     * multiplication may have rounded it to the other side of the tie) */
+    if ( x >= 1e15 ) return sprintf( ( char * ) p, "%.*f", dec, n );
+    m = floor( x );
+    frac = x - m;
+    if ( fabs( frac - 0.5 ) <= x * 0x1p-50 + 0x1p-60 ) return sprintf( ( char * ) p, "%.*f", dec, n );
+
+    v = ( uint64_t ) m + ( frac > 0.5 );
+
+    /* Decimals, with leading zeros */
+    for ( int d = 0; d < dec; d++ ) {
+        *--end = '0' + v % 10;
+        v /= 10;
+    }
+    if ( dec ) *--end = '.';
+
+    start = string_utoa_back( end, v );
+    if ( signbit( n ) ) *--start = '-';
+
+    len = buf + sizeof( buf ) - start;
+    memcpy( p, start, len );
+    p[len] = '\0';
 
-    if ( p > i ) while (( *i++ = *p++ ) );
+    return len;
 }
 
 /* --------------------------------------------------------------------------- */
 
+/****************************************************************************/
+/* FUNCTION : string_data_new                                               */
+/****************************************************************************/
+/* uint64_t len: length of the text that will be stored                     */
+/****************************************************************************/
+/* Allocates the data of a string, from the arena if it's short enough.     */
+/* The text is not initialized, but it is '\0' terminated at len.          */
+/****************************************************************************/
+
+static STRING_DATA * string_data_new( uint64_t len ) {
+    STRING_DATA * s;
+
+    if ( len < STRING_SMALL_SIZE ) {
+        if ( !string_arena_free ) {
+            unsigned char * chunk = malloc( STRING_SMALL_BLOCK * STRING_ARENA_BLOCKS );
+            if ( !chunk ) {
+                fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+                exit( 2 );
+            }
+            /* Chunks are never released, their blocks are recycled */
+            for ( int n = STRING_ARENA_BLOCKS - 1; n >= 0; n-- ) {
+                s = ( STRING_DATA * ) ( chunk + n * STRING_SMALL_BLOCK );
+                *( STRING_DATA ** ) s->text = string_arena_free;
+                string_arena_free = s;
+            }
+        }
+        s = string_arena_free;
+        string_arena_free = *( STRING_DATA ** ) s->text;
+        s->size = STRING_SMALL_SIZE;
+    } else {
+        s = ( STRING_DATA * ) malloc( sizeof( STRING_DATA ) + len + 1 );
+        if ( !s ) {
+            fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+            exit( 2 );
+        }
+        s->size = len + 1;
+    }
+
+    s->len = len;
+    s->hash = 0;
+    s->text[len] = '\0';
+
+    return s;
+}
+
+/****************************************************************************/
+/* FUNCTION : string_data_free                                              */
+/****************************************************************************/
+/* Releases the data of a string. Fixed strings are not touched.            */
+/****************************************************************************/
+
+static void string_data_free( STRING_DATA * s ) {
+    if ( s->size == STRING_SMALL_SIZE ) {
+        *( STRING_DATA ** ) s->text = string_arena_free;
+        string_arena_free = s;
+    } else if ( s->size != STRING_FIXED ) {
+        free( s );
+    }
+}
+
 /****************************************************************************/
 /* FUNCTION : string_alloc                                                  */
 /****************************************************************************/
@@ -215,7 +395,7 @@ static void string_alloc( int count ) {
 
     string_allocated += count;
 
-    string_ptr = ( unsigned char ** ) realloc( string_ptr, string_allocated * sizeof( unsigned char * ) );
+    string_ptr = ( STRING_DATA ** ) realloc( string_ptr, string_allocated * sizeof( STRING_DATA * ) );
     string_uct = ( uint64_t * ) realloc( string_uct, string_allocated * sizeof( uint64_t ) );
     string_bmp = ( uint64_t * ) realloc( string_bmp, ( string_allocated >> 6 ) * sizeof( uint64_t ) );
 
@@ -260,14 +440,14 @@ void string_dump( int ( *wlog )( const char *fmt, ... ) ) {
         if ( bit_tst( string_bmp, i ) && string_ptr[i] ) {
             if ( !string_uct[i] ) {
                 if ( i >= string_reserved ) {
-                    free( string_ptr[i] );
+                    string_data_free( string_ptr[i] );
                     string_ptr[i] = NULL;
                     bit_clr( string_bmp, i );
                 }
                 continue;
             }
             used++;
-            wlog( "[STRING] %4d %6" PRId64 " %6s {%s}\n", i, string_uct[i], ( i >= string_reserved ) ? "" : "STATIC", string_ptr[i] );
+            wlog( "[STRING] %4d %6" PRId64 " %6s {%s}\n", i, string_uct[i], ( i >= string_reserved ) ? "" : "STATIC", string_ptr[i]->text );
         }
     }
 
@@ -284,7 +464,7 @@ void string_dump( int ( *wlog )( const char *fmt, ... ) ) {
 /* valid while no other string function is called.                          */
 /****************************************************************************/
 
-const unsigned char * string_get( int64_t code ) {
+static inline STRING_DATA * string_data_get( int64_t code ) {
 //    assert( code < string_allocated && code >= 0 );
     if ( code >= string_allocated || code < 0 ) {
         fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
@@ -293,10 +473,29 @@ const unsigned char * string_get( int64_t code ) {
     return string_ptr[code];
 }
 
+const unsigned char * string_get( int64_t code ) {
+    STRING_DATA * s = string_data_get( code );
+    return s ? s->text : NULL;
+}
+
+/****************************************************************************/
+/* FUNCTION : string_length                                                 */
+/****************************************************************************/
+/* int code: identifier of the string                                       */
+/****************************************************************************/
+/* Returns the length of a string, without counting its characters.         */
+/****************************************************************************/
+
+int64_t string_length( int64_t code ) {
+    STRING_DATA * s = string_data_get( code );
+    return s ? s->len : 0;
+}
+
 /****************************************************************************/
 /* FUNCTION : string_load                                                   */
 /****************************************************************************/
-/* file * fp: the DCB file (must be opened)                                 */
+/* offsets: offset of every string in text (DCB byte order)                 */
+/* text: the text area of the DCB, already in memory                        */
 /*                                                                          */
 /* This function uses the global "dcb" struct. It should be already filled. */
 /****************************************************************************/
@@ -306,35 +505,44 @@ const unsigned char * string_get( int64_t code ) {
 /* all this data and allocates memory if needed.                            */
 /****************************************************************************/
 
-void string_load( void * fp, int64_t ostroffs, int64_t ostrdata, int64_t nstrings, int64_t totalsize ) {
-    uint64_t * string_offset;
+void string_load( const void * offsets, const void * text, int64_t nstrings, int64_t totalsize ) {
+    const unsigned char * t = ( const unsigned char * ) text;
+    unsigned char * ptr;
+    uint64_t size = 0, offset;
     int n;
 
-    string_mem = malloc( totalsize );
-    if ( !string_mem ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
+    if ( string_last_id + nstrings > string_allocated )
+        string_alloc((( string_last_id + nstrings - string_allocated ) / BLOCK_INCR + 1 ) * BLOCK_INCR );
+
+    /* Each text is stored again after its header */
+    for ( n = 0; n < nstrings; n++ ) {
+        memcpy( &offset, ( const uint64_t * ) offsets + n, sizeof( offset ) );
+        ARRANGE_QWORD( &offset );
+        if ( offset > ( uint64_t ) totalsize ) offset = totalsize;
+        size += STRING_ALIGN( sizeof( STRING_DATA ) + strnlen( ( const char * ) t + offset, totalsize - offset ) + 1 );
     }
-//    assert( string_mem );
 
-    string_offset = ( uint64_t * ) malloc( sizeof( uint64_t ) * nstrings );
-    if ( !string_offset ) {
+    string_mem = malloc( size );
+    if ( size && !string_mem ) {
         fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
         exit(2);
     }
-//    assert( string_offset );
-
-    file_seek(( file * )fp, ostroffs, SEEK_SET );
-    file_readUint64A(( file * )fp, string_offset, nstrings );
-
-    if ( string_last_id + nstrings > string_allocated )
-        string_alloc((( string_last_id + nstrings - string_allocated ) / BLOCK_INCR + 1 ) * BLOCK_INCR );
-
-    file_seek(( file * )fp, ostrdata, SEEK_SET );
-    file_read(( file * )fp, string_mem, totalsize );
+//    assert( string_mem );
 
+    ptr = string_mem;
     for ( n = 0; n < nstrings; n++ ) {
-        string_ptr[string_last_id + n] = string_mem + string_offset[n];
+        STRING_DATA * sd = ( STRING_DATA * ) ptr;
+        memcpy( &offset, ( const uint64_t * ) offsets + n, sizeof( offset ) );
+        ARRANGE_QWORD( &offset );
+        if ( offset > ( uint64_t ) totalsize ) offset = totalsize;
+        sd->len = strnlen( ( const char * ) t + offset, totalsize - offset );
+        sd->size = STRING_FIXED;
+        sd->hash = 0;
+        memcpy( sd->text, t + offset, sd->len );
+        sd->text[sd->len] = '\0';
+        ptr += STRING_ALIGN( sizeof( STRING_DATA ) + sd->len + 1 );
+
+        string_ptr[string_last_id + n] = sd;
         string_uct[string_last_id + n] = 0;
         bit_set( string_bmp, string_last_id + n );
     }
@@ -345,8 +553,6 @@ void string_load( void * fp, int64_t ostroffs, int64_t ostrdata, int64_t nstring
 
     string_reserved = string_last_id;
     string_bmp_start = string_last_id >> 6;
-
-    free( string_offset );
 }
 
 /****************************************************************************/
@@ -381,7 +587,7 @@ void string_discard( int64_t code ) {
 
     if ( !string_uct[code] ) {
         if ( code >= string_reserved ) {
-            free( string_ptr[code] );
+            string_data_free( string_ptr[code] );
             string_ptr[code] = NULL;
             bit_clr( string_bmp, code );
         }
@@ -441,28 +647,33 @@ static int64_t string_getid() {
 }
 
 /****************************************************************************/
-/* FUNCTION : string_new                                                    */
+/* FUNCTION : string_store                                                  */
 /****************************************************************************/
-/* Create a new string. It returns its ID. Note that it uses strdup()       */
+/* Gives an ID to a new string data and returns it.                         */
 /****************************************************************************/
 
-int64_t string_new( const char * ptr ) {
-    unsigned char * str = strdup( ptr );
-    int64_t id;
+static int64_t string_store( STRING_DATA * s ) {
+    int64_t id = string_getid();
 
-    if ( !str ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
+    string_ptr[id] = s;
+    string_uct[id] = 0;
 
-//    assert( str );
+    return id;
+}
 
-    id = string_getid();
+/****************************************************************************/
+/* FUNCTION : string_new                                                    */
+/****************************************************************************/
+/* Create a new string. It returns its ID. The text is copied.              */
+/****************************************************************************/
 
-    string_ptr[id] = str;
-    string_uct[id] = 0;
+int64_t string_new( const char * ptr ) {
+    uint64_t len = strlen( ptr );
+    STRING_DATA * s = string_data_new( len );
 
-    return id;
+    memcpy( s->text, ptr, len );
+
+    return string_store( s );
 }
 
 /*
@@ -479,61 +690,99 @@ int64_t string_new( const char * ptr ) {
  */
 
 int64_t string_newa( const unsigned char * ptr, unsigned count ) {
-    unsigned char * str = malloc( count + 1 );
-    int64_t id;
+    const unsigned char * end = memchr( ptr, '\0', count );
+    STRING_DATA * s;
 
-    if ( !str ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( str );
-    id = string_getid();
+    /* Stop at the first '\0', as strncpy() did */
+    if ( end ) count = end - ptr;
 
-    strncpy( str, ptr, count );
-    str[count] = '\0';
-    string_ptr[id] = str;
-    string_uct[id] = 0;
+    s = string_data_new( count );
+    memcpy( s->text, ptr, count );
 
-    return id;
+    return string_store( s );
 }
 
 /****************************************************************************/
-/* FUNCTION : string_concat                                                 */
+/* FUNCTION : string_data_append                                            */
 /****************************************************************************/
-/* Add some text to an string and return the resulting string. This does not*/
-/* modify the original string, but creates a new one.                       */
+/* Appends len bytes of text to the string code, in place. The room for the */
+/* text grows exponentially, so building a string piece by piece doesn't    */
+/* copy it every time.                                                      */
 /****************************************************************************/
 
-int64_t string_concat( int64_t code1, unsigned char * str2 ) {
-    unsigned char * str1;
-    int len1, len2;
+static void string_data_append( int64_t code, const unsigned char * text, uint64_t len ) {
+    STRING_DATA * s1 = string_ptr[code], * s;
+    uint64_t size;
 
-    if ( code1 >= string_allocated || code1 < 0 ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
-        exit(2);
+    if ( s1->len + len < s1->size ) {
+        /* Fits in place */
+        memmove( s1->text + s1->len, text, len );
+        s1->len += len;
+        s1->text[s1->len] = '\0';
+        s1->hash = 0;
+        return;
     }
-//    assert( code1 < string_allocated && code1 >= 0 );
 
-    str1 = string_ptr[code1];
-    if ( !str1 ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
-        exit(2);
+    if ( s1->len + len < STRING_SMALL_SIZE ) {
+        /* Fixed string, still short */
+        s = string_data_new( s1->len + len );
+        memcpy( s->text, s1->text, s1->len );
+        memcpy( s->text + s1->len, text, len );
+        string_ptr[code] = s;
+        return;
     }
-//    assert( str1 );
 
-    len1 = strlen( str1 );
-    len2 = strlen( str2 ) + 1;
+    size = s1->size * 2;
+    if ( size < s1->len + len + 1 ) size = s1->len + len + 1;
+
+    if ( s1->size != STRING_FIXED && s1->size != STRING_SMALL_SIZE ) {
+        /* Text may be part of the string itself (s += s) */
+        if ( text >= s1->text && text < s1->text + s1->len ) {
+            uint64_t offset = text - s1->text;
+            s = ( STRING_DATA * ) realloc( s1, sizeof( STRING_DATA ) + size );
+            if ( s ) text = s->text + offset;
+        } else {
+            s = ( STRING_DATA * ) realloc( s1, sizeof( STRING_DATA ) + size );
+        }
+        s1 = NULL;
+    } else {
+        s = ( STRING_DATA * ) malloc( sizeof( STRING_DATA ) + size );
+        if ( s ) {
+            memcpy( s->text, s1->text, s1->len );
+            s->len = s1->len;
+        }
+    }
 
-    str1 = ( char * ) realloc( str1, len1 + len2 );
-    if ( !str1 ) {
+    if ( !s ) {
         fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
         exit(2);
     }
-//    assert( str1 );
 
-    memmove( str1 + len1, str2, len2 );
+    s->size = size;
+    s->hash = 0;
+    memcpy( s->text + s->len, text, len );
+    s->len += len;
+    s->text[s->len] = '\0';
 
-    string_ptr[code1] = str1;
+    if ( s1 ) string_data_free( s1 );
+    string_ptr[code] = s;
+}
+
+/****************************************************************************/
+/* FUNCTION : string_concat                                                 */
+/****************************************************************************/
+/* Add some text to an string and return the resulting string. This does    */
+/* modify the original string.                                              */
+/****************************************************************************/
+
+int64_t string_concat( int64_t code1, unsigned char * str2 ) {
+    if ( !string_data_get( code1 ) ) {
+        fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
+        exit(2);
+    }
+//    assert( string_ptr[code1] );
+
+    string_data_append( code1, str2, strlen( str2 ) );
 
     return code1;
 }
@@ -546,36 +795,88 @@ int64_t string_concat( int64_t code1, unsigned char * str2 ) {
 /****************************************************************************/
 
 int64_t string_add( int64_t code1, int64_t code2 ) {
-    const unsigned char * str1 = string_get( code1 );
-    const unsigned char * str2 = string_get( code2 );
-    unsigned char * str3;
-    int64_t id;
-    int len1, len2;
+    STRING_DATA * s1 = string_data_get( code1 );
+    STRING_DATA * s2 = string_data_get( code2 );
+    STRING_DATA * s3;
 
-    if ( !str1 || !str2 ) {
+    if ( !s1 || !s2 ) {
         fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
         exit(2);
     }
-//    assert( str1 );
-//    assert( str2 );
+//    assert( s1 );
+//    assert( s2 );
 
-    len1 = strlen( str1 );
-    len2 = strlen( str2 ) + 1;
+    s3 = string_data_new( s1->len + s2->len );
 
-    str3 = ( char * ) malloc( len1 + len2 );
-    if ( !str3 ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+    memcpy( s3->text, s1->text, s1->len );
+    memcpy( s3->text + s1->len, s2->text, s2->len );
+
+    return string_store( s3 );
+}
+
+/****************************************************************************/
+/* FUNCTION : string_append                                                 */
+/****************************************************************************/
+/* Add an string to another one. If the first one is used only once (by the */
+/* variable or the stack slot that is going to receive the result) its text */
+/* is extended in place and its ID is returned, so building a string in a   */
+/* loop is not quadratic. Otherwise it works as string_add().               */
+/****************************************************************************/
+
+int64_t string_append( int64_t code1, int64_t code2 ) {
+    STRING_DATA * s1 = string_data_get( code1 );
+    STRING_DATA * s2 = string_data_get( code2 );
+
+    if ( !s1 || !s2 ) {
+        fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
         exit(2);
     }
-//    assert( str3 );
 
-    memmove( str3, str1, len1 );
-    memmove( str3 + len1, str2, len2 );
+    if ( string_uct[code1] != 1 || code1 < string_reserved || code1 == code2 ) return string_add( code1, code2 );
 
-    id = string_getid();
+    string_data_append( code1, s2->text, s2->len );
 
-    string_ptr[id] = str3;
-    string_uct[id] = 0;
+    return code1;
+}
+
+/****************************************************************************/
+/* FUNCTION : string_cache_get / string_cache_set                           */
+/****************************************************************************/
+/* Small direct-mapped caches of the last numbers converted to text, as     */
+/* the same values (scores, counters, coordinates...) are usually printed   */
+/* frame after frame. Each entry holds a use of its string, so a cached     */
+/* string is never the only user of itself and it is never appended in      */
+/* place. The strings are discarded when their entry is replaced.           */
+/****************************************************************************/
+
+#define STRING_CACHE_SIZE   256
+
+typedef struct {
+    uint64_t key;
+    int64_t id;
+} STRING_CACHE;
+
+static STRING_CACHE string_itoa_cache[STRING_CACHE_SIZE];
+static STRING_CACHE string_ftoa_cache[STRING_CACHE_SIZE];
+
+#define string_cache_entry(cache,key)  (&(cache)[ ( ( uint64_t ) (key) * 0x9E3779B97F4A7C15ULL ) >> 56 ])
+
+static inline int64_t string_cache_get( STRING_CACHE * cache, uint64_t key ) {
+    STRING_CACHE * e = string_cache_entry( cache, key );
+
+    /* id 0 is never cached, it's an empty entry */
+    return ( e->id && e->key == key && string_ptr[e->id] ) ? e->id : -1;
+}
+
+static int64_t string_cache_set( STRING_CACHE * cache, uint64_t key, int64_t id ) {
+    STRING_CACHE * e = string_cache_entry( cache, key );
+
+    if ( !id ) return id;
+    if ( e->id ) string_discard( e->id );
+
+    e->key = key;
+    e->id = id;
+    string_use( id );
 
     return id;
 }
@@ -587,23 +888,11 @@ int64_t string_add( int64_t code1, int64_t code2 ) {
 /****************************************************************************/
 
 int64_t string_ptoa( void * n ) {
-    unsigned char * str;
-    int64_t id;
+    STRING_DATA * s = string_data_new( 16 );
 
-    str = ( unsigned char * ) malloc( 17 );
-    if ( !str ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( str ) ;
-
-    _string_ptoa( str, n );
+    _string_ptoa( s->text, n );
 
-    id = string_getid();
-    string_ptr[id] = str;
-    string_uct[id] = 0;
-
-    return id;
+    return string_store( s );
 }
 
 /****************************************************************************/
@@ -613,16 +902,14 @@ int64_t string_ptoa( void * n ) {
 /****************************************************************************/
 
 int64_t string_ftoa( double n ) {
-    unsigned char * str = ( unsigned char * ) malloc( 384 ), * ptr = str;
+    unsigned char str[384], * ptr = str;
+    uint64_t bits;
     int64_t id;
 
-    if ( !str ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( str ) ;
+    memcpy( &bits, &n, sizeof( bits ) );
+    if ( ( id = string_cache_get( string_ftoa_cache, bits ) ) != -1 ) return id;
 
-    ptr += sprintf( str, "%lf", n ) - 1;
+    ptr += _string_dtoa( str, n, 6 ) - 1;
 
     while ( ptr >= str ) {
         if ( *ptr != '0' ) break;
@@ -634,11 +921,7 @@ int64_t string_ftoa( double n ) {
         *( str + 1 ) = '\0';
     }
 
-    id = string_getid();
-    string_ptr[id] = str;
-    string_uct[id] = 0;
-
-    return id;
+    return string_cache_set( string_ftoa_cache, bits, string_new( str ) );
 }
 
 /****************************************************************************/
@@ -648,23 +931,16 @@ int64_t string_ftoa( double n ) {
 /****************************************************************************/
 
 int64_t string_itoa( int64_t n ) {
-    unsigned char * str;
+    STRING_DATA * s;
+    unsigned char str[22];
     int64_t id;
 
-    str = ( unsigned char * ) malloc( 22 );
-    if ( !str ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( str ) ;
+    if ( ( id = string_cache_get( string_itoa_cache, n ) ) != -1 ) return id;
 
-    _string_ntoa( str, n );
-
-    id = string_getid();
-    string_ptr[id] = str;
-    string_uct[id] = 0;
+    s = string_data_new( string_ntoa_len( str, n ) );
+    memcpy( s->text, str, s->len );
 
-    return id;
+    return string_cache_set( string_itoa_cache, n, string_store( s ) );
 }
 
 /****************************************************************************/
@@ -674,35 +950,77 @@ int64_t string_itoa( int64_t n ) {
 /****************************************************************************/
 
 int64_t string_uitoa( uint64_t n ) {
-    unsigned char * str;
-    int64_t id;
+    STRING_DATA * s;
+    unsigned char str[22];
 
-    str = ( unsigned char * ) malloc( 22 );
-    if ( !str ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( str ) ;
-
-    _string_utoa( str, n );
+    /* Same text as the signed ones */
+    if ( n <= INT64_MAX ) return string_itoa( n );
 
-    id = string_getid();
-    string_ptr[id] = str;
-    string_uct[id] = 0;
+    s = string_data_new( string_utoa_len( str, n ) );
+    memcpy( s->text, str, s->len );
 
-    return id;
+    return string_store( s );
 }
 
 /****************************************************************************/
 /* FUNCTION : string_comp                                                   */
 /****************************************************************************/
-/* Compare two strings using strcmp and return the result                   */
+/* Compare two strings as strcmp does and return the result                 */
 /****************************************************************************/
 
 int64_t string_comp( int64_t code1, int64_t code2 ) {
-    const unsigned char * str1 = string_get( code1 );
-    const unsigned char * str2 = string_get( code2 );
-    return strcmp( str1, str2 );
+    STRING_DATA * s1 = string_data_get( code1 );
+    STRING_DATA * s2 = string_data_get( code2 );
+
+    if ( s1 == s2 ) return 0;
+
+    /* The '\0' of the shorter one ends the comparison */
+    return memcmp( s1->text, s2->text, ( s1->len < s2->len ? s1->len : s2->len ) + 1 );
+}
+
+/****************************************************************************/
+/* FUNCTION : string_data_hash                                              */
+/****************************************************************************/
+/* Returns the hash of a string (FNV-1a), calculating it if needed.         */
+/* Never returns 0.                                                         */
+/****************************************************************************/
+
+static inline uint64_t string_data_hash( STRING_DATA * s ) {
+    if ( !s->hash ) {
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for ( uint64_t n = 0; n < s->len; n++ ) h = ( h ^ s->text[n] ) * 0x100000001B3ULL;
+        s->hash = h ? h : 1;
+    }
+    return s->hash;
+}
+
+/****************************************************************************/
+/* FUNCTION : string_equal                                                  */
+/****************************************************************************/
+/* Returns 1 if both strings have the same text. Strings with different     */
+/* length or hash are discarded without looking at the text.                */
+/****************************************************************************/
+
+int64_t string_equal( int64_t code1, int64_t code2 ) {
+    STRING_DATA * s1 = string_data_get( code1 );
+    STRING_DATA * s2 = string_data_get( code2 );
+
+    if ( s1 == s2 ) return 1;
+    if ( !s1 || !s2 || s1->len != s2->len ) return 0;
+    if ( string_data_hash( s1 ) != string_data_hash( s2 ) ) return 0;
+
+    return !memcmp( s1->text, s2->text, s1->len );
+}
+
+/****************************************************************************/
+/* FUNCTION : string_hash                                                   */
+/****************************************************************************/
+/* Returns the hash of a string. The text must not be modified after that.  */
+/****************************************************************************/
+
+uint64_t string_hash( int64_t code ) {
+    STRING_DATA * s = string_data_get( code );
+    return s ? string_data_hash( s ) : 0;
 }
 
 /****************************************************************************/
@@ -725,7 +1043,7 @@ uint64_t string_char( int64_t n, int nchar ) {
 //    assert( str );
 
     if ( nchar < 0 ) {
-        nchar = strlen( str ) + nchar;
+        nchar = string_ptr[n]->len + nchar;
         if ( nchar < 0 ) return 0;
     }
 
@@ -746,16 +1064,15 @@ uint64_t string_char( int64_t n, int nchar ) {
 
 int64_t string_substr( int64_t code, int first, int len ) {
     const unsigned char * str = string_get( code );
-    unsigned char * ptr;
+    STRING_DATA * s;
     int rlen;
-    int64_t n;
 
     if ( !str ) {
         fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
         exit(2);
     }
 
-    rlen = strlen( str );
+    rlen = string_ptr[code]->len;
 
     if ( first < 0 ) {
         first = rlen + first;
@@ -770,19 +1087,10 @@ int64_t string_substr( int64_t code, int first, int len ) {
 
     if ( first + len > rlen ) len = ( rlen - first );
 
-    ptr = ( unsigned char * ) malloc( len + 1 );
-    if ( !ptr ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-    memcpy( ptr, str + first, len );
-    ptr[len] = '\0';
-
-    n = string_getid();
-    string_ptr[n] = ptr;
-    string_uct[n] = 0;
+    s = string_data_new( len );
+    memcpy( s->text, str + first, len );
 
-    return n;
+    return string_store( s );
 }
 
 /*
@@ -804,7 +1112,8 @@ int64_t string_substr( int64_t code, int first, int len ) {
 int64_t string_find( int64_t code1, int64_t code2, int first ) {
     unsigned char * str1 = ( unsigned char * ) string_get( code1 );
     unsigned char * str2 = ( unsigned char * ) string_get( code2 );
-    unsigned char * p = str1, * p1, * p2;
+    unsigned char * p = str1, * end;
+    int64_t len1, len2;
 
     if ( !str1 || !str2 ) {
         fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
@@ -812,29 +1121,26 @@ int64_t string_find( int64_t code1, int64_t code2, int first ) {
     }
 //    assert( str1 && str2 );
 
+    len1 = string_ptr[code1]->len;
+    len2 = string_ptr[code2]->len;
+
     if ( first < 0 ) {
-        first += strlen( str1 );
+        first += len1;
         if ( first < 0 ) return -1;
-        str1 += first;
     } else {
-        /* Avoid use strlen */
-        while ( first-- && *str1 ) str1++;
-        if ( !*str1 ) return -1;
+        if ( first >= len1 ) return -1;
     }
 
-    while ( *str1 ) {
-        if ( *str1 == *str2 ) {
-            p1 = str1 + 1;
-            p2 = str2 + 1;
+    /* An empty substring is never found */
+    if ( !len2 ) return -1;
 
-            while ( *p1 && *p2 && *p1 == *p2 )
-            {
-                p1++;
-                p2++;
-            }
-            if ( !*p2 ) return str1 - p;
-        }
-        str1++;
+    /* Last position where the substring still fits */
+    end = p + len1 - len2;
+
+    for ( str1 = p + first; str1 <= end; str1++ ) {
+        str1 = memchr( str1, *str2, end - str1 + 1 );
+        if ( !str1 ) break;
+        if ( !memcmp( str1 + 1, str2 + 1, len2 - 1 ) ) return str1 - p;
     }
 
     return -1;
@@ -865,8 +1171,8 @@ int64_t string_rfind(int64_t code1, int64_t code2, int first) {
         exit(2);
     }
 
-    int64_t len_str1 = strlen( str1 );
-    int64_t len_str2 = strlen( str2 );
+    int64_t len_str1 = string_ptr[code1]->len;
+    int64_t len_str2 = string_ptr[code2]->len;
 
     if ( first < 0 ) {
         first = -( first + 1 );
@@ -914,8 +1220,8 @@ int64_t string_rfind(int64_t code1, int64_t code2, int first) {
 
 int64_t string_ucase( int64_t code ) {
     const unsigned char * str = string_get( code );
-    unsigned char * base, * ptr;
-    int64_t id;
+    unsigned char * ptr;
+    STRING_DATA * s;
 
     if ( !str ) {
         fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
@@ -923,21 +1229,11 @@ int64_t string_ucase( int64_t code ) {
     }
 //    assert( str );
 
-    base = ( unsigned char * ) malloc( strlen( str ) + 1 );
-    if ( !base ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( base );
-
-    for ( ptr = base; *str; ptr++, str++ ) *ptr = TOUPPER( *str );
-    ptr[0] = '\0';
+    s = string_data_new( string_ptr[code]->len );
 
-    id = string_getid();
-    string_ptr[id] = base;
-    string_uct[id] = 0;
+    for ( ptr = s->text; *str; ptr++, str++ ) *ptr = TOUPPER( *str );
 
-    return id;
+    return string_store( s );
 }
 
 /*
@@ -955,8 +1251,8 @@ int64_t string_ucase( int64_t code ) {
 
 int64_t string_lcase( int64_t code ) {
     const unsigned char * str = string_get( code );
-    unsigned char * base, * ptr;
-    int64_t id;
+    unsigned char * ptr;
+    STRING_DATA * s;
 
     if ( !str ) {
         fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
@@ -964,21 +1260,11 @@ int64_t string_lcase( int64_t code ) {
     }
 //    assert( str );
 
-    base = ( unsigned char * ) malloc( strlen( str ) + 1 );
-    if ( !base ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( base );
+    s = string_data_new( string_ptr[code]->len );
 
-    for ( ptr = base; *str; ptr++, str++ ) *ptr = TOLOWER( *str );
-    ptr[0] = '\0';
+    for ( ptr = s->text; *str; ptr++, str++ ) *ptr = TOLOWER( *str );
 
-    id = string_getid();
-    string_ptr[id] = base;
-    string_uct[id] = 0;
-
-    return id;
+    return string_store( s );
 }
 
 /*
@@ -994,24 +1280,20 @@ int64_t string_lcase( int64_t code ) {
  */
 
 int64_t string_strip( int64_t code ) {
-    const unsigned char * str = string_get( code );
-    unsigned char * base, * ptr;
-    int64_t id = string_new( str );
+    const unsigned char * str = string_get( code ), * end;
 
-    ptr = base = ( unsigned char * )string_get( id );
-
-    if ( !ptr ) {
+    if ( !str ) {
         fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
         exit(2);
     }
-//    assert( ptr );
+//    assert( str );
+
+    end = str + string_ptr[code]->len;
 
     while ( *str == ' ' || *str == '\n' || *str == '\r' || *str == '\t' ) str++;
-    while ( *str ) *ptr++ = *str++;
-    while ( ptr > base && ( ptr[-1] == ' ' || ptr[-1] == '\n' || ptr[-1] == '\r' || ptr[-1] == '\t' ) ) ptr--;
-    *ptr = '\0';
+    while ( end > str && ( end[-1] == ' ' || end[-1] == '\n' || end[-1] == '\r' || end[-1] == '\t' ) ) end--;
 
-    return id;
+    return string_newa( str, end - str );
 }
 
 /*
@@ -1028,19 +1310,12 @@ int64_t string_strip( int64_t code ) {
  */
 
 int64_t string_format( double number, int dec, char point, char thousands ) {
-    unsigned char * str = malloc( 384 );
+    unsigned char str[384];
     unsigned char * s = str, * t, * p = NULL;
     int c, neg;
-    int64_t id;
-
-    if ( !str ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( str );
 
-    if ( dec == -1 ) s += sprintf( str, "%f", number );
-    else             s += sprintf( str, "%.*f", dec, number );
+    if ( dec == -1 ) dec = 6;
+    s += _string_dtoa( str, number, dec );
 
     neg = (*str == '-') ? 1 : 0;
 
@@ -1071,12 +1346,7 @@ int64_t string_format( double number, int dec, char point, char thousands ) {
         *t-- = *s--;
     }
 
-    id = string_getid();
-
-    string_ptr[id] = str;
-    string_uct[id] = 0;
-
-    return id;
+    return string_new( str );
 }
 
 /*
@@ -1123,40 +1393,29 @@ int64_t string_casecmp( int64_t code1, int64_t code2 ) {
 int64_t string_pad( int64_t code, int total, int align ) {
     const unsigned char * ptr = string_get( code );
     int len, spaces = 0;
-    int64_t id;
-    unsigned char * str;
+    STRING_DATA * s;
 
     if ( !ptr ) {
         fprintf( stderr, "ERROR: Runtime error - %s: internal error\n", __FUNCTION__ );
         exit(2);
     }
 //    assert( ptr );
-    len = strlen( ptr );
+    len = string_ptr[code]->len;
     if ( len < total ) spaces = total - len;
 
-    if ( !spaces ) return string_new( ptr );
+    if ( !spaces ) return string_newa( ptr, len );
 
-    str = malloc( total + 1 );
-    if ( !str ) {
-        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
-        exit(2);
-    }
-//    assert( str );
+    s = string_data_new( total );
 
     if ( !align ) {
-        memset( str, ' ', spaces );
-        strcpy( str + spaces, ptr );
+        memset( s->text, ' ', spaces );
+        memcpy( s->text + spaces, ptr, len );
     } else {
-        strcpy( str, ptr );
-        memset( str + len, ' ', spaces );
-        str[total] = '\0';
+        memcpy( s->text, ptr, len );
+        memset( s->text + len, ' ', spaces );
     }
 
-    id = string_getid();
-    string_ptr[id] = str;
-    string_uct[id] = 0;
-
-    return id;
+    return string_store( s );
 }
 
 /*
@@ -32,6 +32,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <inttypes.h>
+
+#ifdef _WIN32
+#include <process.h>
+#endif
 
 #include "bgdrtm.h"
 #include "dcb.h"
@@ -104,6 +109,7 @@ int64_t module_finalize_count = 0;
 /* ---------------------------------------------------------------------- */
 
 static SYSPROC ** sysproc_tab = NULL;
+static int64_t sysproc_tab_count = 0;
 
 /* ---------------------------------------------------------------------- */
 
@@ -132,7 +138,6 @@ static const char * token_ptr = NULL;
 
 static void get_token() {
     char * ptr;
-    unsigned int n;
 
     while ( isspace( *token_ptr ) ) token_ptr++;
 
@@ -159,13 +164,9 @@ static void get_token() {
         while ( ISWORDCHAR( *token_ptr ) ) *ptr++ = TOUPPER( *token_ptr++ );
     *ptr = 0;
 
-    for ( n = 0; n < dcb.data.NID; n++ ) {
-        if ( strcmp( (const char *)dcb.id[n].Name, token.name ) == 0 ) {
-            token.type = IDENTIFIER;
-            token.code = dcb.id[n].Code;
-            strcpy( token.name, (char *)dcb.id[n].Name );
-            return;
-        }
+    if ( ( token.code = getid( token.name ) ) != -1 ) {
+        token.type = IDENTIFIER;
+        return;
     }
 
     token.type = NOTOKEN;
@@ -420,6 +421,7 @@ int64_t sysproc_add( char * name, char * paramtypes, int64_t type, void * func )
 /* ---------------------------------------------------------------------- */
 
 SYSPROC * sysproc_get( int64_t code ) {
+    if ( code < 0 || code >= sysproc_tab_count ) return NULL;
     return sysproc_tab[code];
 }
 
@@ -458,6 +460,230 @@ static char * dlsearchpath[] = {
 
 /* ---------------------------------------------------------------------- */
 
+/* Fixup cache
+ *
+ * When BGDI_CACHE names a directory, the resolved variable fixups and the
+ * codes of the system functions are saved there, in a file named after the
+ * hash of the DCB. Each module's record holds a hash of the interface it
+ * exports, so a later run of the same DCB applies the cached values for as
+ * long as its modules export the same things, and resolves them otherwise.
+ */
+
+#define FIXCACHE_MAGIC      0x3143584644474201LL    /* "\1BGDFXC1" */
+
+static uint8_t * fixcache_in = NULL;
+static int64_t fixcache_in_pos = 0;
+static int64_t fixcache_in_size = -1;   /* -1 after the first mismatch */
+
+static uint8_t * fixcache_out = NULL;
+static int64_t fixcache_out_size = 0;
+static int64_t fixcache_out_allocated = 0;
+
+static char fixcache_name[ __MAX_PATH ];
+
+/* ---------------------------------------------------------------------- */
+
+static uint64_t fixcache_hash( uint64_t h, const char * str ) {
+    if ( !str ) return h * 1099511628211ULL;
+    while ( *str ) h = ( h ^ ( uint8_t ) *str++ ) * 1099511628211ULL;
+    return ( h ^ 0xff ) * 1099511628211ULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* Returns the next size bytes of the cache, or NULL once it doesn't match */
+
+static void * fixcache_get( int64_t size ) {
+    void * data;
+    if ( fixcache_in_size < 0 || fixcache_in_size - fixcache_in_pos < size ) {
+        fixcache_in_size = -1;
+        return NULL;
+    }
+    data = fixcache_in + fixcache_in_pos;
+    fixcache_in_pos += size;
+    return data;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* Reads the next record of the cache and compares it with the current one */
+
+static int fixcache_check( const int64_t * record, int64_t size ) {
+    void * cached = fixcache_get( size );
+    if ( !cached || memcmp( cached, record, size ) ) {
+        fixcache_in_size = -1;
+        return 0;
+    }
+    return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void fixcache_put( const void * data, int64_t size ) {
+    if ( fixcache_out_size + size > fixcache_out_allocated ) {
+        fixcache_out_allocated = ( fixcache_out_size + size ) * 2 + 256;
+        fixcache_out = ( uint8_t * ) realloc( fixcache_out, fixcache_out_allocated );
+        if ( !fixcache_out ) {
+            fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+            exit(2);
+        }
+    }
+    memcpy( fixcache_out + fixcache_out_size, data, size );
+    fixcache_out_size += size;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void fixcache_open() {
+    const char * dir = getenv( "BGDI_CACHE" );
+    int64_t record[3] = { FIXCACHE_MAGIC, ( int64_t ) dcb.hash, ( int64_t ) dcb.data.NImports };
+    file * fp;
+
+    fixcache_name[0] = '\0';
+    if ( !dir || !*dir ) return;
+
+    snprintf( fixcache_name, sizeof( fixcache_name ), "%s/%016" PRIx64 ".fxc", dir, dcb.hash );
+
+    if ( ( fp = file_open( fixcache_name, "rb0" ) ) ) {
+        fixcache_in_size = file_size( fp );
+        fixcache_in = ( uint8_t * ) malloc( fixcache_in_size > 0 ? fixcache_in_size : 1 );
+        if ( !fixcache_in || file_read( fp, fixcache_in, fixcache_in_size ) != fixcache_in_size ) fixcache_in_size = -1;
+        file_close( fp );
+    }
+
+    fixcache_check( record, sizeof( record ) );
+    fixcache_put( record, sizeof( record ) );
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* A cached fixup is either not found or lies within the data area */
+
+static int fixcache_valid_var( const int64_t * cached, int64_t limit ) {
+    if ( cached[0] == -1 ) return cached[1] == -1 && cached[2] == -1;
+    return cached[0] >= 0 && cached[0] <= limit && cached[1] >= 0 && cached[2] > 0 &&
+           cached[1] <= ( limit - cached[0] ) / cached[2];
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void fixcache_vars( DLVARFIXUP * fixup, int64_t count, DCB_VAR * basevar, int nvars, char * basedata, int64_t limit ) {
+    int64_t * cached = ( int64_t * ) fixcache_get( count * 3 * sizeof( int64_t ) ), value[3], n;
+
+    /* A damaged cache is discarded, and rewritten at close */
+    for ( n = 0; cached && n < count; n++ ) {
+        if ( !fixcache_valid_var( cached + n * 3, limit ) ) {
+            fixcache_in_size = -1;
+            cached = NULL;
+        }
+    }
+
+    for ( ; count--; fixup++ ) {
+        if ( cached ) {
+            fixup->data_offset = cached[0] == -1 ? NULL : ( void * ) ( ( intptr_t ) basedata + cached[0] );
+            fixup->size = cached[1];
+            fixup->elements = cached[2];
+            cached += 3;
+        } else {
+            get_var_info( fixup, basevar, nvars, basedata );
+        }
+
+        value[0] = fixup->data_offset ? ( int64_t ) ( ( intptr_t ) fixup->data_offset - ( intptr_t ) basedata ) : -1;
+        value[1] = fixup->size;
+        value[2] = fixup->elements;
+        fixcache_put( value, sizeof( value ) );
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void fixcache_module( DLVARFIXUP * globals_fixup, DLVARFIXUP * locals_fixup ) {
+    int64_t record[3] = { 0, 0, 0 };
+    DLVARFIXUP * f;
+
+    for ( f = globals_fixup; f && f->var; f++, record[0]++ ) record[2] = fixcache_hash( record[2], f->var );
+    for ( f = locals_fixup; f && f->var; f++, record[1]++ ) record[2] = fixcache_hash( record[2], f->var );
+
+    fixcache_check( record, sizeof( record ) );
+    fixcache_put( record, sizeof( record ) );
+
+    fixcache_vars( globals_fixup, record[0], dcb.glovar, dcb.data.NGloVars, ( char * ) globaldata, dcb.data.SGlobal );
+    fixcache_vars( locals_fixup, record[1], dcb.locvar, dcb.data.NLocVars, NULL, dcb.data.SLocal );
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* A cached code is either -1 or one of the DCB */
+
+static int fixcache_valid_code( int64_t code ) {
+    int64_t n;
+
+    if ( code == -1 ) return 1;
+    for ( n = 0; n < dcb.data.NSysProcsCodes; n++ ) if ( ( int64_t ) sysproc_code_ref[n].Code == code ) return 1;
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void fixcache_sysprocs() {
+    int64_t record[2] = { 0, 0 }, * cached, code, n;
+    SYSPROC * proc;
+
+    for ( proc = sysprocs; proc->func; proc++, record[0]++ ) {
+        record[1] = fixcache_hash( record[1], proc->name );
+        record[1] = fixcache_hash( record[1], proc->paramtypes );
+        record[1] = ( record[1] ^ proc->type ) * 1099511628211ULL;
+    }
+
+    fixcache_check( record, sizeof( record ) );
+    fixcache_put( record, sizeof( record ) );
+
+    cached = ( int64_t * ) fixcache_get( record[0] * sizeof( int64_t ) );
+    for ( n = 0; cached && n < record[0]; n++ ) {
+        if ( !fixcache_valid_code( cached[n] ) ) {
+            fixcache_in_size = -1;
+            cached = NULL;
+        }
+    }
+
+    if ( cached ) {
+        for ( proc = sysprocs; proc->func; proc++ ) proc->code = *cached++;
+    } else {
+        sysprocs_fixup();
+    }
+
+    for ( proc = sysprocs; proc->func; proc++ ) {
+        code = proc->code;
+        fixcache_put( &code, sizeof( code ) );
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* Saves the cache, unless it was read whole and matched */
+
+static void fixcache_close() {
+    char tmpname[ __MAX_PATH + 32 ];
+    file * fp;
+
+    if ( fixcache_name[0] && ( fixcache_in_size < 0 || fixcache_in_pos != fixcache_in_size ) ) {
+        /* Several instances may be starting at once */
+        snprintf( tmpname, sizeof( tmpname ), "%s.%" PRId64, fixcache_name, ( int64_t ) getpid() );
+        if ( ( fp = file_open( tmpname, "wb0" ) ) ) {
+            int ok = file_write( fp, fixcache_out, fixcache_out_size ) == fixcache_out_size;
+            file_close( fp );
+            if ( !ok || rename( tmpname, fixcache_name ) ) remove( tmpname );
+        }
+    }
+
+    free( fixcache_in );
+    free( fixcache_out );
+    fixcache_in = fixcache_out = NULL;
+    fixcache_out_size = fixcache_out_allocated = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
 void sysproc_init() {
     SYSPROC       * proc;
     void          * library = NULL;
@@ -490,6 +716,8 @@ void sysproc_init() {
 #define DLLEXT
 #endif
 
+    fixcache_open();
+
     for ( n = 0; n < dcb.data.NImports; n++ ) {
         filename = string_get( dcb.imports[n] );
 
@@ -542,19 +770,7 @@ void sysproc_init() {
 
         /* Fixups */
 
-        if ( globals_fixup ) {
-            while ( globals_fixup->var ) {
-                get_var_info( globals_fixup, dcb.glovar, dcb.data.NGloVars, globaldata );
-                globals_fixup++;
-            }
-        }
-
-        if ( locals_fixup ) {
-            while ( locals_fixup->var ) {
-                get_var_info( locals_fixup, dcb.locvar, dcb.data.NLocVars, NULL );
-                locals_fixup++;
-            }
-        }
+        fixcache_module( globals_fixup, locals_fixup );
 
         sysproc_add_tab( functions_exports );
 
@@ -589,7 +805,8 @@ void sysproc_init() {
 
     /* System Procs FixUp */
 
-    sysprocs_fixup();
+    fixcache_sysprocs();
+    fixcache_close();
 
     proc = sysprocs;
     while ( proc->func ) {
@@ -603,12 +820,18 @@ void sysproc_init() {
         exit(2);
     }
 
+    sysproc_tab_count = maxcode + 1;
+
     proc = sysprocs;
     while ( proc->func ) {
         if ( proc->code > -1 ) sysproc_tab[proc->code] = proc;
         proc++;
     }
 
+    /* Calls go straight to their targets */
+
+    calls_fixup();
+
     /* Sort handler_hooks */
     if ( handler_hook_list )
         qsort( handler_hook_list, handler_hook_count, sizeof( handler_hook_list[0] ), ( int ( * )( const void *, const void * ) ) compare_priority );
@@ -0,0 +1,237 @@
+/*
+ *  Copyright (C) SplinterGU (Fenix/BennuGD) (Since 2006)
+ *
+ *  This file is part of Bennu Game Development
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+
+/*
+ * FILE        : typeplan.c
+ * DESCRIPTION : Compiles DCB type descriptors into flat layout plans
+ *
+ * Copying, saving or loading structured data used to walk its DCB_TYPEDEF
+ * descriptors recursively, element by element. Each descriptor array is now
+ * compiled once into a list of plain data runs, string slots and repeated
+ * blocks, so a large array of numbers becomes a single memcpy or write, and
+ * only the strings need to be visited one by one.
+ *
+ * Plans are kept for the whole run, looked up by the contents of the
+ * descriptors. Descriptors with unknown types have no plan, and their
+ * callers keep walking them as before.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bgdrtm.h"
+#include "typeplan.h"
+
+/* --------------------------------------------------------------------------- */
+
+#define TYPEPLAN_BUCKETS    256
+
+static TYPEPLAN * typeplan_table[ TYPEPLAN_BUCKETS ] = { NULL };
+
+typedef struct {
+    TYPEPLAN_OP * ops;
+    int64_t count;
+    int64_t allocated;
+    int64_t mark;       /* First op that new ops can be merged with */
+} TYPEPLAN_BUILDER;
+
+static int typeplan_vars( TYPEPLAN_BUILDER * b, DCB_VAR * var, int64_t nvars );
+
+/* --------------------------------------------------------------------------- */
+
+static TYPEPLAN_OP * typeplan_push( TYPEPLAN_BUILDER * b ) {
+    if ( b->count >= b->allocated ) {
+        b->allocated = b->allocated * 2 + 16;
+        b->ops = ( TYPEPLAN_OP * ) realloc( b->ops, b->allocated * sizeof( TYPEPLAN_OP ) );
+        if ( !b->ops ) {
+            fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+            exit(2);
+        }
+    }
+    return &b->ops[b->count++];
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Adds a data run or a string block, merged with the previous one if it can be */
+
+static void typeplan_emit( TYPEPLAN_BUILDER * b, int64_t op, int64_t width, int64_t count ) {
+    TYPEPLAN_OP * last = b->count > b->mark ? &b->ops[b->count - 1] : NULL;
+
+    if ( !count ) return;
+
+    if ( op == TYPEPLAN_DATA && TYPEPLAN_MERGE_WIDTHS ) {
+        count *= width;
+        width = 1;
+    }
+
+    if ( last && last->op == op && last->width == width ) {
+        last->count += count;
+        last->size += count * width;
+        return;
+    }
+
+    last = typeplan_push( b );
+    last->op = op;
+    last->width = width;
+    last->count = count;
+    last->length = 0;
+    last->size = count * width;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int typeplan_type( TYPEPLAN_BUILDER * b, DCB_TYPEDEF * var ) {
+    int64_t count = 1, n = 0, start, length, mark;
+    TYPEPLAN_OP body;
+
+    while ( var->BaseType[n] == TYPE_ARRAY ) count *= var->Count[n++];
+
+    switch ( var->BaseType[n] ) {
+        case TYPE_DOUBLE:
+        case TYPE_INT:
+        case TYPE_QWORD:
+        case TYPE_POINTER:
+            typeplan_emit( b, TYPEPLAN_DATA, sizeof( int64_t ), count );
+            return 0;
+
+        case TYPE_FLOAT:
+        case TYPE_INT32:
+        case TYPE_DWORD:
+            typeplan_emit( b, TYPEPLAN_DATA, sizeof( int32_t ), count );
+            return 0;
+
+        case TYPE_WORD:
+        case TYPE_SHORT:
+            typeplan_emit( b, TYPEPLAN_DATA, sizeof( int16_t ), count );
+            return 0;
+
+        case TYPE_BYTE:
+        case TYPE_SBYTE:
+        case TYPE_CHAR:
+            typeplan_emit( b, TYPEPLAN_DATA, 1, count );
+            return 0;
+
+        case TYPE_STRING:
+            typeplan_emit( b, TYPEPLAN_STRING, sizeof( int64_t ), count );
+            return 0;
+
+        case TYPE_STRUCT:
+            if ( count <= 0 ) return 0;
+            if ( count == 1 ) return typeplan_vars( b, dcb.varspace_vars[var->Members], dcb.varspace[var->Members].NVars );
+
+            /* The members go after a TYPEPLAN_REPEAT op */
+            mark = b->mark;
+            start = b->count;
+            typeplan_push( b )->op = TYPEPLAN_REPEAT;
+            b->mark = b->count;
+
+            if ( typeplan_vars( b, dcb.varspace_vars[var->Members], dcb.varspace[var->Members].NVars ) ) return -1;
+
+            length = b->count - start - 1;
+
+            if ( length <= 1 ) {
+                /* A single run or string block is just made longer */
+                b->count = start;
+                b->mark = mark;
+                if ( length ) {
+                    body = b->ops[start + 1];
+                    typeplan_emit( b, body.op, body.width, body.count * count );
+                }
+                return 0;
+            }
+
+            b->ops[start].width = 0;
+            b->ops[start].count = count;
+            b->ops[start].length = length;
+            b->ops[start].size = 0;
+            for ( n = start + 1; n < b->count; n += b->ops[n].op == TYPEPLAN_REPEAT ? b->ops[n].length + 1 : 1 )
+                b->ops[start].size += b->ops[n].size;
+            b->ops[start].size *= count;
+
+            /* Nothing can be merged with the end of the repeated block */
+            b->mark = b->count;
+            return 0;
+
+        default:
+            return -1;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int typeplan_vars( TYPEPLAN_BUILDER * b, DCB_VAR * var, int64_t nvars ) {
+    for ( ; nvars > 0; nvars--, var++ ) if ( typeplan_type( b, &var->Type ) ) return -1;
+    return 0;
+}
+
+/* --------------------------------------------------------------------------- */
+
+TYPEPLAN * typeplan_get( DCB_TYPEDEF * var, int64_t nvars ) {
+    TYPEPLAN_BUILDER b = { NULL, 0, 0, 0 };
+    TYPEPLAN * plan;
+    uint64_t hash = 14695981039346656037ULL;
+    const uint8_t * p = ( const uint8_t * ) var;
+    int64_t n, size = nvars * sizeof( DCB_TYPEDEF );
+
+    if ( nvars <= 0 ) return NULL;
+
+    for ( n = 0; n < size; n++ ) hash = ( hash ^ p[n] ) * 1099511628211ULL;
+
+    for ( plan = typeplan_table[ hash % TYPEPLAN_BUCKETS ]; plan; plan = plan->next )
+        if ( plan->hash == hash && plan->nvars == nvars && !memcmp( plan->types, var, size ) ) return plan->nops < 0 ? NULL : plan;
+
+    plan = ( TYPEPLAN * ) calloc( 1, sizeof( TYPEPLAN ) );
+    if ( !plan || !( plan->types = ( DCB_TYPEDEF * ) malloc( size ) ) ) {
+        fprintf( stderr, "ERROR: Runtime error - %s: out of memory\n", __FUNCTION__ );
+        exit(2);
+    }
+
+    plan->hash = hash;
+    plan->nvars = nvars;
+    memcpy( plan->types, var, size );
+
+    for ( n = 0; n < nvars; n++ ) if ( typeplan_type( &b, &var[n] ) ) break;
+
+    if ( n == nvars ) {
+        plan->ops = b.ops;
+        plan->nops = b.count;
+        for ( n = 0; n < b.count; n += b.ops[n].op == TYPEPLAN_REPEAT ? b.ops[n].length + 1 : 1 ) plan->size += b.ops[n].size;
+    } else {
+        /* Remember the descriptors can't be planned */
+        free( b.ops );
+        plan->nops = -1;
+    }
+
+    plan->next = typeplan_table[ hash % TYPEPLAN_BUCKETS ];
+    typeplan_table[ hash % TYPEPLAN_BUCKETS ] = plan;
+
+    return plan->nops < 0 ? NULL : plan;
+}
+
+/* --------------------------------------------------------------------------- */
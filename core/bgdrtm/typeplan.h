@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) SplinterGU (Fenix/BennuGD) (Since 2006)
+ *
+ *  This file is part of Bennu Game Development
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+
+#ifndef __TYPEPLAN_H
+#define __TYPEPLAN_H
+
+#include <stdint.h>
+
+#include "dcb.h"
+#include "arrange.h"
+
+/* --------------------------------------------------------------------------- */
+/* Type layout plans                                                           */
+/* --------------------------------------------------------------------------- */
+
+/* TYPEPLAN_OP.op values */
+
+#define TYPEPLAN_DATA       1   /* count elements of width bytes, without strings */
+#define TYPEPLAN_STRING     2   /* count string slots */
+#define TYPEPLAN_REPEAT     3   /* The next length ops, count times */
+
+/* Plain data of different widths is merged into byte runs, unless its byte
+   order has to be fixed when it is saved or loaded */
+
+#if __BYTEORDER == __LIL_ENDIAN
+#define TYPEPLAN_MERGE_WIDTHS   1
+#else
+#define TYPEPLAN_MERGE_WIDTHS   0
+#endif
+
+typedef struct {
+    int64_t op;
+    int64_t width;
+    int64_t count;
+    int64_t length;
+    int64_t size;       /* Bytes covered by the op (all the repetitions for TYPEPLAN_REPEAT) */
+} TYPEPLAN_OP;
+
+typedef struct _typeplan {
+    struct _typeplan * next;
+    uint64_t hash;
+    int64_t nvars;
+    DCB_TYPEDEF * types;
+    int64_t size;       /* Bytes covered by the whole plan */
+    int64_t nops;
+    TYPEPLAN_OP * ops;
+} TYPEPLAN;
+
+/* --------------------------------------------------------------------------- */
+
+extern TYPEPLAN * typeplan_get( DCB_TYPEDEF * var, int64_t nvars );
+
+/* --------------------------------------------------------------------------- */
+
+#endif
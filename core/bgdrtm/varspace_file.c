@@ -35,6 +35,140 @@
 #include "files.h"
 #include "varspace_file.h"
 #include "xstrings.h"
+#include "typeplan.h"
+
+/* ----------------------------------------------------------------- */
+/*
+ *  FUNCTION : saveplan / loadplan
+ *
+ *  Save or load data at the current file offset, following a type
+ *  layout plan. Plain data runs are written or read at once.
+ *
+ *  RETURN VALUE :
+ *      Number of bytes actually written or read, -1 on error
+ *
+ */
+
+static int64_t plan_data( file * fp, uint8_t * data, TYPEPLAN_OP * op, int save ) {
+    int64_t done = 0, chunk, n;
+
+    switch ( op->width ) {
+        case sizeof( uint64_t ):
+            return ( save ? file_writeUint64A( fp, ( uint64_t * ) data, op->count ) : file_readUint64A( fp, ( uint64_t * ) data, op->count ) ) * sizeof( uint64_t );
+
+        case sizeof( uint32_t ):
+            return ( save ? file_writeUint32A( fp, ( uint32_t * ) data, op->count ) : file_readUint32A( fp, ( uint32_t * ) data, op->count ) ) * sizeof( uint32_t );
+
+        case sizeof( uint16_t ):
+            return ( save ? file_writeUint16A( fp, ( uint16_t * ) data, op->count ) : file_readUint16A( fp, ( uint16_t * ) data, op->count ) ) * sizeof( uint16_t );
+    }
+
+    /* Byte runs, in pieces file_read/file_write can take */
+    while ( done < op->size ) {
+        chunk = op->size - done > 0x40000000 ? 0x40000000 : op->size - done;
+        n = save ? file_write( fp, data + done, chunk ) : file_read( fp, data + done, chunk );
+        if ( n <= 0 ) break;
+        done += n;
+        if ( n < chunk ) break;
+    }
+    return done;
+}
+
+static int64_t saveplan( file * fp, uint8_t * data, TYPEPLAN_OP * op, int64_t nops, int64_t dcbformat ) {
+    TYPEPLAN_OP * end = op + nops;
+    int64_t result = 0, n, partial;
+    const char * str;
+    uint32_t len;
+
+    for ( ; op < end; op++ ) {
+        switch ( op->op ) {
+            case TYPEPLAN_DATA:
+                result += plan_data( fp, data, op, 1 );
+                break;
+
+            case TYPEPLAN_STRING:
+                if ( dcbformat ) {
+                    result += file_writeUint64A( fp, ( uint64_t * ) data, op->count ) * sizeof( uint64_t );
+                } else {
+                    for ( n = 0; n < op->count; n++ ) {
+                        str = string_get( (( uint64_t * )data )[n] );
+                        len = strlen( str );
+                        file_writeUint32( fp, &len );
+                        file_write( fp, ( void * ) str, len );
+                    }
+                    result += op->size;
+                }
+                break;
+
+            case TYPEPLAN_REPEAT:
+                for ( n = 0; n < op->count; n++ ) {
+                    partial = saveplan( fp, data + n * ( op->size / op->count ), op + 1, op->length, dcbformat );
+                    if ( partial < 0 ) return -1;
+                    result += partial;
+                }
+                data += op->size;
+                op += op->length;
+                continue;
+        }
+        data += op->size;
+    }
+    return result;
+}
+
+static int64_t loadplan( file * fp, uint8_t * data, TYPEPLAN_OP * op, int64_t nops, int64_t dcbformat ) {
+    static char * str = NULL;
+    static uint32_t allocated = 0;
+    TYPEPLAN_OP * end = op + nops;
+    int64_t result = 0, n, partial;
+    uint32_t len;
+
+    for ( ; op < end; op++ ) {
+        switch ( op->op ) {
+            case TYPEPLAN_DATA:
+                result += plan_data( fp, data, op, 0 );
+                break;
+
+            case TYPEPLAN_STRING:
+                if ( dcbformat ) {
+                    result += file_readUint64A( fp, ( uint64_t * ) data, op->count ) * sizeof( uint64_t );
+                } else {
+                    for ( n = 0; n < op->count; n++ ) {
+                        string_discard( (( uint64_t * )data )[n] );
+                        len = 0;
+                        file_readUint32( fp, &len );
+                        /* The text buffer is reused from string to string */
+                        if ( len >= allocated ) {
+                            char * p = realloc( str, ( size_t ) len + 1 );
+                            if ( !p ) {
+                                fprintf( stderr, "loadtype: out of memory\n" ) ;
+                                return -1;
+                            }
+                            str = p;
+                            allocated = len + 1;
+                        }
+                        if ( len > 0 ) file_read( fp, str, len );
+                        str[len] = 0;
+                        (( uint64_t * )data )[n] = string_new( str );
+                        string_use( (( uint64_t * )data )[n] );
+                    }
+                    result += op->size;
+                }
+                break;
+
+            case TYPEPLAN_REPEAT:
+                for ( n = 0; n < op->count; n++ ) {
+                    partial = loadplan( fp, data + n * ( op->size / op->count ), op + 1, op->length, dcbformat );
+                    if ( partial < 0 ) return -1;
+                    result += partial;
+                }
+                data += op->size;
+                op += op->length;
+                continue;
+        }
+        data += op->size;
+    }
+    return result;
+}
 
 /* ----------------------------------------------------------------- */
 /*
@@ -84,6 +218,9 @@ int64_t loadvars( file * fp, void * data, DCB_VAR * var, int64_t nvars, int64_t
 
 int64_t loadtypes( file * fp, void * data, DCB_TYPEDEF * var, int64_t nvars, int64_t dcbformat ) {
     int64_t result = 0;
+    TYPEPLAN * plan = typeplan_get( var, nvars );
+
+    if ( plan ) return loadplan( fp, data, plan->ops, plan->nops, dcbformat );
 
     for ( ; nvars > 0; nvars--, var++ ) {
         int64_t partial = loadtype( fp, data, var, dcbformat );
@@ -140,6 +277,9 @@ int64_t savevars( file * fp, void * data, DCB_VAR * var, int64_t nvars, int64_t
 
 int64_t savetypes( file * fp, void * data, DCB_TYPEDEF * var, int64_t nvars, int64_t dcbformat ) {
     int64_t result = 0;
+    TYPEPLAN * plan = typeplan_get( var, nvars );
+
+    if ( plan ) return saveplan( fp, data, plan->ops, plan->nops, dcbformat );
 
     for ( ; nvars > 0; nvars--, var++ ) {
         int64_t partial = savetype( fp, data, var, dcbformat );
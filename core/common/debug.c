@@ -155,6 +155,17 @@ struct {
 
     { "STR2CHARNUL"                 , MN_STR2CHARNUL            , 0 },
 
+    { "JFALSE_EQ"                   , MN_JFALSE_EQ              , 1 },
+    { "JFALSE_NE"                   , MN_JFALSE_NE              , 1 },
+    { "JFALSE_GT"                   , MN_JFALSE_GT              , 1 },
+    { "JFALSE_LT"                   , MN_JFALSE_LT              , 1 },
+    { "JFALSE_GTE"                  , MN_JFALSE_GTE             , 1 },
+    { "JFALSE_LTE"                  , MN_JFALSE_LTE             , 1 },
+
+    { "VARADD_PRIVATE"              , MN_VARADD_PRIV            , 1 },
+    { "VARADD_LOCAL"                , MN_VARADD_LOCAL           , 1 },
+    { "VARADD_GLOBAL"               , MN_VARADD_GLOBAL          , 1 },
+
     { "A2STR"                       , MN_A2STR                  , 1 },
     { "STR2A"                       , MN_STR2A                  , 1 },
     { "STRACAT"                     , MN_STRACAT                , 1 },
@@ -299,14 +310,34 @@ void mnemonic_dump( int64_t i, int64_t param ) {
             printf( "%s", mnemonics_sorted[n].name );
 
             if ( i == MN_SYSCALL || i == MN_SYSPROC ) {
+#ifndef __BGDRTM__
                 printf( "%s (%" PRId64 ")\n", sysproc_name( param ), param );
-            } else if ( i == MN_CALL || i == MN_PROC || i == MN_TYPE ) {
+#else
+                /* Resolved at load time by calls_fixup() */
+                SYSPROC * p = ( SYSPROC * )( intptr_t ) param;
+                if ( p ) printf( "%s (%" PRId64 ")\n", p->name, p->code );
+                else     printf( "?\n" );
+#endif
+            } else if ( i == MN_CALL || i == MN_PROC ) {
+#ifndef __BGDRTM__
+                if ( libmode )  printf( "%s (%" PRId64 ")\n", identifier_name( (procdef_search(param))->identifier ), param );
+                else            printf( "%s (%" PRId64 ")\n", identifier_name( (procdef_get(param))->identifier ), param );
+#else
+                PROCDEF * p = ( PROCDEF * )( intptr_t ) param;
+                if ( p ) printf( "%s (%" PRId64 ")\n", p->name, p->type );
+                else     printf( "?\n" );
+#endif
+            } else if ( i == MN_TYPE ) {
 #ifndef __BGDRTM__
                 if ( libmode )  printf( "%s (%" PRId64 ")\n", identifier_name( (procdef_search(param))->identifier ), param );
                 else            printf( "%s (%" PRId64 ")\n", identifier_name( (procdef_get(param))->identifier ), param );
 #else
                 printf( "%s (%" PRId64 ")\n", procdef_get(param)->name, param );
 #endif
+            } else if ( ( i & MN_MASK ) == MN_VARADD_PRIV || ( i & MN_MASK ) == MN_VARADD_LOCAL || ( i & MN_MASK ) == MN_VARADD_GLOBAL ) {
+                int32_t imm = MN_VARIMM_VALUE( param );
+                if ( MN_TYPEOF( i ) == MN_FLOAT ) printf( "%" PRIu32 ", %f\n", MN_VARIMM_OFFSET( param ), *( float * ) &imm );
+                else                              printf( "%" PRIu32 ", %" PRId32 "\n", MN_VARIMM_OFFSET( param ), imm );
             } else if ( i != MN_SENTENCE ) {
                 switch ( MN_PARAMS( i ) ) {
                     case    1:
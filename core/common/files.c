@@ -46,7 +46,13 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#if !defined( _WIN32 ) && !defined( PS3_PPU ) && !defined( __SWITCH__ )
+#define USE_MMAP
+#include <sys/mman.h>
+#endif
+
 #include "files.h"
+#include "zpack.h"
 
 #define MAX_POSSIBLE_PATHS  128
 
@@ -59,52 +65,445 @@ int max_x_files = 0;
 
 int x_files_count = 0;
 
+/* X_FILE names are found with a hash table (first file of each chain) */
+
+static int * x_file_hash = NULL;
+static int x_file_hash_mask = 0;
+
+#ifdef USE_MMAP
+/* The container (stub or DCB) is mapped once, stored files are read from there */
+
+static const unsigned char * x_file_map = NULL;
+static size_t x_file_map_size = 0;
+static char * x_file_map_name = NULL;
+#endif
+
+static uint32_t xfile_hashname( const char * name ) {
+    uint32_t h = 0x811C9DC5;
+    while ( *name ) h = ( h ^ ( unsigned char ) *name++ ) * 0x01000193;
+    return h;
+}
+
 /* Add new file to PATH */
 
 void xfile_init( int maxfiles ) {
+    int n;
+
     x_file = ( XFILE * ) calloc( sizeof( XFILE ), maxfiles );
     max_x_files = maxfiles;
+
+    for ( n = 16; n < maxfiles * 2; n <<= 1 );
+    x_file_hash = ( int * ) malloc( n * sizeof( int ) );
+    assert( x_file && x_file_hash );
+    x_file_hash_mask = n - 1;
+    while ( n-- ) x_file_hash[n] = -1;
 }
 
-void file_add_xfile( file * fp, const char * stubname, long offset, char * name, int size ) {
+void file_add_xfile( file * fp, const char * stubname, long offset, char * name, int size, int flags ) {
+    XFILE * xf = &x_file[x_files_count];
     char * ptr;
+    int * link;
 
     assert( x_files_count < max_x_files );
-    assert( fp->type == F_FILE );
 
-    x_file[x_files_count].stubname = strdup( stubname );
-    x_file[x_files_count].offset = offset;
-    x_file[x_files_count].size = size;
-    x_file[x_files_count].name = strdup( name );
+    xf->stubname = strdup( stubname );
+    xf->offset = offset;
+    xf->size = size;
+    xf->stored = size;
+    xf->flags = flags;
+    xf->data = NULL;
+    xf->name = strdup( name );
 
-    ptr = x_file[x_files_count].name;
+    ptr = xf->name;
     while ( *ptr ) {
         if ( *ptr == '\\' ) *ptr = '/'; /* Unix style */
         ptr++;
     }
 
+#ifdef USE_MMAP
+    /* Only plain containers can be mapped, the others are read with file_open() */
+    if ( fp->type == F_FILE && !x_file_map_name ) {
+        struct stat st;
+
+        x_file_map_name = strdup( stubname );
+        if ( !fstat( fileno( fp->fp ), &st ) && st.st_size > 0 ) {
+            void * map = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno( fp->fp ), 0 );
+            if ( map != MAP_FAILED ) {
+                x_file_map = ( const unsigned char * ) map;
+                x_file_map_size = st.st_size;
+            }
+        }
+    }
+
+    if ( x_file_map && fp->type == F_FILE && !strcmp( x_file_map_name, stubname ) &&
+         offset >= 0 && ( size_t ) offset + size <= x_file_map_size )
+        xf->data = x_file_map + offset;
+#endif
+
+    /* Added at the end of the chain, so the first file with a name wins */
+    link = &x_file_hash[ xfile_hashname( xf->name ) & x_file_hash_mask ];
+    while ( *link != -1 ) link = &x_file[*link].next;
+    *link = x_files_count;
+    xf->next = -1;
+
     x_files_count++;
 }
 
+static XFILE * xfile_find( const char * name ) {
+    int n;
+
+    if ( !x_files_count ) return NULL;
+
+    for ( n = x_file_hash[ xfile_hashname( name ) & x_file_hash_mask ]; n != -1; n = x_file[n].next )
+        if ( !strcmp( name, x_file[n].name ) ) return &x_file[n];
+
+    return NULL;
+}
+
+/* Gets the contents of a X_FILE. Stored files in a mapped container are used
+ * in place, the others are read (and uncompressed) in a single step */
+
+static int xfile_open( file * f, XFILE * xf ) {
+    const unsigned char * src = xf->data;
+    unsigned char * buf = NULL, * mem;
+    uint64_t len;
+
+    if ( !src ) {
+        file * c = file_open( xf->stubname, "rb" );
+        if ( !c ) return 0;
+
+        buf = ( unsigned char * ) malloc( xf->stored ? xf->stored : 1 );
+        if ( !buf || file_seek( c, xf->offset, SEEK_SET ) < 0 || file_read( c, buf, xf->stored ) != xf->stored ) {
+            file_close( c );
+            free( buf );
+            return 0;
+        }
+        file_close( c );
+        src = buf;
+    }
+
+    if ( !( xf->flags & XFILE_COMPRESSED ) ) {
+        f->mem = buf ? buf : ( unsigned char * ) src;
+        f->mem_alloc = buf ? 1 : 0;
+        return 1;
+    }
+
+    /* The uncompressed size goes before the zpack block */
+    if ( xf->stored < ( int ) sizeof( len ) ) {
+        free( buf );
+        return 0;
+    }
+
+    memcpy( &len, src, sizeof( len ) );
+    ARRANGE_QWORD( &len );
+
+    mem = ( unsigned char * ) malloc( len ? len : 1 );
+    if ( !mem || len > INT32_MAX || zpack_uncompress( src + sizeof( len ), xf->stored - sizeof( len ), mem, len ) != len ) {
+        free( mem );
+        free( buf );
+        return 0;
+    }
+    free( buf );
+
+    xf->size = len;
+    f->mem = mem;
+    f->mem_alloc = 1;
+    return 1;
+}
+
+/* Reads a line of a X_FILE, as fgets() does (eof is set when the end of
+ * the file stops the line) */
+
+static char * xfile_gets( file * fp, char * buffer, int len ) {
+    int n = 0;
+
+    while ( n < len - 1 ) {
+        if ( fp->pos >= fp->xf->size ) {
+            fp->eof = 1;
+            break;
+        }
+        if ( ( buffer[n++] = fp->mem[fp->pos++] ) == '\n' ) break;
+    }
+    if ( len > 0 ) buffer[n] = '\0';
+
+    return n ? buffer : NULL;
+}
+
+/* Packed files. Header: magic and chunk size (32 bits). Each chunk: its
+ * size (32 bits, high bit set if stored uncompressed) and data. At the
+ * end: the file offset of each chunk (64 bits) and a footer with the
+ * uncompressed size and the offset of this index (64 bits each) */
+
+#define PACK_HEADER     ( sizeof( PACK_MAGIC ) - 1 + sizeof( uint32_t ) )
+#define PACK_FOOTER     ( 2 * sizeof( uint64_t ) )
+#define PACK_STORED     0x80000000
+
+static PACKFILE * pack_new( uint32_t chunk ) {
+    PACKFILE * pk = ( PACKFILE * ) calloc( 1, sizeof( PACKFILE ) );
+
+    if ( !pk ) return NULL;
+
+    pk->chunk = chunk;
+    pk->loaded = -1;
+    pk->buf = ( uint8_t * ) malloc( chunk );
+    pk->cbuf = ( uint8_t * ) malloc( ZPACK_BOUND( chunk ) );
+    if ( !pk->buf || !pk->cbuf ) {
+        free( pk->buf );
+        free( pk->cbuf );
+        free( pk );
+        return NULL;
+    }
+
+    return pk;
+}
+
+static void pack_free( PACKFILE * pk ) {
+    free( pk->index );
+    free( pk->buf );
+    free( pk->cbuf );
+    free( pk );
+}
+
+/* Opens a packed file for reading. Returns 0 if it isn't one */
+
+static int pack_open( file * f, const char * filename ) {
+    char header[PACK_HEADER];
+    uint64_t footer[2];
+    uint32_t chunk;
+    PACKFILE * pk;
+    FILE * fp;
+    int64_t n;
+
+    if ( !( fp = fopen( filename, "rb" ) ) ) return 0;
+
+    if ( fread( header, 1, PACK_HEADER, fp ) != PACK_HEADER || memcmp( header, PACK_MAGIC, sizeof( PACK_MAGIC ) - 1 ) ||
+         fseek( fp, -( long ) PACK_FOOTER, SEEK_END ) || fread( footer, 1, PACK_FOOTER, fp ) != PACK_FOOTER ) {
+        fclose( fp );
+        return 0;
+    }
+
+    memcpy( &chunk, header + sizeof( PACK_MAGIC ) - 1, sizeof( chunk ) );
+    ARRANGE_DWORD( &chunk );
+    ARRANGE_QWORD( &footer[0] );
+    ARRANGE_QWORD( &footer[1] );
+
+    if ( !chunk || chunk > 0x1000000 || !( pk = pack_new( chunk ) ) ) {
+        fclose( fp );
+        return 0;
+    }
+
+    pk->size = footer[0];
+    pk->nchunks = ( pk->size + chunk - 1 ) / chunk;
+    pk->index = ( uint64_t * ) malloc( ( pk->nchunks + 1 ) * sizeof( uint64_t ) );
+
+    if ( !pk->index || fseek( fp, footer[1], SEEK_SET ) ||
+         fread( pk->index, sizeof( uint64_t ), pk->nchunks, fp ) != ( size_t ) pk->nchunks ) {
+        pack_free( pk );
+        fclose( fp );
+        return 0;
+    }
+    for ( n = 0; n < pk->nchunks; n++ ) ARRANGE_QWORD( &pk->index[n] );
+
+    f->type = F_PKFILE;
+    f->fp = fp;
+    f->pk = pk;
+    f->eof = 0;
+
+    return 1;
+}
+
+/* Creates a packed file */
+
+static int pack_create( file * f, const char * filename ) {
+    char header[PACK_HEADER];
+    uint32_t chunk = PACK_CHUNK;
+    PACKFILE * pk;
+    FILE * fp;
+
+    if ( !( fp = fopen( filename, "wb" ) ) ) return 0;
+
+    memcpy( header, PACK_MAGIC, sizeof( PACK_MAGIC ) - 1 );
+    ARRANGE_DWORD( &chunk );
+    memcpy( header + sizeof( PACK_MAGIC ) - 1, &chunk, sizeof( chunk ) );
+
+    if ( fwrite( header, 1, PACK_HEADER, fp ) != PACK_HEADER || !( pk = pack_new( PACK_CHUNK ) ) ) {
+        fclose( fp );
+        return 0;
+    }
+    pk->writing = 1;
+
+    f->type = F_PKFILE;
+    f->fp = fp;
+    f->pk = pk;
+    f->eof = 0;
+
+    return 1;
+}
+
+/* Compresses and writes the pending data as a new chunk */
+
+static int pack_flush( file * fp ) {
+    PACKFILE * pk = fp->pk;
+    uint32_t size;
+    int clen;
+
+    if ( !pk->used ) return 1;
+
+    if ( pk->nchunks == pk->allocated ) {
+        uint64_t * index = ( uint64_t * ) realloc( pk->index, ( pk->allocated += 64 ) * sizeof( uint64_t ) );
+        if ( !index ) return 0;
+        pk->index = index;
+    }
+    pk->index[pk->nchunks++] = ftell( fp->fp );
+
+    /* Incompressible chunks are stored */
+    clen = zpack_compress( pk->buf, pk->used, pk->cbuf, pk->used - pk->used / 32 );
+    size = clen ? clen : ( pk->used | PACK_STORED );
+    ARRANGE_DWORD( &size );
+
+    if ( fwrite( &size, sizeof( size ), 1, fp->fp ) != 1 ||
+         fwrite( clen ? pk->cbuf : pk->buf, 1, clen ? clen : pk->used, fp->fp ) != ( size_t ) ( clen ? clen : pk->used ) ) {
+        fp->error = 1;
+        return 0;
+    }
+
+    pk->used = 0;
+    return 1;
+}
+
+/* Writes the last chunk and the index. Returns 0 if any write failed */
+
+static int pack_finish( file * fp ) {
+    PACKFILE * pk = fp->pk;
+    uint64_t footer[2];
+    int64_t n;
+
+    if ( fp->error || !pack_flush( fp ) ) return 0;
+
+    footer[0] = pk->size;
+    footer[1] = ftell( fp->fp );
+    for ( n = 0; n < pk->nchunks; n++ ) ARRANGE_QWORD( &pk->index[n] );
+    ARRANGE_QWORD( &footer[0] );
+    ARRANGE_QWORD( &footer[1] );
+
+    if ( fwrite( pk->index, sizeof( uint64_t ), pk->nchunks, fp->fp ) != ( size_t ) pk->nchunks ||
+         fwrite( footer, 1, PACK_FOOTER, fp->fp ) != PACK_FOOTER ) {
+        fp->error = 1;
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Makes the chunk with the current position available in buf */
+
+static int pack_load( file * fp ) {
+    PACKFILE * pk = fp->pk;
+    int64_t n = pk->pos / pk->chunk;
+    uint32_t size;
+    int len;
+
+    if ( n == pk->loaded ) return 1;
+    if ( n >= pk->nchunks ) return 0;
+
+    pk->loaded = -1;
+    len = ( n == pk->nchunks - 1 ) ? pk->size - n * pk->chunk : pk->chunk;
+
+    if ( fseek( fp->fp, pk->index[n], SEEK_SET ) || fread( &size, sizeof( size ), 1, fp->fp ) != 1 ) return 0;
+    ARRANGE_DWORD( &size );
+
+    if ( size & PACK_STORED ) {
+        if ( ( int ) ( size & ~PACK_STORED ) != len || fread( pk->buf, 1, len, fp->fp ) != ( size_t ) len ) return 0;
+    } else {
+        if ( size > ZPACK_BOUND( pk->chunk ) || fread( pk->cbuf, 1, size, fp->fp ) != size ||
+             zpack_uncompress( pk->cbuf, size, pk->buf, len ) != len ) return 0;
+    }
+
+    pk->loaded = n;
+    pk->used = len;
+    return 1;
+}
+
+static int pack_read( file * fp, void * buffer, int len ) {
+    PACKFILE * pk = fp->pk;
+    int result = 0;
+
+    while ( result < len ) {
+        int off, n;
+
+        if ( pk->pos >= pk->size ) {
+            fp->eof = 1;
+            break;
+        }
+        if ( !pack_load( fp ) ) {
+            fp->error = 1;
+            break;
+        }
+
+        off = pk->pos - pk->loaded * pk->chunk;
+        n = pk->used - off;
+        if ( n > len - result ) n = len - result;
+
+        memcpy( ( uint8_t * ) buffer + result, pk->buf + off, n );
+        result += n;
+        pk->pos += n;
+    }
+
+    return result;
+}
+
+static int pack_write( file * fp, void * buffer, int len ) {
+    PACKFILE * pk = fp->pk;
+    int result = 0;
+
+    if ( !pk->writing ) return 0;
+
+    while ( result < len ) {
+        int n = pk->chunk - pk->used;
+        if ( n > len - result ) n = len - result;
+
+        memcpy( pk->buf + pk->used, ( uint8_t * ) buffer + result, n );
+        pk->used += n;
+        result += n;
+        pk->pos += n;
+        pk->size += n;
+
+        if ( pk->used == pk->chunk && !pack_flush( fp ) ) break;
+    }
+
+    return result;
+}
+
+/* Reads a line, as fgets() does */
+
+static char * pack_gets( file * fp, char * buffer, int len ) {
+    int n = 0;
+
+    while ( n < len - 1 ) {
+        if ( pack_read( fp, buffer + n, 1 ) != 1 ) break;
+        if ( buffer[n++] == '\n' ) break;
+    }
+    if ( len > 0 ) buffer[n] = '\0';
+
+    return n ? buffer : NULL;
+}
+
 /* Read a datablock from file */
 
 int file_read( file * fp, void * buffer, int len ) {
     if ( !fp || !len ) return 0;
 
     if ( fp->type == F_XFILE ) {
-        int result;
-
-        if (( len + fp->pos ) > ( fp->xf->offset + fp->xf->size ) ) {
+        if ( len > fp->xf->size - fp->pos ) {
             fp->eof = 1;
-            len = fp->xf->size + fp->xf->offset - fp->pos;
+            len = fp->xf->size - fp->pos;
+            if ( len < 0 ) len = 0;
         }
 
-        gzseek( fp->gz, fp->pos, SEEK_SET );
-        result = gzread( fp->gz, buffer, len );
-        fp->error = ( result < len );
-        if ( result < 0 ) result = 0;
-        fp->pos = gztell( fp->gz );
-        return result;
+        memcpy( buffer, fp->mem + fp->pos, len );
+        fp->error = 0;
+        fp->pos += len;
+        return len;
     }
 
     if ( fp->type == F_GZFILE ) {
@@ -113,6 +512,9 @@ int file_read( file * fp, void * buffer, int len ) {
         if ( result < 0 ) result = 0;
         return result;
     }
+
+    if ( fp->type == F_PKFILE ) return pack_read( fp, buffer, len );
+
     return fread( buffer, 1, len, fp->fp );
 }
 
@@ -156,20 +558,14 @@ int file_qgets( file * fp, char * buffer, int len ) {
     size_t sz;
 
     if ( fp->type == F_XFILE ) {
-        ptr = result = buffer;
-
-        if ( fp->pos - fp->xf->offset + len - 1 > fp->xf->size ) {
-            len = fp->xf->size - ( fp->pos - fp->xf->offset ) - 1;
-            fp->eof = 1;
-        }
-
-        gzseek( fp->gz, fp->pos, SEEK_SET );
-        result = gzgets( fp->gz, buffer, len ) ;
-        fp->pos = gztell( fp->gz );
+        result = xfile_gets( fp, buffer, len );
     }
     else if ( fp->type == F_GZFILE ) {
         result = gzgets( fp->gz, buffer, len );
     }
+    else if ( fp->type == F_PKFILE ) {
+        result = pack_gets( fp, buffer, len );
+    }
     else {
         result = fgets( buffer, len, fp->fp );
     }
@@ -210,20 +606,14 @@ int file_gets( file * fp, char * buffer, int len ) {
     size_t sz;
 
     if ( fp->type == F_XFILE ) {
-        char * ptr = result = buffer;
-
-        if ( fp->pos - fp->xf->offset + len - 1 > fp->xf->size ) {
-            len = fp->xf->size - ( fp->pos - fp->xf->offset ) - 1;
-            fp->eof = 1;
-        }
-
-        gzseek( fp->gz, fp->pos, SEEK_SET );
-        result = gzgets( fp->gz, buffer, len );
-        fp->pos = gztell( fp->gz );
+        result = xfile_gets( fp, buffer, len );
     }
     else if ( fp->type == F_GZFILE ) {
         result = gzgets( fp->gz, buffer, len );
     }
+    else if ( fp->type == F_PKFILE ) {
+        result = pack_gets( fp, buffer, len );
+    }
     else {
         result = fgets( buffer, len, fp->fp );
     }
@@ -472,6 +862,8 @@ int file_write( file * fp, void * buffer, int len ) {
         return result;
     }
 
+    if ( fp->type == F_PKFILE ) return pack_write( fp, buffer, len );
+
     return fwrite( buffer, 1, len, fp->fp );
 }
 
@@ -484,6 +876,8 @@ long file_size( file * fp ) {
 
     if ( fp->type == F_XFILE ) return fp->xf->size;
 
+    if ( fp->type == F_PKFILE ) return fp->pk->size;
+
     pos = file_pos( fp );
     file_seek(fp, 0, SEEK_END );
     size = file_pos( fp );
@@ -496,17 +890,19 @@ long file_size( file * fp ) {
 /* Get current file pointer position */
 
 long file_pos( file * fp ) {
-    if ( fp->type == F_XFILE ) return fp->pos - fp->xf->offset;
+    if ( fp->type == F_XFILE ) return fp->pos;
 
     if ( fp->type == F_GZFILE ) return gztell( fp->gz );
 
+    if ( fp->type == F_PKFILE ) return fp->pk->pos;
+
     return ftell( fp->fp );
 }
 
 int file_flush( file * fp ) {
     if ( fp->type == F_XFILE ) return 0;
 
-    if ( fp->type == F_GZFILE ) return 0;
+    if ( fp->type == F_GZFILE || fp->type == F_PKFILE ) return 0;
 
     return fflush( fp->fp );
 }
@@ -516,14 +912,27 @@ int file_flush( file * fp ) {
 int file_seek( file * fp, long pos, int where ) {
     assert( fp );
     if ( fp->type == F_XFILE ) {
-        if ( where == SEEK_END )        pos = fp->xf->size - pos + 1;
-        else if ( where == SEEK_CUR )   pos += ( fp->pos - fp->xf->offset );
+        if ( where == SEEK_END )        pos += fp->xf->size;
+        else if ( where == SEEK_CUR )   pos += fp->pos;
 
         if ( fp->xf->size < pos ) pos = fp->xf->size;
 
         if ( pos < 0 ) pos = 0;
 
-        fp->pos = pos + fp->xf->offset;
+        fp->pos = pos;
+        fp->eof = 0;
+        return pos;
+    }
+
+    if ( fp->type == F_PKFILE ) {
+        if ( where == SEEK_END )        pos += fp->pk->size;
+        else if ( where == SEEK_CUR )   pos += fp->pk->pos;
+
+        /* Writing is sequential */
+        if ( pos < 0 || pos > fp->pk->size || ( fp->pk->writing && pos != fp->pk->pos ) ) return -1;
+
+        fp->pk->pos = pos;
+        fp->eof = 0;
         return pos;
     }
 
@@ -549,13 +958,19 @@ void file_rewind( file * fp ) {
 
     switch ( fp->type ) {
         case F_XFILE:
-            fp->pos = fp->xf->offset;
+            fp->pos = 0;
+            fp->eof = 0;
             break;
 
         case F_GZFILE:
             gzrewind( fp->gz );
             break;
 
+        case F_PKFILE:
+            if ( !fp->pk->writing ) fp->pk->pos = 0;
+            fp->eof = 0;
+            break;
+
         default:
             rewind( fp->fp );
     }
@@ -568,6 +983,10 @@ static int open_raw( file * f, const char * filename, const char * mode ) {
     char    *p;
 
     if ( !strchr( mode, '0' ) ) {
+        /* 'p': write a packed file. They are always detected when reading */
+        if ( strchr( mode, 'w' ) && strchr( mode, 'p' ) ) return pack_create( f, filename );
+        if ( strchr( mode, 'r' ) && !strchr( mode, '+' ) && pack_open( f, filename ) ) return 1;
+
         f->type = F_GZFILE;
         f->gz = gzopen( filename, mode );
         f->eof  = 0;
@@ -576,7 +995,7 @@ static int open_raw( file * f, const char * filename, const char * mode ) {
 
     p = _mode;
     while ( *mode ) {
-        if ( *mode != '0' ) {
+        if ( *mode != '0' && *mode != 'p' ) {
             *p = *mode;
             p++;
         }
@@ -623,17 +1042,16 @@ file * file_open( const char * filename, char * mode ) {
     if (  strchr( mode, 'r' ) &&  strchr( mode, 'b' ) &&  /* Only read-only files */
          !strchr( mode, '+' ) && !strchr( mode, 'w' ) )
     {
-        for ( i = 0; i < x_files_count; i++ ) {
-            if ( !strcmp( filename, x_file[i].name ) ) {
-                f->eof  = 0;
-                f->pos  = x_file[i].offset;
-                f->type = F_XFILE;
-                f->xf   = &x_file[i];
-                f->gz = gzopen( x_file[i].stubname, "rb" );
-
-                opened_files++;
-                return f;
-            }
+        XFILE * xf = xfile_find( filename );
+
+        if ( xf && xfile_open( f, xf ) ) {
+            f->eof  = 0;
+            f->pos  = 0;
+            f->type = F_XFILE;
+            f->xf   = xf;
+
+            opened_files++;
+            return f;
         }
     }
 
@@ -672,15 +1090,56 @@ file * file_open( const char * filename, char * mode ) {
     return 0;
 }
 
-/* Close file */
+/* Gets a region of a file in writable memory, that is never released.
+ * Plain files are mapped (copy on write), the others are read at once */
+
+void * file_load( file * fp, long offset, long size ) {
+    uint8_t * mem;
 
-void file_close( file * fp ) {
-    if ( fp == NULL ) return;
+    if ( !fp || offset < 0 || size <= 0 ) return NULL;
+
+#ifdef USE_MMAP
+    if ( fp->type == F_FILE ) {
+        struct stat st;
+        long page = sysconf( _SC_PAGESIZE ), start = offset - offset % page;
+
+        if ( !fstat( fileno( fp->fp ), &st ) && offset + size <= st.st_size ) {
+            void * map = mmap( NULL, size + ( offset - start ), PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno( fp->fp ), start );
+            if ( map != MAP_FAILED ) return ( uint8_t * ) map + ( offset - start );
+        }
+    }
+#endif
+
+    mem = ( uint8_t * ) malloc( size );
+    if ( !mem ) return NULL;
+
+    if ( file_seek( fp, offset, SEEK_SET ) < 0 || file_read( fp, mem, size ) != size ) {
+        free( mem );
+        return NULL;
+    }
+
+    return mem;
+}
+
+/* Close file. Returns 0 if a packed file couldn't be completed */
+
+int file_close( file * fp ) {
+    int ok = 1;
+
+    if ( fp == NULL ) return 1;
     if ( fp->type == F_FILE ) fclose( fp->fp );
-    if ( fp->type == F_GZFILE || fp->type == F_XFILE ) gzclose( fp->gz );
+    if ( fp->type == F_GZFILE ) gzclose( fp->gz );
+    if ( fp->type == F_XFILE && fp->mem_alloc ) free( fp->mem );
+    if ( fp->type == F_PKFILE ) {
+        if ( fp->pk->writing ) ok = pack_finish( fp );
+        pack_free( fp->pk );
+        if ( fclose( fp->fp ) ) ok = 0;
+    }
 
     opened_files--;
     free( fp );
+
+    return ok;
 }
 
 /* Add a new dir to PATH */
@@ -740,6 +1199,8 @@ int file_eof( file * fp ) {
         return gzeof( fp->gz ) ? 1 : 0;
     }
 
+    if ( fp->type == F_PKFILE ) return ( fp->eof || fp->error ) ? 1 : 0;
+
     return feof( fp->fp ) ? 1 : 0;
 }
 
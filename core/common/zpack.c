@@ -0,0 +1,225 @@
+/*
+ *  Copyright (C) SplinterGU (Fenix/BennuGD) (Since 2006)
+ *
+ *  This file is part of Bennu Game Development
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "zpack.h"
+
+/* ------------------------------------------------------------------------- */
+
+/*
+ *  A block is a list of sequences. Each one has a token byte (literal count
+ *  in the high nibble, match length - 4 in the low one; 15 means more length
+ *  bytes follow, each one added until one is not 255), the literals and the
+ *  16 bits little endian distance of the match. The last sequence only has
+ *  literals.
+ */
+
+#define MIN_MATCH       4
+#define LAST_LITERALS   5       /* Last bytes of a block are always literals */
+#define MATCH_LIMIT     12      /* No match starts in the last bytes */
+#define MAX_DISTANCE    65535
+#define HASH_BITS       14
+
+static inline uint32_t read32( const uint8_t * p ) {
+    uint32_t v;
+    memcpy( &v, p, sizeof( v ) );
+    return v;
+}
+
+static inline uint32_t hash4( const uint8_t * p ) {
+    return ( read32( p ) * 2654435761U ) >> ( 32 - HASH_BITS );
+}
+
+static inline uint8_t * put_length( uint8_t * op, int n ) {
+    for ( ; n >= 255; n -= 255 ) *op++ = 255;
+    *op++ = n;
+    return op;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : zpack_compress
+ *
+ *  Compress a block (greedy parsing with a hash of the last positions)
+ *
+ *  PARAMS:
+ *              src         Data
+ *              len         Size of the data
+ *              dst         Output buffer
+ *              max         Size of the output buffer (ZPACK_BOUND(len) always fits)
+ *
+ *  RETURN VALUE:
+ *      Size of the compressed block, or 0 if it doesn't fit in max bytes
+ */
+
+int zpack_compress( const uint8_t * src, int len, uint8_t * dst, int max ) {
+    uint32_t table[1 << HASH_BITS];
+    const uint8_t * ip = src, * anchor = src, * end = src + len;
+    const uint8_t * mlimit = end - MATCH_LIMIT, * mend = end - LAST_LITERALS;
+    uint8_t * op = dst, * oend = dst + max;
+    int lit;
+
+    memset( table, 0, sizeof( table ) );
+
+    if ( len >= MATCH_LIMIT + 1 ) {
+        ip++;
+        while ( ip < mlimit ) {
+            uint32_t h = hash4( ip );
+            const uint8_t * ref = src + table[h];
+            const uint8_t * mp, * rp;
+            uint8_t * token;
+            int mlen, dist;
+
+            table[h] = ip - src;
+
+            if ( ip - ref > MAX_DISTANCE || ref >= ip || read32( ref ) != read32( ip ) ) {
+                /* Go faster over incompressible data */
+                ip += 1 + ( ( ip - anchor ) >> 6 );
+                continue;
+            }
+
+            /* Extend the match backwards and forwards */
+            while ( ip > anchor && ref > src && ip[-1] == ref[-1] ) { ip--; ref--; }
+            dist = ip - ref;
+
+            mp = ip + MIN_MATCH;
+            rp = ref + MIN_MATCH;
+            while ( mp < mend && *mp == *rp ) { mp++; rp++; }
+            mlen = mp - ip - MIN_MATCH;
+
+            lit = ip - anchor;
+            if ( op + 1 + lit + lit / 255 + 2 + mlen / 255 + 1 > oend ) return 0;
+
+            token = op++;
+            *token = ( lit >= 15 ? 15 : lit ) << 4;
+            if ( lit >= 15 ) op = put_length( op, lit - 15 );
+            memcpy( op, anchor, lit );
+            op += lit;
+
+            *op++ = dist & 0xff;
+            *op++ = dist >> 8;
+
+            *token |= mlen >= 15 ? 15 : mlen;
+            if ( mlen >= 15 ) op = put_length( op, mlen - 15 );
+
+            /* Remember a position inside the match too */
+            if ( mp - 2 < mlimit ) table[ hash4( mp - 2 ) ] = mp - 2 - src;
+
+            anchor = ip = mp;
+        }
+    }
+
+    /* Last literals */
+    lit = end - anchor;
+    if ( op + 1 + lit + lit / 255 + 1 > oend ) return 0;
+
+    *op++ = ( lit >= 15 ? 15 : lit ) << 4;
+    if ( lit >= 15 ) op = put_length( op, lit - 15 );
+    memcpy( op, anchor, lit );
+    op += lit;
+
+    return op - dst;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/*
+ *  FUNCTION : zpack_uncompress
+ *
+ *  Uncompress a block. Every length and distance is checked, so a corrupt
+ *  block can't write or read out of the buffers.
+ *
+ *  PARAMS:
+ *              src         Compressed block
+ *              clen        Size of the compressed block
+ *              dst         Output buffer
+ *              len         Size of the uncompressed data
+ *
+ *  RETURN VALUE:
+ *      len, or -1 if the block is corrupt
+ */
+
+int zpack_uncompress( const uint8_t * src, int clen, uint8_t * dst, int len ) {
+    const uint8_t * ip = src, * iend = src + clen;
+    uint8_t * op = dst, * oend = dst + len;
+
+    while ( ip < iend ) {
+        unsigned token = *ip++;
+        size_t lit = token >> 4, mlen = token & 15, dist;
+        const uint8_t * ref;
+
+        if ( lit == 15 ) {
+            unsigned c;
+            do {
+                if ( ip >= iend ) return -1;
+                lit += c = *ip++;
+            } while ( c == 255 );
+        }
+        if ( lit > ( size_t ) ( iend - ip ) || lit > ( size_t ) ( oend - op ) ) return -1;
+        memcpy( op, ip, lit );
+        op += lit;
+        ip += lit;
+
+        /* The last sequence has no match */
+        if ( ip >= iend ) break;
+
+        if ( iend - ip < 2 ) return -1;
+        dist = ip[0] | ( ip[1] << 8 );
+        ip += 2;
+        if ( !dist || dist > ( size_t ) ( op - dst ) ) return -1;
+
+        if ( mlen == 15 ) {
+            unsigned c;
+            do {
+                if ( ip >= iend ) return -1;
+                mlen += c = *ip++;
+            } while ( c == 255 );
+        }
+        mlen += MIN_MATCH;
+        if ( mlen > ( size_t ) ( oend - op ) ) return -1;
+
+        ref = op - dist;
+        if ( dist >= 8 && op + mlen + 8 <= oend ) {
+            /* Copy 8 bytes at a time, it may write a bit past the match */
+            uint8_t * mend = op + mlen;
+            do {
+                memcpy( op, ref, 8 );
+                op += 8;
+                ref += 8;
+            } while ( op < mend );
+            op = mend;
+        } else {
+            while ( mlen-- ) *op++ = *ref++;
+        }
+    }
+
+    return op == oend ? len : -1;
+}
+
+/* ------------------------------------------------------------------------- */
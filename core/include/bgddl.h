@@ -41,12 +41,19 @@
 
 /* --------------------------------------------------------------------------- */
 
+/* RFUNC() declares a reentrant function: it only works with its own
+   parameters, so parallel-safe processes may call it */
+
 #ifdef __BGDC__
 #define FUNC(a,b,c,d)     { a, b, c, NULL }
+#define RFUNC(a,b,c,d)    { a, b, c, NULL, SYSFUNC_REENTRANT }
 #else
 #define FUNC(a,b,c,d)     { a, b, c, d }
+#define RFUNC(a,b,c,d)    { a, b, c, d, SYSFUNC_REENTRANT }
 #endif
 
+#define SYSFUNC_REENTRANT   0x01
+
 /* --------------------------------------------------------------------------- */
 
 #define __bgdexport(m,a)    m##_##a
@@ -80,6 +87,7 @@ typedef struct {
     char * paramtypes;
     int64_t type;
     void * func;
+    int64_t flags;
 } DLSYSFUNCS;
 
 typedef struct {
@@ -58,7 +58,7 @@
 
 /* Please update the version's high-number between versions */
 
-#define DCB_VERSION 0x0800
+#define DCB_VERSION 0x0901
 
 #define DCL_MAGIC       "dcl\x0d\x0a\x1f\x00\x00"
 #define DCB_MAGIC       "dcb\x0d\x0a\x1f\x00\x00"
@@ -70,7 +70,7 @@ typedef struct {
     uint64_t    Code;
 } __PACKED DCB_ID;
 
-#define DCB_FILE_COMPRESSED 1
+#define DCB_FILE_COMPRESSED 1   /* zpack block, after its 64 bits uncompressed size */
 
 typedef struct {
     union {
@@ -141,6 +141,7 @@ typedef struct {
     uint64_t    SPrivate;
     uint64_t    SPublic;
     uint64_t    SCode;
+    uint64_t    SStack;
 
     uint64_t    OPrivate;
     uint64_t    OPriVars;
@@ -231,6 +232,7 @@ typedef struct {
     uint8_t         *** sourcelines;
     uint64_t        * sourcecount;
     uint8_t         ** sourcefiles;
+    uint64_t        hash;   /* Of the loaded sections, before any change */
 } __PACKED DCB_HEADER;
 
 typedef struct {
@@ -249,6 +251,7 @@ typedef struct {
 extern DCB_HEADER dcb;
 
 extern void sysprocs_fixup( void );
+extern void calls_fixup( void );
 extern int64_t getid( char * name );
 
 #endif
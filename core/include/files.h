@@ -91,11 +91,12 @@ extern int    file_flush       (file * fp) ;
 extern int    file_seek        (file * fp, long pos, int where) ;
 extern void   file_rewind      (file * fp) ;
 extern void   file_addp        (const char * path) ;
-extern void   file_close       (file * fp) ;
+extern int    file_close       (file * fp) ;
+extern void * file_load        (file * fp, long offset, long size) ;
 extern int    file_remove      (const char * filename) ;
 extern int    file_move        (const char * source_file, const char * target_file) ;
 extern int    file_exists      (const char * filename) ;
-extern void   file_add_xfile   (file * fp, const char * stubname, long offset, char * name, int size) ;
+extern void   file_add_xfile   (file * fp, const char * stubname, long offset, char * name, int size, int flags) ;
 extern int    file_eof         (file * fp) ;
 
 extern void   xfile_init       (int maxfiles);
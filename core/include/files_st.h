@@ -30,6 +30,7 @@
 #define __FILES_ST_H
 
 #include <stdio.h>
+#include <stdint.h>
 
 /* ---------------------------------------------------------------------- */
 /* File Access Functions                                                  */
@@ -38,6 +39,7 @@
 #define F_XFILE  1
 #define F_FILE   2
 #define F_GZFILE 3
+#define F_PKFILE 4
 
 #ifndef NO_ZLIB
 #include <zlib.h>
@@ -71,13 +73,39 @@
 #define PATH_SLASH
 #endif
 
+#define XFILE_COMPRESSED    1   /* Data is a zpack block, after its 64 bits uncompressed size */
+
 typedef struct {
     char * stubname;
     char * name;
     long offset;
-    int  size;
+    int  size;                      /* Uncompressed size (known after the first open) */
+    int  stored;                    /* Size of the data in the container */
+    int  flags;
+    int  next;                      /* Next file with the same name hash, or -1 */
+    const unsigned char * data;     /* Data in the mapped container, or NULL */
 } XFILE;
 
+/* Packed file: chunks compressed on their own with zpack, and an index of
+ * them at the end, so any position can be read by uncompressing one chunk */
+
+#define PACK_MAGIC      "BGDPACK\x1a"
+#define PACK_CHUNK      65536
+
+typedef struct {
+    uint32_t    chunk;              /* Uncompressed size of each chunk */
+    int64_t     size;               /* Uncompressed size of the file */
+    int64_t     pos;
+    int64_t     nchunks;
+    int64_t     allocated;          /* Entries of index (writing) */
+    uint64_t *  index;              /* File offset of each chunk */
+    int64_t     loaded;             /* Chunk in buf, or -1 */
+    int         used;               /* Bytes in buf */
+    int         writing;
+    uint8_t *   buf;                /* Uncompressed chunk */
+    uint8_t *   cbuf;               /* Compressed chunk */
+} PACKFILE;
+
 typedef struct {
     int     type;
 
@@ -85,6 +113,9 @@ typedef struct {
     gzFile  gz;
 
     XFILE * xf; // X_FILE *
+    PACKFILE * pk;
+    unsigned char * mem;            /* Contents of a X_FILE */
+    int     mem_alloc;              /* mem must be freed on close */
     int     error;
 	char	name[__MAX_PATH];
 	long    pos;
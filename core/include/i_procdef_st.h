@@ -49,6 +49,7 @@ typedef struct _procdef {
 	int64_t public_size;
 
 	int64_t code_size;
+	int64_t stack_size;
 
 	int64_t string_count;
 	int64_t pubstring_count;
@@ -60,12 +61,19 @@ typedef struct _procdef {
 	char * name;
 
     int64_t breakpoint;
+
+    /* Instance memory pool (see instance.c) */
+
+    struct _instance * pool;
+    int64_t pool_count;
+    int64_t pool_block_size;
 } PROCDEF;
 
 #define PROC_USES_FRAME 	0x01
 #define PROC_USES_LOCALS	0x02
 #define PROC_FUNCTION   	0x04
 #define PROC_USES_PUBLICS   0x08
+#define PROC_PARALLEL       0x10    /* May run on a worker thread (see jobs.c) */
 
 /* System functions */
 
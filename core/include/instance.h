@@ -64,8 +64,14 @@ extern void instance_posupdate( INSTANCE * i ) ;
 extern int instance_poschanged( INSTANCE * i ) ;
 extern int instance_exists( INSTANCE * i ) ;
 
+extern void instance_pool_get_stats( INSTANCE_POOL_STATS * stats ) ;
+extern void instance_pool_dump() ;
+extern void instance_pool_release() ;
+
 extern INSTANCE * instance_next_by_priority();
 extern void instance_dirty( INSTANCE * i ) ;
+extern void instance_park( INSTANCE * r ) ;
+extern void instance_wake( INSTANCE * r ) ;
 
 extern void instance_reset_iterator_by_priority() ;
 
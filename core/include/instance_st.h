@@ -29,12 +29,14 @@
 #ifndef __INSTANCE_ST_H
 #define __INSTANCE_ST_H
 
+/* Process IDs are FIRST_INSTANCE_ID + slot index in the low 32 bits and a
+   generation counter in the high 32 bits (see instance.c) */
+
 #define FIRST_INSTANCE_ID   0x00010000
-#define LAST_INSTANCE_ID    0x0001ffff
 
 #define STACK_RETURN_VALUE  0x8000
 #define STACK_SIZE_MASK     0x7FFF
-#define STACK_SIZE          4096
+#define STACK_SIZE          4096    /* Default, for processes without a computed size */
 
 /* ---------------------------------------------------------------------- */
 /* Instances. An instance is created from a process, but in reality,      */
@@ -71,17 +73,14 @@ typedef struct _instance {
     struct _instance * next_by_priority;
     struct _instance * prev_by_priority;
     int64_t last_priority;
+    int64_t parked;             /* In the idle list instead of the priority one */
+    int64_t job;                /* JOB_xxx, see jobs.h */
 
     /* Linked list by process_type */
 
     struct _instance * next_by_type;
     struct _instance * prev_by_type;
 
-    /* Linked list by INSTANCE * */
-
-    struct _instance * next_by_instance;
-    struct _instance * prev_by_instance;
-
     /* Function support */
 
     struct _instance * called_by;
@@ -102,6 +101,17 @@ typedef struct _instance {
 
 } INSTANCE;
 
+/* Instance memory pool statistics */
+
+typedef struct _instance_pool_stats {
+    int64_t allocated;          /* Blocks obtained from the system */
+    int64_t reused;             /* Blocks recycled from a pool */
+    int64_t in_use;             /* Blocks owned by live instances */
+    int64_t pooled;             /* Blocks waiting in a pool */
+    int64_t bytes_in_use;
+    int64_t bytes_pooled;
+} INSTANCE_POOL_STATS;
+
 /* Macros for accessing local or private instance data. */
 
 #define LOCQWORD(a,b)   ( *(uint64_t *) ((uint8_t *)(a->locdata)+b) )
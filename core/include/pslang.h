@@ -199,7 +199,24 @@
 
 #define MN_STR2CHARNUL          (0x56 | MN_0_PARAMS)
 
-/*** Free 57, 58, 59, 5A, 5B, 5C, 5D, 5E, 5F ****/
+/* Superinstructions - only emitted by the compiler peephole pass */
+
+#define MN_JFALSE_EQ            (0x57 | MN_1_PARAMS) /* compare + jfalse */
+#define MN_JFALSE_NE            (0x58 | MN_1_PARAMS)
+#define MN_JFALSE_GT            (0x59 | MN_1_PARAMS)
+#define MN_JFALSE_LT            (0x5A | MN_1_PARAMS)
+#define MN_JFALSE_GTE           (0x5B | MN_1_PARAMS)
+#define MN_JFALSE_LTE           (0x5C | MN_1_PARAMS)
+
+#define MN_VARADD_PRIV          (0x5D | MN_1_PARAMS) /* variable += immediate */
+#define MN_VARADD_LOCAL         (0x5E | MN_1_PARAMS)
+#define MN_VARADD_GLOBAL        (0x5F | MN_1_PARAMS)
+
+/* MN_VARADD_* param: variable offset (low 32 bits) and immediate (high 32 bits) */
+
+#define MN_VARIMM(offset,imm)   ((int64_t)(((uint64_t)(uint32_t)(imm) << 32) | (uint32_t)(offset)))
+#define MN_VARIMM_OFFSET(param) ((uint32_t)(param))
+#define MN_VARIMM_VALUE(param)  ((int32_t)((uint64_t)(param) >> 32))
 
 #define MN_A2STR                (0x60 | MN_1_PARAMS)
 #define MN_STR2A                (0x61 | MN_1_PARAMS)
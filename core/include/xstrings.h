@@ -42,23 +42,28 @@ extern int decode_utf8_strings;
 extern void _string_ptoa( unsigned char *t, void * p );
 extern void _string_ntoa( unsigned char *p, uint64_t n );
 extern void _string_utoa( unsigned char *p, uint64_t n );
+extern int _string_dtoa( unsigned char *p, double n, int dec );
 extern int64_t      string_atop( unsigned char *str );
 
 extern void         string_init() ;
 extern const unsigned char * string_get( int64_t code ) ;
+extern int64_t      string_length( int64_t code ) ;
 extern void         string_dump( int ( *wlog )( const char *fmt, ... ) );
-extern void         string_load( void *, int64_t, int64_t, int64_t, int64_t ) ;
+extern void         string_load( const void *, const void *, int64_t, int64_t ) ;
 extern int64_t      string_new( const unsigned char * ptr ) ;
 extern int64_t      string_newa( const unsigned char * ptr, unsigned count ) ;
 extern void         string_use( int64_t code ) ;
 extern void         string_discard( int64_t code ) ;
 extern int64_t      string_add( int64_t code1, int64_t code2 ) ;
+extern int64_t      string_append( int64_t code1, int64_t code2 ) ;
 extern int64_t      string_compile( const unsigned char ** source ) ;
 extern int64_t      string_itoa( int64_t n ) ;
 extern int64_t      string_uitoa( int64_t n ) ;
 extern int64_t      string_ftoa( double n ) ;
 extern int64_t      string_ptoa( void * n ) ;
 extern int64_t      string_comp( int64_t code1, int64_t code2 ) ;
+extern int64_t      string_equal( int64_t code1, int64_t code2 ) ;
+extern uint64_t     string_hash( int64_t code ) ;
 extern int64_t      string_casecmp( int64_t code1, int64_t code2 ) ;
 extern int64_t      string_char( int64_t n, int nchar ) ;
 extern int64_t      string_substr( int64_t code, int first, int len ) ;
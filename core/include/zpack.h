@@ -0,0 +1,44 @@
+/*
+ *  Copyright (C) SplinterGU (Fenix/BennuGD) (Since 2006)
+ *
+ *  This file is part of Bennu Game Development
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty. In no event will the authors be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *
+ *     2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ */
+
+#ifndef __ZPACK_H
+#define __ZPACK_H
+
+#include <stdint.h>
+
+/* ------------------------------------------------------------------------- */
+/* Fast LZ77 block codec (LZ4 block layout). Blocks are independent, so any  */
+/* chunk of a packed file can be uncompressed without reading the previous. */
+/* ------------------------------------------------------------------------- */
+
+#define ZPACK_BOUND(n)  ( ( n ) + ( n ) / 255 + 16 )
+
+extern int zpack_compress( const uint8_t * src, int len, uint8_t * dst, int max );
+extern int zpack_uncompress( const uint8_t * src, int clen, uint8_t * dst, int len );
+
+/* ------------------------------------------------------------------------- */
+
+#endif
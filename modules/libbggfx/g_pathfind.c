@@ -29,6 +29,7 @@
 /* --------------------------------------------------------------------------- */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "libbggfx.h"
@@ -88,44 +89,39 @@ static double chebyshev(int dx, int dy) {
 /* Grid                                                                        */
 /* --------------------------------------------------------------------------- */
 
-GRID * path_new( GRAPH * gr ) {
-    if ( !gr ) return NULL;
-    SDL_Surface * surface;
+/* The walkmap has a border of blocked cells, so x and y may go one step out of the grid */
+#define walkableAt(grid,x,y)    ( (grid)->walkmap[((x)+1)+((y)+1)*(grid)->pitch] )
 
-#ifdef USE_SDL2
-    if ( !gr->surface || gr->surface->format->BitsPerPixel == 1 ) return NULL;
-#endif
-#ifdef USE_SDL2_GPU
-    if ( !gr->tex ) return NULL;
-#endif
+/* Moves to the neighbors of a cell, the straight ones first */
+static const int moves[8][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 }, { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
 
-    GRID * grid = ( GRID * ) calloc( 1, sizeof( GRID ) );
-    if ( !grid ) return NULL;
+/* --------------------------------------------------------------------------- */
 
-#ifdef USE_SDL2
-    surface = gr->surface;
-#endif
-#ifdef USE_SDL2_GPU
-    surface = GPU_CopySurfaceFromImage( gr->tex );
-    if ( !surface ) {
-        free( grid );
-        return NULL;
-    }
-#endif
+static void hpa_mark( GRID * grid, int x, int y );
+static void hpa_destroy( HPA_GRAPH * hpa );
 
-    int w = grid->w = surface->w;
-    int h = grid->h = surface->h;
+static void grid_pause( GRID * grid );
+static void grid_resume( GRID * grid );
+static void grid_release( GRID * grid );
 
-    grid->matrix = calloc( grid->w * grid->h, sizeof( NODE ) );
-    if ( !grid->matrix ) {
-        free( grid );
-#ifdef USE_SDL2_GPU
-        SDL_FreeSurface( surface );
-#endif
-        return NULL;
-    }
+/* --------------------------------------------------------------------------- */
 
-    int x, y;
+static void grid_set_walkable( GRID * grid, int pos, int walkable ) {
+    NODE * node = &grid->matrix[pos];
+
+    if ( node->walkable == walkable ) return;
+
+    node->walkable = walkable;
+    grid->walkmap[( node->x + 1 ) + ( node->y + 1 ) * grid->pitch] = walkable;
+    hpa_mark( grid, node->x, node->y );
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Reads the walkable cells from the surface, of the same size as the grid */
+
+static void grid_load( GRID * grid, SDL_Surface * surface ) {
+    int w = grid->w, h = grid->h, x, y;
 
     switch ( surface->format->BitsPerPixel ) {
         case 8: {
@@ -133,9 +129,9 @@ GRID * path_new( GRAPH * gr ) {
             int pos = 0;
             for ( y = 0; y < h; y++, pmem += surface->pitch )
                 for ( mem = pmem, x = 0; x < w; x++ ) {
-                    grid->matrix[pos].walkable = *mem++ ? 0 : 1;
                     grid->matrix[pos].x = x;
                     grid->matrix[pos].y = y;
+                    grid_set_walkable( grid, pos, *mem++ ? 0 : 1 );
                     pos++;
                 }
             break;
@@ -147,9 +143,9 @@ GRID * path_new( GRAPH * gr ) {
             int pos = 0;
             for ( y = 0; y < h; y++, pmem += surface->pitch )
                 for ( mem = ( uint16_t * ) pmem, x = 0; x < w; x++ ) {
-                    grid->matrix[pos].walkable = ( *mem++ & ~( ( uint16_t )surface->format->Amask ) ) ? 0 : 1;
                     grid->matrix[pos].x = x;
                     grid->matrix[pos].y = y;
+                    grid_set_walkable( grid, pos, ( *mem++ & ~( ( uint16_t )surface->format->Amask ) ) ? 0 : 1 );
                     pos++;
                 }
             break;
@@ -160,13 +156,13 @@ GRID * path_new( GRAPH * gr ) {
             int pos = 0;
             for ( y = 0; y < h; y++, pmem += surface->pitch )
                 for ( mem = pmem, x = 0; x < w; x++ ) {
+                    grid->matrix[pos].x = x;
+                    grid->matrix[pos].y = y;
                     uint8_t r = *mem++ << surface->format->Rmask;
                     uint8_t g = *mem++ << surface->format->Gmask;
                     uint8_t b = *mem++ << surface->format->Bmask;
-                    grid->matrix[pos].walkable = (r | g | b) ? 0 : 1;
+                    grid_set_walkable( grid, pos, (r | g | b) ? 0 : 1 );
 //                    grid->matrix[pos].walkable = ( ( *mem++ << surface->format->Rmask ) | ( *mem++ << surface->format->Gmask ) | ( *mem++ << surface->format->Bmask ) ) ? 0 : 1;
-                    grid->matrix[pos].x = x;
-                    grid->matrix[pos].y = y;
                     pos++;
                 }
             break;
@@ -178,14 +174,63 @@ GRID * path_new( GRAPH * gr ) {
             int pos = 0;
             for ( y = 0; y < h; y++, pmem += surface->pitch )
                 for ( mem = ( uint32_t * ) pmem, x = 0; x < w; x++ ) {
-                    grid->matrix[pos].walkable = ( *mem++ & ~( ( uint32_t ) surface->format->Amask ) ) ? 0 : 1;
                     grid->matrix[pos].x = x;
                     grid->matrix[pos].y = y;
+                    grid_set_walkable( grid, pos, ( *mem++ & ~( ( uint32_t ) surface->format->Amask ) ) ? 0 : 1 );
                     pos++;
                 }
             break;
         }
     }
+}
+
+/* --------------------------------------------------------------------------- */
+
+GRID * path_new( GRAPH * gr ) {
+    if ( !gr ) return NULL;
+    SDL_Surface * surface;
+
+#ifdef USE_SDL2
+    if ( !gr->surface || gr->surface->format->BitsPerPixel == 1 ) return NULL;
+#endif
+#ifdef USE_SDL2_GPU
+    if ( !gr->tex ) return NULL;
+#endif
+
+    GRID * grid = ( GRID * ) calloc( 1, sizeof( GRID ) );
+    if ( !grid ) return NULL;
+
+#ifdef USE_SDL2
+    surface = gr->surface;
+#endif
+#ifdef USE_SDL2_GPU
+    surface = GPU_CopySurfaceFromImage( gr->tex );
+    if ( !surface ) {
+        free( grid );
+        return NULL;
+    }
+#endif
+
+    grid->w = surface->w;
+    grid->h = surface->h;
+
+    grid->matrix = calloc( grid->w * grid->h, sizeof( NODE ) );
+    grid->pitch = grid->w + 2;
+    grid->walkmap = calloc( grid->pitch * ( grid->h + 2 ), sizeof( uint8_t ) );
+    grid->lock = SDL_CreateMutex();
+    if ( !grid->matrix || !grid->walkmap || !grid->lock ) {
+        free( grid->matrix );
+        free( grid->walkmap );
+        if ( grid->lock ) SDL_DestroyMutex( grid->lock );
+        free( grid );
+#ifdef USE_SDL2_GPU
+        SDL_FreeSurface( surface );
+#endif
+        return NULL;
+    }
+
+    grid_load( grid, surface );
+
 #ifdef USE_SDL2_GPU
     SDL_FreeSurface( surface );
 #endif
@@ -194,73 +239,165 @@ GRID * path_new( GRAPH * gr ) {
 
 /* --------------------------------------------------------------------------- */
 
+/* Reloads the walkable cells from a graphic of the same size. Clusters of
+   the PF_HPA graphs whose cells changed are rebuilt on their next search.
+   Requests being searched over the grid end first. */
+
+int path_update( GRID * grid, GRAPH * gr ) {
+    if ( !grid || !gr ) return 0;
+    SDL_Surface * surface;
+
+#ifdef USE_SDL2
+    if ( !gr->surface || gr->surface->format->BitsPerPixel == 1 ) return 0;
+    surface = gr->surface;
+#endif
+#ifdef USE_SDL2_GPU
+    if ( !gr->tex ) return 0;
+    surface = GPU_CopySurfaceFromImage( gr->tex );
+    if ( !surface ) return 0;
+#endif
+
+    int ok = surface->w == grid->w && surface->h == grid->h;
+    if ( ok ) {
+        grid_pause( grid );
+        grid_load( grid, surface );
+        grid_resume( grid );
+    }
+
+#ifdef USE_SDL2_GPU
+    SDL_FreeSurface( surface );
+#endif
+    return ok;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Requests still waiting for the grid fail */
+
 void path_destroy( GRID * grid ) {
     if ( grid ) {
+        grid_release( grid );
+        free( grid->open[0].nodes );
+        free( grid->open[1].nodes );
         free( grid->matrix );
+        free( grid->walkmap );
+        hpa_destroy( grid->hpa[0] );
+        hpa_destroy( grid->hpa[1] );
+        SDL_DestroyMutex( grid->lock );
         free( grid );
     }
 }
 
 /* --------------------------------------------------------------------------- */
 
-static void resetGrid( GRID * g ) {
-    int i, l = g->h * g->w;
-    for ( i = 0; i < l; i++) {
-        g->matrix[i].f = 0;
-        g->matrix[i].g = 0;
-        g->matrix[i].h = 0;
-        g->matrix[i].opened = 0;
-        g->matrix[i].parent = NULL;
-        g->matrix[i].next = NULL;
-        g->matrix[i].prev = NULL;
+/* Starts a new search. Nodes keep the state of the last search that
+   touched them, node_touch() clears it the first time the new one does */
+
+static void grid_new_search( GRID * g ) {
+    if ( !++g->generation ) {
+        int i, j, d, l = g->h * g->w;
+        for ( i = 0; i < l; i++ ) g->matrix[i].generation = 0;
+        for ( d = 0; d < 2; d++ ) {
+            if ( !g->hpa[d] ) continue;
+            for ( i = 0; i < g->hpa[d]->cw * g->hpa[d]->ch; i++ )
+                for ( j = 0; j < g->hpa[d]->clusters[i].nnodes; j++ ) g->hpa[d]->clusters[i].nodes[j].node.generation = 0;
+        }
+        g->generation = 1;
     }
+    g->order = 0;
+    g->open[0].count = 0;
+    g->open[1].count = 0;
 }
 
 /* --------------------------------------------------------------------------- */
-/*                                                                             */
+
+static NODE * node_touch( GRID * g, NODE * node ) {
+    if ( node->generation != g->generation ) {
+        node->f = 0;
+        node->g = 0;
+        node->h = 0;
+        node->opened = 0;
+        node->closed = 0;
+        node->parent = NULL;
+        node->next = NULL;
+        node->generation = g->generation;
+    }
+    return node;
+}
+
 /* --------------------------------------------------------------------------- */
+/* Open lists                                                                  */
+/* --------------------------------------------------------------------------- */
+
+/* Lower f first, and on ties the first inserted, as the old sorted list did */
+#define node_before(a,b)    ( (a)->f < (b)->f || ( (a)->f == (b)->f && (a)->order < (b)->order ) )
 
-/* Uso: pf_open = add(pf_open, this) ; */
-/* La lista permanecerá ordenada */
-static NODE * node_add( NODE * list, NODE * this ) {
-    NODE * curr = list;
-    if ( !curr ) {
-        this->next = NULL;
-        this->prev = NULL;
-        return this;
+static void heap_up( NODE_HEAP * heap, int i ) {
+    NODE * node = heap->nodes[i];
+
+    while ( i > 0 ) {
+        int parent = ( i - 1 ) >> 1;
+        if ( !node_before( node, heap->nodes[parent] ) ) break;
+        heap->nodes[i] = heap->nodes[parent];
+        heap->nodes[i]->heap_index = i;
+        i = parent;
     }
+    heap->nodes[i] = node;
+    node->heap_index = i;
+}
 
-    if ( curr->f > this->f ) {
-        this->next = curr;
-        this->prev = NULL;
-        return this;
+/* --------------------------------------------------------------------------- */
+
+static void heap_down( NODE_HEAP * heap, int i ) {
+    NODE * node = heap->nodes[i];
+
+    for ( ;; ) {
+        int child = i * 2 + 1;
+        if ( child >= heap->count ) break;
+        if ( child + 1 < heap->count && node_before( heap->nodes[child + 1], heap->nodes[child] ) ) child++;
+        if ( !node_before( heap->nodes[child], node ) ) break;
+        heap->nodes[i] = heap->nodes[child];
+        heap->nodes[i]->heap_index = i;
+        i = child;
     }
+    heap->nodes[i] = node;
+    node->heap_index = i;
+}
 
-    for ( ; curr->next; ) {
-        if ( curr->next->f > this->f ) {
-            this->next = curr->next;
-            this->prev = curr;
-            curr->next->prev = this;
-            curr->next = this;
-            return list;
-        }
-        curr = curr->next;
+/* --------------------------------------------------------------------------- */
+
+static int heap_push( GRID * g, NODE_HEAP * heap, NODE * node ) {
+    if ( heap->count >= heap->allocated ) {
+        int allocated = heap->allocated ? heap->allocated * 2 : 256;
+        NODE ** nodes = ( NODE ** ) realloc( heap->nodes, allocated * sizeof( NODE * ) );
+        if ( !nodes ) return -1;
+        heap->nodes = nodes;
+        heap->allocated = allocated;
     }
+    node->order = g->order++;
+    heap->nodes[heap->count++] = node;
+    heap_up( heap, heap->count - 1 );
+    return 0;
+}
+
+/* --------------------------------------------------------------------------- */
 
-    curr->next = this;
-    this->prev = curr;
-    this->next = NULL;
-    return list;
+static NODE * heap_pop( NODE_HEAP * heap ) {
+    NODE * node = heap->nodes[0];
+    if ( --heap->count > 0 ) {
+        heap->nodes[0] = heap->nodes[heap->count];
+        heap_down( heap, 0 );
+    }
+    return node;
 }
 
 /* --------------------------------------------------------------------------- */
 
-/* Uso: pf_open = remove(pf_open, this) ; */
-static NODE * node_remove( NODE * list, NODE * this ) {
-    if ( this->next ) this->next->prev = this->prev;
-    if ( this->prev ) this->prev->next = this->next;
-    if ( list == this ) return this->next;
-    return list;
+/* The node's f went down: it moves behind the nodes with its new f */
+
+static void heap_decrease( GRID * g, NODE_HEAP * heap, NODE * node ) {
+    node->order = g->order++;
+    heap_up( heap, node->heap_index );
 }
 
 /* --------------------------------------------------------------------------- */
@@ -305,7 +442,7 @@ static int64_t * return_path_results( NODE * nodeA, NODE * nodeB ) {
 #define BY_END      2
 
 #define checkNeighbor(grid,node,sx,sy,dx,dy,iam,opener_target,list)  \
-            if ( (sx) >= 0 && (sx) < grid->w && (sy) >= 0 && (sy) < grid->h && ( neighbor = &grid->matrix[(sx)+(sy)*grid->w] )->walkable && !neighbor->closed ) {  \
+            if ( (sx) >= 0 && (sx) < grid->w && (sy) >= 0 && (sy) < grid->h && walkableAt( grid, (sx), (sy) ) && !( neighbor = node_touch( grid, &grid->matrix[(sx)+(sy)*grid->w] ) )->closed ) {  \
                 if ( neighbor->opened == opener_target ) {  \
                     /*  Found, make results and return */ \
                     if ( iam == BY_START ) return return_path_results( node, neighbor ); \
@@ -324,13 +461,12 @@ static int64_t * return_path_results( NODE * nodeA, NODE * nodeB ) {
                     neighbor->parent = node; \
                     if (!neighbor->opened) { \
                         neighbor->opened = iam; \
-                        list = node_add(list,neighbor); \
+                        if ( heap_push( grid, list, neighbor ) ) return NULL; \
                     } else { \
                         /* the neighbor can be reached with smaller cost. \
                            Since its f value has been updated, we have to \
                            update its position in the open list */ \
-                        list = node_remove(list,neighbor); \
-                        list = node_add(list,neighbor); \
+                        heap_decrease( grid, list, neighbor ); \
                     } \
                 } \
             }
@@ -347,39 +483,38 @@ int64_t * path_find_biastar( GRID * grid, int startX, int startY, int endX, int
          endY   < 0 || endY   >= grid->h )
         return NULL;
 
-    NODE * startOpenList = NULL, * endOpenList = NULL,
-         * startNode = &grid->matrix[startX + startY * grid->w ],
-         * endNode = &grid->matrix[endX + endY * grid->w ],
-         * node,
-         * neighbor;
+    NODE_HEAP * startOpenList = &grid->open[0], * endOpenList = &grid->open[1];
+    NODE * startNode, * endNode, * node, * neighbor;
 
     double ng;
 
     if ( weight <= 1 ) weight = 1;
 
-    resetGrid( grid );
+    grid_new_search( grid );
+
+    startNode = node_touch( grid, &grid->matrix[startX + startY * grid->w ] );
+    endNode = node_touch( grid, &grid->matrix[endX + endY * grid->w ] );
 
     // set the `g` and `f` value of the start node to be 0
     // and push it into the start open list
     startNode->g = 0;
     startNode->f = 0;
-    startOpenList = node_add(startOpenList,startNode);
+    if ( heap_push( grid, startOpenList, startNode ) ) return NULL;
     startNode->opened = BY_START;
 
     // set the `g` and `f` value of the end node to be 0
     // and push it into the open open list
     endNode->g = 0;
     endNode->f = 0;
-    endOpenList = node_add(endOpenList,endNode);
+    if ( heap_push( grid, endOpenList, endNode ) ) return NULL;
     endNode->opened = BY_END;
 
     // while both the open lists are not empty
-    while ( startOpenList && endOpenList ) {
+    while ( startOpenList->count && endOpenList->count ) {
 
         // pop the position of start node which has the minimum `f` value.
-        node = startOpenList;
+        node = heap_pop( startOpenList );
         node->closed = 1;
-        startOpenList = node_remove( startOpenList, node );
 
         checkNeighbor(grid,node,node->x,node->y-1,endX,endY,BY_START,BY_END,startOpenList);
         checkNeighbor(grid,node,node->x+1,node->y,endX,endY,BY_START,BY_END,startOpenList);
@@ -393,9 +528,8 @@ int64_t * path_find_biastar( GRID * grid, int startX, int startY, int endX, int
         }
 
         // pop the position of end node which has the minimum `f` value.
-        node = endOpenList;
+        node = heap_pop( endOpenList );
         node->closed = 1;
-        endOpenList = node_remove( endOpenList, node );
 
         checkNeighbor(grid,node,node->x,node->y-1,startX,startY,BY_END,BY_START,endOpenList);
         checkNeighbor(grid,node,node->x+1,node->y,startX,startY,BY_END,BY_START,endOpenList);
@@ -413,33 +547,1520 @@ int64_t * path_find_biastar( GRID * grid, int startX, int startY, int endX, int
     return NULL;
 }
 
+/* --------------------------------------------------------------------------- */
+/* Jump Point Search finder                                                    */
 /* --------------------------------------------------------------------------- */
 
-int64_t * path_find( GRID * grid, int startX, int startY, int endX, int endY, int options, int weight, int heuristic ) {
+/* Only for uniform cost grids. Instead of opening every neighbor, it jumps
+   along straight and diagonal lines and only opens the nodes where the
+   optimal path may turn (jump points). It finds paths of the same length as
+   an exact A* over the same moves: 4 directions, or 8 with PF_DIAG (as in
+   the A* finder, diagonal moves may cut corners). */
+
+/* Costs are kept in fixed point, so diagonal steps are counted exactly enough */
+#define JPS_COST_ONE    65536.0
+
+#define COST_STRAIGHT   ( ( int64_t ) JPS_COST_ONE )
+#define COST_DIAGONAL   ( ( int64_t ) ( JPS_COST_ONE * 1.41421356237309504880 + 0.5 ) )
+
+/* Walks from ( x, y ) in the ( dx, dy ) direction, and returns the first jump
+   point found, or NULL */
+
+static NODE * jps_jump( GRID * grid, int x, int y, int dx, int dy, NODE * endNode, int diagonal ) {
+    for ( ;; x += dx, y += dy ) {
+        if ( !walkableAt( grid, x, y ) ) return NULL;
+
+        NODE * node = &grid->matrix[x + y * grid->w];
+        if ( node == endNode ) return node;
+
+        if ( diagonal ) {
+            if ( dx && dy ) {
+                /* forced neighbors along the diagonal */
+                if ( ( walkableAt( grid, x - dx, y + dy ) && !walkableAt( grid, x - dx, y ) ) ||
+                     ( walkableAt( grid, x + dx, y - dy ) && !walkableAt( grid, x, y - dy ) ) ) return node;
+
+                /* moving diagonally, look for horizontal/vertical jump points */
+                if ( jps_jump( grid, x + dx, y, dx, 0, endNode, diagonal ) || jps_jump( grid, x, y + dy, 0, dy, endNode, diagonal ) ) return node;
+            } else if ( dx ) {
+                if ( ( walkableAt( grid, x + dx, y + 1 ) && !walkableAt( grid, x, y + 1 ) ) ||
+                     ( walkableAt( grid, x + dx, y - 1 ) && !walkableAt( grid, x, y - 1 ) ) ) return node;
+            } else {
+                if ( ( walkableAt( grid, x + 1, y + dy ) && !walkableAt( grid, x + 1, y ) ) ||
+                     ( walkableAt( grid, x - 1, y + dy ) && !walkableAt( grid, x - 1, y ) ) ) return node;
+            }
+        } else {
+            if ( dx ) {
+                if ( ( walkableAt( grid, x, y - 1 ) && !walkableAt( grid, x - dx, y - 1 ) ) ||
+                     ( walkableAt( grid, x, y + 1 ) && !walkableAt( grid, x - dx, y + 1 ) ) ) return node;
+            } else {
+                if ( ( walkableAt( grid, x - 1, y ) && !walkableAt( grid, x - 1, y - dy ) ) ||
+                     ( walkableAt( grid, x + 1, y ) && !walkableAt( grid, x + 1, y - dy ) ) ) return node;
+
+                /* moving vertically, look for horizontal jump points */
+                if ( jps_jump( grid, x + 1, y, 1, 0, endNode, diagonal ) || jps_jump( grid, x - 1, y, -1, 0, endNode, diagonal ) ) return node;
+            }
+        }
+    }
+}
 
-    double ( * heuristic_fn )( int dx, int dy );
+/* --------------------------------------------------------------------------- */
 
-    switch ( heuristic ) {
-        default:
-        case PF_HEURISTIC_MANHATTAN:
-            if ( options & PF_DIAG )    heuristic_fn = octile; // If diagonals not manhattan allowed
-            else                        heuristic_fn = manhattan;
-            break;
+/* Directions worth following from a node, pruned by the direction it was reached from */
 
-        case PF_HEURISTIC_EUCLIDEAN:
-            heuristic_fn = euclidean;
-            break;
+static int jps_directions( GRID * grid, NODE * node, int diagonal, int dirs[8][2] ) {
+    int x = node->x, y = node->y, dx, dy, n = 0;
 
-        case PF_HEURISTIC_OCTILE:
-            heuristic_fn = octile;
-            break;
+#define addDirection(ddx,ddy)   { dirs[n][0] = (ddx); dirs[n][1] = (ddy); n++; }
 
-        case PF_HEURISTIC_CHEBYSHEV:
-            heuristic_fn = chebyshev;
-            break;
+    if ( !node->parent ) {
+        addDirection(0,-1); addDirection(1,0); addDirection(0,1); addDirection(-1,0);
+        if ( diagonal ) { addDirection(-1,-1); addDirection(1,-1); addDirection(1,1); addDirection(-1,1); }
+        return n;
     }
 
-    return path_find_biastar( grid, startX, startY, endX, endY, options, weight, heuristic_fn );
+    dx = ( x > node->parent->x ) - ( x < node->parent->x );
+    dy = ( y > node->parent->y ) - ( y < node->parent->y );
+
+    if ( diagonal ) {
+        if ( dx && dy ) {
+            if ( walkableAt( grid, x, y + dy ) ) addDirection( 0, dy );
+            if ( walkableAt( grid, x + dx, y ) ) addDirection( dx, 0 );
+            if ( walkableAt( grid, x + dx, y + dy ) ) addDirection( dx, dy );
+            if ( !walkableAt( grid, x - dx, y ) ) addDirection( -dx, dy );
+            if ( !walkableAt( grid, x, y - dy ) ) addDirection( dx, -dy );
+        } else if ( dx ) {
+            if ( walkableAt( grid, x + dx, y ) ) addDirection( dx, 0 );
+            if ( !walkableAt( grid, x, y + 1 ) ) addDirection( dx, 1 );
+            if ( !walkableAt( grid, x, y - 1 ) ) addDirection( dx, -1 );
+        } else {
+            if ( walkableAt( grid, x, y + dy ) ) addDirection( 0, dy );
+            if ( !walkableAt( grid, x + 1, y ) ) addDirection( 1, dy );
+            if ( !walkableAt( grid, x - 1, y ) ) addDirection( -1, dy );
+        }
+    } else {
+        if ( dx ) {
+            addDirection( 0, -1 ); addDirection( 0, 1 ); addDirection( dx, 0 );
+        } else {
+            addDirection( -1, 0 ); addDirection( 1, 0 ); addDirection( 0, dy );
+        }
+    }
+
+#undef addDirection
+
+    return n;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Returns every cell of the path, filling the straight lines between jump points */
+
+static int64_t * jps_path_results( NODE * startNode, NODE * endNode ) {
+    NODE * node, * next = NULL;
+    int count = 1;
+
+    /* reverse the chain of jump points, counting the cells */
+    for ( node = endNode; node; node = node->parent ) {
+        node->next = next;
+        if ( next ) count += MAX( abs( next->x - node->x ), abs( next->y - node->y ) );
+        next = node;
+    }
+
+    int64_t * results = ( int64_t * ) calloc( ( count + 1 ) * 2, sizeof( int64_t ) ), * p;
+    if ( !results ) return NULL;
+    p = results;
+
+    *p++ = startNode->x;
+    *p++ = startNode->y;
+    for ( node = startNode; node->next; node = node->next ) {
+        int x = node->x, y = node->y,
+            dx = ( node->next->x > x ) - ( node->next->x < x ),
+            dy = ( node->next->y > y ) - ( node->next->y < y );
+        while ( x != node->next->x || y != node->next->y ) {
+            *p++ = x += dx;
+            *p++ = y += dy;
+        }
+    }
+    *p++ = -1;
+    *p++ = -1;
+
+    return results;
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t * path_find_jps( GRID * grid, int startX, int startY, int endX, int endY, int options, int weight, double ( * heuristic )( int dx, int dy ) ) {
+    if ( !grid ||
+         startX < 0 || startX >= grid->w ||
+         startY < 0 || startY >= grid->h ||
+         endX   < 0 || endX   >= grid->w ||
+         endY   < 0 || endY   >= grid->h )
+        return NULL;
+
+    NODE_HEAP * openList = &grid->open[0];
+    NODE * startNode, * endNode, * node, * jumpNode;
+    int diagonal = options & PF_DIAG, dirs[8][2], ndirs, n;
+    int64_t ng;
+
+    /* jumps never stop on a blocked cell */
+    if ( !walkableAt( grid, endX, endY ) ) return NULL;
+
+    if ( weight <= 1 ) weight = 1;
+
+    grid_new_search( grid );
+
+    startNode = node_touch( grid, &grid->matrix[startX + startY * grid->w ] );
+    endNode = node_touch( grid, &grid->matrix[endX + endY * grid->w ] );
+
+    startNode->g = 0;
+    startNode->f = 0;
+    if ( heap_push( grid, openList, startNode ) ) return NULL;
+    startNode->opened = 1;
+
+    while ( openList->count ) {
+        node = heap_pop( openList );
+        node->closed = 1;
+
+        if ( node == endNode ) return jps_path_results( startNode, endNode );
+
+        ndirs = jps_directions( grid, node, diagonal, dirs );
+        for ( n = 0; n < ndirs; n++ ) {
+            jumpNode = jps_jump( grid, node->x + dirs[n][0], node->y + dirs[n][1], dirs[n][0], dirs[n][1], endNode, diagonal );
+            if ( !jumpNode || node_touch( grid, jumpNode )->closed ) continue;
+
+            int jx = jumpNode->x, jy = jumpNode->y;
+
+            /* jump points are always on a straight or diagonal line */
+            ng = node->g + ( int64_t ) ( octile( abs( jx - node->x ), abs( jy - node->y ) ) * JPS_COST_ONE + 0.5 );
+
+            if ( !jumpNode->opened || ng < jumpNode->g ) {
+                jumpNode->g = ng;
+                if ( !jumpNode->h ) jumpNode->h = ( int64_t ) ( weight * heuristic( abs( jx - endX ), abs( jy - endY ) ) * JPS_COST_ONE );
+                jumpNode->f = jumpNode->g + jumpNode->h;
+                jumpNode->parent = node;
+                if ( !jumpNode->opened ) {
+                    jumpNode->opened = 1;
+                    if ( heap_push( grid, openList, jumpNode ) ) return NULL;
+                } else {
+                    heap_decrease( grid, openList, jumpNode );
+                }
+            }
+        }
+    }
+
+    // fail to find the path
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------- */
+/* Hierarchical finder (HPA*)                                                  */
+/* --------------------------------------------------------------------------- */
+
+/* The search runs over the cluster graph, from the start cell to the nodes of
+   its cluster and from the nodes of the end cluster to the end cell. Then each
+   step of the abstract path is refined with a search limited to its cluster.
+   Paths follow the same moves as the A* finder, and are near optimal: they
+   only cross clusters at transitions. */
+
+#define HPA_CLUSTER_SIZE    16
+#define HPA_MAX_ENTRANCE    6       /* Longer entrances get a transition at each end, instead of one in the middle */
+
+
+/* Cluster flags */
+#define HPA_CHANGED         1       /* Its cells changed, its borders must be found again */
+#define HPA_REBUILD         2       /* Its transitions changed, its nodes must be built again */
+#define HPA_RELINK          4       /* A neighbor was rebuilt, edges to it must be found again */
+
+/* Borders owned by a cluster, to the E, S, SE and SW neighbors */
+static const int hpa_borders[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_mark( GRID * grid, int x, int y ) {
+    int i;
+
+    for ( i = 0; i < 2; i++ ) {
+        HPA_GRAPH * hpa = grid->hpa[i];
+        if ( !hpa ) continue;
+        hpa->clusters[x / HPA_CLUSTER_SIZE + ( y / HPA_CLUSTER_SIZE ) * hpa->cw].flags |= HPA_CHANGED;
+        hpa->dirty = 1;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_destroy( HPA_GRAPH * hpa ) {
+    int i, d;
+
+    if ( !hpa ) return;
+
+    for ( i = 0; i < hpa->cw * hpa->ch; i++ ) {
+        for ( d = 0; d < 4; d++ ) free( hpa->clusters[i].border[d] );
+        free( hpa->clusters[i].nodes );
+        free( hpa->clusters[i].edges );
+    }
+    free( hpa->clusters );
+    free( hpa );
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Searches inside a cluster work on a copy of its cells, with a border of
+   blocked ones, small enough to stay in cache */
+
+#define HPA_PITCH           ( HPA_CLUSTER_SIZE + 2 )
+#define HPA_CELLS           ( HPA_PITCH * HPA_PITCH )
+#define HPA_UNSEEN          -1
+#define HPA_CLOSED          -2
+
+#define hpa_cell(c,x,y)     ( ( (x) - (c)->x0 + 1 ) + ( (y) - (c)->y0 + 1 ) * HPA_PITCH )
+#define hpa_cell_x(c,cell)  ( (c)->x0 + (cell) % HPA_PITCH - 1 )
+#define hpa_cell_y(c,cell)  ( (c)->y0 + (cell) / HPA_PITCH - 1 )
+
+typedef struct {
+    uint8_t walkable[HPA_CELLS];
+    int offsets[8];
+    int32_t costs[8];
+    int nmoves;
+    int32_t dist[HPA_CELLS];    /* Cost from the start, -1 if not reached */
+    int16_t parent[HPA_CELLS];
+    int16_t pos[HPA_CELLS];     /* Position in the heap, HPA_UNSEEN or HPA_CLOSED */
+    int16_t heap[HPA_CELLS];
+    uint8_t target[HPA_CELLS];
+    int count;
+} HPA_LOCAL;
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_local_load( GRID * grid, HPA_CLUSTER * c, int diagonal, HPA_LOCAL * s ) {
+    int x, y, n;
+
+    memset( s->walkable, 0, sizeof( s->walkable ) );
+    for ( y = c->y0; y < c->y1; y++ )
+        for ( x = c->x0; x < c->x1; x++ )
+            s->walkable[hpa_cell( c, x, y )] = walkableAt( grid, x, y );
+
+    s->nmoves = diagonal ? 8 : 4;
+    for ( n = 0; n < s->nmoves; n++ ) {
+        s->offsets[n] = moves[n][0] + moves[n][1] * HPA_PITCH;
+        s->costs[n] = ( int32_t ) ( n < 4 ? COST_STRAIGHT : COST_DIAGONAL );
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void hpa_local_up( HPA_LOCAL * s, int i ) {
+    int cell = s->heap[i];
+
+    while ( i > 0 ) {
+        int parent = ( i - 1 ) >> 1;
+        if ( s->dist[s->heap[parent]] <= s->dist[cell] ) break;
+        s->pos[s->heap[i] = s->heap[parent]] = i;
+        i = parent;
+    }
+    s->pos[s->heap[i] = cell] = i;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int hpa_local_pop( HPA_LOCAL * s ) {
+    int top = s->heap[0], cell = s->heap[--s->count], i = 0;
+
+    for ( ;; ) {
+        int child = i * 2 + 1;
+        if ( child >= s->count ) break;
+        if ( child + 1 < s->count && s->dist[s->heap[child + 1]] < s->dist[s->heap[child]] ) child++;
+        if ( s->dist[s->heap[child]] >= s->dist[cell] ) break;
+        s->pos[s->heap[i] = s->heap[child]] = i;
+        i = child;
+    }
+    if ( s->count ) s->pos[s->heap[i] = cell] = i;
+
+    s->pos[top] = HPA_CLOSED;
+    return top;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Dijkstra search from a cell of the cluster loaded with hpa_local_load().
+   Stops when the ntargets cells are reached, and returns 1, or 0 if some
+   can't be. With no targets, it visits the whole cluster. Leaves the cost to
+   each reached cell, and the way back from it. */
+
+static int hpa_local_search( HPA_LOCAL * s, int start, int16_t * targets, int ntargets ) {
+    int i, n;
+
+    for ( i = 0; i < HPA_CELLS; i++ ) {
+        s->dist[i] = -1;
+        s->pos[i] = HPA_UNSEEN;
+        s->target[i] = 0;
+    }
+    for ( i = 0; i < ntargets; i++ ) s->target[targets[i]] = 1;
+
+    s->dist[start] = 0;
+    s->parent[start] = -1;
+    s->heap[0] = start;
+    s->pos[start] = 0;
+    s->count = 1;
+
+    while ( s->count ) {
+        int cell = hpa_local_pop( s );
+
+        if ( s->target[cell] && !--ntargets ) return 1;
+
+        for ( n = 0; n < s->nmoves; n++ ) {
+            int neighbor = cell + s->offsets[n];
+            if ( !s->walkable[neighbor] || s->pos[neighbor] == HPA_CLOSED ) continue;
+
+            int32_t ng = s->dist[cell] + s->costs[n];
+            if ( s->pos[neighbor] == HPA_UNSEEN ) {
+                s->dist[neighbor] = ng;
+                s->parent[neighbor] = cell;
+                s->heap[s->count] = neighbor;
+                hpa_local_up( s, s->count++ );
+            } else if ( ng < s->dist[neighbor] ) {
+                s->dist[neighbor] = ng;
+                s->parent[neighbor] = cell;
+                hpa_local_up( s, s->pos[neighbor] );
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Finds the transitions on one of the borders owned by a cluster. Each run of
+   cells that can be crossed in a straight move (an entrance) gets one or two
+   transitions. With diagonal moves, cells that can only be crossed diagonally
+   get their own ones. */
+
+static int hpa_border( GRID * grid, HPA_GRAPH * hpa, int ci, int d ) {
+    HPA_CLUSTER * c = &hpa->clusters[ci];
+    int cx = ci % hpa->cw, cy = ci / hpa->cw,
+        dx = hpa_borders[d][0], dy = hpa_borders[d][1],
+        ax, ay, sx, sy, len, i, j, k, start, n = 0;
+    HPA_TRANSITION * t;
+
+    free( c->border[d] );
+    c->border[d] = NULL;
+    c->nborder[d] = 0;
+
+    if ( cx + dx < 0 || cx + dx >= hpa->cw || cy + dy >= hpa->ch ) return 0;
+
+    switch ( d ) {
+        case 0:  ax = c->x1 - 1; ay = c->y0;     sx = 0; sy = 1; len = c->y1 - c->y0; break;
+        case 1:  ax = c->x0;     ay = c->y1 - 1; sx = 1; sy = 0; len = c->x1 - c->x0; break;
+        case 2:  ax = c->x1 - 1; ay = c->y1 - 1; sx = 0; sy = 0; len = 1; break;
+        default: ax = c->x0;     ay = c->y1 - 1; sx = 0; sy = 0; len = 1; break;
+    }
+
+    /* corners can only be crossed diagonally */
+    if ( d >= 2 && !hpa->diagonal ) return 0;
+
+    t = ( HPA_TRANSITION * ) malloc( len * 3 * sizeof( HPA_TRANSITION ) );
+    if ( !t ) return -1;
+
+#define walkableA(i)        walkableAt( grid, ax + (i) * sx, ay + (i) * sy )
+#define walkableB(i)        walkableAt( grid, ax + (i) * sx + dx, ay + (i) * sy + dy )
+#define crossing(i)         ( walkableA(i) && walkableB(i) )
+#define addTransition(i,j,c)    { t[n].ax = ax + (i) * sx; t[n].ay = ay + (i) * sy; t[n].bx = ax + (j) * sx + dx; t[n].by = ay + (j) * sy + dy; t[n].cost = (c); n++; }
+
+    for ( i = 0; i < len; ) {
+        if ( !crossing( i ) ) {
+            i++;
+            continue;
+        }
+        for ( start = i; i < len && crossing( i ); i++ );
+        if ( i - start < HPA_MAX_ENTRANCE ) {
+            addTransition( start + ( i - start ) / 2, start + ( i - start ) / 2, d < 2 ? COST_STRAIGHT : COST_DIAGONAL );
+        } else {
+            addTransition( start, start, COST_STRAIGHT );
+            addTransition( i - 1, i - 1, COST_STRAIGHT );
+        }
+    }
+
+    /* Cells next to each other on a side are connected, so a diagonal
+       transition is only needed between runs of cells that no other
+       transition joins */
+    if ( hpa->diagonal && d < 2 ) {
+        int runA[HPA_CLUSTER_SIZE], runB[HPA_CLUSTER_SIZE];
+
+        for ( i = 0; i < len; i++ ) {
+            runA[i] = walkableA(i) ? ( i && runA[i - 1] >= 0 ? runA[i - 1] : i ) : -1;
+            runB[i] = walkableB(i) ? ( i && runB[i - 1] >= 0 ? runB[i - 1] : i ) : -1;
+        }
+
+        for ( i = 0; i < len; i++ ) {
+            if ( runA[i] < 0 ) continue;
+            for ( j = i - 1; j <= i + 1; j += 2 ) {
+                if ( j < 0 || j >= len || runB[j] < 0 ) continue;
+                for ( k = 0; k < n; k++ ) {
+                    /* positions along the border */
+                    int ti = ( t[k].ax - ax ) + ( t[k].ay - ay ), tj = ( t[k].bx - dx - ax ) + ( t[k].by - dy - ay );
+                    if ( runA[ti] == runA[i] && runB[tj] == runB[j] ) break;
+                }
+                if ( k == n ) addTransition( i, j, COST_DIAGONAL );
+            }
+        }
+    }
+
+#undef walkableA
+#undef walkableB
+#undef crossing
+#undef addTransition
+
+    if ( !n ) {
+        free( t );
+        return 0;
+    }
+
+    c->border[d] = t;
+    c->nborder[d] = n;
+    return 0;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Builds the nodes of a cluster, one per cell in its transitions, with edges
+   to the other side of each transition and to every node of the cluster that
+   can be reached without leaving it */
+
+static int hpa_cluster_build( GRID * grid, HPA_GRAPH * hpa, int ci ) {
+    HPA_CLUSTER * c = &hpa->clusters[ci], * o;
+    int cx = ci % hpa->cw, cy = ci / hpa->cw, d, i, j, k, nlinks = 0, nnodes = 0, nedges;
+    HPA_NODE * nodes = NULL, * node;
+    HPA_EDGE * edges = NULL, * e;
+    HPA_TRANSITION * t;
+    HPA_LOCAL local;
+    int16_t cells[HPA_CELLS];
+
+    /* transitions of its own borders, and of the borders its neighbors own towards it */
+    for ( d = 0; d < 4; d++ ) {
+        nlinks += c->nborder[d];
+        int ox = cx - hpa_borders[d][0], oy = cy - hpa_borders[d][1];
+        if ( ox >= 0 && ox < hpa->cw && oy >= 0 ) nlinks += hpa->clusters[ox + oy * hpa->cw].nborder[d];
+    }
+
+    if ( nlinks ) {
+        nodes = ( HPA_NODE * ) calloc( nlinks, sizeof( HPA_NODE ) );
+        if ( !nodes ) return -1;
+    }
+
+    /* one node per cell, counting its edges to other clusters */
+#define forEachLink(code) \
+    for ( d = 0; d < 4; d++ ) { \
+        int ox = cx - hpa_borders[d][0], oy = cy - hpa_borders[d][1], x, y, tx, ty, tcluster; \
+        for ( t = c->border[d], k = 0; k < c->nborder[d]; k++, t++ ) { \
+            x = t->ax; y = t->ay; tx = t->bx; ty = t->by; tcluster = ci + hpa_borders[d][0] + hpa_borders[d][1] * hpa->cw; \
+            code \
+        } \
+        if ( ox < 0 || ox >= hpa->cw || oy < 0 ) continue; \
+        o = &hpa->clusters[ox + oy * hpa->cw]; \
+        for ( t = o->border[d], k = 0; k < o->nborder[d]; k++, t++ ) { \
+            x = t->bx; y = t->by; tx = t->ax; ty = t->ay; tcluster = ox + oy * hpa->cw; \
+            code \
+        } \
+    }
+
+#define findNode() \
+    for ( node = nodes, i = 0; i < nnodes && ( node->node.x != x || node->node.y != y ); i++, node++ );
+
+    forEachLink(
+        findNode();
+        if ( i == nnodes ) {
+            node->node.x = x;
+            node->node.y = y;
+            node->cluster = ci;
+            node->index = nnodes++;
+        }
+        node->nedges++;
+        ( void ) tx; ( void ) ty; ( void ) tcluster;
+    )
+
+    nedges = nlinks + nnodes * ( nnodes - 1 );
+    if ( nedges ) {
+        edges = ( HPA_EDGE * ) calloc( nedges, sizeof( HPA_EDGE ) );
+        if ( !edges ) {
+            free( nodes );
+            return -1;
+        }
+    }
+
+    for ( e = edges, i = 0; i < nnodes; i++ ) {
+        nodes[i].edges = e;
+        e += nodes[i].nedges + nnodes - 1;
+        nodes[i].nedges = 0;
+    }
+
+    forEachLink(
+        findNode();
+        e = &node->edges[node->nedges++];
+        e->cost = t->cost;
+        e->cluster = tcluster;
+        e->x = tx;
+        e->y = ty;
+    )
+
+#undef forEachLink
+#undef findNode
+
+    /* distances inside the cluster, the same both ways */
+    hpa_local_load( grid, c, hpa->diagonal, &local );
+    for ( i = 0; i < nnodes; i++ ) cells[i] = hpa_cell( c, nodes[i].node.x, nodes[i].node.y );
+
+    for ( i = 0; i < nnodes - 1; i++ ) {
+        hpa_local_search( &local, cells[i], &cells[i + 1], nnodes - i - 1 );
+        for ( j = i + 1; j < nnodes; j++ ) {
+            int64_t cost = local.dist[cells[j]];
+            if ( cost < 0 ) continue;
+
+            e = &nodes[i].edges[nodes[i].nedges++];
+            e->to = &nodes[j];
+            e->cost = cost;
+            e->cluster = ci;
+            e->x = nodes[j].node.x;
+            e->y = nodes[j].node.y;
+
+            e = &nodes[j].edges[nodes[j].nedges++];
+            e->to = &nodes[i];
+            e->cost = cost;
+            e->cluster = ci;
+            e->x = nodes[i].node.x;
+            e->y = nodes[i].node.y;
+        }
+    }
+
+    free( c->nodes );
+    free( c->edges );
+    c->nodes = nodes;
+    c->nnodes = nnodes;
+    c->edges = edges;
+    return 0;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Points the edges of a cluster to the nodes of its neighbors */
+
+static void hpa_cluster_relink( HPA_GRAPH * hpa, HPA_CLUSTER * c ) {
+    int i, j, k;
+
+    for ( i = 0; i < c->nnodes; i++ ) {
+        for ( j = 0; j < c->nodes[i].nedges; j++ ) {
+            HPA_EDGE * e = &c->nodes[i].edges[j];
+            HPA_CLUSTER * o = &hpa->clusters[e->cluster];
+            if ( o == c ) continue;
+            e->to = NULL;
+            for ( k = 0; k < o->nnodes; k++ ) {
+                if ( o->nodes[k].node.x == e->x && o->nodes[k].node.y == e->y ) {
+                    e->to = &o->nodes[k];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Sets a flag on a cluster and its 8 neighbors */
+
+static void hpa_flag_around( HPA_GRAPH * hpa, int ci, int flag ) {
+    int cx = ci % hpa->cw, cy = ci / hpa->cw, x, y;
+
+    for ( y = MAX( cy - 1, 0 ); y <= cy + 1 && y < hpa->ch; y++ )
+        for ( x = MAX( cx - 1, 0 ); x <= cx + 1 && x < hpa->cw; x++ )
+            hpa->clusters[x + y * hpa->cw].flags |= flag;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Returns the cluster graph for the moves, building it or the clusters that
+   changed since the last search */
+
+static HPA_GRAPH * hpa_get( GRID * grid, int diagonal ) {
+    HPA_GRAPH * hpa = grid->hpa[diagonal];
+    int i, d, n;
+
+    if ( !hpa ) {
+        hpa = ( HPA_GRAPH * ) calloc( 1, sizeof( HPA_GRAPH ) );
+        if ( !hpa ) return NULL;
+
+        hpa->cw = ( grid->w + HPA_CLUSTER_SIZE - 1 ) / HPA_CLUSTER_SIZE;
+        hpa->ch = ( grid->h + HPA_CLUSTER_SIZE - 1 ) / HPA_CLUSTER_SIZE;
+        hpa->diagonal = diagonal;
+        hpa->dirty = 1;
+
+        hpa->clusters = ( HPA_CLUSTER * ) calloc( hpa->cw * hpa->ch, sizeof( HPA_CLUSTER ) );
+        if ( !hpa->clusters ) {
+            free( hpa );
+            return NULL;
+        }
+
+        for ( i = 0; i < hpa->cw * hpa->ch; i++ ) {
+            HPA_CLUSTER * c = &hpa->clusters[i];
+            c->x0 = ( i % hpa->cw ) * HPA_CLUSTER_SIZE;
+            c->y0 = ( i / hpa->cw ) * HPA_CLUSTER_SIZE;
+            c->x1 = MIN( c->x0 + HPA_CLUSTER_SIZE, grid->w );
+            c->y1 = MIN( c->y0 + HPA_CLUSTER_SIZE, grid->h );
+            c->flags = HPA_CHANGED;
+        }
+
+        grid->hpa[diagonal] = hpa;
+    }
+
+    if ( !hpa->dirty ) return hpa;
+
+    /* Flags are only cleared once their work is done, so after running out of
+       memory the next search goes on from here */
+
+    n = hpa->cw * hpa->ch;
+
+    for ( i = 0; i < n; i++ ) {
+        if ( !( hpa->clusters[i].flags & HPA_CHANGED ) ) continue;
+        int cx = i % hpa->cw, cy = i / hpa->cw;
+        for ( d = 0; d < 4; d++ ) {
+            int ox = cx - hpa_borders[d][0], oy = cy - hpa_borders[d][1];
+            if ( hpa_border( grid, hpa, i, d ) ) return NULL;
+            if ( ox >= 0 && ox < hpa->cw && oy >= 0 && hpa_border( grid, hpa, ox + oy * hpa->cw, d ) ) return NULL;
+        }
+        hpa_flag_around( hpa, i, HPA_REBUILD );
+        hpa->clusters[i].flags &= ~HPA_CHANGED;
+    }
+
+    for ( i = 0; i < n; i++ ) {
+        if ( !( hpa->clusters[i].flags & HPA_REBUILD ) ) continue;
+        if ( hpa_cluster_build( grid, hpa, i ) ) return NULL;
+        hpa_flag_around( hpa, i, HPA_RELINK );
+        hpa->clusters[i].flags &= ~HPA_REBUILD;
+    }
+
+    for ( i = 0; i < n; i++ ) {
+        if ( !( hpa->clusters[i].flags & HPA_RELINK ) ) continue;
+        hpa_cluster_relink( hpa, &hpa->clusters[i] );
+        hpa->clusters[i].flags &= ~HPA_RELINK;
+    }
+
+    hpa->dirty = 0;
+    return hpa;
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t * path_find_hpa( GRID * grid, int startX, int startY, int endX, int endY, int options, int weight, double ( * heuristic )( int dx, int dy ) ) {
+    if ( !grid ||
+         startX < 0 || startX >= grid->w ||
+         startY < 0 || startY >= grid->h ||
+         endX   < 0 || endX   >= grid->w ||
+         endY   < 0 || endY   >= grid->h )
+        return NULL;
+
+    if ( !walkableAt( grid, startX, startY ) || !walkableAt( grid, endX, endY ) ) return NULL;
+
+    int diagonal = ( options & PF_DIAG ) ? 1 : 0;
+    HPA_GRAPH * hpa = hpa_get( grid, diagonal );
+    if ( !hpa ) return NULL;
+
+    NODE_HEAP * openList = &grid->open[0];
+    HPA_CLUSTER * startCluster = &hpa->clusters[startX / HPA_CLUSTER_SIZE + ( startY / HPA_CLUSTER_SIZE ) * hpa->cw],
+                * endCluster = &hpa->clusters[endX / HPA_CLUSTER_SIZE + ( endY / HPA_CLUSTER_SIZE ) * hpa->cw];
+    HPA_NODE start = { 0 }, end = { 0 }, * hnode;
+    HPA_EDGE * e;
+    HPA_CLUSTER * loaded = NULL;
+    HPA_LOCAL local;
+    NODE * node, * neighbor, ** steps = NULL;
+    int64_t * endCosts = NULL, * results = NULL, ng, cost;
+    int i, n, nsteps, count, allocated;
+
+    if ( weight <= 1 ) weight = 1;
+
+    start.node.x = startX;
+    start.node.y = startY;
+    start.cluster = startCluster - hpa->clusters;
+    start.index = -1;
+    end.node.x = endX;
+    end.node.y = endY;
+    end.cluster = endCluster - hpa->clusters;
+    end.index = -1;
+
+    start.edges = ( HPA_EDGE * ) calloc( startCluster->nnodes + 1, sizeof( HPA_EDGE ) );
+    endCosts = ( int64_t * ) malloc( ( endCluster->nnodes + 1 ) * sizeof( int64_t ) );
+    if ( !start.edges || !endCosts ) goto fail;
+
+    /* connect the start cell to the nodes of its cluster, and to the end cell if it's there */
+    hpa_local_load( grid, startCluster, diagonal, &local );
+    hpa_local_search( &local, hpa_cell( startCluster, startX, startY ), NULL, 0 );
+    for ( i = 0; i < startCluster->nnodes; i++ ) {
+        if ( ( cost = local.dist[hpa_cell( startCluster, startCluster->nodes[i].node.x, startCluster->nodes[i].node.y )] ) < 0 ) continue;
+        start.edges[start.nedges].to = &startCluster->nodes[i];
+        start.edges[start.nedges++].cost = cost;
+    }
+    if ( startCluster == endCluster && ( cost = local.dist[hpa_cell( endCluster, endX, endY )] ) >= 0 ) {
+        start.edges[start.nedges].to = &end;
+        start.edges[start.nedges++].cost = cost;
+    }
+
+    /* and the nodes of the end cluster to the end cell */
+    hpa_local_load( grid, loaded = endCluster, diagonal, &local );
+    hpa_local_search( &local, hpa_cell( endCluster, endX, endY ), NULL, 0 );
+    for ( i = 0; i < endCluster->nnodes; i++ )
+        endCosts[i] = local.dist[hpa_cell( endCluster, endCluster->nodes[i].node.x, endCluster->nodes[i].node.y )];
+
+    /* A* over the cluster graph */
+    grid_new_search( grid );
+
+    node = node_touch( grid, &start.node );
+    if ( heap_push( grid, openList, node ) ) goto fail;
+    node->opened = 1;
+
+#define relax(to,cost)  \
+            if ( !( neighbor = node_touch( grid, (to) ) )->closed ) { \
+                ng = node->g + (cost); \
+                if ( !neighbor->opened || ng < neighbor->g ) { \
+                    neighbor->g = ng; \
+                    if ( !neighbor->h ) neighbor->h = ( int64_t ) ( weight * heuristic( abs( neighbor->x - endX ), abs( neighbor->y - endY ) ) * JPS_COST_ONE ); \
+                    neighbor->f = neighbor->g + neighbor->h; \
+                    neighbor->parent = node; \
+                    if ( !neighbor->opened ) { \
+                        neighbor->opened = 1; \
+                        if ( heap_push( grid, openList, neighbor ) ) goto fail; \
+                    } else { \
+                        heap_decrease( grid, openList, neighbor ); \
+                    } \
+                } \
+            }
+
+    while ( openList->count ) {
+        node = heap_pop( openList );
+        node->closed = 1;
+
+        if ( node == &end.node ) break;
+
+        hnode = ( HPA_NODE * ) node;
+        for ( e = hnode->edges, i = 0; i < hnode->nedges; i++, e++ ) {
+            if ( e->to ) relax( &e->to->node, e->cost );
+        }
+
+        if ( hnode->index >= 0 && hnode->cluster == end.cluster && endCosts[hnode->index] >= 0 ) relax( &end.node, endCosts[hnode->index] );
+    }
+
+#undef relax
+
+    // fail to find the path
+    if ( !end.node.closed || end.node.generation != grid->generation ) goto fail;
+
+    /* the abstract path, from start to end */
+    for ( nsteps = 0, node = &end.node; node; node = node->parent ) nsteps++;
+    steps = ( NODE ** ) malloc( nsteps * sizeof( NODE * ) );
+    if ( !steps ) goto fail;
+    for ( i = nsteps, node = &end.node; node; node = node->parent ) steps[--i] = node;
+
+    /* refine it: steps inside a cluster are searched in it, steps between clusters are adjacent cells */
+    allocated = 256;
+    results = ( int64_t * ) malloc( allocated * 2 * sizeof( int64_t ) );
+    if ( !results ) goto fail;
+    results[0] = startX;
+    results[1] = startY;
+    count = 1;
+
+    for ( n = 1; n < nsteps; n++ ) {
+        HPA_NODE * from = ( HPA_NODE * ) steps[n - 1], * to = ( HPA_NODE * ) steps[n];
+        HPA_CLUSTER * c = &hpa->clusters[to->cluster];
+        int length = 1, cell = hpa_cell( c, to->node.x, to->node.y );
+        int16_t target = cell;
+
+        if ( from->cluster == to->cluster ) {
+            if ( c != loaded ) hpa_local_load( grid, loaded = c, diagonal, &local );
+            if ( !hpa_local_search( &local, hpa_cell( c, from->node.x, from->node.y ), &target, 1 ) ) goto fail;
+            for ( length = 0, i = cell; local.parent[i] >= 0; i = local.parent[i] ) length++;
+        }
+
+        if ( count + length + 1 > allocated ) {
+            while ( count + length + 1 > allocated ) allocated *= 2;
+            int64_t * r = ( int64_t * ) realloc( results, allocated * 2 * sizeof( int64_t ) );
+            if ( !r ) goto fail;
+            results = r;
+        }
+
+        if ( from->cluster == to->cluster ) {
+            for ( i = count + length - 1; local.parent[cell] >= 0; cell = local.parent[cell], i-- ) {
+                results[i * 2] = hpa_cell_x( c, cell );
+                results[i * 2 + 1] = hpa_cell_y( c, cell );
+            }
+        } else {
+            results[count * 2] = to->node.x;
+            results[count * 2 + 1] = to->node.y;
+        }
+        count += length;
+    }
+
+    results[count * 2] = -1;
+    results[count * 2 + 1] = -1;
+
+    free( steps );
+    free( start.edges );
+    free( endCosts );
+    return results;
+
+fail:
+    free( results );
+    free( steps );
+    free( start.edges );
+    free( endCosts );
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int64_t * path_find_grid( GRID * grid, int startX, int startY, int endX, int endY, int options, int weight, int heuristic ) {
+
+    double ( * heuristic_fn )( int dx, int dy );
+
+    switch ( heuristic ) {
+        default:
+        case PF_HEURISTIC_MANHATTAN:
+            if ( options & PF_DIAG )    heuristic_fn = octile; // If diagonals not manhattan allowed
+            else                        heuristic_fn = manhattan;
+            break;
+
+        case PF_HEURISTIC_EUCLIDEAN:
+            heuristic_fn = euclidean;
+            break;
+
+        case PF_HEURISTIC_OCTILE:
+            heuristic_fn = octile;
+            break;
+
+        case PF_HEURISTIC_CHEBYSHEV:
+            heuristic_fn = chebyshev;
+            break;
+    }
+
+    if ( options & PF_HPA ) return path_find_hpa( grid, startX, startY, endX, endY, options, weight, heuristic_fn );
+    if ( options & PF_JPS ) return path_find_jps( grid, startX, startY, endX, endY, options, weight, heuristic_fn );
+
+    return path_find_biastar( grid, startX, startY, endX, endY, options, weight, heuristic_fn );
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t * path_find( GRID * grid, int startX, int startY, int endX, int endY, int options, int weight, int heuristic ) {
+    int64_t * results;
+
+    if ( !grid ) return NULL;
+
+    SDL_LockMutex( grid->lock );
+    results = path_find_grid( grid, startX, startY, endX, endY, options, weight, heuristic );
+    SDL_UnlockMutex( grid->lock );
+
+    return results;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* --------------------------------------------------------------------------- */
+/* Flow fields                                                                 */
+/* --------------------------------------------------------------------------- */
+
+/* A Dijkstra search from the goal over the whole grid, with the same moves
+   as the A* finder. Each reached cell keeps its cost to the goal and the
+   move towards it, so any number of units can follow the field one step at
+   a time, without searching. Fields use the layout of the walkmap, so its
+   blocked border keeps the search inside the grid. */
+
+#define FLOW_UNSEEN     -1
+#define FLOW_CLOSED     -2
+
+/* The move back to where a move comes from */
+#define opposite(n)     ( ( (n) & 4 ) | ( ( (n) + 2 ) & 3 ) )
+
+/* Open cells, a binary min-heap that keeps the costs with the cells */
+
+typedef struct {
+    int64_t cost;
+    int32_t cell;
+} FLOW_OPEN;
+
+static void flow_up( FLOW_OPEN * heap, int32_t * pos, int i ) {
+    FLOW_OPEN open = heap[i];
+
+    while ( i > 0 ) {
+        int parent = ( i - 1 ) >> 1;
+        if ( heap[parent].cost <= open.cost ) break;
+        heap[i] = heap[parent];
+        pos[heap[i].cell] = i;
+        i = parent;
+    }
+    heap[i] = open;
+    pos[open.cell] = i;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int32_t flow_pop( FLOW_OPEN * heap, int32_t * pos, int * count ) {
+    int32_t top = heap[0].cell;
+    FLOW_OPEN open = heap[--*count];
+    int i = 0;
+
+    for ( ;; ) {
+        int child = i * 2 + 1;
+        if ( child >= *count ) break;
+        if ( child + 1 < *count && heap[child + 1].cost < heap[child].cost ) child++;
+        if ( heap[child].cost >= open.cost ) break;
+        heap[i] = heap[child];
+        pos[heap[i].cell] = i;
+        i = child;
+    }
+    if ( *count ) {
+        heap[i] = open;
+        pos[open.cell] = i;
+    }
+
+    pos[top] = FLOW_CLOSED;
+    return top;
+}
+
+/* --------------------------------------------------------------------------- */
+
+FLOWFIELD * path_flowfield_new( GRID * grid, int goalX, int goalY, int options ) {
+    if ( !grid ||
+         goalX < 0 || goalX >= grid->w ||
+         goalY < 0 || goalY >= grid->h )
+        return NULL;
+
+    FLOWFIELD * ff = ( FLOWFIELD * ) calloc( 1, sizeof( FLOWFIELD ) );
+    if ( !ff ) return NULL;
+
+    int l = grid->pitch * ( grid->h + 2 ), i, n, count, nmoves = ( options & PF_DIAG ) ? 8 : 4, offsets[8];
+    int32_t * queue = NULL, * pos = NULL;
+    FLOW_OPEN * heap = NULL;
+
+    ff->w = grid->w;
+    ff->h = grid->h;
+    ff->pitch = grid->pitch;
+    ff->goalX = goalX;
+    ff->goalY = goalY;
+    ff->cost = ( int64_t * ) malloc( l * sizeof( int64_t ) );
+    ff->direction = ( int8_t * ) malloc( l * sizeof( int8_t ) );
+    if ( nmoves == 4 ) {
+        queue = ( int32_t * ) malloc( l * sizeof( int32_t ) );
+    } else {
+        pos = ( int32_t * ) malloc( l * sizeof( int32_t ) );
+        heap = ( FLOW_OPEN * ) malloc( l * sizeof( FLOW_OPEN ) );
+    }
+    if ( !ff->cost || !ff->direction || ( nmoves == 4 ? !queue : ( !pos || !heap ) ) ) {
+        free( queue );
+        free( pos );
+        free( heap );
+        path_flowfield_destroy( ff );
+        return NULL;
+    }
+
+    /* all bits set, -1 in all of them ( FLOW_UNSEEN in pos ) */
+    memset( ff->cost, 0xff, l * sizeof( int64_t ) );
+    memset( ff->direction, 0xff, l * sizeof( int8_t ) );
+    if ( pos ) memset( pos, 0xff, l * sizeof( int32_t ) );
+
+    for ( n = 0; n < nmoves; n++ ) offsets[n] = moves[n][0] + moves[n][1] * ff->pitch;
+
+    /* an unreachable goal leaves every cell unreachable */
+    i = ( goalX + 1 ) + ( goalY + 1 ) * ff->pitch;
+    count = 0;
+    if ( grid->walkmap[i] ) {
+        ff->cost[i] = 0;
+        count = 1;
+    }
+
+    if ( nmoves == 4 ) {
+        /* all moves cost the same, a breadth-first search finds the same costs */
+        queue[0] = i;
+        for ( i = 0; i < count; i++ ) {
+            int32_t cell = queue[i];
+
+            for ( n = 0; n < 4; n++ ) {
+                int32_t neighbor = cell + offsets[n];
+                if ( !grid->walkmap[neighbor] || ff->cost[neighbor] >= 0 ) continue;
+
+                ff->cost[neighbor] = ff->cost[cell] + COST_STRAIGHT;
+                ff->direction[neighbor] = opposite( n );
+                queue[count++] = neighbor;
+            }
+        }
+        count = 0;
+    } else {
+        heap[0].cost = 0;
+        heap[0].cell = i;
+        pos[i] = 0;
+    }
+
+    while ( count ) {
+        int32_t cell = flow_pop( heap, pos, &count );
+
+        for ( n = 0; n < nmoves; n++ ) {
+            int32_t neighbor = cell + offsets[n];
+            if ( !grid->walkmap[neighbor] || pos[neighbor] == FLOW_CLOSED ) continue;
+
+            int64_t ng = ff->cost[cell] + ( n < 4 ? COST_STRAIGHT : COST_DIAGONAL );
+            if ( pos[neighbor] == FLOW_UNSEEN ) {
+                ff->cost[neighbor] = heap[count].cost = ng;
+                ff->direction[neighbor] = opposite( n );
+                heap[count].cell = neighbor;
+                flow_up( heap, pos, count++ );
+            } else if ( ng < ff->cost[neighbor] ) {
+                ff->cost[neighbor] = heap[pos[neighbor]].cost = ng;
+                ff->direction[neighbor] = opposite( n );
+                flow_up( heap, pos, pos[neighbor] );
+            }
+        }
+    }
+
+    free( queue );
+    free( pos );
+    free( heap );
+    return ff;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Next cell from ( x, y ) towards the goal. Returns 0 at the goal, or if it
+   can't be reached from there. */
+
+int path_flowfield_next( FLOWFIELD * ff, int x, int y, int * nextX, int * nextY ) {
+    if ( !ff || x < 0 || x >= ff->w || y < 0 || y >= ff->h ) return 0;
+
+    int d = ff->direction[( x + 1 ) + ( y + 1 ) * ff->pitch];
+    if ( d < 0 ) return 0;
+
+    *nextX = x + moves[d][0];
+    *nextY = y + moves[d][1];
+    return 1;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Length of the path from ( x, y ) to the goal, or -1 if it can't be reached */
+
+double path_flowfield_distance( FLOWFIELD * ff, int x, int y ) {
+    if ( !ff || x < 0 || x >= ff->w || y < 0 || y >= ff->h ) return -1;
+
+    int64_t cost = ff->cost[( x + 1 ) + ( y + 1 ) * ff->pitch];
+    return cost < 0 ? -1 : cost / JPS_COST_ONE;
+}
+
+/* --------------------------------------------------------------------------- */
+
+void path_flowfield_destroy( FLOWFIELD * ff ) {
+    if ( ff ) {
+        free( ff->cost );
+        free( ff->direction );
+        free( ff );
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* --------------------------------------------------------------------------- */
+/* Asynchronous requests                                                       */
+/* --------------------------------------------------------------------------- */
+
+/* Requests are searched by a pool of worker threads, started with the first
+   one. Each worker searches over its own view of a grid: the same walkmap,
+   with its own nodes and open lists, so requests over the same grid run side
+   by side. PF_HPA requests share the cluster graphs of the grid, and take
+   its lock instead. Requests wait in the queue until the frame hook releases
+   them, at most budget of them per frame if there is one. Without workers,
+   the frame hook searches the released requests itself. */
+
+#define PATH_MAX_WORKERS    8
+
+static SDL_mutex * pool_lock = NULL;
+static SDL_cond * pool_wake = NULL;     /* Requests were released, a grid was resumed or the pool is closing */
+static SDL_cond * pool_idle = NULL;     /* A grid has no more running requests */
+static SDL_Thread * pool_threads[PATH_MAX_WORKERS];
+static int pool_size = 0;
+static int pool_exit = 0;
+
+static PATH_REQUEST * queued = NULL, * queued_last = NULL;          /* Waiting for the frame hook */
+static PATH_REQUEST * released = NULL, * released_last = NULL;      /* Waiting for a worker */
+static int budget = 0;
+
+/* --------------------------------------------------------------------------- */
+
+static void request_append( PATH_REQUEST ** first, PATH_REQUEST ** last, PATH_REQUEST * r ) {
+    r->next = NULL;
+    if ( *last ) ( *last )->next = r;
+    else *first = r;
+    *last = r;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int request_remove( PATH_REQUEST ** first, PATH_REQUEST ** last, PATH_REQUEST * r ) {
+    PATH_REQUEST * prev = NULL, * p;
+
+    for ( p = *first; p && p != r; p = p->next ) prev = p;
+    if ( !p ) return 0;
+
+    if ( prev ) prev->next = r->next;
+    else *first = r->next;
+    if ( *last == r ) *last = prev;
+    r->next = NULL;
+    return 1;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Search state of a worker over a grid, made on its first request there */
+
+static GRID * grid_view( GRID * grid, int worker ) {
+    GRID * view = grid->views[worker];
+    int x, y;
+
+    if ( view ) return view;
+
+    if ( !( view = ( GRID * ) calloc( 1, sizeof( GRID ) ) ) ) return NULL;
+    if ( !( view->matrix = ( NODE * ) calloc( grid->w * grid->h, sizeof( NODE ) ) ) ) {
+        free( view );
+        return NULL;
+    }
+
+    view->w = grid->w;
+    view->h = grid->h;
+    view->walkmap = grid->walkmap;
+    view->pitch = grid->pitch;
+
+    for ( y = 0; y < grid->h; y++ )
+        for ( x = 0; x < grid->w; x++ ) {
+            view->matrix[x + y * grid->w].x = x;
+            view->matrix[x + y * grid->w].y = y;
+        }
+
+    return grid->views[worker] = view;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Takes the first released request whose grid isn't paused. The pool must be locked */
+
+static PATH_REQUEST * request_take() {
+    PATH_REQUEST * r;
+
+    for ( r = released; r && r->grid->paused; r = r->next ) ;
+    if ( !r ) return NULL;
+
+    request_remove( &released, &released_last, r );
+    if ( !r->grid->views && pool_size ) r->grid->views = ( GRID ** ) calloc( PATH_MAX_WORKERS, sizeof( GRID * ) );
+    r->grid->running++;
+    r->status = PF_RUNNING;
+    return r;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Searches a taken request, with the pool unlocked. Worker -1 is the main thread */
+
+static int64_t * request_search( PATH_REQUEST * r, int worker ) {
+    GRID * view;
+
+    if ( !( r->options & PF_HPA ) && worker >= 0 && r->grid->views && ( view = grid_view( r->grid, worker ) ) )
+        return path_find_grid( view, r->startX, r->startY, r->endX, r->endY, r->options, r->weight, r->heuristic );
+
+    return path_find( r->grid, r->startX, r->startY, r->endX, r->endY, r->options, r->weight, r->heuristic );
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Stores the results of a searched request. The pool must be locked */
+
+static void request_end( PATH_REQUEST * r, int64_t * results ) {
+    if ( !--r->grid->running ) SDL_CondBroadcast( pool_idle );
+
+    if ( r->cancelled ) {
+        free( results );
+        free( r );
+        return;
+    }
+
+    r->results = results;
+    r->status = results ? PF_DONE : PF_FAILED;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static int path_worker( void * data ) {
+    int worker = ( int ) ( intptr_t ) data;
+    PATH_REQUEST * r;
+    int64_t * results;
+
+    SDL_LockMutex( pool_lock );
+    while ( !pool_exit ) {
+        if ( !( r = request_take() ) ) {
+            SDL_CondWait( pool_wake, pool_lock );
+            continue;
+        }
+        SDL_UnlockMutex( pool_lock );
+        results = request_search( r, worker );
+        SDL_LockMutex( pool_lock );
+        request_end( r, results );
+    }
+    SDL_UnlockMutex( pool_lock );
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* One worker for each core but the main thread's, none on a single core */
+
+static int path_async_init() {
+    int n;
+
+    if ( pool_lock ) return 1;
+
+    pool_lock = SDL_CreateMutex();
+    pool_wake = SDL_CreateCond();
+    pool_idle = SDL_CreateCond();
+    if ( !pool_lock || !pool_wake || !pool_idle ) {
+        if ( pool_lock ) SDL_DestroyMutex( pool_lock );
+        if ( pool_wake ) SDL_DestroyCond( pool_wake );
+        if ( pool_idle ) SDL_DestroyCond( pool_idle );
+        pool_lock = NULL;
+        pool_wake = pool_idle = NULL;
+        return 0;
+    }
+
+    n = MIN( SDL_GetCPUCount() - 1, PATH_MAX_WORKERS );
+
+    SDL_LockMutex( pool_lock );
+    for ( pool_size = 0; pool_size < n; pool_size++ )
+        if ( !( pool_threads[pool_size] = SDL_CreateThread( path_worker, "path_worker", ( void * ) ( intptr_t ) pool_size ) ) ) break;
+    SDL_UnlockMutex( pool_lock );
+
+    return 1;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* No request starts over the grid until grid_resume(), and the running ones end */
+
+static void grid_pause( GRID * grid ) {
+    if ( !pool_lock ) return;
+
+    SDL_LockMutex( pool_lock );
+    grid->paused = 1;
+    while ( grid->running ) SDL_CondWait( pool_idle, pool_lock );
+    SDL_UnlockMutex( pool_lock );
+}
+
+/* --------------------------------------------------------------------------- */
+
+static void grid_resume( GRID * grid ) {
+    if ( !pool_lock ) return;
+
+    SDL_LockMutex( pool_lock );
+    grid->paused = 0;
+    SDL_CondBroadcast( pool_wake );
+    SDL_UnlockMutex( pool_lock );
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Fails the requests waiting for the grid, and frees the views of the workers
+   once the running ones end */
+
+static void grid_release( GRID * grid ) {
+    PATH_REQUEST * r, * next;
+    PATH_REQUEST ** lists[2][2] = { { &queued, &queued_last }, { &released, &released_last } };
+    int i;
+
+    if ( pool_lock ) {
+        SDL_LockMutex( pool_lock );
+        for ( i = 0; i < 2; i++ )
+            for ( r = *lists[i][0]; r; r = next ) {
+                next = r->next;
+                if ( r->grid != grid ) continue;
+                request_remove( lists[i][0], lists[i][1], r );
+                r->status = PF_FAILED;
+            }
+        while ( grid->running ) SDL_CondWait( pool_idle, pool_lock );
+        SDL_UnlockMutex( pool_lock );
+    }
+
+    if ( grid->views ) {
+        for ( i = 0; i < PATH_MAX_WORKERS; i++ ) {
+            if ( !grid->views[i] ) continue;
+            free( grid->views[i]->open[0].nodes );
+            free( grid->views[i]->open[1].nodes );
+            free( grid->views[i]->matrix );
+            free( grid->views[i] );
+        }
+        free( grid->views );
+        grid->views = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Queues a search with the same arguments as path_find(). The script polls
+   the request with path_request_status() each frame, and takes the results
+   with path_request_results() once it ends. */
+
+PATH_REQUEST * path_find_async( GRID * grid, int startX, int startY, int endX, int endY, int options, int weight, int heuristic ) {
+    PATH_REQUEST * r;
+
+    if ( !grid || !path_async_init() ) return NULL;
+
+    if ( !( r = ( PATH_REQUEST * ) calloc( 1, sizeof( PATH_REQUEST ) ) ) ) return NULL;
+
+    r->grid = grid;
+    r->startX = startX;
+    r->startY = startY;
+    r->endX = endX;
+    r->endY = endY;
+    r->options = options;
+    r->weight = weight;
+    r->heuristic = heuristic;
+    r->status = PF_QUEUED;
+
+    SDL_LockMutex( pool_lock );
+    if ( budget ) {
+        request_append( &queued, &queued_last, r );
+    } else {
+        request_append( &released, &released_last, r );
+        SDL_CondSignal( pool_wake );
+    }
+    SDL_UnlockMutex( pool_lock );
+
+    return r;
+}
+
+/* --------------------------------------------------------------------------- */
+
+int path_request_status( PATH_REQUEST * r ) {
+    int status;
+
+    if ( !r || !pool_lock ) return PF_FAILED;
+
+    SDL_LockMutex( pool_lock );
+    status = r->status;
+    SDL_UnlockMutex( pool_lock );
+
+    return status;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Returns the path of an ended request, as path_find() does, and frees the
+   request. Requests that didn't end yet are kept, and give NULL */
+
+int64_t * path_request_results( PATH_REQUEST * r ) {
+    int64_t * results;
+
+    if ( path_request_status( r ) < PF_DONE ) return NULL;
+
+    results = r->results;
+    free( r );
+
+    return results;
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Frees a request at any point. A running search isn't stopped, its worker
+   drops the results */
+
+void path_request_cancel( PATH_REQUEST * r ) {
+    if ( !r || !pool_lock ) return;
+
+    SDL_LockMutex( pool_lock );
+    if ( r->status == PF_RUNNING ) {
+        r->cancelled = 1;
+        SDL_UnlockMutex( pool_lock );
+        return;
+    }
+    if ( !request_remove( &queued, &queued_last, r ) ) request_remove( &released, &released_last, r );
+    SDL_UnlockMutex( pool_lock );
+
+    free( r->results );
+    free( r );
+}
+
+/* --------------------------------------------------------------------------- */
+
+/* Sets how many queued requests are released each frame, 0 for no limit.
+   Returns the previous budget */
+
+int path_async_budget( int n ) {
+    int old = budget;
+
+    if ( n >= 0 ) budget = n;
+
+    return old;
+}
+
+/* --------------------------------------------------------------------------- */
+
+void path_async_frame() {
+    PATH_REQUEST * r;
+    int64_t * results;
+    int n;
+
+    if ( !pool_lock ) return;
+
+    SDL_LockMutex( pool_lock );
+
+    for ( n = 0; queued && ( !budget || n < budget ); n++ ) {
+        r = queued;
+        request_remove( &queued, &queued_last, r );
+        request_append( &released, &released_last, r );
+    }
+    if ( n ) SDL_CondBroadcast( pool_wake );
+
+    if ( !pool_size ) {
+        while ( ( r = request_take() ) ) {
+            SDL_UnlockMutex( pool_lock );
+            results = request_search( r, -1 );
+            SDL_LockMutex( pool_lock );
+            request_end( r, results );
+        }
+    }
+
+    SDL_UnlockMutex( pool_lock );
+}
+
+/* --------------------------------------------------------------------------- */
+
+void path_async_exit() {
+    PATH_REQUEST * r;
+    int i;
+
+    if ( !pool_lock ) return;
+
+    SDL_LockMutex( pool_lock );
+    pool_exit = 1;
+    SDL_CondBroadcast( pool_wake );
+    SDL_UnlockMutex( pool_lock );
+
+    for ( i = 0; i < pool_size; i++ ) SDL_WaitThread( pool_threads[i], NULL );
+
+    while ( ( r = queued ) ) {
+        queued = r->next;
+        free( r );
+    }
+    while ( ( r = released ) ) {
+        released = r->next;
+        free( r );
+    }
+    queued_last = released_last = NULL;
+
+    SDL_DestroyCond( pool_wake );
+    SDL_DestroyCond( pool_idle );
+    SDL_DestroyMutex( pool_lock );
+    pool_lock = NULL;
+    pool_wake = pool_idle = NULL;
+    pool_size = 0;
+    pool_exit = 0;
 }
 
 /* --------------------------------------------------------------------------- */
@@ -41,18 +41,115 @@ typedef struct _node {
     int walkable;
     int opened;
     int closed;
+    uint32_t generation;    /* Search that set the fields above, stale if it isn't the current one */
+    int heap_index;         /* Position in its open list */
+    int64_t order;          /* Insertion order in its open list, for ties */
     struct _node * parent;
-    struct _node * next, * prev;
+    struct _node * next;
 } NODE;
 
+/* Open list, a binary min-heap on ( f, order ) */
+
+typedef struct {
+    NODE ** nodes;
+    int count;
+    int allocated;
+} NODE_HEAP;
+
+/* Hierarchical search (PF_HPA). The grid is split in clusters, joined by
+   transitions between cells on both sides of their borders. The cells on
+   transitions are the nodes of an abstract graph, where each cluster keeps
+   the distances between its own nodes. Clusters are only rebuilt when their
+   cells change. */
+
+typedef struct _hpa_node HPA_NODE;
+
+typedef struct {
+    HPA_NODE * to;
+    int64_t cost;
+    int cluster, x, y;      /* Target cell, to find the node again when its cluster is rebuilt */
+} HPA_EDGE;
+
+struct _hpa_node {
+    NODE node;              /* Search state, must be the first field */
+    int cluster;
+    int index;              /* Position in its cluster */
+    int nedges;
+    HPA_EDGE * edges;
+};
+
+typedef struct {
+    int ax, ay;             /* Cell in the owner cluster */
+    int bx, by;             /* Cell in the neighbor cluster */
+    int64_t cost;
+} HPA_TRANSITION;
+
+typedef struct {
+    int x0, y0, x1, y1;     /* Cells [x0,x1) x [y0,y1) */
+    int flags;
+    HPA_TRANSITION * border[4]; /* Transitions to the E, S, SE and SW neighbors */
+    int nborder[4];
+    HPA_NODE * nodes;
+    int nnodes;
+    HPA_EDGE * edges;       /* Storage for the edges of all its nodes */
+} HPA_CLUSTER;
+
 typedef struct {
+    HPA_CLUSTER * clusters;
+    int cw, ch;
+    int diagonal;
+    int dirty;
+} HPA_GRAPH;
+
+typedef struct _grid {
     NODE * matrix;
     int w, h;
+    uint8_t * walkmap;      /* Walkable cells, with a blocked border: ( x + 1 ) + ( y + 1 ) * pitch */
+    int pitch;
+    uint32_t generation;
+    int64_t order;
+    NODE_HEAP open[2];
+    HPA_GRAPH * hpa[2];     /* Cluster graphs for PF_HPA, without and with PF_DIAG, built on first use */
+    SDL_mutex * lock;       /* Guards the search state above, shared by path_find() and PF_HPA requests */
+    struct _grid ** views;  /* Search state of each worker, over the same walkmap */
+    int running;            /* Requests being searched, guarded by the worker pool */
+    int paused;             /* path_update() is waiting for them, no new ones start */
 } GRID;
 
+/* Asynchronous search, see path_find_async() */
+
+typedef struct _path_request {
+    GRID * grid;
+    int startX, startY, endX, endY;
+    int options, weight, heuristic;
+    int status;
+    int cancelled;          /* Dropped while running, its worker frees it */
+    int64_t * results;
+    struct _path_request * next;
+} PATH_REQUEST;
+
+/* Flow field to a goal, for any number of units heading to it */
+
+typedef struct {
+    int w, h;
+    int pitch;              /* Fields are laid out as the walkmap: ( x + 1 ) + ( y + 1 ) * pitch */
+    int goalX, goalY;
+    int64_t * cost;         /* Integration field: cost to the goal, -1 if it can't be reached */
+    int8_t * direction;     /* Direction field: move to the next cell, -1 at the goal or if it can't be reached */
+} FLOWFIELD;
+
 /* --------------------------------------------------------------------------- */
 
 #define PF_DIAG     1
+#define PF_JPS      2   /* Jump Point Search, for uniform cost grids */
+#define PF_HPA      4   /* Hierarchical search over cached clusters, near optimal */
+
+/* Request status */
+
+#define PF_QUEUED   0
+#define PF_RUNNING  1
+#define PF_DONE     2
+#define PF_FAILED   3
 
 /* --------------------------------------------------------------------------- */
 
@@ -67,8 +164,22 @@ enum {
 
 extern GRID * path_new( GRAPH * gr );
 extern int64_t * path_find( GRID * grid, int startX, int startY, int endX, int endY, int options, int weight, int heuristic );
+extern int path_update( GRID * grid, GRAPH * gr );
 extern void path_destroy( GRID * grid );
 
+extern PATH_REQUEST * path_find_async( GRID * grid, int startX, int startY, int endX, int endY, int options, int weight, int heuristic );
+extern int path_request_status( PATH_REQUEST * r );
+extern int64_t * path_request_results( PATH_REQUEST * r );
+extern void path_request_cancel( PATH_REQUEST * r );
+extern int path_async_budget( int budget );
+extern void path_async_frame();
+extern void path_async_exit();
+
+extern FLOWFIELD * path_flowfield_new( GRID * grid, int goalX, int goalY, int options );
+extern int path_flowfield_next( FLOWFIELD * ff, int x, int y, int * nextX, int * nextY );
+extern double path_flowfield_distance( FLOWFIELD * ff, int x, int y );
+extern void path_flowfield_destroy( FLOWFIELD * ff );
+
 /* --------------------------------------------------------------------------- */
 
 #endif
@@ -253,9 +253,12 @@ static int compare_instances( const void * ptr1, const void * ptr2 ) {
     const INSTANCE * i1 = *( const INSTANCE ** )ptr1;
     const INSTANCE * i2 = *( const INSTANCE ** )ptr2;
 
-    int64_t ret = LOCQWORD( libbggfx, i2, COORDZ ) - LOCQWORD( libbggfx, i1, COORDZ );
+    int64_t z1 = LOCINT64( libbggfx, i1, COORDZ ), z2 = LOCINT64( libbggfx, i2, COORDZ );
+    int64_t id1 = LOCINT64( libbggfx, i1, PROCESS_ID ), id2 = LOCINT64( libbggfx, i2, PROCESS_ID );
 
-    return !ret ? LOCQWORD( libbggfx, i1, PROCESS_ID ) - LOCQWORD( libbggfx, i2, PROCESS_ID ) : ret;
+    /* Don't return differences, they don't fit in an int (IDs carry a generation in the high bits) */
+    if ( z1 != z2 ) return z1 < z2 ? 1 : -1;
+    return ( id1 > id2 ) - ( id1 < id2 );
 }
 
 /* --------------------------------------------------------------------------- */
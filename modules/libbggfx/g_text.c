@@ -303,13 +303,13 @@ static const char * get_text( TEXT * text ) {
             return buffer;
 
         case TEXT_DOUBLE: {
-                char * aux = buffer + ( sprintf( buffer, "%lf", *( double * )text->var ) - 1 );
+                char * aux = buffer + ( _string_dtoa( ( unsigned char * ) buffer, *( double * )text->var, 6 ) - 1 );
                 while ( *aux == '0' && *( aux - 1 ) != '.' ) *aux-- = '\0';
                 return buffer;
             }
 
         case TEXT_FLOAT: {
-                char * aux = buffer + ( sprintf( buffer, "%f", *( float * )text->var ) - 1 );
+                char * aux = buffer + ( _string_dtoa( ( unsigned char * ) buffer, *( float * )text->var, 6 ) - 1 );
                 while ( *aux == '0' && *( aux - 1 ) != '.' ) *aux-- = '\0';
                 return buffer;
             }
@@ -158,10 +158,11 @@ DLVARFIXUP __bgdexport( libbggfx, locals_fixup )[] = {
    Lowest priority last execute */
 
 HOOK __bgdexport( libbggfx, handler_hooks )[] = {
-    { 9500, gr_wait_frame },
-    { 9000, gr_draw_frame },
-    { 4700, wm_events     },
-    {    0, NULL          }
+    { 9600, path_async_frame },
+    { 9500, gr_wait_frame    },
+    { 9000, gr_draw_frame    },
+    { 4700, wm_events        },
+    {    0, NULL             }
 } ;
 
 /* --------------------------------------------------------------------------- */
@@ -209,6 +210,7 @@ void __bgdexport( libbggfx, module_initialize )() {
 /* --------------------------------------------------------------------------- */
 
 void __bgdexport( libbggfx, module_finalize )() {
+    path_async_exit();
     media_exit();
     frame_exit();
     gr_video_exit();
@@ -3357,6 +3357,7 @@ static void console_do( const char * cmd ) {
                     LOCQWORD( libmod_debug, i, STATUS ) = ( LOCQWORD( libmod_debug, i, STATUS ) & ( STATUS_WAITING_MASK | STATUS_PAUSED_MASK ) ) | STATUS_FROZEN ;
                     break;
             }
+            instance_wake( i );
             strcpy( action, oaction );
             ptr = optr;
         }
@@ -3392,6 +3393,7 @@ static void console_do( const char * cmd ) {
                 LOCQWORD( libmod_debug, i, STATUS ) = ( LOCQWORD( libmod_debug, i, STATUS ) & ( STATUS_WAITING_MASK | STATUS_PAUSED_MASK ) ) | STATUS_FROZEN ;
                 break;
         }
+        instance_wake( i );
         console_printf( COLOR_SILVER "OK" );
         return ;
     }
@@ -87,6 +87,13 @@ DLCONSTANT __bgdexport( libmod_gfx, constants_def )[] = {
 
     /* Pathfind */
     { "PF_DIAG"             , TYPE_INT          , PF_DIAG                               }, /* Allow the pathfinding from using diagonal paths. */
+    { "PF_JPS"              , TYPE_INT          , PF_JPS                                }, /* Use Jump Point Search (uniform cost grids). */
+    { "PF_HPA"              , TYPE_INT          , PF_HPA                                }, /* Use the hierarchical search over cached clusters (big maps). */
+
+    { "PF_QUEUED"           , TYPE_INT          , PF_QUEUED                             }, /* PATH_STATUS: waiting for a worker. */
+    { "PF_RUNNING"          , TYPE_INT          , PF_RUNNING                            }, /* PATH_STATUS: being searched. */
+    { "PF_DONE"             , TYPE_INT          , PF_DONE                               }, /* PATH_STATUS: found, take it with PATH_RESULTS. */
+    { "PF_FAILED"           , TYPE_INT          , PF_FAILED                             }, /* PATH_STATUS: no path, or its grid was destroyed. */
 
     { "PF_MANHATTAN"        , TYPE_INT          , PF_HEURISTIC_MANHATTAN                },
     { "PF_EUCLIDEAN"        , TYPE_INT          , PF_HEURISTIC_EUCLIDEAN                },
@@ -457,10 +464,21 @@ DLSYSFUNCS  __bgdexport( libmod_gfx, functions_exports )[] = {
 
     /* pathfind */
     FUNC( "PATH_NEW"            , "II"              , TYPE_POINTER    , libmod_gfx_path_new                     ),
+    FUNC( "PATH_UPDATE"         , "PII"             , TYPE_INT        , libmod_gfx_path_update                  ),
     FUNC( "PATH_DESTROY"        , "P"               , TYPE_INT        , libmod_gfx_path_destroy                 ),
     FUNC( "PATH_FIND"           , "PIIIII"          , TYPE_POINTER    , libmod_gfx_path_find                    ),
     FUNC( "PATH_FIND"           , "PIIIIIII"        , TYPE_POINTER    , libmod_gfx_path_find2                   ),
     FUNC( "PATH_FREE_RESULTS"   , "P"               , TYPE_INT        , libmod_gfx_path_free_results            ),
+    FUNC( "PATH_FIND_ASYNC"     , "PIIIII"          , TYPE_POINTER    , libmod_gfx_path_find_async              ),
+    FUNC( "PATH_FIND_ASYNC"     , "PIIIIIII"        , TYPE_POINTER    , libmod_gfx_path_find_async2             ),
+    FUNC( "PATH_STATUS"         , "P"               , TYPE_INT        , libmod_gfx_path_status                  ),
+    FUNC( "PATH_RESULTS"        , "P"               , TYPE_POINTER    , libmod_gfx_path_results                 ),
+    FUNC( "PATH_CANCEL"         , "P"               , TYPE_INT        , libmod_gfx_path_cancel                  ),
+    FUNC( "PATH_BUDGET"         , "I"               , TYPE_INT        , libmod_gfx_path_budget                  ),
+    FUNC( "PATH_FLOWFIELD_NEW"  , "PIII"            , TYPE_POINTER    , libmod_gfx_path_flowfield_new           ),
+    FUNC( "PATH_FLOWFIELD_NEXT" , "PIIPP"           , TYPE_INT        , libmod_gfx_path_flowfield_next          ),
+    FUNC( "PATH_FLOWFIELD_DISTANCE", "PII"          , TYPE_DOUBLE     , libmod_gfx_path_flowfield_distance      ),
+    FUNC( "PATH_FLOWFIELD_DESTROY", "P"             , TYPE_INT        , libmod_gfx_path_flowfield_destroy       ),
 
     FUNC( "TEXTURE_SET_QUALITY" , "I"               , TYPE_INT        , libmod_gfx_set_texture_quality          ),
 
@@ -29,6 +29,7 @@
 #include <SDL.h>
 
 #include <stdlib.h>
+#include <math.h>
 
 #include "bgdrtm.h"
 #include "bgddl.h"
@@ -60,6 +61,7 @@ typedef struct {
     double  scale_x;
     double  scale_y;
     int64_t flags;
+    int64_t angle;
     double  c; // cos
     double  s; // sin
     double  cn; // cos normalize
@@ -67,8 +69,10 @@ typedef struct {
     double  sx, sy;
     int64_t ncboxes;
     __cbox_info * cboxes;
+    int64_t allocated;      // cboxes are kept between calls
     int64_t ncboxes_box;
     int64_t ncboxes_circle;
+    double  reach;          // no cbox goes farther from x, y, whatever the angle
 } __obj_col_info;
 
 /* --------------------------------------------------------------------------- */
@@ -80,8 +84,6 @@ typedef struct {
 #define in_radius_box_circle(x,y,x2,y2,radius)              ((x-x2)*(x-x2)+(y-y2)*(y-y2))<((radius)*(radius))
 #define in_radius_circle_circle(x,y,x2,y2,radius,radius2)   ((x-x2)*(x-x2)+(y-y2)*(y-y2))<((radius+radius2)*(radius+radius2))
 
-#define FREE(a) free(a);a=NULL
-
 /* --------------------------------------------------------------------------- */
 // scale must be with decimal points
 
@@ -214,6 +216,62 @@ static inline void __calculate_box_limits( __obj_col_info * oci ) {
 
 /* --------------------------------------------------------------------------- */
 
+static inline int __alloc_cboxes( __obj_col_info * oci, int64_t n ) {
+    if ( n > oci->allocated ) {
+        __cbox_info * cboxes = realloc( oci->cboxes, n * sizeof( __cbox_info ) );
+        if ( !cboxes ) return 0;
+        oci->cboxes = cboxes;
+        oci->allocated = n;
+    }
+    oci->ncboxes = n;
+    return 1;
+}
+
+/* --------------------------------------------------------------------------- */
+// Rotation and mirror keep distances to x, y, so the reach doesn't depend on them
+
+static inline void __calculate_reach( __obj_col_info * oci ) {
+    double  lef_x, top_y, rig_x, bot_y, r;
+    int i;
+
+    oci->reach = 0;
+
+    for ( i = 0; i < oci->ncboxes; i++ ) {
+        lef_x = oci->scale_x * ( oci->cboxes[i].cbox.x - oci->center_x );
+        top_y = oci->scale_y * ( oci->cboxes[i].cbox.y - oci->center_y );
+        if ( oci->cboxes[i].cbox.shape == BITMAP_CB_SHAPE_CIRCLE ) {
+            r = sqrt( lef_x * lef_x + top_y * top_y ) + oci->cboxes[i].cbox.width * oci->scale_x;
+        } else {
+            rig_x = oci->scale_x * ( oci->cboxes[i].cbox.width - 1 ) + lef_x;
+            bot_y = oci->scale_y * ( oci->cboxes[i].cbox.height - 1 ) + top_y;
+            lef_x = MAX( fabs( lef_x ), fabs( rig_x ) );
+            top_y = MAX( fabs( top_y ), fabs( bot_y ) );
+            r = sqrt( lef_x * lef_x + top_y * top_y );
+        }
+        if ( oci->reach < r ) oci->reach = r;
+    }
+}
+
+/* --------------------------------------------------------------------------- */
+// Left out of __get_proc_info, candidates out of reach don't need it
+
+static inline void __calculate_rotation( __obj_col_info * oci ) {
+    int64_t angle = oci->angle;
+
+    oci->c = cos_deg( angle );
+    oci->s = sin_deg( angle );
+    oci->sx = 1;
+    oci->sy = -1;
+
+    if ( oci->flags & B_HMIRROR ) { angle = -angle; oci->sx = -1; }
+    if ( oci->flags & B_VMIRROR ) { angle = -angle; oci->sy = 1; }
+
+    oci->cn = cos_deg( angle );
+    oci->sn = sin_deg( angle );
+}
+
+/* --------------------------------------------------------------------------- */
+
 static int __get_proc_info(
         INSTANCE * proc,
         __obj_col_info * oci // Box
@@ -260,30 +318,15 @@ static int __get_proc_info(
         }
     }
 
-    int64_t angle = LOCINT64( libmod_gfx, proc, ANGLE );
+    oci->angle = LOCINT64( libmod_gfx, proc, ANGLE );
     oci->flags = LOCQWORD( libmod_gfx, proc, FLAGS );
 
-    oci->c = cos_deg( angle );
-    oci->s = sin_deg( angle );
-    oci->sx = 1;
-    oci->sy = -1;
-
-    if ( oci->flags & B_HMIRROR ) { angle = -angle; oci->sx = -1; }
-    if ( oci->flags & B_VMIRROR ) { angle = -angle; oci->sy = 1; }
-
-    oci->cn = cos_deg( angle );
-    oci->sn = sin_deg( angle );
-
     int i;
     if ( graph->ncboxes ) {
-        oci->cboxes = malloc( graph->ncboxes * sizeof( __cbox_info ) );
-        if ( !oci->cboxes ) return 0;
-        oci->ncboxes = graph->ncboxes;
+        if ( !__alloc_cboxes( oci, graph->ncboxes ) ) return 0;
         for ( i = 0; i < oci->ncboxes; i++ ) oci->cboxes[i].cbox = graph->cboxes[i];
     } else { // No graph cbox defined, use a virtual cbox
-        oci->cboxes = malloc( sizeof( __cbox_info ) );
-        if ( !oci->cboxes ) return 0;
-        oci->ncboxes = 1;
+        if ( !__alloc_cboxes( oci, 1 ) ) return 0;
         oci->cboxes->cbox.code   = -1;
         oci->cboxes->cbox.shape  = LOCINT64( libmod_gfx, proc, CSHAPE );
         oci->cboxes->cbox.x      = LOCINT64( libmod_gfx, proc, CBOX_X );
@@ -341,6 +384,8 @@ static int __get_proc_info(
         }
     }
 
+    __calculate_reach( oci );
+
     return 1;
 }
 
@@ -365,15 +410,9 @@ static int __get_mouse_info( __obj_col_info * oci ) {
     oci->center_y = 0;
 
     oci->flags = 0;
+    oci->angle = 0;
 
-    oci->cn = oci->c = cos_deg( 0 );
-    oci->sn = oci->s = sin_deg( 0 );
-    oci->sx = 1;
-    oci->sy = -1;
-
-    oci->cboxes = malloc( sizeof( __cbox_info ) );
-    if ( !oci->cboxes ) return 0;
-    oci->ncboxes = 1;
+    if ( !__alloc_cboxes( oci, 1 ) ) return 0;
     oci->cboxes->cbox.code   = -1;
     oci->cboxes->cbox.shape  = BITMAP_CB_SHAPE_BOX;
     oci->cboxes->cbox.x      = 0;
@@ -384,6 +423,8 @@ static int __get_mouse_info( __obj_col_info * oci ) {
     oci->ncboxes_box = 1;
     oci->ncboxes_circle = 0;
 
+    __calculate_reach( oci );
+
     return 1;
 }
 
@@ -417,7 +458,18 @@ static inline int __check_collision( __obj_col_info * ociA, __obj_col_info * oci
     double normalized_verticesA[8], normalized_verticesB[8], normalized_verticesC[8];
     int64_t top, bottom, left, right, minx, miny, px = 0, py = 0, _px, _py;
 
+    // Too far for any cbox pair, leave the indexes as a full scan without collision would.
+    // Boxes are compared by their bounding boxes in the other's axis, up to sqrt(2) times
+    // their reach.
+    double reach = 1.42 * ( ociA->reach + ociB->reach ) + 2.0;
+    if ( fabs( ociB->x - ociA->x ) > reach || fabs( ociB->y - ociA->y ) > reach ) {
+        if ( *idxA < ociA->ncboxes ) *idxB = 0;
+        *idxA = 0;
+        return 0;
+    }
+
     // Get real vertices
+    __calculate_rotation( ociB );
     __calculate_shape( ociB );
     if ( ociB->ncboxes_box ) __calculate_box_limits( ociB );
 
@@ -702,6 +754,7 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
     if ( !__get_proc_info( my, ociA ) ) return 0;
 
     // Get real vertices
+    __calculate_rotation( ociA );
     __calculate_shape( ociA );
     if ( ociA->ncboxes_box ) __calculate_box_limits( ociA );
 
@@ -739,8 +792,6 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
                         ociB->y -= scrolls[id_scroll].posy0 - r->y;
                     }
                 }
-                FREE( ociB->cboxes );
-                FREE( ociA->cboxes );
                 if ( collision ) {
                     (*idxB)++;
                     LOCQWORD( libmod_gfx, my, COLLISION_RESERVED_ID_SCROLL ) = id_scroll;
@@ -755,9 +806,7 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
             }
             LOCQWORD( libmod_gfx, my, COLLISION_RESERVED_ID_SCROLL ) = 0;
             collision = __check_collision( ociA, ociB, idxA, idxB, cbox_result_code, penetration ) ;
-            FREE( ociB->cboxes );
         }
-        FREE( ociA->cboxes );
         if ( collision ) {
             (*idxB)++;
             LOCINT64( libmod_gfx, my, COLLIDER_CBOX ) = -1;
@@ -794,10 +843,8 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
            ) {
             if ( __get_proc_info( ptr, ociB ) ) {
                 collision = __check_collision( ociA, ociB, idxA, idxB, cbox_result_code, penetration ) ;
-                FREE( ociB->cboxes );
                 if ( collision ) {
                     (*idxB)++;
-                    FREE( ociA->cboxes );
 
                     LOCQWORD( libmod_gfx, my, COLLISION_RESERVED_ID_SCAN ) = LOCQWORD( libmod_gfx, ptr, PROCESS_ID );
                     LOCINT64( libmod_gfx, my, COLLIDER_CBOX ) = cbox_result_code[0];
@@ -809,7 +856,6 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
                 }
             }
         }
-        FREE( ociA->cboxes );
         LOCINT64( libmod_gfx, my, COLLISION_RESERVED_MODE ) = -1;
         return 0;
     }
@@ -837,10 +883,8 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
                ) {
                 if ( __get_proc_info( ptr, ociB ) ) {
                     collision = __check_collision( ociA, ociB, idxA, idxB, cbox_result_code, penetration ) ;
-                    FREE( ociB->cboxes );
                     if ( collision ) {
                         (*idxB)++;
-                        FREE( ociA->cboxes );
                         LOCQWORD( libmod_gfx, my, COLLISION_RESERVED_ID_SCAN ) = LOCQWORD( libmod_gfx, ptr, PROCESS_ID );
                         LOCINT64( libmod_gfx, my, COLLIDER_CBOX ) = cbox_result_code[0];
                         LOCINT64( libmod_gfx, my, COLLIDED_ID   ) = LOCQWORD( libmod_gfx, ptr, PROCESS_ID );
@@ -853,7 +897,6 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
             }
             ptr = ptr->next;
         }
-        FREE( ociA->cboxes );
         LOCINT64( libmod_gfx, my, COLLISION_RESERVED_MODE ) = -1;
         return 0;
     }
@@ -886,10 +929,8 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
            ) {
             if ( __get_proc_info( ptr, ociB ) ) {
                 collision = __check_collision( ociA, ociB, idxA, idxB, cbox_result_code, penetration ) ;
-                FREE( ociB->cboxes );
                 if ( collision ) {
                     (*idxB)++;
-                    FREE( ociA->cboxes );
                     LOCQWORD( libmod_gfx, my, COLLISION_RESERVED_ID_SCAN ) = LOCQWORD( libmod_gfx, ptr, PROCESS_ID );
                     LOCINT64( libmod_gfx, my, COLLIDER_CBOX ) = cbox_result_code[0];
                     LOCINT64( libmod_gfx, my, COLLIDED_ID   ) = LOCQWORD( libmod_gfx, ptr, PROCESS_ID );
@@ -902,7 +943,6 @@ static int64_t __collision( INSTANCE * my, int64_t id ) {
         }
         ptr = instance_get_by_type( id, ctx );
     }
-    FREE( ociA->cboxes );
     LOCINT64( libmod_gfx, my, COLLISION_RESERVED_MODE ) = -1;
     return 0;
 }
@@ -47,6 +47,12 @@ int64_t libmod_gfx_path_new( INSTANCE * my, int64_t * params ) {
 
 /* --------------------------------------------------------------------------- */
 
+int64_t libmod_gfx_path_update( INSTANCE * my, int64_t * params ) {
+    return path_update( ( GRID * ) ( intptr_t ) params[0], bitmap_get( ( int ) params[1], ( int ) params[2] ) );
+}
+
+/* --------------------------------------------------------------------------- */
+
 int64_t libmod_gfx_path_destroy( INSTANCE * my, int64_t * params ) {
     path_destroy( ( GRID * ) ( intptr_t ) params[0] );
     return 1;
@@ -72,3 +78,73 @@ int64_t libmod_gfx_path_free_results( INSTANCE * my, int64_t * params ) {
 }
 
 /* --------------------------------------------------------------------------- */
+/* Bsquedas en segundo plano */
+
+int64_t libmod_gfx_path_find_async( INSTANCE * my, int64_t * params ) {
+    return ( int64_t ) ( intptr_t ) path_find_async( ( GRID * ) ( intptr_t ) params[0], ( int ) params[1], ( int ) params[2], ( int ) params[3], ( int ) params[4], ( int ) params[5], 1, PF_HEURISTIC_MANHATTAN );
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_find_async2( INSTANCE * my, int64_t * params ) {
+    return ( int64_t ) ( intptr_t ) path_find_async( ( GRID * ) ( intptr_t ) params[0], ( int ) params[1], ( int ) params[2], ( int ) params[3], ( int ) params[4], ( int ) params[5], ( int ) params[6], ( int ) params[7] );
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_status( INSTANCE * my, int64_t * params ) {
+    return path_request_status( ( PATH_REQUEST * ) ( intptr_t ) params[0] );
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_results( INSTANCE * my, int64_t * params ) {
+    return ( int64_t ) ( intptr_t ) path_request_results( ( PATH_REQUEST * ) ( intptr_t ) params[0] );
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_cancel( INSTANCE * my, int64_t * params ) {
+    path_request_cancel( ( PATH_REQUEST * ) ( intptr_t ) params[0] );
+    return 1;
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_budget( INSTANCE * my, int64_t * params ) {
+    return path_async_budget( ( int ) params[0] );
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_flowfield_new( INSTANCE * my, int64_t * params ) {
+    return ( int64_t ) ( intptr_t ) path_flowfield_new( ( GRID * ) ( intptr_t ) params[0], ( int ) params[1], ( int ) params[2], ( int ) params[3] );
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_flowfield_next( INSTANCE * my, int64_t * params ) {
+    int x, y;
+
+    if ( !path_flowfield_next( ( FLOWFIELD * ) ( intptr_t ) params[0], ( int ) params[1], ( int ) params[2], &x, &y ) ) return 0;
+
+    *( int64_t * )( intptr_t )params[3] = x;
+    *( int64_t * )( intptr_t )params[4] = y;
+    return 1;
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_flowfield_distance( INSTANCE * my, int64_t * params ) {
+    double res = path_flowfield_distance( ( FLOWFIELD * ) ( intptr_t ) params[0], ( int ) params[1], ( int ) params[2] );
+    return *( ( int64_t * ) &res );
+}
+
+/* --------------------------------------------------------------------------- */
+
+int64_t libmod_gfx_path_flowfield_destroy( INSTANCE * my, int64_t * params ) {
+    path_flowfield_destroy( ( FLOWFIELD * ) ( intptr_t ) params[0] );
+    return 1;
+}
+
+/* --------------------------------------------------------------------------- */
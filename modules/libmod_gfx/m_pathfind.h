@@ -36,10 +36,21 @@
 /* --------------------------------------------------------------------------- */
 
 int64_t libmod_gfx_path_new( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_update( INSTANCE * my, int64_t * params );
 int64_t libmod_gfx_path_destroy( INSTANCE * my, int64_t * params );
 int64_t libmod_gfx_path_find( INSTANCE * my, int64_t * params );
 int64_t libmod_gfx_path_find2( INSTANCE * my, int64_t * params );
 int64_t libmod_gfx_path_free_results( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_find_async( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_find_async2( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_status( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_results( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_cancel( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_budget( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_flowfield_new( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_flowfield_next( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_flowfield_distance( INSTANCE * my, int64_t * params );
+int64_t libmod_gfx_path_flowfield_destroy( INSTANCE * my, int64_t * params );
 
 /* --------------------------------------------------------------------------- */
 
@@ -192,41 +192,41 @@ DLSYSFUNCS  __bgdexport( libmod_misc, functions_exports)[] =
     FUNC( "FMOVE"                   , "SS"          , TYPE_INT          , libmod_misc_file_move                     ),
 
     /* Math */
-    FUNC( "MAX"                     , "DD"          , TYPE_DOUBLE       , libmod_misc_math_max                      ),
-    FUNC( "MIN"                     , "DD"          , TYPE_DOUBLE       , libmod_misc_math_min                      ),
-    FUNC( "SGN"                     , "D"           , TYPE_DOUBLE       , libmod_misc_math_sgn                      ),
-    FUNC( "SGN"                     , "I"           , TYPE_INT          , libmod_misc_math_sgn2                     ),
-    FUNC( "ROUND"                   , "D"           , TYPE_DOUBLE       , libmod_misc_math_round                    ),
-    FUNC( "FLOOR"                   , "D"           , TYPE_DOUBLE       , libmod_misc_math_floor                    ),
-    FUNC( "CEIL"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_ceil                     ),
-    FUNC( "TRUNC"                   , "D"           , TYPE_DOUBLE       , libmod_misc_math_trunc                    ),
-    FUNC( "FRAC"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_frac                     ),
-    FUNC( "DECIMAL"                 , "D"           , TYPE_DOUBLE       , libmod_misc_math_decimal                  ),
-
-    FUNC( "RAD"                     , "I"           , TYPE_DOUBLE       , libmod_misc_math_rad                      ),
-    FUNC( "DEG"                     , "D"           , TYPE_INT          , libmod_misc_math_deg                      ),
-
-    FUNC( "ABS"                     , "D"           , TYPE_DOUBLE       , libmod_misc_math_abs                      ),
-    FUNC( "EXP"                     , "D"           , TYPE_DOUBLE       , libmod_misc_math_exp                      ),
-    FUNC( "LOG"                     , "D"           , TYPE_DOUBLE       , libmod_misc_math_log                      ),
-    FUNC( "LOG10"                   , "D"           , TYPE_DOUBLE       , libmod_misc_math_log10                    ),
-    FUNC( "POW"                     , "DD"          , TYPE_DOUBLE       , libmod_misc_math_pow                      ),
-    FUNC( "SQRT"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_sqrt                     ),
-    FUNC( "FMOD"                    , "DD"          , TYPE_DOUBLE       , libmod_misc_math_fmod                     ),
-    FUNC( "MMOD"                    , "DD"          , TYPE_DOUBLE       , libmod_misc_math_modulus                  ),
-    FUNC( "MODULUS"                 , "DD"          , TYPE_DOUBLE       , libmod_misc_math_modulus                  ),
-
-    FUNC( "COS"                     , "I"           , TYPE_DOUBLE       , libmod_misc_math_cos                      ),
-    FUNC( "SIN"                     , "I"           , TYPE_DOUBLE       , libmod_misc_math_sin                      ),
-    FUNC( "TAN"                     , "I"           , TYPE_DOUBLE       , libmod_misc_math_tan                      ),
-    FUNC( "ACOS"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_acos                     ),
-    FUNC( "ASIN"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_asin                     ),
-    FUNC( "ATAN"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_atan                     ),
-    FUNC( "ATAN2"                   , "DD"          , TYPE_DOUBLE       , libmod_misc_math_atan2                    ),
-
-    FUNC( "ISINF"                   , "D"           , TYPE_INT          , libmod_misc_math_isinf                    ),
-    FUNC( "ISNAN"                   , "D"           , TYPE_INT          , libmod_misc_math_isnan                    ),
-    FUNC( "FINITE"                  , "D"           , TYPE_INT          , libmod_misc_math_finite                   ),
+    RFUNC("MAX"                     , "DD"          , TYPE_DOUBLE       , libmod_misc_math_max                      ),
+    RFUNC("MIN"                     , "DD"          , TYPE_DOUBLE       , libmod_misc_math_min                      ),
+    RFUNC("SGN"                     , "D"           , TYPE_DOUBLE       , libmod_misc_math_sgn                      ),
+    RFUNC("SGN"                     , "I"           , TYPE_INT          , libmod_misc_math_sgn2                     ),
+    RFUNC("ROUND"                   , "D"           , TYPE_DOUBLE       , libmod_misc_math_round                    ),
+    RFUNC("FLOOR"                   , "D"           , TYPE_DOUBLE       , libmod_misc_math_floor                    ),
+    RFUNC("CEIL"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_ceil                     ),
+    RFUNC("TRUNC"                   , "D"           , TYPE_DOUBLE       , libmod_misc_math_trunc                    ),
+    RFUNC("FRAC"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_frac                     ),
+    RFUNC("DECIMAL"                 , "D"           , TYPE_DOUBLE       , libmod_misc_math_decimal                  ),
+
+    RFUNC("RAD"                     , "I"           , TYPE_DOUBLE       , libmod_misc_math_rad                      ),
+    RFUNC("DEG"                     , "D"           , TYPE_INT          , libmod_misc_math_deg                      ),
+
+    RFUNC("ABS"                     , "D"           , TYPE_DOUBLE       , libmod_misc_math_abs                      ),
+    RFUNC("EXP"                     , "D"           , TYPE_DOUBLE       , libmod_misc_math_exp                      ),
+    RFUNC("LOG"                     , "D"           , TYPE_DOUBLE       , libmod_misc_math_log                      ),
+    RFUNC("LOG10"                   , "D"           , TYPE_DOUBLE       , libmod_misc_math_log10                    ),
+    RFUNC("POW"                     , "DD"          , TYPE_DOUBLE       , libmod_misc_math_pow                      ),
+    RFUNC("SQRT"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_sqrt                     ),
+    RFUNC("FMOD"                    , "DD"          , TYPE_DOUBLE       , libmod_misc_math_fmod                     ),
+    RFUNC("MMOD"                    , "DD"          , TYPE_DOUBLE       , libmod_misc_math_modulus                  ),
+    RFUNC("MODULUS"                 , "DD"          , TYPE_DOUBLE       , libmod_misc_math_modulus                  ),
+
+    RFUNC("COS"                     , "I"           , TYPE_DOUBLE       , libmod_misc_math_cos                      ),
+    RFUNC("SIN"                     , "I"           , TYPE_DOUBLE       , libmod_misc_math_sin                      ),
+    RFUNC("TAN"                     , "I"           , TYPE_DOUBLE       , libmod_misc_math_tan                      ),
+    RFUNC("ACOS"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_acos                     ),
+    RFUNC("ASIN"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_asin                     ),
+    RFUNC("ATAN"                    , "D"           , TYPE_DOUBLE       , libmod_misc_math_atan                     ),
+    RFUNC("ATAN2"                   , "DD"          , TYPE_DOUBLE       , libmod_misc_math_atan2                    ),
+
+    RFUNC("ISINF"                   , "D"           , TYPE_INT          , libmod_misc_math_isinf                    ),
+    RFUNC("ISNAN"                   , "D"           , TYPE_INT          , libmod_misc_math_isnan                    ),
+    RFUNC("FINITE"                  , "D"           , TYPE_INT          , libmod_misc_math_finite                   ),
 
     FUNC( "INTERSECT"               , "DDDDDDDDPP"  , TYPE_INT          , libmod_misc_math_intersect                ),
     FUNC( "INTERSECT_LINE_CIRCLE"   , "DDDDDDDPPPP" , TYPE_INT          , libmod_misc_math_intersect_line_circle    ),
@@ -234,31 +234,31 @@ DLSYSFUNCS  __bgdexport( libmod_misc, functions_exports)[] =
     FUNC( "ORTHO"                   , "DDDDDDPP"    , TYPE_DOUBLE       , libmod_misc_math_orthogonal_projection    ),
     FUNC( "PROJECT"                 , "DDDDDDPP"    , TYPE_DOUBLE       , libmod_misc_math_normal_projection        ),
 
-    FUNC( "FGET_ANGLE"              , "DDDD"        , TYPE_INT          , libmod_misc_math_fget_angle               ),
-    FUNC( "FGET_DIST"               , "DDDD"        , TYPE_DOUBLE       , libmod_misc_math_fget_dist                ),
-    FUNC( "DISTANCE"                , "DDDD"        , TYPE_DOUBLE       , libmod_misc_math_fget_dist                ),
-    FUNC( "DIST"                    , "DDDD"        , TYPE_DOUBLE       , libmod_misc_math_fget_dist                ),
-    FUNC( "NEAR_ANGLE"              , "III"         , TYPE_INT          , libmod_misc_math_near_angle               ),
-    FUNC( "GET_DISTX"               , "ID"          , TYPE_DOUBLE       , libmod_misc_math_get_distx                ),
-    FUNC( "GET_DISTY"               , "ID"          , TYPE_DOUBLE       , libmod_misc_math_get_disty                ),
-
-    FUNC( "MAG"                     , "DD"          , TYPE_DOUBLE       , libmod_misc_math_mag                      ),
-
-    FUNC( "CLAMP"                   , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_clamp_double             ),
-    FUNC( "CLAMP"                   , "III"         , TYPE_INT          , libmod_misc_math_clamp                    ),
-    FUNC( "BETWEEN"                 , "DDD"         , TYPE_INT          , libmod_misc_math_between_double           ),
-    FUNC( "BETWEEN"                 , "III"         , TYPE_INT          , libmod_misc_math_between                  ),
-    FUNC( "TOWARDS"                 , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_towards_double           ),
-    FUNC( "TOWARDS"                 , "III"         , TYPE_INT          , libmod_misc_math_towards                  ),
-    FUNC( "WRAP"                    , "III"         , TYPE_INT          , libmod_misc_math_wrap                     ),
-    FUNC( "LERP"                    , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_lerp                     ),
-    FUNC( "INVLERP"                 , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_invert_lerp              ),
-    FUNC( "RANGECHK"                , "DDD"         , TYPE_INT          , libmod_misc_math_check_range_double       ),
-    FUNC( "RANGECHK"                , "III"         , TYPE_INT          , libmod_misc_math_check_range              ),
-    FUNC( "REMAP"                   , "DDDDD"       , TYPE_DOUBLE       , libmod_misc_math_remap_double             ),
-    FUNC( "REMAP"                   , "IIIII"       , TYPE_INT          , libmod_misc_math_remap                    ),
-    FUNC( "NORMALIZE"               , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_normalize_double         ),
-    FUNC( "NORMALIZE"               , "III"         , TYPE_DOUBLE       , libmod_misc_math_normalize                ),
+    RFUNC("FGET_ANGLE"              , "DDDD"        , TYPE_INT          , libmod_misc_math_fget_angle               ),
+    RFUNC("FGET_DIST"               , "DDDD"        , TYPE_DOUBLE       , libmod_misc_math_fget_dist                ),
+    RFUNC("DISTANCE"                , "DDDD"        , TYPE_DOUBLE       , libmod_misc_math_fget_dist                ),
+    RFUNC("DIST"                    , "DDDD"        , TYPE_DOUBLE       , libmod_misc_math_fget_dist                ),
+    RFUNC("NEAR_ANGLE"              , "III"         , TYPE_INT          , libmod_misc_math_near_angle               ),
+    RFUNC("GET_DISTX"               , "ID"          , TYPE_DOUBLE       , libmod_misc_math_get_distx                ),
+    RFUNC("GET_DISTY"               , "ID"          , TYPE_DOUBLE       , libmod_misc_math_get_disty                ),
+
+    RFUNC("MAG"                     , "DD"          , TYPE_DOUBLE       , libmod_misc_math_mag                      ),
+
+    RFUNC("CLAMP"                   , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_clamp_double             ),
+    RFUNC("CLAMP"                   , "III"         , TYPE_INT          , libmod_misc_math_clamp                    ),
+    RFUNC("BETWEEN"                 , "DDD"         , TYPE_INT          , libmod_misc_math_between_double           ),
+    RFUNC("BETWEEN"                 , "III"         , TYPE_INT          , libmod_misc_math_between                  ),
+    RFUNC("TOWARDS"                 , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_towards_double           ),
+    RFUNC("TOWARDS"                 , "III"         , TYPE_INT          , libmod_misc_math_towards                  ),
+    RFUNC("WRAP"                    , "III"         , TYPE_INT          , libmod_misc_math_wrap                     ),
+    RFUNC("LERP"                    , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_lerp                     ),
+    RFUNC("INVLERP"                 , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_invert_lerp              ),
+    RFUNC("RANGECHK"                , "DDD"         , TYPE_INT          , libmod_misc_math_check_range_double       ),
+    RFUNC("RANGECHK"                , "III"         , TYPE_INT          , libmod_misc_math_check_range              ),
+    RFUNC("REMAP"                   , "DDDDD"       , TYPE_DOUBLE       , libmod_misc_math_remap_double             ),
+    RFUNC("REMAP"                   , "IIIII"       , TYPE_INT          , libmod_misc_math_remap                    ),
+    RFUNC("NORMALIZE"               , "DDD"         , TYPE_DOUBLE       , libmod_misc_math_normalize_double         ),
+    RFUNC("NORMALIZE"               , "III"         , TYPE_DOUBLE       , libmod_misc_math_normalize                ),
 
     /* Mem */
     FUNC( "MEM_CALLOC"              , "II"          , TYPE_POINTER      , libmod_misc_mem_calloc                    ),
@@ -77,6 +77,7 @@ int64_t libmod_misc_proc_exit( INSTANCE * my, int64_t * params ) {
     INSTANCE * i = first_instance;
     while ( i ) {
         LOCQWORD( libmod_misc, i, STATUS ) = STATUS_KILLED;
+        instance_wake( i );
         i = i->next;
     }
 
@@ -198,6 +199,7 @@ int64_t libmod_misc_proc_signal( INSTANCE * my, int64_t * params ) {
                 default:
                     return 1;
             }
+            instance_wake( i );
         }
 
         if ( params[1] >= S_TREE ) {
@@ -353,8 +355,10 @@ int64_t libmod_misc_proc_let_me_alone( INSTANCE * my, int64_t * params ) {
     INSTANCE * i = first_instance;
 
     while ( i ) {
-        if ( i != my && !( LOCQWORD( libmod_misc, i, STATUS ) & STATUS_DEAD ) )
+        if ( i != my && !( LOCQWORD( libmod_misc, i, STATUS ) & STATUS_DEAD ) ) {
             LOCQWORD( libmod_misc, i, STATUS ) = ( LOCQWORD( libmod_misc, i, STATUS ) & STATUS_WAITING_MASK ) | STATUS_KILLED;
+            instance_wake( i );
+        }
         i = i->next;
     }
     if ( LOCQWORD( libmod_misc, my, STATUS ) & ( STATUS_RUNNING | STATUS_SLEEPING | STATUS_FROZEN ) ) LOCQWORD( libmod_misc, my, STATUS ) = STATUS_RUNNING;
@@ -479,6 +483,7 @@ static int64_t __libmod_misc_proc_resume( INSTANCE * my, int64_t what ) {
         i = first_instance;
         while ( i ) {
             LOCQWORD( libmod_misc, i, STATUS ) &= ~STATUS_PAUSED_MASK;
+            instance_wake( i );
             i = i->next;
         }
         return 0;
@@ -489,6 +494,7 @@ static int64_t __libmod_misc_proc_resume( INSTANCE * my, int64_t what ) {
         ctx = NULL;
         while ( ( i = instance_get_by_type( what, &ctx ) ) ) {
             LOCQWORD( libmod_misc, i, STATUS ) &= ~STATUS_PAUSED_MASK;
+            instance_wake( i );
         }
         return 0;
     }
@@ -497,6 +503,7 @@ static int64_t __libmod_misc_proc_resume( INSTANCE * my, int64_t what ) {
         i = instance_get( what );
         if ( i ) {
             LOCQWORD( libmod_misc, i, STATUS ) &= ~STATUS_PAUSED_MASK;
+            instance_wake( i );
         }
     }
     return 1;
@@ -45,8 +45,7 @@
  */
 
 int64_t libmod_misc_string_strlen( INSTANCE * my, int64_t * params ) {
-    const char * str = string_get( params[0] ) ;
-    int64_t r = str ? strlen( str ) : 0 ;
+    int64_t r = string_length( params[0] ) ;
     string_discard( params[0] ) ;
     return r ;
 }